@@ -126,6 +126,9 @@ typedef enum
 }
 E_ECC_CURVE;                            /*!< ECC curve                \hideinitializer */
 
+typedef void (*CRYPTO_IRQ_CB)(uint32_t u32IntSts);      /*!< Crypto interrupt callback, see CRYPTO_SetCallback() */
+typedef void (*CRYPTO_WAIT_CB)(uint32_t u32IntMsk);     /*!< Crypto wait callback, see CRYPTO_SetCallback()      */
+
 /*! @}*/ /* end of group CRYPTO_EXPORTED_CONSTANTS */
 
 /** @addtogroup CRYPTO_EXPORTED_MACROS CRYPTO Exported Macros
@@ -327,18 +330,23 @@ E_ECC_CURVE;                            /*!< ECC curve                \hideiniti
 /*---------------------------------------------------------------------------------------------------------*/
 
 void Crypto_Init(void);
+void CRYPTO_SetCallback(CRYPTO_IRQ_CB pfnIrq, CRYPTO_WAIT_CB pfnWait);
 void PRNG_Config(CRPT_T *crpt, uint32_t u32KeySize, uint32_t u32SeedReload, uint32_t u32Seed);
 int  PRNG_Start(CRPT_T *crpt);
 void PRNG_Read(CRPT_T *crpt, uint32_t u32RandKey[]);
 int  PRNG_ReSeed(CRPT_T *crpt, uint32_t u32Seed);
 void AES_Open(CRPT_T *crpt, uint32_t u32EncDec, uint32_t u32OpMode, uint32_t u32KeySize, uint32_t u32SwapType);
 int  AES_Start(CRPT_T *crpt, int is_sm4, uint32_t u32DMAMode);
+void AES_Trigger(CRPT_T *crpt, int is_sm4, uint32_t u32DMAMode);
 void AES_SetKey(CRPT_T *crpt, uint32_t au32Keys[], uint32_t u32KeySize);
 void AES_SetInitVect(CRPT_T *crpt, uint32_t au32IV[]);
 void AES_SetDMATransfer(CRPT_T *crpt, uint32_t u32FBIAddr, uint32_t u32FBOAddr, uint32_t u32SrcAddr, uint32_t u32DstAddr, uint32_t u32TransCnt);
+void AES_SetGCMCount(CRPT_T *crpt, uint32_t u32IVCnt, uint32_t u32ACnt, uint32_t u32PCnt);
 void SHA_Open(CRPT_T *crpt, uint32_t u32OpMode, uint32_t u32SwapType, uint32_t hmac_key_len);
 int  SHA_Start(CRPT_T *crpt, uint32_t u32DMAMode);
+void SHA_Trigger(CRPT_T *crpt, uint32_t u32DMAMode);
 void SHA_SetDMATransfer(CRPT_T *crpt, uint32_t u32SrcAddr, uint32_t u32TransCnt);
+void SHA_SetFeedback(CRPT_T *crpt, uint32_t u32FBIAddr, uint32_t u32FBOAddr);
 void SHA_Read(CRPT_T *crpt, uint32_t u32Digest[]);
 int ECC_IsPrivateKeyValid(CRPT_T *crpt, E_ECC_CURVE ecc_curve,  char private_k[]);
 int ECC_GeneratePublicKey(CRPT_T *crpt, E_ECC_CURVE ecc_curve, char *private_k, char public_k1[], char public_k2[]);
@@ -355,8 +363,16 @@ int ECC_GenerateSecretZ_KS(CRPT_T *crpt, E_ECC_CURVE ecc_curve, int k_ksnum, cha
 int ECC_GenerateSignature_KS(CRPT_T *crpt, E_ECC_CURVE ecc_curve, char *message, int d_ksnum, int k_ksnum, char *R, char *S);
 int ECC_VerifySignature_KS(CRPT_T *crpt, E_ECC_CURVE ecc_curve, char *message, int x_ksnum, int y_ksnum, char *R, char *S);
 
+int ECC_GetCurveBytes(E_ECC_CURVE ecc_curve);
+int ECC_GeneratePublicKey_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t private_k[], uint8_t public_x[], uint8_t public_y[]);
+int ECC_Multiply_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t x1[], const uint8_t y1[], const uint8_t k[], uint8_t x2[], uint8_t y2[]);
+int ECC_GenerateSecretZ_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t private_k[], const uint8_t public_x[], const uint8_t public_y[], uint8_t secret_z[]);
+int ECC_GenerateSignature_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t message[], const uint8_t d[], const uint8_t k[], uint8_t R[], uint8_t S[]);
+int ECC_VerifySignature_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t message[], const uint8_t public_x[], const uint8_t public_y[], const uint8_t R[], const uint8_t S[]);
+
 int RSA_Encrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen, uint8_t *pubk, int klen, uint8_t *n, int nlen, uint8_t *out, int *olen);
 int RSA_Decrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen, uint8_t *privk, int klen, uint8_t *n, int nlen, uint8_t *out, int *olen);
+int RSA_DecryptCRT(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen, uint8_t *privk, int klen, uint8_t *n, int nlen, uint8_t *p, int plen, uint8_t *q, int qlen, uint8_t *out, int *olen);
 
 void Hex2Reg(char input[], uint32_t volatile reg[]);
 void Reg2Hex(int count, uint32_t volatile reg[], char output[]);
@@ -512,6 +512,8 @@ struct sk_buff {
     unsigned int len;
     unsigned int volatile rdy;
     void *pData;
+    unsigned int ts_sec;     /* rx hardware timestamp, 0 if not taken */
+    unsigned int ts_subsec;
 };
 
 struct net_device_stats {
@@ -566,6 +568,7 @@ typedef struct EMACDeviceStruct {
     DmaDesc *RxBusyDesc;             /* Rx Descriptor address corresponding to the index TxBusy */
     DmaDesc *RxNextDesc;             /* Rx Descriptor address corresponding to the index RxNext */
     DmaDesc *TxPrevDesc;             /* Previous Tx Descriptor */
+    u32     RxIntWdt;                /* Rx interrupt watchdog count, when non-zero rx descriptors are armed with DIC and RI is raised by the watchdog */
     u32     tx_sec;
     u32     tx_subsec;
     u32     rx_sec;
@@ -689,6 +692,8 @@ static void __inline__ EMAC_CLEARBITS(u64 u64Reg, u32 u32Mask)
 
 #define EMAC_DMA_RX_PD_RESUME(emacdev)       EMAC_WRITE((u64)&((EMACdevice *)emacdev)->MacBase->DmaRxPollDemand, 0UL)
 
+#define EMAC_DMA_RX_INT_WDT(emacdev, val)    EMAC_WRITE((u64)&((EMACdevice *)emacdev)->MacBase->DmaRxIntWdt, (val) & EMAC_DmaRxIntWdt_RIWT_Msk)
+
 #define EMAC_DMA_OPMODE_INIT(emacdev, val)   EMAC_WRITE((u64)&((EMACdevice *)emacdev)->MacBase->DmaOpMode, val)
 
 #define EMAC_DMA_RX_ENABLE(emacdev)          EMAC_SETBITS((u64)&((EMACdevice *)emacdev)->MacBase->DmaOpMode, EMAC_DmaOpMode_SR_Msk)
@@ -726,8 +731,8 @@ static void __inline__ EMAC_CLEARBITS(u64 u64Reg, u32 u32Mask)
 #define EMAC_TS_PTP_FILTER_ENABLE(emacdev)   EMAC_SETBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_TSENMACADDR_Msk)
 #define EMAC_TS_PTP_FILTER_DISABLE(emacdev)  EMAC_CLEARBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_TSENMACADDR_Msk)
 
-#define EMAC_TS_MASTER_ENABLE(emacdev)       EMAC_SETBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_SNAPTYPSEL_Msk)
-#define EMAC_TS_MASTER_DISABLE(emacdev)      EMAC_CLEARBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_SNAPTYPSEL_Msk)
+#define EMAC_TS_MASTER_ENABLE(emacdev)       EMAC_SETBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_TSMSTRENA_Msk)
+#define EMAC_TS_MASTER_DISABLE(emacdev)      EMAC_CLEARBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_TSMSTRENA_Msk)
 
 #define EMAC_TS_EVENT_ENABLE(emacdev)        EMAC_SETBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_TSEVNTENA_Msk)
 #define EMAC_TS_EVENT_DISABLE(emacdev)       EMAC_CLEARBITS((u64)&((EMACdevice *)emacdev)->MacBase->TSControl, EMAC_TSControl_TSEVNTENA_Msk)
@@ -824,8 +829,10 @@ bool EMAC_ES_is_rx_checksum_bypassed(u32 ext_status);
 bool EMAC_ES_is_IP_payload_error(u32 ext_status);
 s32 EMAC_get_tx_qptr(EMACdevice *emacdev, u32 *Status, u32 *Length, u32 *Buffer1, u32 *Buffer2, u32 *ExtStatus, u32 *TSLow, u32 *TSHigh);
 s32 EMAC_set_tx_qptr(EMACdevice *emacdev, u32 Length, u32 Buffer1, u32 offload_needed, u32 ts);
+s32 EMAC_set_tx_qptr_sg(EMACdevice *emacdev, u32 Count, u32 *Length, u32 *Buffer1, u32 offload_type, u32 ts);
 s32 EMAC_set_rx_qptr(EMACdevice *emacdev, u32 Buffer1, u32 Length1);
 s32 EMAC_get_rx_qptr(EMACdevice *emacdev, u32 *Status, u32 *Length, u32 *Buffer1, u32 *Buffer2, u32 *ExtStatus, u32 *TSHigh, u32 *TSLow);
+s32 EMAC_detach_rx_qptr(EMACdevice *emacdev, u32 *Status, u32 *Length, u32 *Buffer1, u32 *Buffer2, u32 *ExtStatus, u32 *TSHigh, u32 *TSLow);
 void EMAC_take_desc_ownership(DmaDesc *desc);
 void EMAC_take_desc_ownership_rx(EMACdevice *emacdev);
 void EMAC_take_desc_ownership_tx(EMACdevice *emacdev);
@@ -24,6 +24,10 @@ extern "C"
 #define SDH1_ENABLE_1_8_V	/* by SDH1 SD only */
 #define SDH1_FREQ         200000000ul   /*!< output 200MHz to SD  \hideinitializer */
 
+#ifndef SDH_ADMA_DESC_NUM
+#define SDH_ADMA_DESC_NUM 128   /*!< ADMA2 descriptors per controller, each moves up to 64 KB  \hideinitializer */
+#endif
+
 /** @addtogroup Standard_Driver Standard Driver
   @{
 */
@@ -141,6 +145,7 @@ extern "C"
 
 #define MMC_DATA_READ       1
 #define MMC_DATA_WRITE      2
+#define MMC_DATA_ADMA       4   /* moved by the ADMA2 descriptor table in adma */
 
 #define  SDH_CHCEK_FREQ         100000000ul
 
@@ -151,6 +156,7 @@ extern "C"
 
 #define SDH_TIMEOUT      (SDH_ERR_ID|0x01ul) /*!< Timeout  \hideinitializer */
 #define SDH_NO_MEMORY    (SDH_ERR_ID|0x02ul) /*!< OOM  \hideinitializer */
+#define SDH_BUSY         (SDH_ERR_ID|0x03ul) /*!< Request still queued or on the bus  \hideinitializer */
 
 /*-- function return value */
 #define    Successful  0ul   /*!< Success  \hideinitializer */
@@ -238,6 +244,7 @@ struct mmc_data {
     unsigned int flags;
     unsigned int blocks;
     unsigned int blocksize;
+    void *adma;     /* ADMA2 descriptor table, only with MMC_DATA_ADMA */
 };
 
 struct mmc {
@@ -261,6 +268,33 @@ typedef struct SDH_info_t
     unsigned char   *dmabuf;
 } SDH_INFO_T;                       /*!< Structure holds SD card info */
 
+typedef struct SDH_seg_t
+{
+    uint8_t         *pu8BufAddr;    /*!< Segment buffer, 4-byte aligned */
+    uint32_t        u32SecCount;    /*!< Sectors in the segment */
+} SDH_SEG_T;                        /*!< One buffer of a scattered SDH_ReadSG() or SDH_WriteSG() */
+
+typedef struct SDH_req_t SDH_REQ_T;
+typedef void (*SDH_REQ_CB)(SDH_REQ_T *pReq);   /*!< Completion callback of SDH_Submit(), called from SDH_IntHandler() */
+
+struct SDH_req_t
+{
+    const SDH_SEG_T *pSeg;          /*!< Buffers, as SDH_ReadSG() */
+    int             i32SegCount;    /*!< Number of buffers */
+    uint32_t        u32StartSec;    /*!< First sector */
+    int             i32Write;       /*!< 1 writes the buffers, 0 reads into them */
+    SDH_REQ_CB      pfnDone;        /*!< Called when the request ends, or NULL */
+    void            *pvParam;       /*!< For pfnDone, such as the task to notify */
+    volatile int    i32Status;      /*!< SDH_BUSY until the request ends, then Successful or the error */
+    /** @cond HIDDEN_SYMBOLS */
+    SDH_REQ_T       *pNext;
+    int             i32Idx;         /* segment and offset the next command starts at */
+    uint32_t        u32Off;
+    uint32_t        u32Sec;
+    uint32_t        u32Cnt;         /* sectors of the command on the bus */
+    /** @endcond HIDDEN_SYMBOLS */
+};                                  /*!< Asynchronous read or write, see SDH_Submit() */
+
 /*@}*/ /* end of group SDH_EXPORTED_TYPEDEF */
 
 /** @cond HIDDEN_SYMBOLS */
@@ -297,6 +331,10 @@ void SDH_Open(SDH_T *sdh);
 uint32_t SDH_Probe(SDH_T *sdh);
 int SDH_Read(SDH_T *sdh, uint8_t *pu8BufAddr, uint32_t u32StartSec, uint32_t u32SecCount);
 uint32_t SDH_Write(SDH_T *sdh, uint8_t *pu8BufAddr, uint32_t u32StartSec, uint32_t u32SecCount);
+int SDH_ReadSG(SDH_T *sdh, const SDH_SEG_T *pSeg, int i32SegCount, uint32_t u32StartSec);
+uint32_t SDH_WriteSG(SDH_T *sdh, const SDH_SEG_T *pSeg, int i32SegCount, uint32_t u32StartSec);
+int SDH_Submit(SDH_T *sdh, SDH_REQ_T *pReq);
+void SDH_IntHandler(SDH_T *sdh);
 uint32_t SDH_CardDetection(SDH_T *sdh);
 void SDH_Open_Disk(SDH_T *sdh);
 void SDH_Close_Disk(SDH_T *sdh);
@@ -48,17 +48,26 @@ void Hex2RegEx(char input[], uint32_t volatile reg[], int shift);
 static char ch2hex(char ch);
 static int  get_nibble_value(char c);
 
-static uint32_t _rsa_buff_pool[1548] __attribute__((aligned(32)));
+/* M, N, E, p, q, middle results, then the answer from word 1540 */
+static uint32_t _rsa_buff_pool[1540 + RSA_MAX_BYTE_LEN / 4] __attribute__((aligned(32)));
 static uint32_t *_rsa_buff;
 
 volatile int  g_PRNG_done, g_AES_done, g_AESERR_done;
 static volatile int g_HMAC_error, g_HMAC_done;
 static volatile int g_RSA_error, g_RSA_done;
 
+static CRYPTO_IRQ_CB  g_pfnCrptIrq;
+static CRYPTO_WAIT_CB g_pfnCrptWait;
+
+/* Called while a blocking API waits for an engine interrupt, see CRYPTO_SetCallback() */
+#define CRYPTO_WAIT(msk)    do { if (g_pfnCrptWait != NULL) g_pfnCrptWait(msk); } while (0)
+
 static void ECC_Complete(CRPT_T *crpt);
 
 void CRYPTO_IRQHandler(void)
 {
+	uint32_t u32IntSts = CRPT->INTSTS;
+
 	if (PRNG_GET_INT_FLAG(CRPT))
 	{
 		g_PRNG_done = 1;
@@ -71,6 +80,7 @@ void CRYPTO_IRQHandler(void)
 		{
 			sysprintf("    Not an error. AES_CNT is not multiple of 16.\n");
 			g_AES_done = 1;
+			u32IntSts = (u32IntSts & ~CRPT_INTSTS_AESEIF_Msk) | CRPT_INTSTS_AESIF_Msk;
 		}
 		else
 		{
@@ -108,6 +118,9 @@ void CRYPTO_IRQHandler(void)
 	}
 
 	ECC_Complete(CRPT);
+
+	if (g_pfnCrptIrq != NULL)
+		g_pfnCrptIrq(u32IntSts);
 }
 
 /** @endcond HIDDEN_SYMBOLS */
@@ -130,6 +143,23 @@ void Crypto_Init(void)
 	RSA_ENABLE_INT(CRPT);
 }
 
+/**
+  * @brief  Install callbacks for an operating system.
+  * @param[in]  pfnIrq   Called at the end of CRYPTO_IRQHandler() with the
+  *                      CRPT_INTSTS flags of the interrupt. An AES count error
+  *                      that is not an error is reported as AESIF. NULL for none.
+  * @param[in]  pfnWait  Called by the blocking APIs in their wait loop with the
+  *                      CRPT_INTSTS flags they wait for, so the caller can sleep
+  *                      until pfnIrq sees one of them. It may return early, the
+  *                      loop checks again. NULL to spin.
+  * @return None
+  */
+void CRYPTO_SetCallback(CRYPTO_IRQ_CB pfnIrq, CRYPTO_WAIT_CB pfnWait)
+{
+	g_pfnCrptIrq = pfnIrq;
+	g_pfnCrptWait = pfnWait;
+}
+
 /**
   * @brief  Configure PRNG function
   * @param[in]  crpt   Reference to Crypto module.
@@ -240,6 +270,8 @@ void PRNG_Read(CRPT_T *crpt, uint32_t u32RandKey[])
   *         - \ref AES_MODE_CBC_CS1
   *         - \ref AES_MODE_CBC_CS2
   *         - \ref AES_MODE_CBC_CS3
+  *         - \ref AES_MODE_GCM
+  *         - \ref AES_MODE_GHASH
   * @param[in]  u32KeySize is AES key size, including:
   *         - \ref AES_KEY_SIZE_128
   *         - \ref AES_KEY_SIZE_192
@@ -261,6 +293,25 @@ void AES_Open(CRPT_T *crpt, uint32_t u32EncDec, uint32_t u32OpMode,
 	g_AES_CTL = crpt->AES_CTL;
 }
 
+/**
+  * @brief  Start AES encrypt/decrypt without waiting for the engine. The end
+  *         of the operation is reported through CRYPTO_SetCallback().
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  is_sm4      1: SM4; 0: AES
+  * @param[in]  u32DMAMode  AES DMA control, as for AES_Start()
+  * @return None
+  */
+void AES_Trigger(CRPT_T *crpt, int is_sm4, uint32_t u32DMAMode)
+{
+	crpt->AES_CTL = g_AES_CTL;
+	if (is_sm4)
+		crpt->AES_CTL |= CRPT_AES_CTL_SM4EN_Msk;
+
+	g_AES_done = g_AESERR_done = 0;
+	__DSB();
+	crpt->AES_CTL |= CRPT_AES_CTL_START_Msk | (u32DMAMode << CRPT_AES_CTL_DMALAST_Pos);
+}
+
 /**
   * @brief  Start AES encrypt/decrypt
   * @param[in]  crpt        Reference to Crypto module.
@@ -269,26 +320,23 @@ void AES_Open(CRPT_T *crpt, uint32_t u32EncDec, uint32_t u32OpMode,
   *         - \ref CRYPTO_DMA_CONTINUE   Continuous AES encrypt/decrypt.
   *         - \ref CRYPTO_DMA_LAST       Last AES encrypt/decrypt of a series of AES_Start.
   * @retval   0     Success.
-  * @retval   < 0   Time-out
+  * @retval   < 0   Time-out or AES engine error
   */
 int AES_Start(CRPT_T *crpt, int is_sm4, uint32_t u32DMAMode)
 {
 	uint64_t t0;
 
-	crpt->AES_CTL = g_AES_CTL;
-	if (is_sm4)
-		crpt->AES_CTL |= CRPT_AES_CTL_SM4EN_Msk;
-
-	g_AES_done = g_AESERR_done = 0;
-	__DSB();
-	crpt->AES_CTL |= CRPT_AES_CTL_START_Msk | (u32DMAMode << CRPT_AES_CTL_DMALAST_Pos);
+	AES_Trigger(crpt, is_sm4, u32DMAMode);
 
 	t0 = EL0_GetCurrentPhysicalValue();
 	while (!g_AES_done && !g_AESERR_done)
 	{
+		CRYPTO_WAIT(CRPT_INTSTS_AESIF_Msk | CRPT_INTSTS_AESEIF_Msk);
 		if (EL0_GetCurrentPhysicalValue() - t0 > 12000000)  /* 1 second timeout */
 			return -1;
 	}
+	if (g_AESERR_done)
+		return -1;
 	return 0;
 }
 
@@ -303,7 +351,7 @@ int AES_Start(CRPT_T *crpt, int is_sm4, uint32_t u32DMAMode)
   *                         2:           AES key is from Key Store OTP
   * @param[in]  knum        Use Key Store OTP/SRAM key number "knum" as AES key
   * @retval   0     Success.
-  * @retval   < 0   Time-out
+  * @retval   < 0   Time-out or AES engine error
   */
 int AES_Start_KS(CRPT_T *crpt, uint32_t u32DMAMode, int ksel, int knum)
 {
@@ -322,9 +370,12 @@ int AES_Start_KS(CRPT_T *crpt, uint32_t u32DMAMode, int ksel, int knum)
 	t0 = EL0_GetCurrentPhysicalValue();
 	while (!g_AES_done && !g_AESERR_done)
 	{
+		CRYPTO_WAIT(CRPT_INTSTS_AESIF_Msk | CRPT_INTSTS_AESEIF_Msk);
 		if (EL0_GetCurrentPhysicalValue() - t0 > 12000000)  /* 1 second timeout */
 			return -1;
 	}
+	if (g_AESERR_done)
+		return -1;
 	return 0;
 }
 
@@ -402,6 +453,27 @@ void AES_SetDMATransfer(CRPT_T *crpt, uint32_t u32FBIAddr, uint32_t u32FBOAddr,
 	crpt->AES0_CNT = u32TransCnt;
 }
 
+/**
+  * @brief  Set the byte counts of an AES GCM or GHASH operation. The DMA source
+  *         holds the IV, the additional data and the text in this order, each
+  *         padded with zeros to a multiple of 16 bytes. The engine writes the
+  *         text, padded the same way, followed by the 16 bytes tag.
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  u32IVCnt    IV byte count
+  * @param[in]  u32ACnt     Additional authenticated data byte count
+  * @param[in]  u32PCnt     Plain or cipher text byte count
+  * @return None
+  */
+void AES_SetGCMCount(CRPT_T *crpt, uint32_t u32IVCnt, uint32_t u32ACnt, uint32_t u32PCnt)
+{
+	crpt->AES_GCM_IVCNT[0] = u32IVCnt;
+	crpt->AES_GCM_IVCNT[1] = 0;
+	crpt->AES_GCM_ACNT[0] = u32ACnt;
+	crpt->AES_GCM_ACNT[1] = 0;
+	crpt->AES_GCM_PCNT[0] = u32PCnt;
+	crpt->AES_GCM_PCNT[1] = 0;
+}
+
 
 /**
   * @brief  Open SHA encrypt function.
@@ -432,6 +504,22 @@ void SHA_Open(CRPT_T *crpt, uint32_t u32OpMode, uint32_t u32SwapType, uint32_t h
 	}
 }
 
+/**
+  * @brief  Start SHA encrypt without waiting for the engine. The end of the
+  *         operation is reported through CRYPTO_SetCallback().
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  u32DMAMode  SHA DMA control, as for SHA_Start()
+  * @return None
+  */
+void SHA_Trigger(CRPT_T *crpt, uint32_t u32DMAMode)
+{
+	crpt->HMAC_CTL &= ~(0x7UL << CRPT_HMAC_CTL_DMALAST_Pos);
+
+	g_HMAC_done = g_HMAC_error = 0;
+	__DSB();
+	crpt->HMAC_CTL |= CRPT_HMAC_CTL_START_Msk | (u32DMAMode << CRPT_HMAC_CTL_DMALAST_Pos);
+}
+
 /**
   * @brief  Start SHA encrypt
   * @param[in]  crpt        Reference to Crypto module.
@@ -440,24 +528,23 @@ void SHA_Open(CRPT_T *crpt, uint32_t u32OpMode, uint32_t u32SwapType, uint32_t h
   *         - \ref CRYPTO_DMA_CONTINUE   Continuous SHA encrypt.
   *         - \ref CRYPTO_DMA_LAST       Last SHA encrypt of a series of SHA_Start.
   * @retval   0     Success.
-  * @retval   < 0   Time-out
+  * @retval   < 0   Time-out or SHA engine error
   */
 int SHA_Start(CRPT_T *crpt, uint32_t u32DMAMode)
 {
 	uint64_t t0;
 
-	crpt->HMAC_CTL &= ~(0x7UL << CRPT_HMAC_CTL_DMALAST_Pos);
-
-	g_HMAC_done = g_HMAC_error = 0;
-	__DSB();
-	crpt->HMAC_CTL |= CRPT_HMAC_CTL_START_Msk | (u32DMAMode << CRPT_HMAC_CTL_DMALAST_Pos);
+	SHA_Trigger(crpt, u32DMAMode);
 
 	t0 = EL0_GetCurrentPhysicalValue();
 	while (!g_HMAC_done && !g_HMAC_error)
 	{
+		CRYPTO_WAIT(CRPT_INTSTS_HMACIF_Msk | CRPT_INTSTS_HMACEIF_Msk);
 		if (EL0_GetCurrentPhysicalValue() - t0 > 12000000)  /* 1 second timeout */
 			return -1;
 	}
+	if (g_HMAC_error)
+		return -1;
 	return 0;
 }
 
@@ -474,6 +561,33 @@ void SHA_SetDMATransfer(CRPT_T *crpt, uint32_t u32SrcAddr, uint32_t u32TransCnt)
 	crpt->HMAC_DMACNT = u32TransCnt;
 }
 
+/**
+  * @brief  Set SHA DMA feedback buffer.
+  *         The engine saves its intermediate state to the feedback buffer at the
+  *         end of a DMA, and restores it from there at the start of the next one,
+  *         so that a DMA cascade can be split with other SHA operations in between.
+  *         Must be called after SHA_Open().
+  * @param[in]  crpt         Reference to Crypto module.
+  * @param[in]  u32FBIAddr   SHA feedback in buffer address, 0 for the first DMA of a cascade
+  * @param[in]  u32FBOAddr   SHA feedback out buffer address, 0 for the last DMA of a cascade
+  * @return None
+  */
+void SHA_SetFeedback(CRPT_T *crpt, uint32_t u32FBIAddr, uint32_t u32FBOAddr)
+{
+	crpt->HMAC_CTL &= ~(CRPT_HMAC_CTL_FBIN_Msk | CRPT_HMAC_CTL_FBOUT_Msk);
+	crpt->HMAC_FBADDR = 0;
+	if (u32FBIAddr != 0)
+	{
+		crpt->HMAC_CTL |= CRPT_HMAC_CTL_FBIN_Msk;
+		crpt->HMAC_FBADDR = u32FBIAddr;
+	}
+	if (u32FBOAddr != 0)
+	{
+		crpt->HMAC_CTL |= CRPT_HMAC_CTL_FBOUT_Msk;
+		crpt->HMAC_FBADDR = u32FBOAddr;
+	}
+}
+
 /**
   * @brief  Read the SHA digest.
   * @param[in]  crpt        Reference to Crypto module.
@@ -1200,6 +1314,174 @@ int ecc_init_curve(CRPT_T *crpt, E_ECC_CURVE ecc_curve)
 	return ret;
 }
 
+/*-----------------------------------------------------*/
+/*  Curve parameters in register format, converted     */
+/*  from _Curve[] on first use of each curve           */
+/*-----------------------------------------------------*/
+
+typedef struct e_curve_reg_t
+{
+	int       valid;
+	int       bytes;            /* length of a coordinate or scalar in bytes */
+	uint32_t  Ea[18];
+	uint32_t  Eb[18];
+	uint32_t  Px[18];
+	uint32_t  Py[18];
+	uint32_t  Pn[18];           /* prime modulus or irreducible polynomial */
+	uint32_t  Eorder[18];
+}  ECC_CURVE_REG;
+
+static ECC_CURVE_REG  _CurveReg[sizeof(_Curve) / sizeof(ECC_CURVE)];
+static ECC_CURVE_REG  *pCurveReg;
+
+static ECC_CURVE_REG * get_curve_reg(E_ECC_CURVE ecc_curve)
+{
+	uint32_t   i;
+	ECC_CURVE  *curve;
+	ECC_CURVE_REG  *reg;
+
+	for (i = 0UL; i < sizeof(_Curve) / sizeof(ECC_CURVE); i++)
+	{
+		if (ecc_curve == _Curve[i].curve_id)
+		{
+			break;
+		}
+	}
+	if (i >= sizeof(_Curve) / sizeof(ECC_CURVE))
+	{
+		return NULL;
+	}
+
+	curve = &_Curve[i];
+	reg = &_CurveReg[i];
+	if (reg->valid == 0)
+	{
+		memset(reg, 0, sizeof(ECC_CURVE_REG));
+		Hex2Reg(curve->Ea, reg->Ea);
+		Hex2Reg(curve->Eb, reg->Eb);
+		Hex2Reg(curve->Px, reg->Px);
+		Hex2Reg(curve->Py, reg->Py);
+		Hex2Reg(curve->Eorder, reg->Eorder);
+
+		if (curve->GF == (int)CURVE_GF_2M)
+		{
+			reg->Pn[0] = 0x1UL;
+			reg->Pn[(curve->key_len) / 32] |= (1UL << ((curve->key_len) % 32));
+			reg->Pn[(curve->irreducible_k1) / 32] |= (1UL << ((curve->irreducible_k1) % 32));
+			reg->Pn[(curve->irreducible_k2) / 32] |= (1UL << ((curve->irreducible_k2) % 32));
+			reg->Pn[(curve->irreducible_k3) / 32] |= (1UL << ((curve->irreducible_k3) % 32));
+		}
+		else
+		{
+			Hex2Reg(curve->Pp, reg->Pn);
+		}
+
+		reg->bytes = (curve->Echar + 1) / 2;
+		reg->valid = 1;
+	}
+
+	/* run_ecc_codec() takes the field and key length from pCurve */
+	pCurve = curve;
+	return reg;
+}
+
+/* Same register setup as ecc_init_curve(), from the cached curve */
+static int ecc_load_curve(CRPT_T *crpt, E_ECC_CURVE ecc_curve)
+{
+	int  i;
+
+	pCurveReg = get_curve_reg(ecc_curve);
+	if (pCurveReg == NULL)
+	{
+		CRPT_DBGMSG("Cannot find curve %d!!\n", ecc_curve);
+		return -1;
+	}
+
+	for (i = 0; i < 18; i++)
+	{
+		crpt->ECC_A[i] = pCurveReg->Ea[i];
+		crpt->ECC_B[i] = pCurveReg->Eb[i];
+		crpt->ECC_X1[i] = pCurveReg->Px[i];
+		crpt->ECC_Y1[i] = pCurveReg->Py[i];
+		crpt->ECC_X2[i] = 0UL;
+		crpt->ECC_Y2[i] = 0UL;
+		crpt->ECC_N[i] = pCurveReg->Pn[i];
+	}
+	return 0;
+}
+
+static void ecc_copy_reg(uint32_t volatile dst[], uint32_t volatile src[])
+{
+	int  i;
+
+	for (i = 0; i < 18; i++)
+	{
+		dst[i] = src[i];
+	}
+}
+
+/* Big-endian byte array of len bytes to all 18 words of an ECC register */
+static void Bin2Reg(const uint8_t input[], int len, uint32_t volatile reg[])
+{
+	int       ri, bi, idx;
+	uint32_t  val32;
+
+	for (ri = 0; ri < 18; ri++)
+	{
+		val32 = 0UL;
+		for (bi = 0; bi < 4; bi++)
+		{
+			idx = len - 1 - ri * 4 - bi;
+			if (idx >= 0)
+			{
+				val32 |= (uint32_t)input[idx] << (bi * 8);
+			}
+		}
+		reg[ri] = val32;
+	}
+}
+
+/* Bin2Reg() with the value shifted left by shift bits, as Hex2RegEx() */
+static void Bin2RegEx(const uint8_t input[], int len, uint32_t volatile reg[], int shift)
+{
+	uint32_t  words[18], carry;
+	int       i;
+
+	Bin2Reg(input, len, words);
+	carry = 0UL;
+	for (i = 0; i < 18; i++)
+	{
+		reg[i] = (words[i] << shift) | carry;
+		carry = (shift != 0) ? (words[i] >> (32 - shift)) : 0UL;
+	}
+}
+
+static void Reg2Bin(uint32_t volatile reg[], int len, uint8_t output[])
+{
+	int  i;
+
+	for (i = 0; i < len; i++)
+	{
+		output[len - 1 - i] = (uint8_t)(reg[i / 4] >> ((i % 4) * 8));
+	}
+}
+
+/* Private key alignment of the binary field curves, see ECC_GenerateSecretZ() */
+static int ecc_key_shift(E_ECC_CURVE ecc_curve)
+{
+	if ((ecc_curve == CURVE_B_163) || (ecc_curve == CURVE_B_233) || (ecc_curve == CURVE_B_283) ||
+			(ecc_curve == CURVE_B_409) || (ecc_curve == CURVE_B_571) || (ecc_curve == CURVE_K_163))
+	{
+		return 1;
+	}
+	if ((ecc_curve == CURVE_K_233) || (ecc_curve == CURVE_K_283) ||
+			(ecc_curve == CURVE_K_409) || (ecc_curve == CURVE_K_571))
+	{
+		return 2;
+	}
+	return 0;
+}
+
 static int  get_nibble_value(char c)
 {
 	if ((c >= '0') && (c <= '9'))
@@ -1379,6 +1661,7 @@ int  ECC_GeneratePublicKey(CRPT_T *crpt, E_ECC_CURVE ecc_curve, char *private_k,
 
 		while ((g_ECC_done | g_ECCERR_done) == 0UL)
 		{
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 			//sysprintf("ECC_CTL = 0x%x, ECC_STS = 0x%x\n",  crpt->ECC_CTL, crpt->ECC_STS);
 		}
 
@@ -1458,6 +1741,7 @@ int  ECC_GeneratePublicKey_KS(CRPT_T *crpt, E_ECC_CURVE ecc_curve, int k_ksnum,
 
 		while ((g_ECC_done | g_ECCERR_done) == 0UL)
 		{
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 		}
 		CRPT->ECC_KSCTL = 0;
 
@@ -1518,6 +1802,7 @@ int  ECC_Mutiply(CRPT_T *crpt, E_ECC_CURVE ecc_curve, char x1[], char y1[], char
 
 		while ((g_ECC_done | g_ECCERR_done) == 0UL)
 		{
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 		}
 
 		Reg2Hex(pCurve->Echar, crpt->ECC_X1, x2);
@@ -1627,6 +1912,7 @@ int  ECC_Mutiply_KS(CRPT_T *crpt, E_ECC_CURVE ecc_curve, int x1_ksnum, char x1[]
 
 		while ((g_ECC_done | g_ECCERR_done) == 0UL)
 		{
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 		}
 		CRPT->ECC_KSCTL = 0;
 		crpt->ECC_KSXY = 0;
@@ -1702,6 +1988,7 @@ int  ECC_GenerateSecretZ(CRPT_T *crpt, E_ECC_CURVE ecc_curve, char *private_k, c
 
 		while ((g_ECC_done | g_ECCERR_done) == 0UL)
 		{
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 		}
 
 		Reg2Hex(pCurve->Echar, crpt->ECC_X1, secret_z);
@@ -1817,6 +2104,7 @@ int  ECC_GenerateSecretZ_KS(CRPT_T *crpt, E_ECC_CURVE ecc_curve, int k_ksnum, ch
 
 	while ((g_ECC_done | g_ECCERR_done) == 0UL)
 	{
+		CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 	}
 	crpt->ECC_KSCTL = 0;
 	crpt->ECC_KSXY = 0;
@@ -1864,6 +2152,7 @@ static void run_ecc_codec(CRPT_T *crpt, uint32_t mode, int enable_scap)
 	crpt->ECC_CTL |= ((uint32_t)pCurve->key_len << CRPT_ECC_CTL_CURVEM_Pos) | mode | CRPT_ECC_CTL_START_Msk;
 	while ((g_ECC_done | g_ECCERR_done) == 0UL)
 	{
+		CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 	}
 
 	while (crpt->ECC_STS & CRPT_ECC_STS_BUSY_Msk)
@@ -3045,83 +3334,451 @@ int  ECC_VerifySignature_KS(CRPT_T *crpt, E_ECC_CURVE ecc_curve, char *message,
 }
 
 
-static int rsa_hex_to_reg(int rsa_len, uint8_t *in, int len, uint32_t *reg)
+/**
+  * @brief  Get the length of the coordinates and scalars of a curve in the binary ECC functions.
+  * @param[in]  ecc_curve   The pre-defined ECC curve.
+  * @return  Length in bytes.
+  * @return  -1   "ecc_curve" value is invalid.
+  * @details The ECC_xxx_Bin() functions take and return big-endian byte arrays of this length,
+  *          the curve constants are converted to register format once and kept for later calls.
+  */
+int  ECC_GetCurveBytes(E_ECC_CURVE ecc_curve)
 {
-	int dlen = len;
-	uint8_t *key, buff[RSA_MAX_BYTE_LEN];
-	int i, idx;
+	ECC_CURVE_REG  *reg;
 
-	if (dlen > rsa_len)
+	reg = get_curve_reg(ecc_curve);
+	if (reg == NULL)
+	{
 		return -1;
+	}
+	return reg->bytes;
+}
 
-	memset(reg, 0, RSA_MAX_BYTE_LEN);
+/**
+  * @brief  Given a private key and curve to generate the public key pair, binary version.
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  ecc_curve   The pre-defined ECC curve.
+  * @param[in]  private_k   The input private key.
+  * @param[out] public_x    The output public key x.
+  * @param[out] public_y    The output public key y.
+  * @return  0    Success.
+  * @return  -1   "ecc_curve" value is invalid.
+  * @details All parameters are big-endian byte arrays of ECC_GetCurveBytes() bytes.
+  */
+int  ECC_GeneratePublicKey_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t private_k[],
+							   uint8_t public_x[], uint8_t public_y[])
+{
+	int  ret = 0;
 
-	memset(buff, 0, sizeof(buff));
+	if (ecc_load_curve(crpt, ecc_curve) != 0)
+	{
+		ret = -1;
+	}
 
-	/* remove leading 0x00's */
-	for (key = in; ((*key == 0x00) && (dlen > 0)); key++)
-		dlen--;
+	if (ret == 0)
+	{
+		Bin2Reg(private_k, pCurveReg->bytes, crpt->ECC_K);
+		ecc_copy_reg(crpt->ECC_X2, pCurveReg->Eorder);
 
-	if (dlen < 0 || dlen > rsa_len)
-		return -1;
+		/* set FSEL (Field selection) */
+		if (pCurve->GF == (int)CURVE_GF_2M)
+		{
+			crpt->ECC_CTL = 0UL;
+		}
+		else
+		{
+			/*  CURVE_GF_P */
+			crpt->ECC_CTL = CRPT_ECC_CTL_FSEL_Msk;
+		}
 
-	memcpy(&buff[rsa_len - dlen], key, dlen);
+		if  (ecc_curve == CURVE_25519)
+		{
+			crpt->ECC_CTL |= CRPT_ECC_CTL_SCAP_Msk;
+			crpt->ECC_CTL |= CRPT_ECC_CTL_CSEL_Msk;
+		}
 
-	for (idx = rsa_len - 1; idx > 0; idx -= 4)
-	{
-		*reg++ = (buff[idx - 3] << 24) | (buff[idx - 2] << 16) |
-				 (buff[idx - 1] << 8) | buff[idx];
-	}
-	return 0;
-}
+		/* enable side-channel attack protection */
+		crpt->ECC_CTL |= CRPT_ECC_CTL_SCAP_Msk | CRPT_ECC_CTL_ASCAP_Msk;
 
-static void rsa_reg_to_hex(u32 *reg, int rsa_len, uint8_t *key, int *key_sz)
-{
-	int i, idx;
+		g_ECC_done = g_ECCERR_done = 0UL;
+		crpt->ECC_CTL |= ((uint32_t)pCurve->key_len << CRPT_ECC_CTL_CURVEM_Pos) |
+						 ECCOP_POINT_MUL | CRPT_ECC_CTL_PFA2C_Msk | CRPT_ECC_CTL_START_Msk;
 
-	*key_sz = 0;
-	for (idx = rsa_len / 4 - 1 ; idx >= 0; idx--)
-	{
-		for (i = 3; i >= 0; i--)
+		while ((g_ECC_done | g_ECCERR_done) == 0UL)
 		{
-			*key++ = (reg[idx] >> (i * 8)) & 0xff;
-			(*key_sz)++;
-			if (*key_sz >= RSA_MAX_BYTE_LEN)
-				return;
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
 		}
+
+		Reg2Bin(crpt->ECC_X1, pCurveReg->bytes, public_x);
+		Reg2Bin(crpt->ECC_Y1, pCurveReg->bytes, public_y);
 	}
+
+	return ret;
 }
 
 /**
-  * @brief  Use RSA engine to encrypt a block of data with given
-  *         public key and modulus.
-  * @param[in]  crpt     Reference to Crypto module.
-  * @param[in]  ras_blen Bit length of RSA keys. It must be one of 1024,
-  *                      2048, 3072, or 4096.
-  * @param[in]  data     The plain text data.
-  * @param[in]  dlen     The length of plain text data in bytes.
-  * @param[in]  pubk     The RSA public key.
-  * @param[in]  klen     The length of RSA public key in bytes.
-  * @param[in]  n        The RSA modulus.
-  * @param[in]  nlen     The length of modulus in bytes.
-  * @param[out] out      The RSA encrypted output data. The length always
-  *                      be <klen> / 8.
-  * @param[out] olen     The length of output data.
-  * @retval   0    Success.
-  * @retval   -1   RSA encrypt time-out
-  * @retval   -2   Invalid parameters
+  * @brief  Multiply a point of the curve by a scalar, binary version.
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  ecc_curve   The pre-defined ECC curve.
+  * @param[in]  x1          The x-coordinate of input point.
+  * @param[in]  y1          The y-coordinate of input point.
+  * @param[in]  k           The multiplier.
+  * @param[out] x2          The x-coordinate of output point.
+  * @param[out] y2          The y-coordinate of output point.
+  * @return  0    Success.
+  * @return  -1   "ecc_curve" value is invalid.
+  * @details All parameters are big-endian byte arrays of ECC_GetCurveBytes() bytes.
   */
-int RSA_Encrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
-				 uint8_t *pubk, int klen, uint8_t *n, int nlen, uint8_t *out, int *olen)
+int  ECC_Multiply_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t x1[], const uint8_t y1[],
+					  const uint8_t k[], uint8_t x2[], uint8_t y2[])
 {
-	uint8_t buff[RSA_MAX_BYTE_LEN + 4];
-	uint64_t t0;
+	int  ret = 0;
 
-	if (ras_blen % 1024 || ras_blen > 4096)
-		return -2;
+	if (ecc_load_curve(crpt, ecc_curve) != 0)
+	{
+		ret = -1;
+	}
+
+	if (ret == 0)
+	{
+		Bin2Reg(x1, pCurveReg->bytes, crpt->ECC_X1);
+		Bin2Reg(y1, pCurveReg->bytes, crpt->ECC_Y1);
+		Bin2Reg(k, pCurveReg->bytes, crpt->ECC_K);
+
+		/* set FSEL (Field selection) */
+		if (pCurve->GF == (int)CURVE_GF_2M)
+		{
+			crpt->ECC_CTL = 0UL;
+		}
+		else
+		{
+			/*  CURVE_GF_P */
+			crpt->ECC_CTL = CRPT_ECC_CTL_FSEL_Msk;
+		}
+
+		g_ECC_done = g_ECCERR_done = 0UL;
+		crpt->ECC_CTL |= ((uint32_t)pCurve->key_len << CRPT_ECC_CTL_CURVEM_Pos) |
+						 ECCOP_POINT_MUL | CRPT_ECC_CTL_START_Msk;
+
+		while ((g_ECC_done | g_ECCERR_done) == 0UL)
+		{
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
+		}
+
+		Reg2Bin(crpt->ECC_X1, pCurveReg->bytes, x2);
+		Reg2Bin(crpt->ECC_Y1, pCurveReg->bytes, y2);
+	}
+
+	return ret;
+}
+
+/**
+  * @brief  Given a curve parameter, the other party's public key, and one's own private key to generate
+  *         the secret Z, binary version.
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  ecc_curve   The pre-defined ECC curve.
+  * @param[in]  private_k   One's own private key.
+  * @param[in]  public_x    The other party's public key x.
+  * @param[in]  public_y    The other party's public key y.
+  * @param[out] secret_z    The ECC CDH secret Z.
+  * @return  0    Success.
+  * @return  -1   "ecc_curve" value is invalid.
+  * @details All parameters are big-endian byte arrays of ECC_GetCurveBytes() bytes.
+  */
+int  ECC_GenerateSecretZ_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t private_k[],
+							 const uint8_t public_x[], const uint8_t public_y[], uint8_t secret_z[])
+{
+	int  i, ret = 0;
+
+	if (ecc_load_curve(crpt, ecc_curve) != 0)
+	{
+		ret = -1;
+	}
+
+	if (ret == 0)
+	{
+		for (i = 0; i < 18; i++)
+		{
+			crpt->ECC_X2[i] = 0UL;
+		}
+
+		Bin2RegEx(private_k, pCurveReg->bytes, crpt->ECC_K, ecc_key_shift(ecc_curve));
+		Bin2Reg(public_x, pCurveReg->bytes, crpt->ECC_X1);
+		Bin2Reg(public_y, pCurveReg->bytes, crpt->ECC_Y1);
+
+		/* set FSEL (Field selection) */
+		if (pCurve->GF == (int)CURVE_GF_2M)
+		{
+			crpt->ECC_CTL = 0UL;
+		}
+		else
+		{
+			/*  CURVE_GF_P */
+			crpt->ECC_CTL = CRPT_ECC_CTL_FSEL_Msk;
+		}
+		g_ECC_done = g_ECCERR_done = 0UL;
+		crpt->ECC_CTL |= ((uint32_t)pCurve->key_len << CRPT_ECC_CTL_CURVEM_Pos) |
+						 ECCOP_POINT_MUL | CRPT_ECC_CTL_START_Msk;
+
+		while ((g_ECC_done | g_ECCERR_done) == 0UL)
+		{
+			CRYPTO_WAIT(CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk);
+		}
+
+		Reg2Bin(crpt->ECC_X1, pCurveReg->bytes, secret_z);
+	}
+
+	return ret;
+}
+
+/**
+  * @brief  ECDSA digital signature generation, binary version.
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  ecc_curve   The pre-defined ECC curve.
+  * @param[in]  message     The hash value of source context, truncated to the curve order.
+  * @param[in]  d           The private key.
+  * @param[in]  k           The selected random integer.
+  * @param[out] R           R of the (R,S) pair digital signature
+  * @param[out] S           S of the (R,S) pair digital signature
+  * @return  0    Success.
+  * @return  -1   "ecc_curve" value is invalid.
+  * @details All parameters are big-endian byte arrays of ECC_GetCurveBytes() bytes.
+  *          The register sequence is the one of ECC_GenerateSignature().
+  */
+int  ECC_GenerateSignature_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t message[],
+							   const uint8_t d[], const uint8_t k[], uint8_t R[], uint8_t S[])
+{
+	uint32_t  temp_result1[18], temp_result2[18];
+	int  i, ret = 0;
+
+	if (ecc_load_curve(crpt, ecc_curve) != 0)
+	{
+		ret = -1;
+	}
+
+	if (ret == 0)
+	{
+		/* 3. r = x1 (mod n), where (x1, y1) = k * G */
+		Bin2Reg(k, pCurveReg->bytes, crpt->ECC_K);
+		ecc_copy_reg(crpt->ECC_X2, pCurveReg->Eorder);
+
+		run_ecc_codec(crpt, ECCOP_POINT_MUL, 1);
+
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		for (i = 0; i < 18; i++)
+		{
+			crpt->ECC_Y1[i] = 0UL;
+		}
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_ADD, 0);
+
+		ecc_copy_reg(temp_result1, crpt->ECC_X1);
+		Reg2Bin(temp_result1, pCurveReg->bytes, R);
+
+		/* 4. s = k^-1 * (e + d * r) (mod n), k^-1 first */
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		for (i = 0; i < 18; i++)
+		{
+			crpt->ECC_Y1[i] = 0UL;
+		}
+		crpt->ECC_Y1[0] = 0x1UL;
+		Bin2Reg(k, pCurveReg->bytes, crpt->ECC_X1);
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_DIV, 0);
+
+		ecc_copy_reg(temp_result2, crpt->ECC_X1);
+
+		/* d * r */
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		ecc_copy_reg(crpt->ECC_X1, temp_result1);
+		Bin2Reg(d, pCurveReg->bytes, crpt->ECC_Y1);
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_MUL, 0);
+
+		/* e + d * r */
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		Bin2Reg(message, pCurveReg->bytes, crpt->ECC_Y1);
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_ADD, 0);
+
+		/* k^-1 * (e + d * r) */
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		ecc_copy_reg(crpt->ECC_Y1, temp_result2);
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_MUL, 0);
+
+		Reg2Bin(crpt->ECC_X1, pCurveReg->bytes, S);
+	}
+
+	return ret;
+}
+
+/**
+  * @brief  ECDSA digital signature verification, binary version.
+  * @param[in]  crpt        Reference to Crypto module.
+  * @param[in]  ecc_curve   The pre-defined ECC curve.
+  * @param[in]  message     The hash value of source context, truncated to the curve order.
+  * @param[in]  public_x    The public key x.
+  * @param[in]  public_y    The public key y.
+  * @param[in]  R           R of the (R,S) pair digital signature
+  * @param[in]  S           S of the (R,S) pair digital signature
+  * @return  0    Success.
+  * @return  -1   "ecc_curve" value is invalid.
+  * @return  -2   Verification failed.
+  * @details All parameters are big-endian byte arrays of ECC_GetCurveBytes() bytes.
+  *          The register sequence is the one of ECC_VerifySignature().
+  */
+int  ECC_VerifySignature_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t message[],
+							 const uint8_t public_x[], const uint8_t public_y[],
+							 const uint8_t R[], const uint8_t S[])
+{
+	uint32_t  temp_result1[18], temp_result2[18];
+	uint32_t  temp_x[18], temp_y[18];
+	uint8_t   x1[72];
+	int   i, ret = 0;
+
+	if (ecc_load_curve(crpt, ecc_curve) != 0)
+	{
+		ret = -1;
+	}
+
+	if (ret == 0)
+	{
+		/* 3. w = s^-1 (mod n) */
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		for (i = 0; i < 18; i++)
+		{
+			crpt->ECC_Y1[i] = 0UL;
+		}
+		crpt->ECC_Y1[0] = 0x1UL;
+		Bin2Reg(S, pCurveReg->bytes, crpt->ECC_X1);
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_DIV, 0);
+
+		ecc_copy_reg(temp_result2, crpt->ECC_X1);
+
+		/* 4. u1 = e * w (mod n) */
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		Bin2Reg(message, pCurveReg->bytes, crpt->ECC_X1);
+		ecc_copy_reg(crpt->ECC_Y1, temp_result2);
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_MUL, 0);
+
+		ecc_copy_reg(temp_result1, crpt->ECC_X1);
+
+		/* u2 = r * w (mod n) */
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		Bin2Reg(R, pCurveReg->bytes, crpt->ECC_X1);
+		ecc_copy_reg(crpt->ECC_Y1, temp_result2);
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_MUL, 0);
 
+		ecc_copy_reg(temp_result2, crpt->ECC_X1);
+
+		/* 5. X' = u1 * G + u2 * Q, u1 * G first */
+		ecc_load_curve(crpt, ecc_curve);
+		ecc_copy_reg(crpt->ECC_K, temp_result1);
+		ecc_copy_reg(crpt->ECC_X2, pCurveReg->Eorder);
+
+		run_ecc_codec(crpt, ECCOP_POINT_MUL, 1);
+
+		ecc_copy_reg(temp_x, crpt->ECC_X1);
+		ecc_copy_reg(temp_y, crpt->ECC_Y1);
+
+		/* u2 * Q */
+		ecc_load_curve(crpt, ecc_curve);
+		Bin2Reg(public_x, pCurveReg->bytes, crpt->ECC_X1);
+		Bin2Reg(public_y, pCurveReg->bytes, crpt->ECC_Y1);
+		ecc_copy_reg(crpt->ECC_K, temp_result2);
+		ecc_copy_reg(crpt->ECC_X2, pCurveReg->Eorder);
+
+		run_ecc_codec(crpt, ECCOP_POINT_MUL, 1);
+
+		ecc_copy_reg(temp_result1, crpt->ECC_X1);
+		ecc_copy_reg(temp_result2, crpt->ECC_Y1);
+
+		/* u1 * G + u2 * Q */
+		ecc_load_curve(crpt, ecc_curve);
+		ecc_copy_reg(crpt->ECC_X1, temp_result1);
+		ecc_copy_reg(crpt->ECC_Y1, temp_result2);
+		ecc_copy_reg(crpt->ECC_X2, temp_x);
+		ecc_copy_reg(crpt->ECC_Y2, temp_y);
+
+		run_ecc_codec(crpt, ECCOP_POINT_ADD, 0);
+
+		/* x1' (mod n) */
+		ecc_copy_reg(temp_x, crpt->ECC_X1);
+		ecc_copy_reg(crpt->ECC_N, pCurveReg->Eorder);
+		ecc_copy_reg(crpt->ECC_X1, temp_x);
+		for (i = 0; i < 18; i++)
+		{
+			crpt->ECC_Y1[i] = 0UL;
+		}
+
+		run_ecc_codec(crpt, ECCOP_MODULE | MODOP_ADD, 0);
+
+		/* 6. The signature is valid if x1' = r */
+		Reg2Bin(crpt->ECC_X1, pCurveReg->bytes, x1);
+		if (memcmp(x1, R, pCurveReg->bytes) != 0)
+		{
+			CRPT_DBGMSG("x1' (mod n) != R Test filed!!\n");
+			ret = -2;
+		}
+	}  /* ret == 0 */
+
+	return ret;
+}
+
+static int rsa_hex_to_reg(int rsa_len, uint8_t *in, int len, uint32_t *reg)
+{
+	int dlen = len;
+	uint8_t *key, buff[RSA_MAX_BYTE_LEN];
+	int i, idx;
+
+	if (dlen > rsa_len)
+		return -1;
+
+	memset(reg, 0, RSA_MAX_BYTE_LEN);
+
+	memset(buff, 0, sizeof(buff));
+
+	/* remove leading 0x00's */
+	for (key = in; ((dlen > 0) && (*key == 0x00)); key++)
+		dlen--;
+
+	if (dlen < 0 || dlen > rsa_len)
+		return -1;
+
+	memcpy(&buff[rsa_len - dlen], key, dlen);
+
+	for (idx = rsa_len - 1; idx > 0; idx -= 4)
+	{
+		*reg++ = (buff[idx - 3] << 24) | (buff[idx - 2] << 16) |
+				 (buff[idx - 1] << 8) | buff[idx];
+	}
+	return 0;
+}
+
+static void rsa_reg_to_hex(u32 *reg, int rsa_len, uint8_t *key, int *key_sz)
+{
+	int i, idx;
+
+	*key_sz = 0;
+	for (idx = rsa_len / 4 - 1 ; idx >= 0; idx--)
+	{
+		for (i = 3; i >= 0; i--)
+		{
+			*key++ = (reg[idx] >> (i * 8)) & 0xff;
+			(*key_sz)++;
+			if (*key_sz >= RSA_MAX_BYTE_LEN)
+				return;
+		}
+	}
+}
+
+static void rsa_set_buffers(CRPT_T *crpt)
+{
 	_rsa_buff = nc_ptr(_rsa_buff_pool);
-	memset(_rsa_buff, 0, sizeof(_rsa_buff));
 	crpt->RSA_SADDR[0] = ptr_to_u32(&_rsa_buff[0]);    /* M */
 	crpt->RSA_SADDR[1] = ptr_to_u32(&_rsa_buff[128]);  /* N */
 	crpt->RSA_SADDR[2] = ptr_to_u32(&_rsa_buff[256]);  /* E */
@@ -3136,27 +3793,82 @@ int RSA_Encrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
 	crpt->RSA_MADDR[5] = ptr_to_u32(&_rsa_buff[1280]);
 	crpt->RSA_MADDR[6] = ptr_to_u32(&_rsa_buff[1408]);
 	crpt->RSA_PKADDR   = ptr_to_u32(&_rsa_buff[1536]);
+}
 
-	rsa_hex_to_reg(ras_blen / 8, data, dlen, &_rsa_buff[0]);
-	rsa_hex_to_reg(ras_blen / 8, n, nlen, &_rsa_buff[128]);
-	rsa_hex_to_reg(ras_blen / 8, pubk, klen, &_rsa_buff[256]);
+/*
+ * Runs the operation loaded by rsa_set_buffers() and rsa_hex_to_reg(), then
+ * clears the buffer pool so that no key material is left behind.
+ */
+static int rsa_run(CRPT_T *crpt, int ras_blen, uint32_t ctl, uint8_t *out, int *olen)
+{
+	uint8_t buff[RSA_MAX_BYTE_LEN + 4];
+	uint64_t t0;
+	int ret = 0;
 
 	g_RSA_error = g_RSA_done = 0;
 	__DSB();
-	crpt->RSA_CTL = (((ras_blen / 1024) - 1) << CRPT_RSA_CTL_KEYLENG_Pos) | CRPT_RSA_CTL_START_Msk;
+	crpt->RSA_CTL = (((ras_blen / 1024) - 1) << CRPT_RSA_CTL_KEYLENG_Pos) | ctl | CRPT_RSA_CTL_START_Msk;
 
 	t0 = EL0_GetCurrentPhysicalValue();
 	while (!g_RSA_done && !g_RSA_error)
 	{
+		CRYPTO_WAIT(CRPT_INTSTS_RSAIF_Msk | CRPT_INTSTS_RSAEIF_Msk);
 		if (EL0_GetCurrentPhysicalValue() - t0 > 12000000)  /* 1 second timeout */
-			return -1;
+		{
+			crpt->RSA_CTL = CRPT_RSA_CTL_STOP_Msk;
+			ret = -1;
+			break;
+		}
 	}
 
-	rsa_reg_to_hex(&_rsa_buff[1540], ras_blen / 8, buff, olen);
+	if ((ret == 0) && g_RSA_error)
+		ret = -1;
 
-	memcpy(out, &buff[ras_blen / 8 - *olen], *olen);
+	if (ret == 0)
+	{
+		rsa_reg_to_hex(&_rsa_buff[1540], ras_blen / 8, buff, olen);
+		memcpy(out, &buff[ras_blen / 8 - *olen], *olen);
+	}
 
-	return 0;
+	memset(_rsa_buff, 0, sizeof(_rsa_buff_pool));
+	return ret;
+}
+
+/**
+  * @brief  Use RSA engine to encrypt a block of data with given
+  *         public key and modulus.
+  * @param[in]  crpt     Reference to Crypto module.
+  * @param[in]  ras_blen Bit length of RSA keys. It must be one of 1024,
+  *                      2048, 3072, or 4096.
+  * @param[in]  data     The plain text data.
+  * @param[in]  dlen     The length of plain text data in bytes.
+  * @param[in]  pubk     The RSA public key.
+  * @param[in]  klen     The length of RSA public key in bytes.
+  * @param[in]  n        The RSA modulus.
+  * @param[in]  nlen     The length of modulus in bytes.
+  * @param[out] out      The RSA encrypted output data. The length always
+  *                      be <klen> / 8.
+  * @param[out] olen     The length of output data.
+  * @retval   0    Success.
+  * @retval   -1   RSA engine error or time-out
+  * @retval   -2   Invalid parameters
+  * @note     The RSA buffer pool is shared by all RSA operations, callers
+  *           running in different tasks must serialize their calls.
+  */
+int RSA_Encrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
+				 uint8_t *pubk, int klen, uint8_t *n, int nlen, uint8_t *out, int *olen)
+{
+	if (ras_blen % 1024 || ras_blen > 4096)
+		return -2;
+
+	rsa_set_buffers(crpt);
+
+	if ((rsa_hex_to_reg(ras_blen / 8, data, dlen, &_rsa_buff[0]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 8, n, nlen, &_rsa_buff[128]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 8, pubk, klen, &_rsa_buff[256]) != 0))
+		return -2;
+
+	return rsa_run(crpt, ras_blen, 0, out, olen);
 }
 
 /**
@@ -3175,55 +3887,75 @@ int RSA_Encrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
   *                      be <klen> / 8.
   * @param[out] olen     The length of output data.
   * @retval   0    Success.
-  * @retval   -1   RSA encrypt time-out
+  * @retval   -1   RSA engine error or time-out
   * @retval   -2   Invalid parameters
+  * @note     The RSA buffer pool is shared by all RSA operations, callers
+  *           running in different tasks must serialize their calls.
   */
 int RSA_Decrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
 				 uint8_t *privk, int klen, uint8_t *n, int nlen, uint8_t *out, int *olen)
 {
-	uint8_t buff[RSA_MAX_BYTE_LEN + 4];
-	uint64_t t0;
-
 	if (ras_blen % 1024 || ras_blen > 4096)
 		return -2;
 
-	_rsa_buff = nc_ptr(_rsa_buff_pool);
-	memset(_rsa_buff, 0, sizeof(_rsa_buff));
-	crpt->RSA_SADDR[0] = ptr_to_u32(&_rsa_buff[0]);    /* M */
-	crpt->RSA_SADDR[1] = ptr_to_u32(&_rsa_buff[128]);  /* N */
-	crpt->RSA_SADDR[2] = ptr_to_u32(&_rsa_buff[256]);  /* E */
-	crpt->RSA_SADDR[3] = ptr_to_u32(&_rsa_buff[384]);  /* p */
-	crpt->RSA_SADDR[4] = ptr_to_u32(&_rsa_buff[512]);  /* q */
-	crpt->RSA_DADDR    = ptr_to_u32(&_rsa_buff[1540]); /* Answer */
-	crpt->RSA_MADDR[0] = ptr_to_u32(&_rsa_buff[640]);
-	crpt->RSA_MADDR[1] = ptr_to_u32(&_rsa_buff[768]);
-	crpt->RSA_MADDR[2] = ptr_to_u32(&_rsa_buff[896]);
-	crpt->RSA_MADDR[3] = ptr_to_u32(&_rsa_buff[1024]);
-	crpt->RSA_MADDR[4] = ptr_to_u32(&_rsa_buff[1152]);
-	crpt->RSA_MADDR[5] = ptr_to_u32(&_rsa_buff[1280]);
-	crpt->RSA_MADDR[6] = ptr_to_u32(&_rsa_buff[1408]);
-	crpt->RSA_PKADDR   = ptr_to_u32(&_rsa_buff[1536]);
-
-	rsa_hex_to_reg(ras_blen / 8, data, dlen, &_rsa_buff[0]);
-	rsa_hex_to_reg(ras_blen / 8, n, nlen, &_rsa_buff[128]);
-	rsa_hex_to_reg(ras_blen / 8, privk, klen, &_rsa_buff[256]);
+	rsa_set_buffers(crpt);
 
-	g_RSA_error = g_RSA_done = 0;
-	__DSB();
-	crpt->RSA_CTL = (((ras_blen / 1024) - 1) << CRPT_RSA_CTL_KEYLENG_Pos) | CRPT_RSA_CTL_START_Msk;
-
-	t0 = EL0_GetCurrentPhysicalValue();
-	while (!g_RSA_done && !g_RSA_error)
+	if ((rsa_hex_to_reg(ras_blen / 8, data, dlen, &_rsa_buff[0]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 8, n, nlen, &_rsa_buff[128]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 8, privk, klen, &_rsa_buff[256]) != 0))
 	{
-		if (EL0_GetCurrentPhysicalValue() - t0 > 12000000)  /* 1 second timeout */
-			return -1;
+		memset(_rsa_buff, 0, sizeof(_rsa_buff_pool));
+		return -2;
 	}
 
-	rsa_reg_to_hex(&_rsa_buff[1540], ras_blen / 8, buff, olen);
+	return rsa_run(crpt, ras_blen, 0, out, olen);
+}
+
+/**
+  * @brief  Use RSA engine to decrypt a block of data in CRT mode, with the
+  *         prime factors of the modulus.
+  * @param[in]  crpt     Reference to Crypto module.
+  * @param[in]  ras_blen Bit length of RSA keys. It must be one of 1024,
+  *                      2048, 3072, or 4096.
+  * @param[in]  data     The cipher text data.
+  * @param[in]  dlen     The length of cipher text data in bytes.
+  * @param[in]  privk    The RSA private key.
+  * @param[in]  klen     The length of RSA private key in bytes.
+  * @param[in]  n        The RSA modulus.
+  * @param[in]  nlen     The length of modulus in bytes.
+  * @param[in]  p        The first prime factor of the modulus.
+  * @param[in]  plen     The length of p in bytes, at most <ras_blen> / 16.
+  * @param[in]  q        The second prime factor of the modulus.
+  * @param[in]  qlen     The length of q in bytes, at most <ras_blen> / 16.
+  * @param[out] out      The RSA decrypted output data. The length always
+  *                      be <ras_blen> / 8.
+  * @param[out] olen     The length of output data.
+  * @retval   0    Success.
+  * @retval   -1   RSA engine error or time-out
+  * @retval   -2   Invalid parameters
+  * @note     The RSA buffer pool is shared by all RSA operations, callers
+  *           running in different tasks must serialize their calls.
+  */
+int RSA_DecryptCRT(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
+				   uint8_t *privk, int klen, uint8_t *n, int nlen,
+				   uint8_t *p, int plen, uint8_t *q, int qlen, uint8_t *out, int *olen)
+{
+	if (ras_blen % 1024 || ras_blen > 4096)
+		return -2;
+
+	rsa_set_buffers(crpt);
 
-	memcpy(out, &buff[ras_blen / 8 - *olen], *olen);
+	if ((rsa_hex_to_reg(ras_blen / 8, data, dlen, &_rsa_buff[0]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 8, n, nlen, &_rsa_buff[128]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 8, privk, klen, &_rsa_buff[256]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 16, p, plen, &_rsa_buff[384]) != 0) ||
+		(rsa_hex_to_reg(ras_blen / 16, q, qlen, &_rsa_buff[512]) != 0))
+	{
+		memset(_rsa_buff, 0, sizeof(_rsa_buff_pool));
+		return -2;
+	}
 
-	return 0;
+	return rsa_run(crpt, ras_blen, CRPT_RSA_CTL_CRT_Msk, out, olen);
 }
 
 /*@}*/ /* end of group CRYPTO_EXPORTED_FUNCTIONS */
@@ -1244,6 +1244,93 @@ s32 EMAC_set_tx_qptr(EMACdevice *emacdev, u32 Length, u32 Buffer1, u32 offload_n
     return txnext;
 }
 
+/**
+ * @brief Populate consecutive tx desc structures with the segments of one frame.
+ * Same as EMAC_set_tx_qptr() except that the frame is scattered over several buffers and each
+ * buffer gets its own descriptor. Ownership of the first descriptor is handed to DMA last, so the
+ * DMA never starts on a partially built frame.
+ * This api is same for both ring mode and chain mode.
+ * @param[in] emacdev pointer to EMACdevice.
+ * @param[in] Count number of segments in the frame.
+ * @param[in] Length array of segment lengths (Max is 2048 each).
+ * @param[in] Buffer1 array of Dma-able segment pointers.
+ * @param[in] offload_type checksum insertion done by the offload engine for this frame
+ *          - \ref eDescTxCisBypass
+ *          - \ref eDescTxCisIpv4HdrCs
+ *          - \ref eDescTxCisTcpOnlyCs
+ *          - \ref eDescTxCisTcpPseudoCs
+ * @param[in] ts indicating whether timestamp
+ * @return returns tx descriptor index of the last segment on success. Negative value if there are not enough free descriptors.
+ * @note offload_type is ignored in normal descriptor mode.
+ */
+s32 EMAC_set_tx_qptr_sg(EMACdevice *emacdev, u32 Count, u32 *Length, u32 *Buffer1, u32 offload_type, u32 ts)
+{
+    u32 i;
+    u32 txnext = emacdev->TxNext;
+    DmaDesc *txdesc, *firstdesc;
+    bool enhanced = EMAC_is_desc_enhanced_mode(emacdev);
+
+    if((Count == 0) || (Count > emacdev->TxDescCount - emacdev->BusyTxDesc))
+        return -1;
+
+#ifdef CACHE_ON
+    firstdesc = (DmaDesc *)((uint64_t)(emacdev->TxNextDesc) | NON_CACHE);
+#else
+    firstdesc = emacdev->TxNextDesc;
+#endif
+    /* Make sure the whole run of descriptors is free before touching any of them */
+    txdesc = firstdesc;
+    for(i = 0; i < Count; i++) {
+        if(!EMAC_is_desc_empty(emacdev, txdesc))
+            return -1;
+#ifdef CACHE_ON
+        txdesc = EMAC_is_last_tx_desc(emacdev, txdesc) ? (DmaDesc *)((uint64_t)(emacdev->TxDesc) | NON_CACHE) : (txdesc + 1);
+#else
+        txdesc = EMAC_is_last_tx_desc(emacdev, txdesc) ? emacdev->TxDesc : (txdesc + 1);
+#endif
+    }
+
+    txdesc = firstdesc;
+    for(i = 0; i < Count; i++) {
+        txnext = emacdev->TxNext;
+
+        if(enhanced) {
+            txdesc->length |= ((Length[i] << eDescSize1Shift) & eDescSize1Mask);
+            txdesc->status |= (i == 0 ? (eDescTxFirstSeg | (ts == 1 ? eDescTxTSEnable : 0)) : 0) |
+                              (i == Count - 1 ? (eDescTxLastSeg | eDescTxIntOnCompl) : 0);
+            txdesc->status = ((txdesc->status & (~eDescTxCisMask)) | (offload_type & eDescTxCisMask));
+        } else {
+            txdesc->length |= ((Length[i] << nDescSize1Shift) & nDescSize1Mask) |
+                              (i == 0 ? (nDescTxFirstSeg | (ts == 1 ? nDescTxTSEnable : 0)) : 0) |
+                              (i == Count - 1 ? (nDescTxLastSeg | nDescTxIntOnCompl) : 0);
+        }
+        txdesc->buffer1 = Buffer1[i];
+
+        (emacdev->BusyTxDesc)++;
+
+        /* The first descriptor is given to DMA after all the others are ready */
+        if(i != 0) {
+            __DSB();
+            txdesc->status |= DescOwnByDma;
+        }
+
+        TR("(set)%02d %08x %08x %08x %08x %08x\n",txnext,(u32)((u64)txdesc & 0xFFFFFFFF),txdesc->status,txdesc->length,txdesc->buffer1,txdesc->buffer2);
+
+        emacdev->TxNext = EMAC_is_last_tx_desc(emacdev, txdesc) ? 0 : txnext + 1;
+        emacdev->TxNextDesc = EMAC_is_last_tx_desc(emacdev, txdesc) ? emacdev->TxDesc : (emacdev->TxNextDesc + 1);
+#ifdef CACHE_ON
+        txdesc = (DmaDesc *)((uint64_t)(emacdev->TxNextDesc) | NON_CACHE);
+#else
+        txdesc = emacdev->TxNextDesc;
+#endif
+    }
+
+    __DSB();
+    firstdesc->status |= DescOwnByDma;
+
+    return txnext;
+}
+
 /**
  * @brief Prepares the descriptor to receive packets.
  * The descriptor is allocated with the valid buffer addresses (sk_buff address) and the length fields
@@ -1277,9 +1364,11 @@ s32 EMAC_set_rx_qptr(EMACdevice *emacdev, u32 Buffer1, u32 Length1)
     rxdesc->timestamplow = 0;
     rxdesc->timestamphigh = 0;
 
-    if((rxnext % MODULO_INTERRUPT) != 0)
+    if(((rxnext % MODULO_INTERRUPT) != 0) || (emacdev->RxIntWdt != 0))
         rxdesc->length |= DescRxDisIntCompl;
 
+    /* Descriptor complete before the DMA may see it, as EMAC_set_tx_qptr() */
+    __DSB();
     rxdesc->status = DescOwnByDma;
 
     emacdev->RxNext     = EMAC_is_last_rx_desc(emacdev, rxdesc) ? 0 : rxnext + 1;
@@ -1359,6 +1448,68 @@ s32 EMAC_get_rx_qptr(EMACdevice *emacdev, u32 *Status, u32 *Length, u32 *Buffer1
     return(rxnext);
 }
 
+/**
+ * @brief Get back the descriptor from DMA after data has been received, without giving it back to DMA.
+ * Same as EMAC_get_rx_qptr() except that the descriptor is left empty instead of being re-armed with
+ * the same buffer. The caller owns the returned buffer and must hand a buffer back to the ring with
+ * EMAC_set_rx_qptr() once it is done with it, which allows the received data to be used in place.
+ * This api is same for both ring mode and chain mode.
+ * @param[in] emacdev pointer to EMACdevice.
+ * @param[out] status status of descriptor.
+ * @param[out] Length length of buffer1 (Max is 2048).
+ * @param[out] Buffer1 Dma-able buffer1 pointer.
+ * @param[out] Buffer2 Dma-able buffer2 pointer.
+ * @param[out] ExtStatus extended status of descriptor.
+ * @param[out] TSLow timestamp lower DWORD
+ * @param[out] TSHigh timestamp higher DWORD
+ * @return returns present rx descriptor index on success. Negative value if error.
+ */
+s32 EMAC_detach_rx_qptr(EMACdevice *emacdev, u32 *Status, u32 *Length, u32 *Buffer1, u32 *Buffer2, u32 *ExtStatus, u32 *TSHigh, u32 *TSLow)
+{
+    u32 rxnext = emacdev->RxBusy;
+#ifdef CACHE_ON
+    DmaDesc *rxdesc = (DmaDesc *)((uint64_t)(emacdev->RxBusyDesc) | NON_CACHE);
+#else
+    DmaDesc *rxdesc = emacdev->RxBusyDesc;
+#endif
+    if(EMAC_is_desc_owned_by_dma(rxdesc))
+        return -1;
+    if(EMAC_is_desc_empty(emacdev, rxdesc))
+        return -1;
+
+    if(Status != 0)
+        *Status = rxdesc->status;
+    if(Buffer1 != 0)
+        *Buffer1 = rxdesc->buffer1;
+    if(Buffer2 != 0)
+        *Buffer2 = rxdesc->buffer2;
+
+    if(EMAC_is_desc_enhanced_mode(emacdev)) {
+        if(Length != 0)
+            *Length = (rxdesc->length & eDescSize1Mask) >> eDescSize1Shift;
+        if(ExtStatus != 0)
+            *ExtStatus = rxdesc->extstatus;
+        if(TSHigh != 0)
+            *TSHigh = rxdesc->timestamphigh;
+        if(TSLow != 0)
+            *TSLow = rxdesc->timestamplow;
+    }
+    else {
+        if(Length != 0)
+            *Length = (rxdesc->length & nDescSize1Mask) >> nDescSize1Shift;
+    }
+
+    emacdev->RxBusy     = EMAC_is_last_rx_desc(emacdev, rxdesc) ? 0 : rxnext + 1;
+    emacdev->RxBusyDesc = EMAC_is_last_rx_desc(emacdev, rxdesc) ? emacdev->RxDesc : (rxdesc + 1);
+
+    /* Leave the descriptor empty, EMAC_set_rx_qptr() will attach a new buffer to it */
+    EMAC_rx_desc_init_ring(rxdesc, EMAC_is_last_rx_desc(emacdev, rxdesc));
+    TR("%02d %08x detached\n",rxnext,(u32)((u64)rxdesc & 0xFFFFFFFF));
+    (emacdev->BusyRxDesc)--;
+
+    return(rxnext);
+}
+
 /**
  * @brief Take ownership of this Descriptor.
  * The function is same for both the ring mode and the chain mode DMA structures.
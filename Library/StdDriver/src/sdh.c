@@ -44,6 +44,44 @@ static uint8_t _SDH0_ucSDHCBuffer[512] __attribute__((aligned(4)));
 static uint8_t _SDH1_ucSDHCBuffer[512] __attribute__((aligned(4)));
 #endif
 
+/* ADMA2 descriptor, 32-bit address */
+typedef struct
+{
+    uint16_t attr;
+    uint16_t len;       /* 0 means 64 KB */
+    uint32_t addr;
+} SDH_ADMA_DESC_T;
+
+#define SDH_ADMA_VALID      0x01
+#define SDH_ADMA_END        0x02
+#define SDH_ADMA_ACT_TRAN   0x20
+#define SDH_ADMA_MAX_LEN    0x10000ul
+#define SDH_ADMA_BOUNDARY   0x8000000ul     /* a descriptor must not cross 128 MB */
+
+/* Written through the non-cacheable alias, the controller fetches them from DDR */
+#ifdef __ICCARM__
+#pragma data_alignment = 64
+static SDH_ADMA_DESC_T _SDH0_AdmaDesc[SDH_ADMA_DESC_NUM];
+#pragma data_alignment = 64
+static SDH_ADMA_DESC_T _SDH1_AdmaDesc[SDH_ADMA_DESC_NUM];
+#else
+static SDH_ADMA_DESC_T _SDH0_AdmaDesc[SDH_ADMA_DESC_NUM] __attribute__((aligned(64)));
+static SDH_ADMA_DESC_T _SDH1_AdmaDesc[SDH_ADMA_DESC_NUM] __attribute__((aligned(64)));
+#endif
+
+/* Requests of SDH_Submit(), the head one is on the bus while i32Busy is set */
+typedef struct
+{
+    SDH_REQ_T       *pHead;
+    SDH_REQ_T       *pTail;
+    volatile int    i32Busy;
+    volatile int    i32Sync;    /* a blocking call owns the controller */
+    int             i32Stop;    /* CMD12 on the bus after a failed command */
+    int             i32Err;     /* status of the head request once the stop is over */
+} SDH_QUEUE_T;
+
+static SDH_QUEUE_T _SDH0_Queue, _SDH1_Queue;
+
 SDH_INFO_T SD0, SD1;
 
 /*-----------------------------------------------------------------------------
@@ -155,7 +193,7 @@ static int SDH_transfer_data(SDH_T *sdh, struct mmc_data *data)
     char transfer_done = 0;
     unsigned long start_addr;
 
-    if (data->flags == MMC_DATA_READ)
+    if (data->flags & MMC_DATA_READ)
         start_addr=(unsigned long)data->dest;
     else
         start_addr=(unsigned long)data->src;
@@ -166,11 +204,14 @@ static int SDH_transfer_data(SDH_T *sdh, struct mmc_data *data)
     do {
         stat = sdh->NORMAL_INT_STAT_R;
         if (stat & 0x8000) {  /* SDHCI_INT_ERROR */
+            if (sdh->ERROR_INT_STAT_R & 0x200)  /* ADMA_ERR */
+                sysprintf("ADMA error 0x%x at 0x%x\n", sdh->ADMA_ERR_STAT_R, sdh->ADMA_SA_LOW_R);
 			sysprintf("stat 0x%08x ret -1\n",stat);
             return -1;
         }
 
-        if (!transfer_done && (stat & (1<<3)))
+        /* ADMA2 follows its descriptor table, only SDMA stops at the boundary */
+        if (!transfer_done && !(data->flags & MMC_DATA_ADMA) && (stat & (1<<3)))
         {	/* SDHCI_INT_DMA_END */
             sdh->NORMAL_INT_STAT_R = (1<<3);
             start_addr &=~(512*1024 - 1);
@@ -251,18 +292,26 @@ int SDH_send_command(SDH_T *sdh, struct mmc_cmd *cmd, struct mmc_data *data)
         if (data->blocks > 1)
             mode |= 0x20;   /* SDHCI_TRNS_MULTI */
 
-        if (data->flags == MMC_DATA_READ)
-        {
+        if (data->flags & MMC_DATA_READ)
             mode |= 0x10;   /* SDHCI_TRNS_READ */
-            sdh->SDMASA_R = (unsigned long)data->dest;
+
+        mode |= 0x1; /* Enable SDH_DMA */
+        if (data->flags & MMC_DATA_ADMA)
+        {
+            sdh->ADMA_SA_LOW_R = ptr_to_u32(data->adma);
+            sdh->ADMA_SA_HIGH_R = 0;
+            sdh->HOST_CTRL1_R = (sdh->HOST_CTRL1_R & ~0x18) | 0x10;   /* DMA_SEL: ADMA2 */
+            sdh->BLOCKSIZE_R = data->blocksize & 0xfff;
         }
         else
         {
-            sdh->SDMASA_R = (unsigned long)data->src;
+            if (data->flags & MMC_DATA_READ)
+                sdh->SDMASA_R = (unsigned long)data->dest;
+            else
+                sdh->SDMASA_R = (unsigned long)data->src;
+            sdh->HOST_CTRL1_R &= ~0x18;
+            sdh->BLOCKSIZE_R = 0x7000|(data->blocksize & 0xfff);
         }
-        mode |= 0x1; /* Enable SDH_DMA */
-        sdh->HOST_CTRL1_R &= ~0x18;
-        sdh->BLOCKSIZE_R = 0x7000|(data->blocksize & 0xfff);
         sdh->BLOCKCOUNT_R = data->blocks;
         sdh->XFER_MODE_R = mode;
 
@@ -1125,62 +1174,367 @@ uint32_t SDH_Probe(SDH_T *sdh)
     return SDH_Init(sdh);
 }
 
-/**
- *  @brief  This function use to read data from SD card.
- *
- *  @param[in]     sdh           Select SDH0 or SDH1.
- *  @param[out]    pu8BufAddr    The buffer to receive the data from SD card.
- *  @param[in]     u32StartSec   The start read sector address.
- *  @param[in]     u32SecCount   The the read sector number of data
- *
- *  @retval   Successful Write data to SD card success.
- */
-int SDH_Read(SDH_T *sdh, uint8_t *pu8BufAddr, uint32_t u32StartSec, uint32_t u32SecCount)
+/** @cond HIDDEN_SYMBOLS */
+
+static SDH_INFO_T *SDH_info(SDH_T *sdh)
 {
-    struct mmc_cmd cmd;
-    struct mmc_data data;
-    int err;
-    SDH_INFO_T *pSD;
+    return (sdh == SDH0) ? &SD0 : &SD1;
+}
 
-    if (sdh == SDH0)
-        pSD = &SD0;
-    else
-    	pSD = &SD1;
+/* Read or write command of u32SecCount sectors from u32StartSec */
+static void SDH_rw_cmd(SDH_T *sdh, struct mmc_cmd *cmd, uint32_t u32StartSec, uint32_t u32SecCount, int write)
+{
+    SDH_INFO_T *pSD = SDH_info(sdh);
 
-    if (u32SecCount > 1)
-        cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
+    if (write)
+        cmd->cmdidx = (u32SecCount > 1) ? MMC_CMD_WRITE_MULTIPLE_BLOCK : MMC_CMD_WRITE_SINGLE_BLOCK;
     else
-        cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
+        cmd->cmdidx = (u32SecCount > 1) ? MMC_CMD_READ_MULTIPLE_BLOCK : MMC_CMD_READ_SINGLE_BLOCK;
 
     if ( (pSD->CardType == SDH_TYPE_SD_HIGH) || (pSD->CardType == SDH_TYPE_EMMC) )
-        cmd.cmdarg = u32StartSec;
+        cmd->cmdarg = u32StartSec;
     else
-        cmd.cmdarg = u32StartSec * 512;
+        cmd->cmdarg = u32StartSec * 512;
 
-    cmd.resp_type = MMC_RSP_R1;
+    cmd->resp_type = MMC_RSP_R1;
+}
+
+static int SDH_stop_transmission(SDH_T *sdh)
+{
+    struct mmc_cmd cmd;
+
+    cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
+    cmd.cmdarg = 0;
+    cmd.resp_type = MMC_RSP_R1b;
+    return SDH_send_command(sdh, &cmd, 0);
+}
+
+/* Checks the buffers and makes them safe for the DMA, 0 on success */
+static int SDH_seg_prepare(const SDH_SEG_T *pSeg, int i32SegCount, int write)
+{
+    int i;
+
+    for (i = 0; i < i32SegCount; i++)
+    {
+        if (ptr_to_u32(pSeg[i].pu8BufAddr) & 0x3)
+            return Fail;
+    }
+
+    for (i = 0; i < i32SegCount; i++)
+    {
+        if (write)
+            dcache_clean_by_mva(pSeg[i].pu8BufAddr, pSeg[i].u32SecCount * SDH_BLOCK_SIZE);
+        else
+            dcache_clean_invalidate_by_mva(pSeg[i].pu8BufAddr, pSeg[i].u32SecCount * SDH_BLOCK_SIZE);
+    }
+    return 0;
+}
+
+/* Drops what the CPU may have prefetched while the DMA wrote the buffers */
+static void SDH_seg_complete(const SDH_SEG_T *pSeg, int i32SegCount, int write)
+{
+    int i;
+
+    if (write)
+        return;
+    for (i = 0; i < i32SegCount; i++)
+        dcache_invalidate_by_mva(pSeg[i].pu8BufAddr, pSeg[i].u32SecCount * SDH_BLOCK_SIZE);
+}
 
-    data.dest = (void *)pu8BufAddr;
+static SDH_QUEUE_T *SDH_queue(SDH_T *sdh)
+{
+    return (sdh == SDH0) ? &_SDH0_Queue : &_SDH1_Queue;
+}
+
+static void SDH_async_start(SDH_T *sdh, SDH_QUEUE_T *q);
+
+/* Ends the head request of q with i32Status and hands it back */
+static void SDH_async_done(SDH_T *sdh, SDH_QUEUE_T *q, int i32Status)
+{
+    SDH_REQ_T *req = q->pHead;
+
+    (void)sdh;
+    q->pHead = req->pNext;
+    if (q->pHead == NULL)
+        q->pTail = NULL;
+
+    SDH_seg_complete(req->pSeg, req->i32SegCount, req->i32Write);
+    req->i32Status = i32Status;
+    if (req->pfnDone != NULL)
+        req->pfnDone(req);
+}
+
+/*
+ * A blocking call waits for the asynchronous command on the bus to end and
+ * keeps the queue from starting another one until SDH_release().
+ */
+static void SDH_claim(SDH_T *sdh)
+{
+    SDH_QUEUE_T *q = SDH_queue(sdh);
+    uint64_t daif;
+
+    for (;;)
+    {
+        daif = raw_read_daif();
+        disable_irq();
+        if (!q->i32Busy)
+        {
+            q->i32Sync = 1;
+            raw_write_daif(daif);
+            return;
+        }
+        raw_write_daif(daif);
+    }
+}
+
+static void SDH_release(SDH_T *sdh)
+{
+    SDH_QUEUE_T *q = SDH_queue(sdh);
+    uint64_t daif;
+
+    daif = raw_read_daif();
+    disable_irq();
+    q->i32Sync = 0;
+    if (q->pHead != NULL)
+        SDH_async_start(sdh, q);
+    raw_write_daif(daif);
+}
+
+/* One SDMA command for a buffer that ADMA2 cannot take */
+static int SDH_sdma_rw(SDH_T *sdh, uint8_t *pu8BufAddr, uint32_t u32StartSec, uint32_t u32SecCount, int write)
+{
+    struct mmc_cmd cmd;
+    struct mmc_data data;
+    int err;
+
+    SDH_claim(sdh);
+    SDH_rw_cmd(sdh, &cmd, u32StartSec, u32SecCount, write);
+    if (write)
+        data.src = (void *)pu8BufAddr;
+    else
+        data.dest = (void *)pu8BufAddr;
     data.blocks = u32SecCount;
     data.blocksize = 512;
-    data.flags = MMC_DATA_READ;
+    data.flags = write ? MMC_DATA_WRITE : MMC_DATA_READ;
+
+    if (write)
+        dcache_clean_by_mva(pu8BufAddr, data.blocks*data.blocksize);
+    else
+        dcache_clean_invalidate_by_mva(pu8BufAddr, data.blocks*data.blocksize);
 
-    //dcache_clean_invalidate_by_mva(pu8BufAddr,data.blocks*data.blocksize);
-    dcache_clean_by_mva(pu8BufAddr,data.blocks*data.blocksize);
     err = SDH_send_command(sdh, &cmd, &data);
-    if (err)
-        return err;
+    if ((err == 0) && (u32SecCount > 1))
+        err = SDH_stop_transmission(sdh);
+
+    if (!write)
+        dcache_invalidate_by_mva(pu8BufAddr, data.blocks*data.blocksize);
+    SDH_release(sdh);
+    return err ? err : Successful;
+}
+
+/*
+ * Describes the segments from pSeg[*idx] + *off on in the descriptor table of sdh,
+ * u32MaxSec sectors at most, and moves *idx and *off past them.
+ * Returns the number of sectors described, 0 when no segment is left.
+ */
+static uint32_t SDH_adma_fill(SDH_T *sdh, const SDH_SEG_T *pSeg, int i32SegCount, int *idx, uint32_t *off, uint32_t u32MaxSec)
+{
+    SDH_ADMA_DESC_T *desc = nc_ptr((sdh == SDH0) ? _SDH0_AdmaDesc : _SDH1_AdmaDesc);
+    uint32_t addr, len, room, total = 0, max = u32MaxSec * SDH_BLOCK_SIZE;
+    uint32_t o = *off;
+    int i = *idx, n = 0;
 
-    if (u32SecCount > 1)
+    while ((i < i32SegCount) && (n < SDH_ADMA_DESC_NUM) && (total < max))
     {
-        cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
-        cmd.cmdarg = 0;
-        cmd.resp_type = MMC_RSP_R1b;
-        err = SDH_send_command(sdh, &cmd, 0);
+        len = pSeg[i].u32SecCount * SDH_BLOCK_SIZE - o;
+        if (len == 0)
+        {
+            i++;
+            o = 0;
+            continue;
+        }
+        addr = ptr_to_u32(pSeg[i].pu8BufAddr) + o;
+        if (len > max - total)
+            len = max - total;
+        if (len > SDH_ADMA_MAX_LEN)
+            len = SDH_ADMA_MAX_LEN;
+        room = SDH_ADMA_BOUNDARY - (addr & (SDH_ADMA_BOUNDARY - 1));
+        if (len > room)
+            len = room;
+
+        desc[n].addr = addr;
+        desc[n].len = (uint16_t)len;
+        desc[n].attr = SDH_ADMA_VALID | SDH_ADMA_ACT_TRAN;
+        n++;
+        total += len;
+        o += len;
+    }
+
+    /* A full table can end inside a sector, leave that sector to the next command */
+    len = total % SDH_BLOCK_SIZE;
+    total -= len;
+    while (len > 0)
+    {
+        room = desc[n - 1].len ? desc[n - 1].len : SDH_ADMA_MAX_LEN;
+        if (room <= len)
+        {
+            len -= room;
+            n--;
+        }
+        else
+        {
+            desc[n - 1].len = (uint16_t)(room - len);
+            len = 0;
+        }
+    }
+    if (n == 0)
+        return 0;
+    desc[n - 1].attr |= SDH_ADMA_END;
+    __DSB();
+
+    /* Move the position past what was described */
+    i = *idx;
+    o = *off + total;
+    while ((i < i32SegCount) && (o >= pSeg[i].u32SecCount * SDH_BLOCK_SIZE))
+    {
+        o -= pSeg[i].u32SecCount * SDH_BLOCK_SIZE;
+        i++;
+    }
+    *idx = i;
+    *off = o;
+
+    return total / SDH_BLOCK_SIZE;
+}
+
+static int SDH_adma_rw(SDH_T *sdh, const SDH_SEG_T *pSeg, int i32SegCount, uint32_t u32StartSec, int write)
+{
+    struct mmc_cmd cmd;
+    struct mmc_data data;
+    uint32_t u32SecCount, off = 0;
+    int idx = 0, err = 0;
+
+    if (SDH_seg_prepare(pSeg, i32SegCount, write) != 0)
+        return Fail;
+
+    SDH_claim(sdh);
+
+    /* One command per descriptor table, the block count register has 16 bits */
+    while ((u32SecCount = SDH_adma_fill(sdh, pSeg, i32SegCount, &idx, &off, 0xffff)) != 0)
+    {
+        SDH_rw_cmd(sdh, &cmd, u32StartSec, u32SecCount, write);
+        data.adma = (sdh == SDH0) ? _SDH0_AdmaDesc : _SDH1_AdmaDesc;
+        data.blocks = u32SecCount;
+        data.blocksize = 512;
+        data.flags = (write ? MMC_DATA_WRITE : MMC_DATA_READ) | MMC_DATA_ADMA;
+
+        err = SDH_send_command(sdh, &cmd, &data);
+        if ((err == 0) && (u32SecCount > 1))
+            err = SDH_stop_transmission(sdh);
         if (err)
-            return err;
+            break;
+        u32StartSec += u32SecCount;
     }
-    dcache_invalidate_by_mva(pu8BufAddr,data.blocks*data.blocksize);
-    return Successful;
+
+    SDH_release(sdh);
+    SDH_seg_complete(pSeg, i32SegCount, write);
+    return err ? err : Successful;
+}
+
+/*
+ * Puts the next command of the queue on the bus, with Auto CMD12 in place of
+ * a separate stop command. Completion comes to SDH_IntHandler(). Ends the
+ * requests that have nothing left, and masks the interrupts when the queue
+ * is empty. Called with the IRQs disabled.
+ */
+static void SDH_async_start(SDH_T *sdh, SDH_QUEUE_T *q)
+{
+    SDH_REQ_T *req;
+    struct mmc_cmd cmd;
+    uint16_t mode;
+
+    while ((req = q->pHead) != NULL)
+    {
+        req->u32Cnt = SDH_adma_fill(sdh, req->pSeg, req->i32SegCount, &req->i32Idx, &req->u32Off, 0xffff);
+        if (req->u32Cnt != 0)
+            break;
+        SDH_async_done(sdh, q, Successful);
+    }
+
+    if (req == NULL)
+    {
+        sdh->NORMAL_INT_SIGNAL_EN_R &= ~0x2;    /* XFER_COMPLETE */
+        sdh->ERROR_INT_SIGNAL_EN_R = 0;
+        q->i32Busy = 0;
+        return;
+    }
+
+    SDH_rw_cmd(sdh, &cmd, req->u32Sec, req->u32Cnt, req->i32Write);
+
+    mode = 0x1 | 0x2;                           /* DMA, block count */
+    if (req->u32Cnt > 1)
+        mode |= 0x20 | 0x4;                     /* multi-block, Auto CMD12 */
+    if (!req->i32Write)
+        mode |= 0x10;
+
+    /* The transfer bits only, card detection is left to the application */
+    sdh->NORMAL_INT_STAT_R = 0x8000 | 0x8 | 0x2 | 0x1;
+    sdh->ERROR_INT_STAT_R = 0xffff;
+    sdh->ERROR_INT_STAT_EN_R |= 0x100;          /* AUTO_CMD_ERR */
+    sdh->NORMAL_INT_SIGNAL_EN_R |= 0x2;
+    sdh->ERROR_INT_SIGNAL_EN_R = sdh->ERROR_INT_STAT_EN_R;
+
+    sdh->TOUT_CTRL_R = 0xe;
+    sdh->ADMA_SA_LOW_R = ptr_to_u32((sdh == SDH0) ? _SDH0_AdmaDesc : _SDH1_AdmaDesc);
+    sdh->ADMA_SA_HIGH_R = 0;
+    sdh->HOST_CTRL1_R = (sdh->HOST_CTRL1_R & ~0x18) | 0x10;   /* DMA_SEL: ADMA2 */
+    sdh->BLOCKSIZE_R = SDH_BLOCK_SIZE;
+    sdh->BLOCKCOUNT_R = req->u32Cnt;
+    sdh->XFER_MODE_R = mode;
+    sdh->ARGUMENT_R = cmd.cmdarg;
+    sdh->CMD_R = ((cmd.cmdidx & 0xff) << 8) | SDH_CMD_RESP_SHORT | SDH_CMD_CRC | SDH_CMD_INDEX | SDH_CMD_DATA;
+    q->i32Busy = 1;
+}
+
+/*
+ * An error stops the multi-block command before its Auto CMD12, and may leave
+ * the card sending or receiving. Puts CMD12 on the bus, the head request ends
+ * with i32Status once the card is back in transfer state. Called with the
+ * IRQs disabled, after the CMD and DATA resets.
+ */
+static void SDH_async_stop(SDH_T *sdh, SDH_QUEUE_T *q, int i32Status)
+{
+    q->i32Stop = 1;
+    q->i32Err = i32Status;
+
+    sdh->TOUT_CTRL_R = 0xe;
+    sdh->ARGUMENT_R = 0;
+    sdh->CMD_R = (MMC_CMD_STOP_TRANSMISSION << 8) | SDH_CMD_RESP_SHORT_BUSY | SDH_CMD_CRC | SDH_CMD_INDEX;
+}
+
+/** @endcond HIDDEN_SYMBOLS */
+
+/**
+ *  @brief  This function use to read data from SD card.
+ *
+ *  @param[in]     sdh           Select SDH0 or SDH1.
+ *  @param[out]    pu8BufAddr    The buffer to receive the data from SD card.
+ *  @param[in]     u32StartSec   The start read sector address.
+ *  @param[in]     u32SecCount   The the read sector number of data
+ *
+ *  @retval   Successful Write data to SD card success.
+ *
+ *  @details  A 4-byte aligned buffer is read by ADMA2, others by SDMA.
+ */
+int SDH_Read(SDH_T *sdh, uint8_t *pu8BufAddr, uint32_t u32StartSec, uint32_t u32SecCount)
+{
+    SDH_SEG_T seg;
+
+    if (ptr_to_u32(pu8BufAddr) & 0x3)
+        return SDH_sdma_rw(sdh, pu8BufAddr, u32StartSec, u32SecCount, 0);
+
+    seg.pu8BufAddr = pu8BufAddr;
+    seg.u32SecCount = u32SecCount;
+    return SDH_adma_rw(sdh, &seg, 1, u32StartSec, 0);
 }
 
 
@@ -1193,53 +1547,175 @@ int SDH_Read(SDH_T *sdh, uint8_t *pu8BufAddr, uint32_t u32StartSec, uint32_t u32
  *  @param[in]    u32SecCount   The the write sector number of data.
  *
  *  @retval   Successful Write data to SD card success.
+ *
+ *  @details  A 4-byte aligned buffer is written by ADMA2, others by SDMA.
  */
 uint32_t SDH_Write(SDH_T *sdh, uint8_t *pu8BufAddr, uint32_t u32StartSec, uint32_t u32SecCount)
 {
-    struct mmc_cmd cmd;
-    struct mmc_data data;
-    int err;
-    SDH_INFO_T *pSD;
+    SDH_SEG_T seg;
 
-    if (sdh == SDH0)
-        pSD = &SD0;
-    else
-    	pSD = &SD1;
-    
     if (u32SecCount == 0)
         return 0;
-    else if (u32SecCount == 1)
-        cmd.cmdidx = MMC_CMD_WRITE_SINGLE_BLOCK;
+
+    if (ptr_to_u32(pu8BufAddr) & 0x3)
+        return SDH_sdma_rw(sdh, pu8BufAddr, u32StartSec, u32SecCount, 1);
+
+    seg.pu8BufAddr = pu8BufAddr;
+    seg.u32SecCount = u32SecCount;
+    return SDH_adma_rw(sdh, &seg, 1, u32StartSec, 1);
+}
+
+/**
+ *  @brief  This function use to read consecutive sectors into scattered buffers.
+ *
+ *  @param[in]    sdh           Select SDH0 or SDH1.
+ *  @param[in]    pSeg          The buffers, filled in order.
+ *  @param[in]    i32SegCount   The number of buffers.
+ *  @param[in]    u32StartSec   The start read sector address.
+ *
+ *  @retval   Successful Read data from SD card success.
+ *  @retval   Fail       A buffer is not 4-byte aligned.
+ *
+ *  @details  The buffers are described in an ADMA2 descriptor table and read by as few
+ *            commands as the table and the 16-bit block count allow, SDH_ADMA_DESC_NUM
+ *            descriptors of up to 64 KB each.
+ */
+int SDH_ReadSG(SDH_T *sdh, const SDH_SEG_T *pSeg, int i32SegCount, uint32_t u32StartSec)
+{
+    return SDH_adma_rw(sdh, pSeg, i32SegCount, u32StartSec, 0);
+}
+
+/**
+ *  @brief  This function use to write scattered buffers to consecutive sectors.
+ *
+ *  @param[in]    sdh           Select SDH0 or SDH1.
+ *  @param[in]    pSeg          The buffers, written in order.
+ *  @param[in]    i32SegCount   The number of buffers.
+ *  @param[in]    u32StartSec   The start write sector address.
+ *
+ *  @retval   Successful Write data to SD card success.
+ *  @retval   Fail       A buffer is not 4-byte aligned.
+ *
+ *  @details  See SDH_ReadSG().
+ */
+uint32_t SDH_WriteSG(SDH_T *sdh, const SDH_SEG_T *pSeg, int i32SegCount, uint32_t u32StartSec)
+{
+    return SDH_adma_rw(sdh, pSeg, i32SegCount, u32StartSec, 1);
+}
+
+/**
+ *  @brief  This function use to queue a read or write and return at once.
+ *
+ *  @param[in]    sdh     Select SDH0 or SDH1.
+ *  @param[in]    pReq    The request. It belongs to the driver until pReq->i32Status
+ *                        is no longer SDH_BUSY, and pReq->pfnDone has been called.
+ *
+ *  @retval   Successful The request is queued.
+ *  @retval   Fail       A buffer is not 4-byte aligned.
+ *
+ *  @details  The requests of a controller run in the order they were submitted, each as
+ *            ADMA2 commands with Auto CMD12. The application's SDH interrupt handler must
+ *            call SDH_IntHandler(), which starts the next command as soon as one ends and
+ *            calls pReq->pfnDone from the interrupt. A failed multi-block command is
+ *            stopped with CMD12 before its request ends. Under an RTOS the callback would
+ *            typically give a task notification to pReq->pvParam.
+ *            Blocking calls such as SDH_Read() wait for the command on the bus, then run
+ *            between two queued commands.
+ */
+int SDH_Submit(SDH_T *sdh, SDH_REQ_T *pReq)
+{
+    SDH_QUEUE_T *q = SDH_queue(sdh);
+    uint64_t daif;
+
+    if (SDH_seg_prepare(pReq->pSeg, pReq->i32SegCount, pReq->i32Write) != 0)
+        return Fail;
+
+    pReq->pNext = NULL;
+    pReq->i32Idx = 0;
+    pReq->u32Off = 0;
+    pReq->u32Sec = pReq->u32StartSec;
+    pReq->u32Cnt = 0;
+    pReq->i32Status = (int)SDH_BUSY;
+
+    daif = raw_read_daif();
+    disable_irq();
+    if (q->pTail != NULL)
+        q->pTail->pNext = pReq;
     else
-        cmd.cmdidx = MMC_CMD_WRITE_MULTIPLE_BLOCK;
-    
-    if ( (pSD->CardType == SDH_TYPE_SD_HIGH) || (pSD->CardType == SDH_TYPE_EMMC) )
-        cmd.cmdarg = u32StartSec;
+        q->pHead = pReq;
+    q->pTail = pReq;
+    if (!q->i32Busy && !q->i32Sync)
+        SDH_async_start(sdh, q);
+    raw_write_daif(daif);
+
+    return Successful;
+}
+
+/**
+ *  @brief  This function use to serve the transfer interrupts of SDH_Submit().
+ *
+ *  @param[in]    sdh     Select SDH0 or SDH1.
+ *
+ *  @return   None
+ *
+ *  @details  Call it from the SDH interrupt handler. It leaves the card detection
+ *            status to the caller.
+ */
+void SDH_IntHandler(SDH_T *sdh)
+{
+    SDH_QUEUE_T *q = SDH_queue(sdh);
+    SDH_REQ_T *req = q->pHead;
+    uint32_t stat;
+    int err;
+
+    if (!q->i32Busy || (req == NULL))
+        return;
+
+    stat = sdh->NORMAL_INT_STAT_R;
+    if (q->i32Stop)     /* CMD12 after a failed command, done when the busy ends */
+    {
+        if (!(stat & (0x8000 | 0x2)))
+            return;
+        sdh->NORMAL_INT_STAT_R = 0x8000 | 0x8 | 0x2 | 0x1;
+        sdh->ERROR_INT_STAT_R = 0xffff;
+        if (stat & 0x8000)
+        {
+            SDH_reset(sdh, SDH_RESET_CMD);
+            SDH_reset(sdh, SDH_RESET_DATA);
+        }
+        q->i32Stop = 0;
+        SDH_async_done(sdh, q, q->i32Err);
+    }
+    else if (stat & 0x8000)  /* SDHCI_INT_ERROR */
+    {
+        stat = (sdh->ERROR_INT_STAT_R << 16) | stat;
+        if (stat & 0x2000000)   /* ADMA_ERR */
+            sysprintf("ADMA error 0x%x at 0x%x\n", sdh->ADMA_ERR_STAT_R, sdh->ADMA_SA_LOW_R);
+        /* Not the card detection bits, the application reads them after this */
+        sdh->NORMAL_INT_STAT_R = 0x8000 | 0x8 | 0x2 | 0x1;
+        sdh->ERROR_INT_STAT_R = 0xffff;
+        SDH_reset(sdh, SDH_RESET_CMD);
+        SDH_reset(sdh, SDH_RESET_DATA);
+        err = (stat & (0x10000 | 0x100000)) ? -2 : -1;
+        if (req->u32Cnt > 1)
+        {
+            SDH_async_stop(sdh, q, err);
+            return;
+        }
+        SDH_async_done(sdh, q, err);
+    }
+    else if (stat & 0x2)    /* SDHCI_INT_DATA_END */
+    {
+        sdh->NORMAL_INT_STAT_R = 0x2 | 0x1 | (1<<3);
+        req->u32Sec += req->u32Cnt;
+    }
     else
-        cmd.cmdarg = u32StartSec * 512;
-    
-    cmd.resp_type = MMC_RSP_R1;
-    data.src = (void *)pu8BufAddr;
-    data.blocks = u32SecCount;
-    data.blocksize = 512;
-    data.flags = MMC_DATA_WRITE;
-    
-    //dcache_clean_invalidate_by_mva(pu8BufAddr,data.blocks*data.blocksize);
-    dcache_invalidate_by_mva(pu8BufAddr,data.blocks*data.blocksize);
-    err = SDH_send_command(sdh, &cmd, &data);
-    if (err)
-        return err;
-    if (u32SecCount > 1)
     {
-        cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
-        cmd.cmdarg = 0;
-        cmd.resp_type = MMC_RSP_R1b;
-        err = SDH_send_command(sdh, &cmd, 0);
-        if (err)
-            return err;
+        return;
     }
-    dcache_clean_by_mva(pu8BufAddr,data.blocks*data.blocksize);
-    return Successful;
+
+    /* The rest of the request, or the next one */
+    SDH_async_start(sdh, q);
 }
 
 /**
@@ -0,0 +1,239 @@
+/**************************************************************************//**
+ * @file     bench.c
+ * @brief    Runs the cases of an engine over the block sizes and prints
+ *           throughput and cost per byte or per operation.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+
+#include "bench.h"
+
+const bench_aes_t bench_aes[] =
+{
+	{ "AES-128-ECB",     BENCH_AES_ECB,     128 },
+	{ "AES-128-CBC-enc", BENCH_AES_CBC_ENC, 128 },
+	{ "AES-128-CBC-dec", BENCH_AES_CBC_DEC, 128 },
+	{ "AES-128-CTR",     BENCH_AES_CTR,     128 },
+	{ "AES-256-CBC-enc", BENCH_AES_CBC_ENC, 256 },
+	{ "AES-128-GCM-enc", BENCH_AES_GCM_ENC, 128 },
+};
+const int bench_aes_count = sizeof(bench_aes) / sizeof(bench_aes[0]);
+
+const bench_sha_t bench_sha[] =
+{
+	{ "SHA-1",   1   },
+	{ "SHA-256", 256 },
+	{ "SHA-512", 512 },
+};
+const int bench_sha_count = sizeof(bench_sha) / sizeof(bench_sha[0]);
+
+/* The keys and test messages of bench_ecc[] and bench_rsa[] are made by
+ * bench_sw_keys() */
+bench_ecc_t bench_ecc[] =
+{
+	{ .name = "P-256", .bits = 256, .bytes = 32 },
+	{ .name = "P-384", .bits = 384, .bytes = 48 },
+	{ .name = "P-521", .bits = 521, .bytes = 66 },
+};
+const int bench_ecc_count = sizeof(bench_ecc) / sizeof(bench_ecc[0]);
+
+bench_rsa_t bench_rsa[] =
+{
+	{ .bits = 1024 },
+	{ .bits = 2048 },
+#if BENCH_RSA_MAX_BITS >= 3072
+	{ .bits = 3072 },
+#endif
+#if BENCH_RSA_MAX_BITS >= 4096
+	{ .bits = 4096 },
+#endif
+};
+const int bench_rsa_count = sizeof(bench_rsa) / sizeof(bench_rsa[0]);
+
+/* Room for the IV, additional data and tag that GCM adds to the text */
+uint8_t bench_in_pool[BENCH_MAX_LEN + 64] __attribute__((aligned(64)));
+uint8_t bench_out_pool[BENCH_MAX_LEN + 64] __attribute__((aligned(64)));
+
+const uint8_t bench_key[32] =
+{
+	0x60, 0x3d, 0xeb, 0x10, 0x15, 0xca, 0x71, 0xbe, 0x2b, 0x73, 0xae, 0xf0, 0x85, 0x7d, 0x77, 0x81,
+	0x1f, 0x35, 0x2c, 0x07, 0x3b, 0x61, 0x08, 0xd7, 0x2d, 0x98, 0x10, 0xa3, 0x09, 0x14, 0xdf, 0xf4
+};
+
+const uint8_t bench_iv[16] =
+{
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const size_t bench_sizes[] =
+{
+	16, 64, 256, 1024, 4096, 16384, 65536, 262144, BENCH_MAX_LEN
+};
+
+/*
+ * Deterministic xorshift bytes for the data and the key generation, so that
+ * every run and every engine works on the same input. Not random.
+ */
+void bench_rand(void *buf, size_t len)
+{
+	static uint32_t x = 0x2545f491;
+	uint8_t  *p = buf;
+
+	while (len--)
+	{
+		x ^= x << 13;
+		x ^= x >> 17;
+		x ^= x << 5;
+		*p++ = (uint8_t)(x >> 24);
+	}
+}
+
+/*
+ * Calls fn once to warm up and to see if it works, then calls it again until
+ * BENCH_MIN_MS have passed. Returns what the first call returned.
+ */
+static int bench_measure(int (*fn)(int, size_t), int i, size_t len,
+                         uint32_t *count, uint64_t *elapsed)
+{
+	uint64_t  start, now, min_ticks;
+	uint32_t  n = 0;
+	int       ret;
+
+	ret = fn(i, len);
+	if (ret != 0)
+		return ret;
+
+	min_ticks = bench_hz() * BENCH_MIN_MS / 1000;
+	start = bench_now();
+	do
+	{
+		ret = fn(i, len);
+		n++;
+		now = bench_now();
+	}
+	while ((ret == 0) && (now - start < min_ticks));
+
+	*count = n;
+	*elapsed = now - start;
+	return ret;
+}
+
+/* Prints v / 100 with two decimals */
+static void bench_print_x100(const char *fmt, double v)
+{
+	uint32_t  x = (v > 4e9) ? 0xffffffffU : (uint32_t)(v * 100.0 + 0.5);
+
+	bench_printf(fmt, x / 100, x % 100);
+}
+
+static int bench_result(int ret)
+{
+	if (ret == BENCH_UNSUPPORTED)
+		bench_printf("  not supported\n");
+	else if (ret != 0)
+		bench_printf("  failed %d\n", ret);
+	return ret;
+}
+
+static void bench_bulk(const char *name, int (*fn)(int, size_t), int i)
+{
+	uint64_t  elapsed = 0;
+	uint32_t  count = 0;
+	double    bytes, secs;
+	int       s, ret;
+
+	if (fn == NULL)
+	{
+		bench_printf("%-16s", name);
+		bench_result(BENCH_UNSUPPORTED);
+		return;
+	}
+	bench_printf("%s\n", name);
+
+	for (s = 0; s < (int)(sizeof(bench_sizes) / sizeof(bench_sizes[0])); s++)
+	{
+		bench_printf("  %7u B", (unsigned)bench_sizes[s]);
+		ret = bench_measure(fn, i, bench_sizes[s], &count, &elapsed);
+		if (bench_result(ret) == BENCH_UNSUPPORTED)
+			return;
+		if (ret != 0)
+			continue;
+
+		bytes = (double)bench_sizes[s] * count;
+		secs = (double)elapsed / bench_hz();
+		bench_print_x100("  %6u.%02u MB/s", bytes / secs / 1e6);
+		bench_print_x100("  %6u.%02u ", (double)elapsed / bytes);
+		bench_printf("%s/B", bench_unit);
+		bench_printf("  %9u %s/op\n", (unsigned)(elapsed / count), bench_unit);
+	}
+}
+
+static void bench_ops(const char *name, int (*fn)(int, size_t), int i)
+{
+	uint64_t  elapsed = 0;
+	uint32_t  count = 0;
+	double    secs;
+	int       ret;
+
+	bench_printf("  %-20s", name);
+	if (fn == NULL)
+	{
+		bench_result(BENCH_UNSUPPORTED);
+		return;
+	}
+
+	ret = bench_measure(fn, i, 0, &count, &elapsed);
+	if (bench_result(ret) != 0)
+		return;
+
+	secs = (double)elapsed / bench_hz();
+	bench_print_x100("  %6u.%02u ops/s", count / secs);
+	bench_printf("  %9u k%s/op\n", (unsigned)(elapsed / count / 1000), bench_unit);
+}
+
+/**
+ * Runs every case of engine and prints the results. Cases the engine does
+ * not have are listed as not supported.
+ */
+void bench_run(const bench_engine_t *engine)
+{
+	char  name[32];
+	int   i;
+
+	bench_printf("\n==== %s ====\n", engine->name);
+
+	if ((engine->init != NULL) && (engine->init() != 0))
+	{
+		bench_printf("init failed\n");
+		return;
+	}
+
+	for (i = 0; i < bench_aes_count; i++)
+		bench_bulk(bench_aes[i].name, engine->aes, i);
+
+	for (i = 0; i < bench_sha_count; i++)
+		bench_bulk(bench_sha[i].name, engine->sha, i);
+
+	bench_printf("ECC\n");
+	for (i = 0; i < bench_ecc_count; i++)
+	{
+		strcpy(name, "ECDSA sign ");
+		strcat(name, bench_ecc[i].name);
+		bench_ops(name, engine->ecdsa_sign, i);
+		strcpy(name, "ECDSA verify ");
+		strcat(name, bench_ecc[i].name);
+		bench_ops(name, engine->ecdsa_verify, i);
+		strcpy(name, "ECDH ");
+		strcat(name, bench_ecc[i].name);
+		bench_ops(name, engine->ecdh, i);
+	}
+
+	bench_printf("RSA\n");
+	for (i = 0; i < bench_rsa_count; i++)
+	{
+		bench_printf("  RSA-%u\n", bench_rsa[i].bits);
+		bench_ops("  public (e=65537)", engine->rsa_public, i);
+		bench_ops("  private", engine->rsa_private, i);
+	}
+}
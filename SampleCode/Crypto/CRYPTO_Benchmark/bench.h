@@ -0,0 +1,136 @@
+/**************************************************************************//**
+ * @file     bench.h
+ * @brief    Crypto benchmark shared by the CRPT, TSI and software engines.
+ *           BENCH_HOST selects the Linux host build of the software engine.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef BENCH_HOST
+#include <stdio.h>
+#define bench_printf        printf
+#else
+#include "NuMicro.h"
+#define bench_printf        sysprintf
+#endif
+
+#define BENCH_MAX_LEN       (1024 * 1024)   /* largest bulk request in bytes */
+
+#ifndef BENCH_MIN_MS
+#define BENCH_MIN_MS        100             /* each measure runs at least this long */
+#endif
+
+#ifndef BENCH_RSA_MAX_BITS
+#define BENCH_RSA_MAX_BITS  2048            /* 3072 and 4096 take long to generate */
+#endif
+
+#define BENCH_GCM_IV_LEN    12
+#define BENCH_GCM_AAD_LEN   13              /* as in a TLS record */
+
+/* An engine function returns this when it does not support the case */
+#define BENCH_UNSUPPORTED   1
+
+/* AES cases, the same for all engines */
+#define BENCH_AES_ECB       0
+#define BENCH_AES_CBC_ENC   1
+#define BENCH_AES_CBC_DEC   2
+#define BENCH_AES_CTR       3
+#define BENCH_AES_GCM_ENC   4
+
+typedef struct bench_aes
+{
+	const char  *name;
+	int         mode;               /* BENCH_AES_xxx */
+	int         keybits;
+} bench_aes_t;
+
+typedef struct bench_sha
+{
+	const char  *name;
+	int         bits;               /* 1 for SHA-1, else the SHA-2 digest size */
+} bench_sha_t;
+
+/* ECC key, hash and signature, big-endian, right-aligned in bytes bytes */
+typedef struct bench_ecc
+{
+	const char  *name;
+	int         bits;               /* 256, 384 or 521 */
+	int         bytes;
+	int         hlen;               /* hash length, the hash ends msg */
+	uint8_t     d[66];
+	uint8_t     k[66];              /* signing nonce of the engines that take one */
+	uint8_t     qx[66];
+	uint8_t     qy[66];
+	uint8_t     msg[66];
+	uint8_t     r[66];              /* signature of msg */
+	uint8_t     s[66];
+} bench_ecc_t;
+
+/* RSA key, big-endian */
+typedef struct bench_rsa
+{
+	int         bits;
+	uint8_t     n[512];
+	uint8_t     e[4];
+	uint8_t     d[512];
+	uint8_t     p[256];
+	uint8_t     q[256];
+	uint8_t     msg[512];           /* input, smaller than n */
+} bench_rsa_t;
+
+#ifndef BENCH_HOST
+/* E_ECC_CURVE of a bench_ecc_t */
+#define BENCH_CURVE(e)      (((e)->bits == 256) ? CURVE_P_256 : \
+                             ((e)->bits == 384) ? CURVE_P_384 : CURVE_P_521)
+#endif
+
+/* An engine, the functions it does not have are NULL */
+typedef struct bench_engine
+{
+	const char  *name;
+	int (*init)(void);
+	int (*aes)(int i, size_t len);          /* bench_aes[i] over len bytes */
+	int (*sha)(int i, size_t len);          /* bench_sha[i] over len bytes */
+	int (*ecdsa_sign)(int i, size_t len);   /* with bench_ecc[i], len unused */
+	int (*ecdsa_verify)(int i, size_t len);
+	int (*ecdh)(int i, size_t len);
+	int (*rsa_public)(int i, size_t len);   /* with bench_rsa[i], len unused */
+	int (*rsa_private)(int i, size_t len);
+} bench_engine_t;
+
+extern const bench_aes_t bench_aes[];
+extern const int bench_aes_count;
+extern const bench_sha_t bench_sha[];
+extern const int bench_sha_count;
+extern bench_ecc_t bench_ecc[];
+extern const int bench_ecc_count;
+extern bench_rsa_t bench_rsa[];
+extern const int bench_rsa_count;
+
+extern uint8_t bench_in_pool[];         /* BENCH_MAX_LEN + 64 bytes each */
+extern uint8_t bench_out_pool[];
+extern const uint8_t bench_key[32];
+extern const uint8_t bench_iv[16];
+
+extern const bench_engine_t bench_engine_sw;
+extern const bench_engine_t bench_engine_crpt;
+extern const bench_engine_t bench_engine_tsi;
+
+/* Platform, main.c on the target and bench_host.c on the host */
+extern const char *bench_unit;          /* unit of bench_now() */
+uint64_t bench_now(void);
+uint64_t bench_hz(void);
+
+/* bench.c */
+void bench_rand(void *buf, size_t len);
+void bench_run(const bench_engine_t *engine);
+
+/* bench_sw.c, makes the keys of bench_ecc[] and bench_rsa[] */
+int  bench_sw_keys(void);
+
+#endif /* __BENCH_H__ */
@@ -0,0 +1,165 @@
+/**************************************************************************//**
+ * @file     bench_crpt.c
+ * @brief    CRPT engine of the crypto benchmark, driven directly through
+ *           the crypto.c driver as the other Crypto samples do.
+ *
+ * Every request loads its key and mode, so the figures include the set up
+ * of the engine. The DMA works on the non-cacheable alias of the pools.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+
+#include "bench.h"
+
+static uint32_t crpt_key[8];            /* bench_key as big-endian words */
+static uint32_t crpt_iv[4];
+
+static uint32_t get_be32(const uint8_t *b)
+{
+	return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static int crpt_init(void)
+{
+	int  i;
+
+	for (i = 0; i < 8; i++)
+		crpt_key[i] = get_be32(&bench_key[i * 4]);
+	for (i = 0; i < 4; i++)
+		crpt_iv[i] = get_be32(&bench_iv[i * 4]);
+
+	return 0;
+}
+
+static int crpt_aes(int i, size_t len)
+{
+	const bench_aes_t *c = &bench_aes[i];
+	uint8_t   *in = nc_ptr(bench_in_pool);
+	uint8_t   *out = nc_ptr(bench_out_pool);
+	uint32_t  keysz = (c->keybits == 256) ? AES_KEY_SIZE_256 : AES_KEY_SIZE_128;
+	uint32_t  opmode, cnt = (uint32_t)len;
+	int       encrypt = (c->mode != BENCH_AES_CBC_DEC);
+
+	switch (c->mode)
+	{
+	case BENCH_AES_ECB:
+		opmode = AES_MODE_ECB;
+		break;
+	case BENCH_AES_CBC_ENC:
+	case BENCH_AES_CBC_DEC:
+		opmode = AES_MODE_CBC;
+		break;
+	case BENCH_AES_CTR:
+		opmode = AES_MODE_CTR;
+		break;
+	case BENCH_AES_GCM_ENC:
+		/* The IV block and the padded additional data go before the text */
+		opmode = AES_MODE_GCM;
+		memcpy(in, bench_iv, BENCH_GCM_IV_LEN);
+		memset(in + BENCH_GCM_IV_LEN, 0, 32 - BENCH_GCM_IV_LEN);
+		memcpy(in + 16, bench_key, BENCH_GCM_AAD_LEN);
+		cnt += 32;
+		break;
+	default:
+		return BENCH_UNSUPPORTED;
+	}
+
+	AES_Open(CRPT, encrypt ? AES_MODE_ENCRYPT : AES_MODE_DECRYPT, opmode, keysz, AES_IN_OUT_SWAP);
+	AES_SetKey(CRPT, crpt_key, keysz);
+	if (opmode == AES_MODE_GCM)
+		AES_SetGCMCount(CRPT, BENCH_GCM_IV_LEN, BENCH_GCM_AAD_LEN, (uint32_t)len);
+	else
+		AES_SetInitVect(CRPT, crpt_iv);
+	AES_SetDMATransfer(CRPT, 0, 0, ptr_to_u32(in), ptr_to_u32(out), cnt);
+
+	return AES_Start(CRPT, 0, CRYPTO_DMA_ONE_SHOT);
+}
+
+static int crpt_sha(int i, size_t len)
+{
+	uint32_t  digest[16];
+	uint32_t  mode;
+
+	switch (bench_sha[i].bits)
+	{
+	case 1:
+		mode = SHA_MODE_SHA1;
+		break;
+	case 256:
+		mode = SHA_MODE_SHA256;
+		break;
+	case 512:
+		mode = SHA_MODE_SHA512;
+		break;
+	default:
+		return BENCH_UNSUPPORTED;
+	}
+
+	SHA_Open(CRPT, mode, SHA_IN_OUT_SWAP, 0);
+	SHA_SetDMATransfer(CRPT, ptr_to_u32(nc_ptr(bench_in_pool)), (uint32_t)len);
+	if (SHA_Start(CRPT, CRYPTO_DMA_ONE_SHOT) != 0)
+		return -1;
+
+	SHA_Read(CRPT, digest);
+	return 0;
+}
+
+static int crpt_ecdsa_sign(int i, size_t len)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+	uint8_t     r[66], s[66];
+
+	(void)len;
+	return ECC_GenerateSignature_Bin(CRPT, BENCH_CURVE(e), e->msg, e->d, e->k, r, s);
+}
+
+static int crpt_ecdsa_verify(int i, size_t len)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+
+	(void)len;
+	return ECC_VerifySignature_Bin(CRPT, BENCH_CURVE(e), e->msg, e->qx, e->qy, e->r, e->s);
+}
+
+static int crpt_ecdh(int i, size_t len)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+	uint8_t     z[66];
+
+	(void)len;
+	return ECC_GenerateSecretZ_Bin(CRPT, BENCH_CURVE(e), e->d, e->qx, e->qy, z);
+}
+
+static int crpt_rsa_public(int i, size_t len)
+{
+	bench_rsa_t *k = &bench_rsa[i];
+	int         blen = k->bits / 8, olen;
+
+	(void)len;
+	return RSA_Encrypt(CRPT, k->bits, k->msg, blen, k->e, sizeof(k->e), k->n, blen,
+	                   bench_out_pool, &olen);
+}
+
+static int crpt_rsa_private(int i, size_t len)
+{
+	bench_rsa_t *k = &bench_rsa[i];
+	int         blen = k->bits / 8, olen;
+
+	(void)len;
+	return RSA_DecryptCRT(CRPT, k->bits, k->msg, blen, k->d, blen, k->n, blen,
+	                      k->p, blen / 2, k->q, blen / 2, bench_out_pool, &olen);
+}
+
+const bench_engine_t bench_engine_crpt =
+{
+	"CRPT engine",
+	crpt_init,
+	crpt_aes,
+	crpt_sha,
+	crpt_ecdsa_sign,
+	crpt_ecdsa_verify,
+	crpt_ecdh,
+	crpt_rsa_public,
+	crpt_rsa_private,
+};
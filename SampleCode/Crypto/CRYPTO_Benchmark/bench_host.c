@@ -0,0 +1,36 @@
+/**************************************************************************//**
+ * @file     bench_host.c
+ * @brief    Linux host entry of the crypto benchmark, the software engine
+ *           only. Build with Makefile.host.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <time.h>
+
+#include "bench.h"
+
+const char *bench_unit = "ns";
+
+uint64_t bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t bench_hz(void)
+{
+	return 1000000000u;
+}
+
+int main(void)
+{
+	bench_rand(bench_in_pool, BENCH_MAX_LEN + 64);
+
+	if (bench_sw_keys() != 0)
+		return 1;
+
+	bench_run(&bench_engine_sw);
+	return 0;
+}
@@ -0,0 +1,299 @@
+/**************************************************************************//**
+ * @file     bench_sw.c
+ * @brief    mbedtls software engine of the crypto benchmark. It also makes
+ *           the ECC and RSA keys that all engines use.
+ *
+ * Keys are set up once, as an application would for a session, so the AES
+ * and SHA figures do not include the key schedule.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+
+#include "bench.h"
+
+#include "mbedtls/aes.h"
+#include "mbedtls/gcm.h"
+#include "mbedtls/sha1.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/rsa.h"
+
+#define BENCH_ECC_MAX       3
+#define BENCH_RSA_MAX       4
+
+static mbedtls_aes_context sw_aes_enc[2];      /* 128 and 256-bit keys */
+static mbedtls_aes_context sw_aes_dec;         /* 128-bit key */
+static mbedtls_gcm_context sw_gcm;
+
+static mbedtls_ecp_group sw_grp[BENCH_ECC_MAX];
+static mbedtls_mpi sw_d[BENCH_ECC_MAX];
+static mbedtls_ecp_point sw_q[BENCH_ECC_MAX];
+static mbedtls_rsa_context sw_rsa[BENCH_RSA_MAX];
+
+static const mbedtls_ecp_group_id sw_curve[BENCH_ECC_MAX] =
+{
+	MBEDTLS_ECP_DP_SECP256R1, MBEDTLS_ECP_DP_SECP384R1, MBEDTLS_ECP_DP_SECP521R1
+};
+
+/* The same sequence on every run, fine for a benchmark and nothing else */
+static int sw_rng(void *ctx, unsigned char *out, size_t len)
+{
+	(void)ctx;
+	bench_rand(out, len);
+	return 0;
+}
+
+static int sw_ecc_keys(int i)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+	uint8_t     pt[1 + 2 * 66];
+	size_t      olen;
+	mbedtls_mpi k, r, s;
+	int         ret;
+
+	mbedtls_mpi_init(&k);
+	mbedtls_mpi_init(&r);
+	mbedtls_mpi_init(&s);
+
+	ret = mbedtls_ecp_group_load(&sw_grp[i], sw_curve[i]);
+	if (ret == 0)
+		ret = mbedtls_ecp_gen_keypair(&sw_grp[i], &sw_d[i], &sw_q[i], sw_rng, NULL);
+	if (ret == 0)
+		ret = mbedtls_ecp_point_write_binary(&sw_grp[i], &sw_q[i], MBEDTLS_ECP_PF_UNCOMPRESSED,
+		                                     &olen, pt, sizeof(pt));
+	if (ret == 0)
+		ret = mbedtls_mpi_write_binary(&sw_d[i], e->d, e->bytes);
+	if (ret == 0)
+		ret = mbedtls_ecp_gen_privkey(&sw_grp[i], &k, sw_rng, NULL);
+	if (ret == 0)
+		ret = mbedtls_mpi_write_binary(&k, e->k, e->bytes);
+
+	if (ret == 0)
+	{
+		memcpy(e->qx, pt + 1, e->bytes);
+		memcpy(e->qy, pt + 1 + e->bytes, e->bytes);
+
+		/* A SHA-512 sized hash at most, right-aligned as the CRPT takes it */
+		e->hlen = (e->bytes < 64) ? e->bytes : 64;
+		memset(e->msg, 0, sizeof(e->msg));
+		bench_rand(e->msg + e->bytes - e->hlen, e->hlen);
+
+		ret = mbedtls_ecdsa_sign(&sw_grp[i], &r, &s, &sw_d[i], e->msg + e->bytes - e->hlen,
+		                         e->hlen, sw_rng, NULL);
+	}
+	if (ret == 0)
+		ret = mbedtls_mpi_write_binary(&r, e->r, e->bytes);
+	if (ret == 0)
+		ret = mbedtls_mpi_write_binary(&s, e->s, e->bytes);
+
+	mbedtls_mpi_free(&k);
+	mbedtls_mpi_free(&r);
+	mbedtls_mpi_free(&s);
+	return ret;
+}
+
+static int sw_rsa_keys(int i)
+{
+	bench_rsa_t *k = &bench_rsa[i];
+	int         len = k->bits / 8;
+	int         ret;
+
+	ret = mbedtls_rsa_gen_key(&sw_rsa[i], sw_rng, NULL, k->bits, 65537);
+	if (ret == 0)
+		ret = mbedtls_rsa_export_raw(&sw_rsa[i], k->n, len, k->p, len / 2, k->q, len / 2,
+		                             k->d, len, k->e, sizeof(k->e));
+	if (ret == 0)
+	{
+		/* Below n, whatever n is */
+		bench_rand(k->msg, len);
+		k->msg[0] = 0;
+	}
+	return ret;
+}
+
+/**
+ * Generates the ECC and RSA keys of the benchmark and a signature to verify.
+ * The keys are the same on every run. RSA takes a while.
+ *
+ * @return 0 on success, an mbedtls error code otherwise
+ */
+int bench_sw_keys(void)
+{
+	int  i, ret;
+
+	for (i = 0; i < bench_ecc_count; i++)
+	{
+		mbedtls_ecp_group_init(&sw_grp[i]);
+		mbedtls_mpi_init(&sw_d[i]);
+		mbedtls_ecp_point_init(&sw_q[i]);
+
+		ret = sw_ecc_keys(i);
+		if (ret != 0)
+		{
+			bench_printf("%s key failed -0x%x\n", bench_ecc[i].name, -ret);
+			return ret;
+		}
+	}
+
+	for (i = 0; i < bench_rsa_count; i++)
+	{
+		bench_printf("Generating RSA-%d key...\n", bench_rsa[i].bits);
+		mbedtls_rsa_init(&sw_rsa[i]);
+
+		ret = sw_rsa_keys(i);
+		if (ret != 0)
+		{
+			bench_printf("RSA-%d key failed -0x%x\n", bench_rsa[i].bits, -ret);
+			return ret;
+		}
+	}
+	return 0;
+}
+
+static int sw_init(void)
+{
+	mbedtls_aes_init(&sw_aes_enc[0]);
+	mbedtls_aes_init(&sw_aes_enc[1]);
+	mbedtls_aes_init(&sw_aes_dec);
+	mbedtls_gcm_init(&sw_gcm);
+
+	if ((mbedtls_aes_setkey_enc(&sw_aes_enc[0], bench_key, 128) != 0) ||
+	        (mbedtls_aes_setkey_enc(&sw_aes_enc[1], bench_key, 256) != 0) ||
+	        (mbedtls_aes_setkey_dec(&sw_aes_dec, bench_key, 128) != 0) ||
+	        (mbedtls_gcm_setkey(&sw_gcm, MBEDTLS_CIPHER_ID_AES, bench_key, 128) != 0))
+		return -1;
+
+	return 0;
+}
+
+static int sw_aes(int i, size_t len)
+{
+	mbedtls_aes_context *ctx = &sw_aes_enc[bench_aes[i].keybits == 256];
+	uint8_t   iv[16], stream[16], tag[16];
+	size_t    off = 0;
+
+	memcpy(iv, bench_iv, 16);
+
+	switch (bench_aes[i].mode)
+	{
+	case BENCH_AES_ECB:
+		for (off = 0; off < len; off += 16)
+		{
+			if (mbedtls_aes_crypt_ecb(ctx, MBEDTLS_AES_ENCRYPT, bench_in_pool + off,
+			                          bench_out_pool + off) != 0)
+				return -1;
+		}
+		return 0;
+
+	case BENCH_AES_CBC_ENC:
+		return mbedtls_aes_crypt_cbc(ctx, MBEDTLS_AES_ENCRYPT, len, iv,
+		                             bench_in_pool, bench_out_pool);
+
+	case BENCH_AES_CBC_DEC:
+		return mbedtls_aes_crypt_cbc(&sw_aes_dec, MBEDTLS_AES_DECRYPT, len, iv,
+		                             bench_in_pool, bench_out_pool);
+
+	case BENCH_AES_CTR:
+		return mbedtls_aes_crypt_ctr(ctx, len, &off, iv, stream,
+		                             bench_in_pool, bench_out_pool);
+
+	case BENCH_AES_GCM_ENC:
+		return mbedtls_gcm_crypt_and_tag(&sw_gcm, MBEDTLS_GCM_ENCRYPT, len,
+		                                 bench_iv, BENCH_GCM_IV_LEN,
+		                                 bench_key, BENCH_GCM_AAD_LEN,
+		                                 bench_in_pool, bench_out_pool, 16, tag);
+	}
+	return BENCH_UNSUPPORTED;
+}
+
+static int sw_sha(int i, size_t len)
+{
+	switch (bench_sha[i].bits)
+	{
+	case 1:
+		return mbedtls_sha1(bench_in_pool, len, bench_out_pool);
+	case 256:
+		return mbedtls_sha256(bench_in_pool, len, bench_out_pool, 0);
+	case 512:
+		return mbedtls_sha512(bench_in_pool, len, bench_out_pool, 0);
+	}
+	return BENCH_UNSUPPORTED;
+}
+
+static int sw_ecdsa_sign(int i, size_t len)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+	mbedtls_mpi r, s;
+	int         ret;
+
+	(void)len;
+	mbedtls_mpi_init(&r);
+	mbedtls_mpi_init(&s);
+	ret = mbedtls_ecdsa_sign(&sw_grp[i], &r, &s, &sw_d[i], e->msg + e->bytes - e->hlen,
+	                         e->hlen, sw_rng, NULL);
+	mbedtls_mpi_free(&r);
+	mbedtls_mpi_free(&s);
+	return ret;
+}
+
+static int sw_ecdsa_verify(int i, size_t len)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+	mbedtls_mpi r, s;
+	int         ret;
+
+	(void)len;
+	mbedtls_mpi_init(&r);
+	mbedtls_mpi_init(&s);
+	ret = mbedtls_mpi_read_binary(&r, e->r, e->bytes);
+	if (ret == 0)
+		ret = mbedtls_mpi_read_binary(&s, e->s, e->bytes);
+	if (ret == 0)
+		ret = mbedtls_ecdsa_verify(&sw_grp[i], e->msg + e->bytes - e->hlen, e->hlen,
+		                           &sw_q[i], &r, &s);
+	mbedtls_mpi_free(&r);
+	mbedtls_mpi_free(&s);
+	return ret;
+}
+
+/* The shared secret of the key with itself, the same work as with a peer */
+static int sw_ecdh(int i, size_t len)
+{
+	mbedtls_mpi z;
+	int         ret;
+
+	(void)len;
+	mbedtls_mpi_init(&z);
+	ret = mbedtls_ecdh_compute_shared(&sw_grp[i], &z, &sw_q[i], &sw_d[i], sw_rng, NULL);
+	mbedtls_mpi_free(&z);
+	return ret;
+}
+
+static int sw_rsa_public(int i, size_t len)
+{
+	(void)len;
+	return mbedtls_rsa_public(&sw_rsa[i], bench_rsa[i].msg, bench_out_pool);
+}
+
+/* CRT with blinding, as mbedtls does it by default */
+static int sw_rsa_private(int i, size_t len)
+{
+	(void)len;
+	return mbedtls_rsa_private(&sw_rsa[i], sw_rng, NULL, bench_rsa[i].msg, bench_out_pool);
+}
+
+const bench_engine_t bench_engine_sw =
+{
+	"mbedtls software",
+	sw_init,
+	sw_aes,
+	sw_sha,
+	sw_ecdsa_sign,
+	sw_ecdsa_verify,
+	sw_ecdh,
+	sw_rsa_public,
+	sw_rsa_private,
+};
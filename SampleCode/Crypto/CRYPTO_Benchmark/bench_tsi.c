@@ -0,0 +1,240 @@
+/**************************************************************************//**
+ * @file     bench_tsi.c
+ * @brief    TSI engine of the crypto benchmark, for MA35D05K where the
+ *           crypto engines are reached only through TSI commands.
+ *
+ * The figures include the command round trip to the TSI. AES-GCM and ECDH
+ * are not measured, the parameter blocks of TSI_AES_GCM_Run() and
+ * TSI_ECC_Multiply() are not described. RSA private runs without CRT.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+
+#include "bench.h"
+#include "tsi_cmd.h"
+
+#define TSI_ECC_SLOT        576     /* bytes per value in an ECC parameter block */
+#define TSI_RSA_SLOT        512     /* bytes per value in an RSA parameter block */
+
+#define TSI_PARAM_SIGN      0x100
+#define TSI_PARAM_VERIFY    0x200
+#define TSI_PARAM_PUBLIC    0x300
+#define TSI_PARAM_PRIVATE   0x400
+
+static uint32_t tsi_key_mem[8] __attribute__((aligned(32)));
+static uint32_t tsi_iv_mem[4] __attribute__((aligned(32)));
+static uint32_t tsi_digest_mem[16] __attribute__((aligned(32)));
+static uint8_t tsi_param_mem[TSI_ECC_SLOT * 5] __attribute__((aligned(32)));
+static uint8_t tsi_out_mem[TSI_ECC_SLOT * 2] __attribute__((aligned(32)));
+
+/* What tsi_param_mem holds, TSI_PARAM_xxx | index, the blocks are only
+ * rebuilt when the case changes */
+static int tsi_param_case = -1;
+
+static const char tsi_hex_tbl[] = "0123456789abcdef";
+
+static void tsi_bin_to_hex(const uint8_t *bin, int len, char *hex)
+{
+	int  i;
+
+	for (i = 0; i < len; i++)
+	{
+		*hex++ = tsi_hex_tbl[bin[i] >> 4];
+		*hex++ = tsi_hex_tbl[bin[i] & 0xf];
+	}
+	*hex = 0;
+}
+
+/* Big-endian bytes to the RSA register layout, the least significant word
+ * first, as rsa_hex_to_reg() of the CRYPTO_RSA sample */
+static void tsi_rsa_to_reg(const uint8_t *bin, int len, uint8_t *slot)
+{
+	uint32_t  *reg = (uint32_t *)slot;
+	int       idx;
+
+	memset(slot, 0, TSI_RSA_SLOT);
+	for (idx = len - 1; idx > 0; idx -= 4)
+		*reg++ = ((uint32_t)bin[idx - 3] << 24) | ((uint32_t)bin[idx - 2] << 16) |
+		         ((uint32_t)bin[idx - 1] << 8) | bin[idx];
+}
+
+static int tsi_init(void)
+{
+	uint32_t  *key = nc_ptr(tsi_key_mem);
+	uint32_t  *iv = nc_ptr(tsi_iv_mem);
+	int       i;
+
+	for (i = 0; i < 8; i++)
+		key[i] = ((uint32_t)bench_key[i * 4] << 24) | ((uint32_t)bench_key[i * 4 + 1] << 16) |
+		         ((uint32_t)bench_key[i * 4 + 2] << 8) | bench_key[i * 4 + 3];
+	for (i = 0; i < 4; i++)
+		iv[i] = ((uint32_t)bench_iv[i * 4] << 24) | ((uint32_t)bench_iv[i * 4 + 1] << 16) |
+		        ((uint32_t)bench_iv[i * 4 + 2] << 8) | bench_iv[i * 4 + 3];
+
+	tsi_param_case = -1;
+	return 0;
+}
+
+static int tsi_aes(int i, size_t len)
+{
+	const bench_aes_t *c = &bench_aes[i];
+	int       keysz = (c->keybits == 256) ? AES_KEY_SIZE_256 : AES_KEY_SIZE_128;
+	int       mode, sid, ret;
+
+	switch (c->mode)
+	{
+	case BENCH_AES_ECB:
+		mode = AES_MODE_ECB;
+		break;
+	case BENCH_AES_CBC_ENC:
+	case BENCH_AES_CBC_DEC:
+		mode = AES_MODE_CBC;
+		break;
+	case BENCH_AES_CTR:
+		mode = AES_MODE_CTR;
+		break;
+	default:
+		return BENCH_UNSUPPORTED;
+	}
+
+	ret = TSI_Open_Session(C_CODE_AES, &sid);
+	if (ret != 0)
+		return ret;
+
+	ret = TSI_AES_Set_IV(sid, ptr_to_u32(nc_ptr(tsi_iv_mem)));
+	if (ret == 0)
+		ret = TSI_AES_Set_Key(sid, keysz, ptr_to_u32(nc_ptr(tsi_key_mem)));
+	if (ret == 0)
+		ret = TSI_AES_Set_Mode(sid, 0, 0, 1, 1, 0, (c->mode != BENCH_AES_CBC_DEC),
+		                       mode, keysz, 0, 0);
+	if (ret == 0)
+		ret = TSI_AES_Run(sid, 1, (int)len, ptr_to_u32(nc_ptr(bench_in_pool)),
+		                  ptr_to_u32(nc_ptr(bench_out_pool)));
+
+	TSI_Close_Session(C_CODE_AES, sid);
+	return ret;
+}
+
+static int tsi_sha(int i, size_t len)
+{
+	int  mode_sel, mode, wcnt;
+
+	switch (bench_sha[i].bits)
+	{
+	case 1:
+		mode_sel = SHA_MODE_SEL_SHA1;
+		mode = SHA_MODE_SHA1;
+		wcnt = 5;
+		break;
+	case 256:
+		mode_sel = SHA_MODE_SEL_SHA2;
+		mode = SHA_MODE_SHA256;
+		wcnt = 8;
+		break;
+	case 512:
+		mode_sel = SHA_MODE_SEL_SHA2;
+		mode = SHA_MODE_SHA512;
+		wcnt = 16;
+		break;
+	default:
+		return BENCH_UNSUPPORTED;
+	}
+
+	return TSI_SHA_All_At_Once(1, 1, mode_sel, mode, wcnt, (int)len,
+	                           ptr_to_u32(nc_ptr(bench_in_pool)),
+	                           ptr_to_u32(nc_ptr(tsi_digest_mem)));
+}
+
+static int tsi_ecdsa_sign(int i, size_t len)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+	char        *param = nc_ptr(tsi_param_mem);
+
+	(void)len;
+	if (tsi_param_case != (TSI_PARAM_SIGN | i))
+	{
+		memset(param, 0, sizeof(tsi_param_mem));
+		tsi_bin_to_hex(e->msg + e->bytes - e->hlen, e->hlen, param);
+		tsi_bin_to_hex(e->d, e->bytes, param + TSI_ECC_SLOT);
+		tsi_bin_to_hex(e->k, e->bytes, param + TSI_ECC_SLOT * 2);
+		tsi_param_case = TSI_PARAM_SIGN | i;
+	}
+
+	return TSI_ECC_GenSignature(BENCH_CURVE(e), 0, ECC_KEY_SEL_USER, 0, ptr_to_u32(param),
+	                            ptr_to_u32(nc_ptr(tsi_out_mem)));
+}
+
+static int tsi_ecdsa_verify(int i, size_t len)
+{
+	bench_ecc_t *e = &bench_ecc[i];
+	char        *param = nc_ptr(tsi_param_mem);
+
+	(void)len;
+	if (tsi_param_case != (TSI_PARAM_VERIFY | i))
+	{
+		memset(param, 0, sizeof(tsi_param_mem));
+		tsi_bin_to_hex(e->msg + e->bytes - e->hlen, e->hlen, param);
+		tsi_bin_to_hex(e->qx, e->bytes, param + TSI_ECC_SLOT);
+		tsi_bin_to_hex(e->qy, e->bytes, param + TSI_ECC_SLOT * 2);
+		tsi_bin_to_hex(e->r, e->bytes, param + TSI_ECC_SLOT * 3);
+		tsi_bin_to_hex(e->s, e->bytes, param + TSI_ECC_SLOT * 4);
+		tsi_param_case = TSI_PARAM_VERIFY | i;
+	}
+
+	return TSI_ECC_VerifySignature(BENCH_CURVE(e), ECC_KEY_SEL_USER, 0, 0, ptr_to_u32(param));
+}
+
+/* M ^ exp mod n, exp being the public or the private exponent */
+static int tsi_rsa_exp_mod(int i, int which)
+{
+	bench_rsa_t *k = &bench_rsa[i];
+	uint8_t     *param = nc_ptr(tsi_param_mem);
+	uint8_t     e[512];
+	int         blen = k->bits / 8;
+
+	if (tsi_param_case != (which | i))
+	{
+		tsi_rsa_to_reg(k->msg, blen, param);
+		tsi_rsa_to_reg(k->n, blen, param + TSI_RSA_SLOT);
+		if (which == TSI_PARAM_PUBLIC)
+		{
+			memset(e, 0, blen);
+			memcpy(e + blen - sizeof(k->e), k->e, sizeof(k->e));
+			tsi_rsa_to_reg(e, blen, param + TSI_RSA_SLOT * 2);
+		}
+		else
+		{
+			tsi_rsa_to_reg(k->d, blen, param + TSI_RSA_SLOT * 2);
+		}
+		tsi_param_case = which | i;
+	}
+
+	return TSI_RSA_Exp_Mod((k->bits - 1) / 1024, 0, RSA_KEY_SEL_USER, 0, ptr_to_u32(param),
+	                       ptr_to_u32(nc_ptr(bench_out_pool)));
+}
+
+static int tsi_rsa_public(int i, size_t len)
+{
+	(void)len;
+	return tsi_rsa_exp_mod(i, TSI_PARAM_PUBLIC);
+}
+
+static int tsi_rsa_private(int i, size_t len)
+{
+	(void)len;
+	return tsi_rsa_exp_mod(i, TSI_PARAM_PRIVATE);
+}
+
+const bench_engine_t bench_engine_tsi =
+{
+	"TSI",
+	tsi_init,
+	tsi_aes,
+	tsi_sha,
+	tsi_ecdsa_sign,
+	tsi_ecdsa_verify,
+	NULL,
+	tsi_rsa_public,
+	tsi_rsa_private,
+};
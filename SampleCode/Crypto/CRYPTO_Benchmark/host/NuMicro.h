@@ -0,0 +1,15 @@
+/**************************************************************************//**
+ * @file     NuMicro.h
+ * @brief    Stand-in for the BSP header on a Linux host. The mbedtls in
+ *           ThirdParty includes NuMicro.h and prints with sysprintf.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUMICRO_H__
+#define __NUMICRO_H__
+
+#include <stdio.h>
+
+#define sysprintf       printf
+
+#endif /* __NUMICRO_H__ */
@@ -0,0 +1,153 @@
+/**************************************************************************//**
+ * @file     main.c
+ * @brief    This sample program measures the throughput and the latency of
+ *           AES, SHA, ECC and RSA on the CRPT engine, or on MA35D05K through
+ *           the TSI, and in mbedtls software, timed with the Cortex-A35
+ *           cycle counter.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <string.h>
+
+#include "NuMicro.h"
+#include "tsi_cmd.h"
+#include "bench.h"
+
+#define CNTPCT_HZ           12000000        /* generic timer frequency */
+
+const char *bench_unit = "cyc";
+
+static uint64_t g_cpu_hz;
+static int      g_use_pmu;
+
+/*
+ * Enables PMCCNTR_EL0 as a 64-bit counter of every CPU cycle at this
+ * exception level.
+ */
+static void PMU_Init(void)
+{
+	uint64_t  val;
+
+	__asm__ volatile("mrs %0, pmcr_el0" : "=r" (val));
+	val |= (1 << 6) | (1 << 2) | (1 << 0);    /* LC: 64-bit, C: reset, E: enable */
+	__asm__ volatile("msr pmcr_el0, %0" : : "r" (val));
+	__asm__ volatile("msr pmccfiltr_el0, %0" : : "r" ((uint64_t)1 << 27));  /* count at EL2 too */
+	__asm__ volatile("msr pmcntenset_el0, %0" : : "r" ((uint64_t)1 << 31));
+	__asm__ volatile("isb");
+}
+
+static uint64_t PMU_Read(void)
+{
+	uint64_t  val;
+
+	__asm__ volatile("isb; mrs %0, pmccntr_el0" : "=r" (val) : : "memory");
+	return val;
+}
+
+/* Cycles per second, against 100 ms of the generic timer */
+static uint64_t PMU_Calibrate(void)
+{
+	uint64_t  t0, c0;
+
+	t0 = EL0_GetCurrentPhysicalValue();
+	c0 = PMU_Read();
+	while (EL0_GetCurrentPhysicalValue() - t0 < CNTPCT_HZ / 10)
+		;
+	return (PMU_Read() - c0) * 10;
+}
+
+uint64_t bench_now(void)
+{
+	return g_use_pmu ? PMU_Read() : EL0_GetCurrentPhysicalValue();
+}
+
+uint64_t bench_hz(void)
+{
+	return g_use_pmu ? g_cpu_hz : CNTPCT_HZ;
+}
+
+static void SYS_Init(void)
+{
+	/* Enable UART module clock */
+	CLK_EnableModuleClock(UART0_MODULE);
+
+	/* Select UART module clock source as SYSCLK1 and UART module clock divider as 15 */
+	CLK_SetModuleClock(UART0_MODULE, CLK_CLKSEL2_UART0SEL_SYSCLK1_DIV2, CLK_CLKDIV1_UART0(15));
+
+	if (Is_MA35D05K())
+	{
+		/* enable Wormhole 1 clock */
+		CLK_EnableModuleClock(WH1_MODULE);
+	}
+	else
+	{
+		/* Enable Crypto engine clock */
+		outpw(TSI_CLK_BASE + 0x4, inpw(TSI_CLK_BASE + 0x4) | (1 << 12));
+	}
+
+	/* Set GPE multi-function pins for UART0 RXD and TXD */
+	SYS->GPE_MFPH &= ~(SYS_GPE_MFPH_PE14MFP_Msk | SYS_GPE_MFPH_PE15MFP_Msk);
+	SYS->GPE_MFPH |= (SYS_GPE_MFPH_PE14MFP_UART0_TXD | SYS_GPE_MFPH_PE15MFP_UART0_RXD);
+}
+
+int32_t main(void)
+{
+	const bench_engine_t *hw;
+
+	/* Unlock protected registers */
+	SYS_UnlockReg();
+
+	/* Init System, IP clock and multi-function I/O */
+	SYS_Init();
+
+	/* Init UART to 115200-8n1 for print message */
+	UART_Open(UART0, 115200);
+
+	if (Is_MA35D05K())
+	{
+		if (TSI_Init() != 0)
+		{
+			sysprintf("TSI Init failed!\n");
+			while (1);
+		}
+		hw = &bench_engine_tsi;
+	}
+	else
+	{
+		Crypto_Init();
+		hw = &bench_engine_crpt;
+	}
+
+	PMU_Init();
+	g_cpu_hz = PMU_Calibrate();
+
+	/* The cycle counter may not count at the level the sample runs at */
+	g_use_pmu = (g_cpu_hz != 0);
+	if (!g_use_pmu)
+		bench_unit = "tick";
+
+	sysprintf("\n\n");
+	sysprintf("+----------------------------------------+\n");
+	sysprintf("|  Crypto Benchmark                      |\n");
+	sysprintf("+----------------------------------------+\n");
+	if (g_use_pmu)
+		sysprintf("CPU %u MHz, ", (unsigned)(g_cpu_hz / 1000000));
+	else
+		sysprintf("No cycle counter, 12 MHz timer ticks, ");
+	sysprintf("at least %d ms per result\n", BENCH_MIN_MS);
+
+	bench_rand(bench_in_pool, BENCH_MAX_LEN + 64);
+	if (bench_sw_keys() != 0)
+		while (1);
+
+	/* The engines use the non-cacheable alias of the pools */
+	dcache_clean_invalidate_by_mva(bench_in_pool, BENCH_MAX_LEN + 64);
+	dcache_clean_invalidate_by_mva(bench_out_pool, BENCH_MAX_LEN + 64);
+	bench_run(hw);
+
+	bench_run(&bench_engine_sw);
+
+	sysprintf("\n\nBenchmark done.\n");
+	while (1);
+}
@@ -0,0 +1,48 @@
+/**************************************************************************//**
+ * @file     mbedtls_config.h
+ * @brief    mbedtls configuration of the crypto benchmark: the software
+ *           algorithms it measures and nothing else, no hardware alternates.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __MBEDTLS_CONFIG_H__
+#define __MBEDTLS_CONFIG_H__
+
+#define MBEDTLS_HAVE_ASM
+
+/* Symmetric */
+#define MBEDTLS_AES_C
+#define MBEDTLS_CIPHER_MODE_CBC
+#define MBEDTLS_CIPHER_MODE_CTR
+#define MBEDTLS_CIPHER_C
+#define MBEDTLS_GCM_C
+
+/* Hashes */
+#define MBEDTLS_SHA1_C
+#define MBEDTLS_SHA224_C
+#define MBEDTLS_SHA256_C
+#define MBEDTLS_SHA384_C
+#define MBEDTLS_SHA512_C
+#define MBEDTLS_MD_C
+
+/* Public key */
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_DP_SECP384R1_ENABLED
+#define MBEDTLS_ECP_DP_SECP521R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_RSA_C
+#define MBEDTLS_PKCS1_V15
+#define MBEDTLS_GENPRIME
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_OID_C
+
+/* RSA-4096 needs the larger window to keep the key generation bearable */
+#define MBEDTLS_MPI_WINDOW_SIZE     6
+#define MBEDTLS_MPI_MAX_SIZE        512
+
+#endif /* __MBEDTLS_CONFIG_H__ */
@@ -0,0 +1,376 @@
+/**************************************************************************//**
+ * @file     diskcache.c
+ * @brief    Write-back sector cache for the FatFs diskio layer
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+
+#include "diskcache.h"
+
+#if DISKCACHE_LINE_SECS < 1 || DISKCACHE_LINE_SECS > 32
+#error "DISKCACHE_LINE_SECS must be 1 to 32"
+#endif
+
+#define LINE_MASK_ALL   ((DISKCACHE_LINE_SECS == 32) ? 0xffffffffU : ((1U << DISKCACHE_LINE_SECS) - 1))
+#define LINE_BASE(s)    ((s) - ((s) % DISKCACHE_LINE_SECS))
+
+/* Bits first to first + n - 1 */
+static uint32_t diskcache_bits(uint32_t first, uint32_t n)
+{
+    return ((n == 32) ? 0xffffffffU : ((1U << n) - 1)) << first;
+}
+
+static int diskcache_find(diskcache_t *dc, uint32_t base)
+{
+    int  i;
+
+    for (i = 0; i < DISKCACHE_LINES; i++)
+    {
+        if (dc->line[i].used && (dc->line[i].sector == base))
+            return i;
+    }
+    return -1;
+}
+
+/*
+ * Reads (write == 0) or writes the runs of consecutive sectors of line i
+ * that are set in mask, one device call per run.
+ */
+static int diskcache_runs(diskcache_t *dc, int i, uint32_t mask, int write)
+{
+    diskcache_line_t *l = &dc->line[i];
+    uint32_t  first, n;
+    int       ret;
+
+    for (first = 0; first < DISKCACHE_LINE_SECS; first += n)
+    {
+        if (!(mask & (1U << first)))
+        {
+            n = 1;
+            continue;
+        }
+        for (n = 1; (first + n < DISKCACHE_LINE_SECS) && (mask & (1U << (first + n))); n++)
+            ;
+
+        if (write)
+        {
+            ret = dc->dev->write(dc->dev->ctx, dc->data[i] + first * DISKCACHE_SS, l->sector + first, n);
+            dc->stats.dev_writes++;
+            dc->stats.dev_write_secs += n;
+        }
+        else
+        {
+            ret = dc->dev->read(dc->dev->ctx, dc->data[i] + first * DISKCACHE_SS, l->sector + first, n);
+            dc->stats.dev_reads++;
+            dc->stats.dev_read_secs += n;
+        }
+        if (ret != 0)
+            return ret;
+    }
+    return 0;
+}
+
+static int diskcache_clean(diskcache_t *dc, int i)
+{
+    int  ret;
+
+    if (dc->line[i].dirty == 0)
+        return 0;
+
+    ret = diskcache_runs(dc, i, dc->line[i].dirty, 1);
+    if (ret == 0)
+        dc->line[i].dirty = 0;
+    return ret;
+}
+
+/* A line for base, a free one or the least recently used after writing it back */
+static int diskcache_alloc(diskcache_t *dc, uint32_t base, int *idx)
+{
+    int  i, victim = 0, ret;
+
+    for (i = 0; i < DISKCACHE_LINES; i++)
+    {
+        if (dc->line[i].used == 0)
+        {
+            victim = i;
+            break;
+        }
+        if (dc->line[i].used < dc->line[victim].used)
+            victim = i;
+    }
+
+    ret = diskcache_clean(dc, victim);
+    if (ret != 0)
+        return ret;
+
+    dc->line[victim].sector = base;
+    dc->line[victim].valid = 0;
+    dc->line[victim].used = ++dc->tick;
+    *idx = victim;
+    return 0;
+}
+
+/* Sectors of the line at base that exist on the device */
+static uint32_t diskcache_on_disk(diskcache_t *dc, uint32_t base)
+{
+    uint32_t  sectors = dc->dev->sectors;
+
+    if ((sectors == 0) || (base + DISKCACHE_LINE_SECS <= sectors))
+        return LINE_MASK_ALL;
+    if (base >= sectors)
+        return 0;
+    return diskcache_bits(0, sectors - base);
+}
+
+/* Loads what the line at base does not have yet, allocating it if needed */
+static int diskcache_load(diskcache_t *dc, uint32_t base, int *idx)
+{
+    uint32_t  mask;
+    int       i, ret;
+
+    i = diskcache_find(dc, base);
+    if (i < 0)
+    {
+        ret = diskcache_alloc(dc, base, &i);
+        if (ret != 0)
+            return ret;
+    }
+
+    mask = diskcache_on_disk(dc, base) & ~dc->line[i].valid;
+    if (mask != 0)
+    {
+        ret = diskcache_runs(dc, i, mask, 0);
+        if (ret != 0)
+        {
+            /* Keep what is dirty, the rest of the line may be half read */
+            dc->line[i].valid = dc->line[i].dirty;
+            if (dc->line[i].valid == 0)
+                dc->line[i].used = 0;
+            return ret;
+        }
+        dc->line[i].valid |= mask;
+    }
+    *idx = i;
+    return 0;
+}
+
+/**
+ * Starts an empty cache on dev. Anything cached before is dropped, dirty or
+ * not, so flush first if the same device stays.
+ *
+ * @param dc the cache
+ * @param dev the device, must stay valid while the cache is used
+ * @return 0
+ */
+int diskcache_init(diskcache_t *dc, const diskcache_dev_t *dev)
+{
+    dc->dev = dev;
+    diskcache_invalidate(dc);
+    memset(&dc->stats, 0, sizeof(dc->stats));
+    return 0;
+}
+
+/**
+ * Drops every line without writing it back, for a medium that has changed.
+ *
+ * @param dc the cache
+ */
+void diskcache_invalidate(diskcache_t *dc)
+{
+    memset(dc->line, 0, sizeof(dc->line));
+    dc->tick = 0;
+    dc->next_sector = 0xffffffffU;
+}
+
+/**
+ * Reads count sectors from sector into buf.
+ *
+ * @param dc the cache
+ * @param buf destination, any alignment for cached reads, what the device
+ *        accepts for reads of DISKCACHE_BYPASS_SECS or more
+ * @param sector first sector
+ * @param count number of sectors
+ * @return 0 on success, the device error otherwise
+ */
+int diskcache_read(diskcache_t *dc, uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    uint32_t  base, first, n, mask, s, end = sector + count;
+    int       i, ret, miss = 0;
+
+    if (count >= DISKCACHE_BYPASS_SECS)
+    {
+        ret = dc->dev->read(dc->dev->ctx, buf, sector, count);
+        dc->stats.dev_reads++;
+        dc->stats.dev_read_secs += count;
+        dc->stats.bypass_secs += count;
+        if (ret != 0)
+            return ret;
+
+        /* The device is behind the sectors still dirty in the cache */
+        for (i = 0; i < DISKCACHE_LINES; i++)
+        {
+            if ((dc->line[i].dirty == 0) || (dc->line[i].sector + DISKCACHE_LINE_SECS <= sector) ||
+                    (dc->line[i].sector >= end))
+                continue;
+            for (s = 0; s < DISKCACHE_LINE_SECS; s++)
+            {
+                if ((dc->line[i].dirty & (1U << s)) && (dc->line[i].sector + s >= sector) &&
+                        (dc->line[i].sector + s < end))
+                    memcpy(buf + (dc->line[i].sector + s - sector) * DISKCACHE_SS,
+                           dc->data[i] + s * DISKCACHE_SS, DISKCACHE_SS);
+            }
+        }
+        return 0;
+    }
+
+    for (s = sector; s < end; s += n)
+    {
+        base = LINE_BASE(s);
+        first = s - base;
+        n = DISKCACHE_LINE_SECS - first;
+        if (n > end - s)
+            n = end - s;
+        mask = diskcache_bits(first, n);
+
+        i = diskcache_find(dc, base);
+        if ((i >= 0) && ((dc->line[i].valid & mask) == mask))
+        {
+            dc->stats.read_hits += n;
+            dc->line[i].used = ++dc->tick;
+        }
+        else
+        {
+            dc->stats.read_misses += n;
+            miss = 1;
+            ret = diskcache_load(dc, base, &i);
+            if (ret != 0)
+                return ret;
+        }
+        memcpy(buf + (s - sector) * DISKCACHE_SS, dc->data[i] + first * DISKCACHE_SS, n * DISKCACHE_SS);
+    }
+
+    /* A miss in a sequential run, the next lines are likely wanted too */
+    if (miss && (sector == dc->next_sector))
+    {
+        base = LINE_BASE(end - 1);
+        for (n = 1; n <= DISKCACHE_READAHEAD; n++)
+        {
+            base += DISKCACHE_LINE_SECS;
+            if (diskcache_on_disk(dc, base) == 0)
+                break;
+            if ((diskcache_find(dc, base) < 0) && (diskcache_load(dc, base, &i) != 0))
+                break;
+        }
+    }
+    dc->next_sector = end;
+    return 0;
+}
+
+/**
+ * Writes count sectors from buf at sector. Small writes only go to the
+ * cache, until diskcache_flush() or until their line is replaced.
+ *
+ * @param dc the cache
+ * @param buf source, any alignment for cached writes, what the device
+ *        accepts for writes of DISKCACHE_BYPASS_SECS or more
+ * @param sector first sector
+ * @param count number of sectors
+ * @return 0 on success, the device error otherwise
+ */
+int diskcache_write(diskcache_t *dc, const uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    uint32_t  base, first, n, mask, s, end = sector + count;
+    int       i, ret;
+
+    if (count >= DISKCACHE_BYPASS_SECS)
+    {
+        ret = dc->dev->write(dc->dev->ctx, buf, sector, count);
+        dc->stats.dev_writes++;
+        dc->stats.dev_write_secs += count;
+        dc->stats.bypass_secs += count;
+        if (ret != 0)
+            return ret;
+
+        /* Cached copies take the new data and are clean again */
+        for (i = 0; i < DISKCACHE_LINES; i++)
+        {
+            if ((dc->line[i].used == 0) || (dc->line[i].sector + DISKCACHE_LINE_SECS <= sector) ||
+                    (dc->line[i].sector >= end))
+                continue;
+            for (s = 0; s < DISKCACHE_LINE_SECS; s++)
+            {
+                if ((dc->line[i].sector + s < sector) || (dc->line[i].sector + s >= end))
+                    continue;
+                if (dc->line[i].valid & (1U << s))
+                    memcpy(dc->data[i] + s * DISKCACHE_SS,
+                           buf + (dc->line[i].sector + s - sector) * DISKCACHE_SS, DISKCACHE_SS);
+                dc->line[i].dirty &= ~(1U << s);
+            }
+        }
+        return 0;
+    }
+
+    for (s = sector; s < end; s += n)
+    {
+        base = LINE_BASE(s);
+        first = s - base;
+        n = DISKCACHE_LINE_SECS - first;
+        if (n > end - s)
+            n = end - s;
+        mask = diskcache_bits(first, n);
+
+        i = diskcache_find(dc, base);
+        if (i >= 0)
+        {
+            dc->stats.write_hits += n;
+            dc->line[i].used = ++dc->tick;
+        }
+        else
+        {
+            /* Only the sectors written become valid, the rest is read when needed */
+            dc->stats.write_misses += n;
+            ret = diskcache_alloc(dc, base, &i);
+            if (ret != 0)
+                return ret;
+        }
+        memcpy(dc->data[i] + first * DISKCACHE_SS, buf + (s - sector) * DISKCACHE_SS, n * DISKCACHE_SS);
+        dc->line[i].valid |= mask;
+        dc->line[i].dirty |= mask;
+    }
+    return 0;
+}
+
+/**
+ * Writes every dirty sector to the device, in ascending sector order.
+ *
+ * @param dc the cache
+ * @return 0 on success, the first device error otherwise. Lines that could
+ *         not be written stay dirty.
+ */
+int diskcache_flush(diskcache_t *dc)
+{
+    uint32_t  last = 0;
+    int       i, next, ret, err = 0, started = 0;
+
+    for (;;)
+    {
+        next = -1;
+        for (i = 0; i < DISKCACHE_LINES; i++)
+        {
+            if ((dc->line[i].dirty == 0) || (started && (dc->line[i].sector <= last)))
+                continue;
+            if ((next < 0) || (dc->line[i].sector < dc->line[next].sector))
+                next = i;
+        }
+        if (next < 0)
+            break;
+
+        ret = diskcache_clean(dc, next);
+        if ((ret != 0) && (err == 0))
+            err = ret;
+        last = dc->line[next].sector;
+        started = 1;
+    }
+    return err;
+}
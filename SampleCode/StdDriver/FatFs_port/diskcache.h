@@ -0,0 +1,98 @@
+/**************************************************************************//**
+ * @file     diskcache.h
+ * @brief    Write-back sector cache for the FatFs diskio layer
+ *
+ * Sits between disk_read()/disk_write() and a block device. Sectors are kept
+ * in lines of DISKCACHE_LINE_SECS consecutive sectors, replaced least
+ * recently used first. Writes stay in the cache until the line is evicted or
+ * diskcache_flush() is called, which disk_ioctl(CTRL_SYNC) must do. A small
+ * read that continues the previous one also loads the next
+ * DISKCACHE_READAHEAD lines. Transfers of DISKCACHE_BYPASS_SECS sectors or
+ * more go straight to the device, cached copies are kept coherent.
+ *
+ * One cache serves one drive. It is not locked, FatFs calls it for one
+ * volume at a time unless FF_FS_REENTRANT is set, which adds the lock.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __DISKCACHE_H__
+#define __DISKCACHE_H__
+
+#include <stdint.h>
+
+#define DISKCACHE_SS            512     /* sector size, FF_MAX_SS */
+
+/* Cached lines, DISKCACHE_LINES * DISKCACHE_LINE_SECS * 512 bytes per drive */
+#ifndef DISKCACHE_LINES
+#define DISKCACHE_LINES         16
+#endif
+
+/* Sectors per line, 1 to 32. A miss loads the whole line. */
+#ifndef DISKCACHE_LINE_SECS
+#define DISKCACHE_LINE_SECS     8
+#endif
+
+/* Lines loaded ahead of a sequential run of small reads, 0 for none */
+#ifndef DISKCACHE_READAHEAD
+#define DISKCACHE_READAHEAD     2
+#endif
+
+/* Transfers of this many sectors or more bypass the cache */
+#ifndef DISKCACHE_BYPASS_SECS
+#define DISKCACHE_BYPASS_SECS   DISKCACHE_LINE_SECS
+#endif
+
+/* Line buffers are aligned to the Cortex-A35 cache line for the DMA */
+#define DISKCACHE_ALIGN         64
+
+/* The block device, the functions return 0 on success */
+typedef struct diskcache_dev
+{
+    int (*read)(void *ctx, uint8_t *buf, uint32_t sector, uint32_t count);
+    int (*write)(void *ctx, const uint8_t *buf, uint32_t sector, uint32_t count);
+    void *ctx;
+    uint32_t sectors;                   /* sectors on the device, 0 if unknown */
+}
+diskcache_dev_t;
+
+typedef struct diskcache_stats
+{
+    uint32_t read_hits;                 /* sectors read from the cache */
+    uint32_t read_misses;               /* sectors that needed the device */
+    uint32_t write_hits;                /* sectors written into a cached line */
+    uint32_t write_misses;              /* sectors that needed a new line */
+    uint32_t bypass_secs;               /* sectors moved around the cache */
+    uint32_t dev_reads;                 /* device calls */
+    uint32_t dev_writes;
+    uint32_t dev_read_secs;             /* sectors moved by those calls */
+    uint32_t dev_write_secs;
+}
+diskcache_stats_t;
+
+typedef struct diskcache_line
+{
+    uint32_t sector;                    /* first sector, a multiple of DISKCACHE_LINE_SECS */
+    uint32_t valid;                     /* bit n: sector + n is in the cache */
+    uint32_t dirty;                     /* bit n: sector + n is newer than the device */
+    uint32_t used;                      /* LRU stamp, 0 for a free line */
+}
+diskcache_line_t;
+
+typedef struct diskcache
+{
+    uint8_t data[DISKCACHE_LINES][DISKCACHE_LINE_SECS * DISKCACHE_SS] __attribute__((aligned(DISKCACHE_ALIGN)));
+    diskcache_line_t line[DISKCACHE_LINES];
+    const diskcache_dev_t *dev;
+    uint32_t tick;
+    uint32_t next_sector;               /* after the last small read, to spot a sequential run */
+    diskcache_stats_t stats;
+}
+diskcache_t;
+
+int  diskcache_init(diskcache_t *dc, const diskcache_dev_t *dev);
+int  diskcache_read(diskcache_t *dc, uint8_t *buf, uint32_t sector, uint32_t count);
+int  diskcache_write(diskcache_t *dc, const uint8_t *buf, uint32_t sector, uint32_t count);
+int  diskcache_flush(diskcache_t *dc);
+void diskcache_invalidate(diskcache_t *dc);
+
+#endif
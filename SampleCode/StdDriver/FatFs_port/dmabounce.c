@@ -0,0 +1,57 @@
+/**************************************************************************//**
+ * @file     dmabounce.c
+ * @brief    Shared DMA bounce buffers for the FatFs diskio layer
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "NuMicro.h"
+#include "dmabounce.h"
+
+#if DMABOUNCE_SECS < 2
+#error "DMABOUNCE_SECS must be 2 or more"
+#endif
+
+static uint8_t dmabounce_pool[DMABOUNCE_BUFS][DMABOUNCE_SECS * DMABOUNCE_SS] __attribute__((aligned(DMABOUNCE_ALIGN)));
+static volatile uint32_t dmabounce_busy;    /* bit n: dmabounce_pool[n] is taken */
+
+/**
+ * Takes a buffer of DMABOUNCE_SECS sectors from the pool.
+ *
+ * @return the buffer, NULL if all of them are taken. The caller must then
+ *         get by without, a wait could deadlock on a single core.
+ */
+uint8_t *dmabounce_get(void)
+{
+    uint64_t  daif;
+    int       i;
+
+    daif = raw_read_daif();
+    disable_irq();
+    for (i = 0; i < DMABOUNCE_BUFS; i++)
+    {
+        if (!(dmabounce_busy & (1U << i)))
+        {
+            dmabounce_busy |= (1U << i);
+            break;
+        }
+    }
+    raw_write_daif(daif);
+
+    return (i < DMABOUNCE_BUFS) ? dmabounce_pool[i] : NULL;
+}
+
+/**
+ * Returns a buffer of dmabounce_get() to the pool.
+ *
+ * @param buf the buffer
+ */
+void dmabounce_put(uint8_t *buf)
+{
+    uint64_t  daif;
+    int       i = (int)((buf - dmabounce_pool[0]) / (DMABOUNCE_SECS * DMABOUNCE_SS));
+
+    daif = raw_read_daif();
+    disable_irq();
+    dmabounce_busy &= ~(1U << i);
+    raw_write_daif(daif);
+}
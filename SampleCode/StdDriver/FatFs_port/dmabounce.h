@@ -0,0 +1,37 @@
+/**************************************************************************//**
+ * @file     dmabounce.h
+ * @brief    Shared DMA bounce buffers for the FatFs diskio layer
+ *
+ * FatFs passes the application's buffer to disk_read()/disk_write() for
+ * whole sectors, at any alignment. The SDH ADMA2 needs 4-byte aligned
+ * addresses, and the cache maintenance around a DMA is only safe on whole
+ * cache lines. A buffer that does not meet both goes, in part or in whole,
+ * through one of the DMABOUNCE_BUFS buffers here, which every drive shares.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __DMABOUNCE_H__
+#define __DMABOUNCE_H__
+
+#include <stdint.h>
+
+/* Buffers in the pool, the drives that may be busy at the same time */
+#ifndef DMABOUNCE_BUFS
+#define DMABOUNCE_BUFS          2
+#endif
+
+/* Sectors per buffer, at least 2 */
+#ifndef DMABOUNCE_SECS
+#define DMABOUNCE_SECS          16
+#endif
+
+#define DMABOUNCE_SS            512     /* sector size, FF_MAX_SS */
+#define DMABOUNCE_ALIGN         64      /* Cortex-A35 cache line */
+
+/* p can take a DMA without a bounce buffer */
+#define DMABOUNCE_IS_ALIGNED(p) ((((uintptr_t)(p)) & (DMABOUNCE_ALIGN - 1)) == 0)
+
+uint8_t *dmabounce_get(void);
+void     dmabounce_put(uint8_t *buf);
+
+#endif
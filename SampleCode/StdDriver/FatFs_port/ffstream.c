@@ -0,0 +1,335 @@
+/**************************************************************************//**
+ * @file     ffstream.c
+ * @brief    Read-ahead streaming of FatFs files into a ring of DMA buffers
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+
+#include "NuMicro.h"
+#include "diskio.h"
+#include "ffstream.h"
+
+#if !FF_USE_FASTSEEK
+#error "ffstream needs FF_USE_FASTSEEK"
+#endif
+
+#if FF_MAX_SS != FSTREAM_SS
+#error "ffstream needs 512-byte sectors"
+#endif
+
+static uint8_t *ffstream_addr(ffstream_t *st, uint32_t sec)
+{
+    return st->ring + (sec % (st->buf_secs * st->nbufs)) * FSTREAM_SS;
+}
+
+/*
+ * Stream sectors that may be read next in one go: the buffers not held by
+ * the consumer, up to the end of the ring, the file and FSTREAM_MAX_SECS.
+ */
+static uint32_t ffstream_room(ffstream_t *st)
+{
+    uint32_t  limit = (st->rel + st->nbufs) * st->buf_secs;
+    uint32_t  ring_secs = st->buf_secs * st->nbufs;
+    uint32_t  n;
+
+    if (limit > st->total_secs)
+        limit = st->total_secs;
+    if (st->issued >= limit)
+        return 0;
+
+    n = limit - st->issued;
+    if (n > ring_secs - st->issued % ring_secs)
+        n = ring_secs - st->issued % ring_secs;
+    if (n > FSTREAM_MAX_SECS)
+        n = FSTREAM_MAX_SECS;
+    return n;
+}
+
+/* Device sector of the next stream sector, *run sectors follow it in its fragment */
+static uint32_t ffstream_sector(ffstream_t *st, uint32_t *run)
+{
+    FATFS     *fs = st->fp->obj.fs;
+    DWORD     *frag = &st->linkmap[st->frag];
+
+    *run = frag[0] * fs->csize - st->frag_off;
+    return fs->database + (frag[1] - 2) * fs->csize + st->frag_off;
+}
+
+static void ffstream_advance(ffstream_t *st, uint32_t n)
+{
+    st->frag_off += n;
+    if (st->frag_off == st->linkmap[st->frag] * st->fp->obj.fs->csize)
+    {
+        st->frag += 2;
+        st->frag_off = 0;
+    }
+}
+
+/* Sectors of the next read, 0 if there is nothing to read */
+static uint32_t ffstream_plan(ffstream_t *st, uint32_t *sector)
+{
+    uint32_t  n, run;
+
+    n = ffstream_room(st);
+    if ((n == 0) || !st->mapped)
+        return n;
+
+    if (st->linkmap[st->frag] == 0)
+    {
+        /* The chain ended before the file size */
+        st->err = FR_INT_ERR;
+        return 0;
+    }
+    *sector = ffstream_sector(st, &run);
+    return (n < run) ? n : run;
+}
+
+/* Starts the next asynchronous read, IRQ masked or from the device interrupt */
+static uint32_t ffstream_start(ffstream_t *st)
+{
+    uint8_t   *buf;
+    uint32_t  n, sector = 0;
+
+    if (st->busy || (st->err != FR_OK))
+        return 0;
+
+    n = ffstream_plan(st, &sector);
+    if (n == 0)
+        return 0;
+
+    buf = ffstream_addr(st, st->issued);
+    dcache_clean_invalidate_by_mva(buf, n * FSTREAM_SS);
+    ffstream_advance(st, n);
+    st->issued += n;
+    st->busy = 1;
+
+    if (st->dev->start(st->dev->ctx, st, nc_ptr(buf), sector, n) != 0)
+    {
+        st->busy = 0;
+        st->err = FR_DISK_ERR;
+        return 0;
+    }
+    return n;
+}
+
+/**
+ * Starts streaming fp from its file pointer. The link map of the file
+ * stays set in fp->cltbl until ffstream_close().
+ *
+ * @param st the stream
+ * @param fp a file open for reading, not read through f_read() while streamed
+ * @param dev an asynchronous device for the drive of fp, or NULL
+ * @param ring nbufs buffers of buf_size bytes, FSTREAM_ALIGN aligned
+ * @param buf_size bytes per buffer, a multiple of FSTREAM_SS
+ * @param nbufs number of buffers
+ * @return FR_OK, or the error of the link map
+ */
+FRESULT ffstream_open(ffstream_t *st, FIL *fp, const ffstream_dev_t *dev, uint8_t *ring,
+                      UINT buf_size, UINT nbufs)
+{
+    FATFS     *fs = fp->obj.fs;
+    FSIZE_t   left;
+    uint32_t  start, run;
+    FRESULT   res;
+
+    if ((ptr_to_u32(ring) & (FSTREAM_ALIGN - 1)) || (buf_size == 0) ||
+            (buf_size % FSTREAM_SS) || (nbufs == 0))
+        return FR_INVALID_PARAMETER;
+
+    memset(st, 0, sizeof(*st));
+    st->fp = fp;
+    st->dev = dev;
+    st->ring = ring;
+    st->buf_secs = buf_size / FSTREAM_SS;
+    st->nbufs = nbufs;
+
+    start = (uint32_t)(fp->fptr / FSTREAM_SS);
+    st->skip = (uint32_t)(fp->fptr % FSTREAM_SS);
+    left = fp->obj.objsize - (FSIZE_t)start * FSTREAM_SS;
+    st->total_secs = (uint32_t)((left + FSTREAM_SS - 1) / FSTREAM_SS);
+    st->last_len = (uint32_t)(left % FSTREAM_SS);
+    if (st->last_len == 0)
+        st->last_len = FSTREAM_SS;
+
+    st->linkmap[0] = FSTREAM_LINKMAP;
+    fp->cltbl = st->linkmap;
+    res = f_lseek(fp, CREATE_LINKMAP);
+    if (res == FR_OK)
+    {
+        /* The fragments before the file pointer are not read */
+        st->mapped = 1;
+        st->frag = 1;
+        while (st->linkmap[st->frag] != 0)
+        {
+            run = st->linkmap[st->frag] * fs->csize;
+            if (start < run)
+            {
+                st->frag_off = start;
+                break;
+            }
+            start -= run;
+            st->frag += 2;
+        }
+    }
+    else if (res == FR_NOT_ENOUGH_CORE)
+    {
+        /* Too fragmented, f_read() from the start of the sector */
+        fp->cltbl = NULL;
+        res = f_lseek(fp, (FSIZE_t)start * FSTREAM_SS);
+    }
+
+    if (res != FR_OK)
+        fp->cltbl = NULL;
+    return res;
+}
+
+/**
+ * Reads into the ring, as far as the buffers released allow. Without an
+ * asynchronous device, call it whenever the consumer would otherwise wait.
+ *
+ * @param st the stream
+ * @return the sectors read, or started with an asynchronous device, 0 if
+ *         the ring is full, the file read or a read has failed
+ */
+UINT ffstream_pump(ffstream_t *st)
+{
+    uint8_t   *buf;
+    uint32_t  n, sector = 0;
+    uint64_t  daif;
+    UINT      br;
+    FRESULT   res;
+
+    if (st->err != FR_OK)
+        return 0;
+
+    if ((st->dev != NULL) && st->mapped)
+    {
+        daif = raw_read_daif();
+        disable_irq();
+        n = ffstream_start(st);
+        raw_write_daif(daif);
+        return n;
+    }
+
+    n = ffstream_plan(st, &sector);
+    if (n == 0)
+        return 0;
+
+    buf = ffstream_addr(st, st->issued);
+    dcache_clean_invalidate_by_mva(buf, n * FSTREAM_SS);
+    if (st->mapped)
+    {
+        res = (disk_read(st->fp->obj.fs->pdrv, nc_ptr(buf), sector, n) == RES_OK) ? FR_OK : FR_DISK_ERR;
+        ffstream_advance(st, n);
+    }
+    else
+    {
+        res = f_read(st->fp, nc_ptr(buf), n * FSTREAM_SS, &br);
+    }
+    dcache_invalidate_by_mva(buf, n * FSTREAM_SS);
+
+    if (res != FR_OK)
+    {
+        st->err = res;
+        return 0;
+    }
+    st->issued += n;
+    st->done += n;
+    return n;
+}
+
+/**
+ * Ends the asynchronous read started by ffstream_dev_t.start() and starts
+ * the next one. May be called from an interrupt.
+ *
+ * @param st the stream
+ * @param err 0 if the sectors were read
+ */
+void ffstream_done(ffstream_t *st, int err)
+{
+    uint32_t  n = st->issued - st->done;
+
+    dcache_invalidate_by_mva(ffstream_addr(st, st->done), n * FSTREAM_SS);
+    if (err != 0)
+    {
+        st->err = FR_DISK_ERR;
+        st->busy = 0;
+        return;
+    }
+    st->done += n;
+    st->busy = 0;
+    ffstream_start(st);
+}
+
+/**
+ * Hands out the next buffer of the file, in place in the ring. It stays
+ * valid until ffstream_release(). Waits for the device only if the buffer
+ * is not read yet.
+ *
+ * @param st the stream
+ * @param buf the data
+ * @param len bytes at buf, 0 at the end of the file
+ * @return FR_OK, or the error of a read
+ */
+FRESULT ffstream_next(ffstream_t *st, uint8_t **buf, UINT *len)
+{
+    uint32_t  first = st->rd * st->buf_secs;
+    uint32_t  end = first + st->buf_secs;
+
+    *buf = NULL;
+    *len = 0;
+    if (first >= st->total_secs)
+        return st->err;
+    if (st->rd - st->rel >= st->nbufs)
+        return FR_DENIED;               /* every buffer is held */
+
+    if (end > st->total_secs)
+        end = st->total_secs;
+    while (st->done < end)
+    {
+        if (st->err != FR_OK)
+            return st->err;
+        ffstream_pump(st);
+    }
+
+    *buf = ffstream_addr(st, first);
+    *len = (end - first) * FSTREAM_SS;
+    if (end == st->total_secs)
+        *len -= FSTREAM_SS - st->last_len;
+    if (st->rd == 0)
+    {
+        *buf += st->skip;
+        *len -= st->skip;
+    }
+    st->rd++;
+    return FR_OK;
+}
+
+/**
+ * Gives the oldest buffer handed out back to the ring.
+ *
+ * @param st the stream
+ */
+void ffstream_release(ffstream_t *st)
+{
+    if (st->rel == st->rd)
+        return;
+    st->rel++;
+
+    /* An asynchronous device may have stopped on a full ring */
+    if (st->dev != NULL)
+        ffstream_pump(st);
+}
+
+/**
+ * Waits for the read in progress and drops the link map from the file.
+ *
+ * @param st the stream
+ */
+void ffstream_close(ffstream_t *st)
+{
+    while (st->busy)
+        ;
+    st->fp->cltbl = NULL;
+}
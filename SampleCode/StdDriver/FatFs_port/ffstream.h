@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * @file     ffstream.h
+ * @brief    Read-ahead streaming of FatFs files into a ring of DMA buffers
+ *
+ * For consumers that go through a file once from start to end, such as
+ * audio and image decoders. ffstream_open() maps the clusters of the file
+ * once with the FatFs fast seek link map (FF_USE_FASTSEEK). Reads then go to
+ * the device sectors directly, FSTREAM_MAX_SECS at most per read and without
+ * walking the FAT, into a ring of equally sized buffers. The consumer gets
+ * the filled buffers in place, in file order, and releases them for refill.
+ *
+ * The ring is filled in the background of the consumer:
+ *  - With an asynchronous device (ffstream_dev_t), the completion of a read
+ *    starts the next one, from the interrupt of the device.
+ *  - Without one, through disk_read(), when the consumer calls
+ *    ffstream_pump() while it waits for something else, such as a PCM
+ *    buffer to play out. A task can do the same under an RTOS.
+ * ffstream_next() only waits for the device if the ring runs dry.
+ *
+ * A file too fragmented for FSTREAM_LINKMAP is read with f_read() instead.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __FFSTREAM_H__
+#define __FFSTREAM_H__
+
+#include <stdint.h>
+
+#include "ff.h"
+
+#define FSTREAM_SS              512     /* sector size, FF_MAX_SS */
+#define FSTREAM_ALIGN           64      /* ring alignment, the Cortex-A35 cache line */
+
+/* Items of the cluster link map, 2 per fragment of the file plus 2 */
+#ifndef FSTREAM_LINKMAP
+#define FSTREAM_LINKMAP         64
+#endif
+
+/* Sectors per read at most */
+#ifndef FSTREAM_MAX_SECS
+#define FSTREAM_MAX_SECS        256
+#endif
+
+typedef struct ffstream ffstream_t;
+
+/*
+ * An asynchronous block device. start() begins reading count sectors from
+ * sector into buf and returns 0, the read must end with ffstream_done().
+ * buf is the non-cacheable alias of the ring, the cache is taken care of.
+ */
+typedef struct ffstream_dev
+{
+    int (*start)(void *ctx, ffstream_t *st, uint8_t *buf, uint32_t sector, uint32_t count);
+    void *ctx;
+}
+ffstream_dev_t;
+
+struct ffstream
+{
+    FIL         *fp;
+    const ffstream_dev_t *dev;          /* NULL for disk_read() from ffstream_pump() */
+    uint8_t     *ring;
+    uint32_t    buf_secs;               /* sectors per buffer */
+    uint32_t    nbufs;
+    uint32_t    skip;                   /* bytes of the first buffer before the file pointer */
+    uint32_t    total_secs;             /* sectors from the file pointer to the end of the file */
+    uint32_t    last_len;               /* bytes of the last sector */
+    DWORD       linkmap[FSTREAM_LINKMAP];
+    int         mapped;                 /* 0 when f_read() does the reads */
+    uint32_t    frag;                   /* linkmap item of the next fragment to read from */
+    uint32_t    frag_off;               /* sectors of that fragment already read */
+    uint32_t    issued;                 /* stream sectors asked from the device */
+    volatile uint32_t done;             /* stream sectors in the ring */
+    volatile int busy;                  /* an asynchronous read is out */
+    volatile FRESULT err;
+    uint32_t    rd;                     /* buffers handed out */
+    uint32_t    rel;                    /* buffers released */
+};
+
+/* All buffers of the file have been handed out */
+#define ffstream_eof(st)    ((st)->rd * (st)->buf_secs >= (st)->total_secs)
+
+FRESULT  ffstream_open(ffstream_t *st, FIL *fp, const ffstream_dev_t *dev, uint8_t *ring,
+                       UINT buf_size, UINT nbufs);
+UINT     ffstream_pump(ffstream_t *st);
+FRESULT  ffstream_next(ffstream_t *st, uint8_t **buf, UINT *len);
+void     ffstream_release(ffstream_t *st);
+void     ffstream_done(ffstream_t *st, int err);
+void     ffstream_close(ffstream_t *st);
+
+#endif
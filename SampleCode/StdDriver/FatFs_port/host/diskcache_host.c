@@ -0,0 +1,399 @@
+/**************************************************************************//**
+ * @file     diskcache_host.c
+ * @brief    Checks the sector cache of diskcache.c on a Linux host, over a
+ *           RAM disk and under the FatFs of ThirdParty. Build with
+ *           Makefile.host.
+ *
+ * Random reads, writes, flushes and invalidations after a flush go through
+ * the cache to a disk whose size is not a multiple of the line. Reads must
+ * return what a plain copy of the disk holds, and a flush must leave the
+ * disk equal to it. Then device calls fail at random: a failed write or
+ * flush must report it, a read that reports no error must be right, and
+ * nothing written before may be lost. Last, file system workloads run on
+ * FatFs straight on the disk, then through the cache. Both runs must leave
+ * the same disk image once FatFs has synced, and the cache must take fewer
+ * device calls. The device calls, hit rates and operations per second of
+ * each workload are printed.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "ff.h"
+#include "diskio.h"
+#include "diskcache.h"
+
+#define DCH_SECS        131069      /* 64 MB, less a part of a line */
+#define DCH_AREA        2000        /* sectors at each end of the disk the model uses */
+#define DCH_LOOPS       200000
+#define DCH_FAIL_LOOPS  50000
+#define DCH_MAX_SECS    40
+
+static uint8_t dch_disk[DCH_SECS * DISKCACHE_SS];
+static uint8_t dch_ref[DCH_SECS * DISKCACHE_SS];
+static uint8_t dch_unknown[DCH_SECS];   /* a failed write left the old or the new data */
+static uint32_t dch_calls, dch_secs;
+static uint32_t dch_fail_in;            /* the device call that fails, counted down, 0 for none */
+static int dch_beyond;
+static int dch_reported;
+
+static int dch_dev_read(void *ctx, uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    (void)ctx;
+    dch_calls++;
+    dch_secs += count;
+    if (dch_fail_in && (--dch_fail_in == 0))
+        return -1;
+    if ((sector >= DCH_SECS) || (count > DCH_SECS - sector))
+    {
+        dch_beyond++;
+        return -2;
+    }
+    memcpy(buf, dch_disk + sector * DISKCACHE_SS, count * DISKCACHE_SS);
+    return 0;
+}
+
+static int dch_dev_write(void *ctx, const uint8_t *buf, uint32_t sector, uint32_t count)
+{
+    (void)ctx;
+    dch_calls++;
+    dch_secs += count;
+    if (dch_fail_in && (--dch_fail_in == 0))
+        return -1;
+    if ((sector >= DCH_SECS) || (count > DCH_SECS - sector))
+    {
+        dch_beyond++;
+        return -2;
+    }
+    memcpy(dch_disk + sector * DISKCACHE_SS, buf, count * DISKCACHE_SS);
+    return 0;
+}
+
+static const diskcache_dev_t dch_dev = { dch_dev_read, dch_dev_write, NULL, DCH_SECS };
+static diskcache_t dch_cache;
+static int dch_use_cache;
+
+/* 1 and a report if ok is not set */
+static int dch_check(int ok, const char *what, uint32_t sector)
+{
+    if (ok)
+        return 0;
+    if (dch_reported++ < 10)
+        printf("%s at sector %u\n", what, sector);
+    return 1;
+}
+
+/* Sectors [sector, sector + count) of a and b are the same where known */
+static int dch_same(const uint8_t *a, const uint8_t *b, uint32_t sector, uint32_t count)
+{
+    uint32_t s;
+
+    for (s = 0; s < count; s++)
+    {
+        if (!dch_unknown[sector + s] &&
+            (memcmp(a + s * DISKCACHE_SS, b + (sector + s) * DISKCACHE_SS, DISKCACHE_SS) != 0))
+            return 0;
+    }
+    return 1;
+}
+
+/* The areas of the model on the disk and on the copy */
+static int dch_disk_same(void)
+{
+    return dch_same(dch_disk, dch_ref, 0, DCH_AREA) &&
+           dch_same(dch_disk + (DCH_SECS - DCH_AREA) * DISKCACHE_SS, dch_ref, DCH_SECS - DCH_AREA, DCH_AREA);
+}
+
+/*
+ * Random requests through the cache against dch_ref, mostly short and close
+ * together, some of the bypass size and some at the end of the disk. With
+ * fail set, one device call in a few fails.
+ */
+static int dch_model(int loops, int fail)
+{
+    static uint8_t buf[DCH_MAX_SECS * DISKCACHE_SS];
+    uint32_t s, n, i;
+    int k, ret, armed, fails = 0;
+
+    for (k = 0; k < loops; k++)
+    {
+        n = 1 + ((rand() % 8 == 0) ? rand() % DCH_MAX_SECS : rand() % 4);
+        s = rand() % DCH_AREA;
+        if (rand() % 50 == 0)
+            s += DCH_SECS - DCH_AREA;
+        if (s + n > DCH_SECS)
+            n = DCH_SECS - s;
+        if (fail && (rand() % 4 == 0))
+            dch_fail_in = 1 + rand() % 3;
+        armed = (dch_fail_in != 0);
+
+        switch (rand() % 5)
+        {
+        case 0:
+        case 1:
+            memset(buf, 0xa5, n * DISKCACHE_SS);
+            ret = diskcache_read(&dch_cache, buf, s, n);
+            if (ret == 0)
+                fails += dch_check(dch_same(buf, dch_ref, s, n), "read differs", s);
+            break;
+
+        case 2:
+        case 3:
+            for (i = 0; i < n * DISKCACHE_SS; i++)
+                buf[i] = (uint8_t)rand();
+            ret = diskcache_write(&dch_cache, buf, s, n);
+            memcpy(dch_ref + s * DISKCACHE_SS, buf, n * DISKCACHE_SS);
+            memset(dch_unknown + s, ret != 0, n);
+            if (armed && (dch_fail_in == 0))
+                fails += dch_check(ret != 0, "failed write not reported", s);
+            break;
+
+        default:
+            ret = diskcache_flush(&dch_cache);
+            if (armed && (dch_fail_in == 0))
+                fails += dch_check(ret != 0, "failed flush not reported", s);
+            else if (ret == 0)
+                fails += dch_check(dch_disk_same(), "disk differs after the flush", s);
+            if ((ret == 0) && (rand() % 10 == 0))
+                diskcache_invalidate(&dch_cache);
+            break;
+        }
+        dch_fail_in = 0;
+    }
+
+    fails += dch_check(diskcache_flush(&dch_cache) == 0, "last flush failed", 0);
+    fails += dch_check(dch_disk_same(), "disk differs after the last flush", 0);
+    return fails;
+}
+
+/* The FatFs glue, on drive 0 */
+DSTATUS disk_initialize(BYTE pdrv)
+{
+    (void)pdrv;
+    if (dch_use_cache)
+        diskcache_init(&dch_cache, &dch_dev);
+    return 0;
+}
+
+DSTATUS disk_status(BYTE pdrv)
+{
+    (void)pdrv;
+    return 0;
+}
+
+DRESULT disk_read(BYTE pdrv, BYTE *buff, DWORD sector, UINT count)
+{
+    (void)pdrv;
+    if (dch_use_cache)
+        return diskcache_read(&dch_cache, buff, sector, count) ? RES_ERROR : RES_OK;
+    return dch_dev_read(NULL, buff, sector, count) ? RES_ERROR : RES_OK;
+}
+
+DRESULT disk_write(BYTE pdrv, const BYTE *buff, DWORD sector, UINT count)
+{
+    (void)pdrv;
+    if (dch_use_cache)
+        return diskcache_write(&dch_cache, buff, sector, count) ? RES_ERROR : RES_OK;
+    return dch_dev_write(NULL, buff, sector, count) ? RES_ERROR : RES_OK;
+}
+
+DRESULT disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+    (void)pdrv;
+    switch (cmd)
+    {
+    case CTRL_SYNC:
+        return (dch_use_cache && diskcache_flush(&dch_cache)) ? RES_ERROR : RES_OK;
+    case GET_SECTOR_COUNT:
+        *(DWORD *)buff = DCH_SECS;
+        return RES_OK;
+    case GET_SECTOR_SIZE:
+        *(WORD *)buff = DISKCACHE_SS;
+        return RES_OK;
+    case GET_BLOCK_SIZE:
+        *(DWORD *)buff = 1;
+        return RES_OK;
+    default:
+        return RES_PARERR;
+    }
+}
+
+DWORD get_fattime(void)
+{
+    return ((DWORD)(2023 - 1980) << 25) | (1 << 21) | (1 << 16);
+}
+
+static double dch_now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static unsigned dch_pct(uint32_t hits, uint32_t misses)
+{
+    return (hits + misses) ? (unsigned)(hits * 100ull / (hits + misses)) : 0;
+}
+
+/* Prints a workload and starts the counters of the next one */
+static void dch_report(const char *name, uint32_t ops, double start, uint32_t *calls)
+{
+    diskcache_stats_t *st = &dch_cache.stats;
+
+    printf("  %-22s %6u fs ops %6u device calls %7u sectors", name, ops, dch_calls, dch_secs);
+    if (dch_use_cache)
+        printf("  read hits %3u%%  write hits %3u%%", dch_pct(st->read_hits, st->read_misses),
+               dch_pct(st->write_hits, st->write_misses));
+    printf("  %9.0f ops/s\n", ops / (dch_now() - start));
+
+    *calls += dch_calls;
+    dch_calls = dch_secs = 0;
+    memset(st, 0, sizeof(*st));
+}
+
+/* Files created, listed and read back, a log synced as it grows, a big file */
+static int dch_fatfs(uint32_t *calls)
+{
+    static FATFS fs;
+    static BYTE work[4096];
+    static char big[16384];
+    FIL f;
+    DIR d;
+    FILINFO fi;
+    char name[32], buf[256];
+    UINT bw;
+    uint32_t ops;
+    double start;
+    int i, j, k, fails = 0;
+
+    memset(dch_disk, 0, sizeof(dch_disk));
+    if ((f_mkfs("", FM_FAT32, 0, work, sizeof(work)) != FR_OK) || (f_mount(&fs, "", 1) != FR_OK))
+    {
+        printf("no volume\n");
+        return 1;
+    }
+    *calls = 0;
+    dch_calls = dch_secs = 0;
+    memset(&dch_cache.stats, 0, sizeof(dch_cache.stats));
+
+    start = dch_now();
+    ops = 1;
+    fails += (f_mkdir("logs") != FR_OK);
+    for (i = 0; i < 200; i++)
+    {
+        sprintf(name, "logs/f%03d.txt", i);
+        if (f_open(&f, name, FA_CREATE_ALWAYS | FA_WRITE) != FR_OK)
+            return fails + 1;
+        for (j = 0; j < 30; j++, ops++)
+        {
+            for (k = 0; k < 100; k++)
+                buf[k] = (char)(i + j + k);
+            fails += (f_write(&f, buf, 100, &bw) != FR_OK) || (bw != 100);
+        }
+        fails += (f_close(&f) != FR_OK);
+        ops++;
+    }
+    dch_report("create 200 files", ops, start, calls);
+
+    start = dch_now();
+    ops = 0;
+    for (k = 0; k < 10; k++)
+    {
+        fails += (f_opendir(&d, "logs") != FR_OK);
+        while ((f_readdir(&d, &fi) == FR_OK) && fi.fname[0])
+            ops++;
+        f_closedir(&d);
+    }
+    fails += dch_check(ops == 10 * 200, "directory listing", 0);
+    dch_report("list the directory x10", ops, start, calls);
+
+    start = dch_now();
+    ops = 0;
+    for (i = 0; i < 200; i++)
+    {
+        sprintf(name, "logs/f%03d.txt", i);
+        if (f_open(&f, name, FA_READ) != FR_OK)
+            return fails + 1;
+        for (j = 0; j < 30; j++, ops++)
+        {
+            fails += (f_read(&f, buf, 100, &bw) != FR_OK) || (bw != 100);
+            for (k = 0; k < 100; k++)
+                fails += dch_check(buf[k] == (char)(i + j + k), "file data differs", 0);
+        }
+        f_close(&f);
+    }
+    dch_report("read 200 files", ops, start, calls);
+
+    start = dch_now();
+    ops = 0;
+    fails += (f_open(&f, "log.bin", FA_CREATE_ALWAYS | FA_WRITE) != FR_OK);
+    for (i = 0; i < 5000; i++, ops++)
+    {
+        fails += (f_write(&f, buf, 64, &bw) != FR_OK);
+        if (i % 100 == 99)
+        {
+            fails += (f_sync(&f) != FR_OK);
+            ops++;
+        }
+    }
+    fails += (f_close(&f) != FR_OK);
+    dch_report("append a log, sync/100", ops, start, calls);
+
+    start = dch_now();
+    ops = 0;
+    fails += (f_open(&f, "big.bin", FA_CREATE_ALWAYS | FA_WRITE) != FR_OK);
+    for (i = 0; i < 256; i++, ops++)
+        fails += (f_write(&f, big, sizeof(big), &bw) != FR_OK);
+    fails += (f_close(&f) != FR_OK);
+    dch_report("write 4 MB by 16 KB", ops, start, calls);
+
+    start = dch_now();
+    ops = 0;
+    fails += (f_open(&f, "big.bin", FA_READ) != FR_OK);
+    for (i = 0; i < 4 * 1024 * 1024 / 200; i++, ops++)
+        fails += (f_read(&f, buf, 200, &bw) != FR_OK);
+    f_close(&f);
+    dch_report("read 4 MB by 200 B", ops, start, calls);
+
+    f_unmount("");
+    return fails;
+}
+
+int main(void)
+{
+    uint32_t i, calls[2];
+    int fails = 0;
+
+    srand(6);
+
+    for (i = 0; i < sizeof(dch_disk); i++)
+        dch_disk[i] = (uint8_t)rand();
+    memcpy(dch_ref, dch_disk, sizeof(dch_disk));
+    diskcache_init(&dch_cache, &dch_dev);
+    fails += dch_model(DCH_LOOPS, 0);
+    printf("%d requests against a copy of the disk\n", DCH_LOOPS);
+    fails += dch_model(DCH_FAIL_LOOPS, 1);
+    printf("%d requests with failing device calls\n", DCH_FAIL_LOOPS);
+    fails += dch_check(dch_beyond == 0, "device call beyond the disk", 0);
+    memset(dch_unknown, 0, sizeof(dch_unknown));
+
+    printf("FatFs on the disk\n");
+    dch_use_cache = 0;
+    fails += dch_fatfs(&calls[0]);
+    memcpy(dch_ref, dch_disk, sizeof(dch_disk));
+
+    printf("FatFs through %d lines of %d sectors\n", DISKCACHE_LINES, DISKCACHE_LINE_SECS);
+    dch_use_cache = 1;
+    fails += dch_fatfs(&calls[1]);
+    fails += dch_check(memcmp(dch_disk, dch_ref, sizeof(dch_disk)) == 0, "disk image differs", 0);
+    printf("device calls: %u on the disk, %u through the cache\n", calls[0], calls[1]);
+    fails += dch_check(calls[1] < calls[0], "no device call saved", 0);
+    fails += dch_check(dch_beyond == 0, "device call beyond the disk", 0);
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
@@ -20,6 +20,10 @@
 #define PCM_BUFFER_SIZE        2304
 #define FILE_IO_BUFFER_SIZE    4096
 
+/* Read-ahead ring of the MP3 file, at least 3 buffers of a multiple of 512 bytes */
+#define MP3_STREAM_BUFS        4
+#define MP3_STREAM_BUF_SIZE    16384
+
 struct mp3Header
 {
     unsigned int sync : 11;
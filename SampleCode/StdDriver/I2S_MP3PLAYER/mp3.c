@@ -27,6 +27,7 @@
 #include "config.h"
 #include "diskio.h"
 #include "ff.h"
+#include "ffstream.h"
 #include "mad.h"
 
 #define NAU8822     1
@@ -48,14 +49,18 @@ struct mad_synth    Synth;
 
 FIL             mp3FileObject;
 FILINFO         Finfo;
-size_t          ReadSize;
 size_t          Remaining;
 size_t          ReturnSize;
 
 // I2S PCM buffer x2
 signed int aPCMBuffer[2][PCM_BUFFER_SIZE];
-// File IO buffer for MP3 library
+// File IO buffer for MP3 header parsing
 unsigned char MadInputBuffer[FILE_IO_BUFFER_SIZE + MAD_BUFFER_GUARD];
+// Read-ahead ring of the MP3 file, libmad decodes in place. The frame left over
+// at the end of the ring is moved into the FILE_IO_BUFFER_SIZE bytes before it,
+// the MAD_BUFFER_GUARD bytes after it are for the end of the file.
+uint8_t Mp3StreamMem[FILE_IO_BUFFER_SIZE + MP3_STREAM_BUFS * MP3_STREAM_BUF_SIZE + 64] __attribute__((aligned(FSTREAM_ALIGN)));
+ffstream_t Mp3Stream;
 // buffer full flag x2
 volatile uint8_t aPCMBuffer_Full[2] = {0, 0};
 // audio information structure
@@ -139,8 +144,9 @@ void StopPlay(void)
 void MP3Player(uint8_t *pFileName)
 {
     FRESULT res;
-    uint8_t *ReadStart;
-    uint8_t *GuardPtr;
+    uint8_t *ReadStart = NULL;
+    uint8_t *StreamBuf;
+    uint32_t u32StreamHeld = 0, u32Keep;
     volatile uint8_t u8PCMBufferTargetIdx = 0;
     volatile uint32_t pcmbuf_idx, i;
     volatile unsigned int Mp3FileOffset = 0;
@@ -170,6 +176,16 @@ void MP3Player(uint8_t *pFileName)
         return;
     }
 
+    /* Read the file ahead into the ring, the reads are done while waiting for the I2S */
+    res = ffstream_open(&Mp3Stream, &mp3FileObject, NULL, Mp3StreamMem + FILE_IO_BUFFER_SIZE,
+                        MP3_STREAM_BUF_SIZE, MP3_STREAM_BUFS);
+    if(res != FR_OK)
+    {
+        f_close(&mp3FileObject);
+        return;
+    }
+    while(ffstream_pump(&Mp3Stream) > 0);
+
 #if (!NAU8822)
     /* Reset NAU88L25 codec */
     NAU88L25_Reset();
@@ -216,36 +232,45 @@ void MP3Player(uint8_t *pFileName)
             {
                 /* Get the remaining frame */
                 Remaining = Stream.bufend - Stream.next_frame;
-                memmove(nc_ptr(MadInputBuffer), Stream.next_frame, Remaining);
-                ReadStart = nc_ptr(MadInputBuffer) + Remaining;
-                ReadSize = FILE_IO_BUFFER_SIZE - Remaining;
+                ReadStart = (uint8_t *)Stream.next_frame;
+                if(Remaining > FILE_IO_BUFFER_SIZE)
+                {
+                    ReadStart += Remaining - FILE_IO_BUFFER_SIZE;
+                    Remaining = FILE_IO_BUFFER_SIZE;
+                }
             }
             else
             {
-                ReadSize = FILE_IO_BUFFER_SIZE,
-                ReadStart = nc_ptr(MadInputBuffer),
                 Remaining = 0;
             }
 
-            /* read the file */
-            res = f_read(&mp3FileObject, nc_ptr(ReadStart), (UINT)ReadSize, (UINT*)&ReturnSize);
+            /* take the next buffer of the file, in place in the ring */
+            res = ffstream_next(&Mp3Stream, &StreamBuf, (UINT*)&ReturnSize);
             if(res != FR_OK)
             {
                 sysprintf("Stop !(%x)\n\r", res);
                 goto stop;
             }
 
-            if(f_eof(&mp3FileObject))
+            if(ReturnSize == 0)
+                goto stop;
+
+            /* the buffer holding the remaining frame stays, unless the ring wrapped */
+            u32Keep = (Remaining != 0) ? 1 : 0;
+            if((Remaining != 0) && (ReadStart + Remaining != StreamBuf))
             {
-                if(ReturnSize == 0)
-                    goto stop;
+                memcpy(StreamBuf - Remaining, ReadStart, Remaining);
+                u32Keep = 0;
             }
+            ReadStart = StreamBuf - Remaining;
+            for(; u32StreamHeld > u32Keep; u32StreamHeld--)
+                ffstream_release(&Mp3Stream);
+            u32StreamHeld++;
 
             /* if the file is over */
-            if(ReadSize > ReturnSize)
+            if(ffstream_eof(&Mp3Stream))
             {
-                GuardPtr = nc_ptr(ReadStart) + ReturnSize;
-                memset(GuardPtr, 0, MAD_BUFFER_GUARD);
+                memset(StreamBuf + ReturnSize, 0, MAD_BUFFER_GUARD);
                 ReturnSize += MAD_BUFFER_GUARD;
             }
 
@@ -253,7 +278,7 @@ void MP3Player(uint8_t *pFileName)
             /* Pipe the new buffer content to libmad's stream decoder
                      * facility.
             */
-            mad_stream_buffer(&Stream, nc_ptr(MadInputBuffer), ReturnSize + Remaining);
+            mad_stream_buffer(&Stream, ReadStart, ReturnSize + Remaining);
             Stream.error = (enum  mad_error)0;
         }
 
@@ -299,7 +324,8 @@ void MP3Player(uint8_t *pFileName)
         {
             //if next buffer is still full (playing), wait until it's empty
             if(aPCMBuffer_Full[u8PCMBufferTargetIdx] == 1)
-                while(aPCMBuffer_Full[u8PCMBufferTargetIdx]);
+                while(aPCMBuffer_Full[u8PCMBufferTargetIdx])
+                    ffstream_pump(&Mp3Stream);
         }
         else
         {
@@ -331,7 +357,8 @@ void MP3Player(uint8_t *pFileName)
                 //sysprintf("change to ==>%d ..\n", u8PCMBufferTargetIdx);
                 /* if next buffer is still full (playing), wait until it's empty */
                 if((aPCMBuffer_Full[u8PCMBufferTargetIdx] == 1) && (audioInfo.mp3Playing))
-                    while(aPCMBuffer_Full[u8PCMBufferTargetIdx]);
+                    while(aPCMBuffer_Full[u8PCMBufferTargetIdx])
+                        ffstream_pump(&Mp3Stream);
             }
         }
     }
@@ -344,6 +371,7 @@ stop:
     mad_frame_finish(&Frame);
     mad_stream_finish(&Stream);
 
+    ffstream_close(&Mp3Stream);
     f_close(&mp3FileObject);
     StopPlay();
 }
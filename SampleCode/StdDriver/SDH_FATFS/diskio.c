@@ -14,9 +14,8 @@
 #include "diskio.h"     /* FatFs lower layer API */
 #include "ff.h"
 
-#define Sector_Size 128 //512byte
-uint32_t Tmp_Buffer[Sector_Size];
-
+#include "diskcache.h"
+#include "dmabounce.h"
 
 #define SDH0_DRIVE      0        /* for SD0          */
 #define SDH1_DRIVE      1        /* for SD1          */
@@ -30,6 +29,112 @@ uint32_t Tmp_Buffer[Sector_Size];
 
 /* Definitions of physical drive number for each media */
 
+static int sd_dev_read(void *ctx, uint8_t *buff, uint32_t sector, uint32_t count);
+static int sd_dev_write(void *ctx, const uint8_t *buff, uint32_t sector, uint32_t count);
+
+/* Small reads and writes of FatFs (FAT, directory, partial clusters) go
+   through a write-back cache, flushed on CTRL_SYNC */
+static diskcache_dev_t sd_dev[2] =
+{
+    { sd_dev_read, sd_dev_write, NULL, 0 },
+    { sd_dev_read, sd_dev_write, NULL, 0 },
+};
+static diskcache_t sd_cache[2];
+
+/* One sector per drive, for when every bounce buffer is taken */
+static uint8_t sd_sector[2][DMABOUNCE_SS] __attribute__((aligned(DMABOUNCE_ALIGN)));
+
+/*
+ * SDH_Read() or SDH_Write() on SDH0 or SDH1, for a buffer at any alignment.
+ * A buffer on a cache line goes straight to the DMA. Of a 4-byte aligned one
+ * only the first and the last sector, which share a cache line with what
+ * surrounds the buffer, go through a bounce buffer, all in one command.
+ * Other buffers are bounced whole, DMABOUNCE_SECS sectors per command.
+ */
+static int sd_dev_rw(SDH_T *sdh, uint8_t *buff, uint32_t sector, uint32_t count, int write)
+{
+    SDH_SEG_T seg[3];
+    uint8_t  *bounce, *tmp;
+    uint32_t n;
+    int      ret = 0;
+
+    if (DMABOUNCE_IS_ALIGNED(buff))
+        return write ? (int)SDH_Write(sdh, buff, sector, count) : SDH_Read(sdh, buff, sector, count);
+
+    bounce = dmabounce_get();
+    if (bounce == NULL)
+    {
+        tmp = sd_sector[(sdh == SDH0) ? 0 : 1];
+        for (; (count > 0) && (ret == 0); count--, sector++, buff += DMABOUNCE_SS)
+        {
+            if (write)
+            {
+                memcpy(tmp, buff, DMABOUNCE_SS);
+                ret = (int)SDH_Write(sdh, tmp, sector, 1);
+            }
+            else
+            {
+                ret = SDH_Read(sdh, tmp, sector, 1);
+                memcpy(buff, tmp, DMABOUNCE_SS);
+            }
+        }
+        return ret;
+    }
+
+    if (((ptr_to_u32(buff) & 0x3) == 0) && (count >= 3))
+    {
+        seg[0].pu8BufAddr = bounce;
+        seg[0].u32SecCount = 1;
+        seg[1].pu8BufAddr = buff + DMABOUNCE_SS;
+        seg[1].u32SecCount = count - 2;
+        seg[2].pu8BufAddr = bounce + DMABOUNCE_SS;
+        seg[2].u32SecCount = 1;
+
+        if (write)
+        {
+            memcpy(bounce, buff, DMABOUNCE_SS);
+            memcpy(bounce + DMABOUNCE_SS, buff + (count - 1) * DMABOUNCE_SS, DMABOUNCE_SS);
+            ret = (int)SDH_WriteSG(sdh, seg, 3, sector);
+        }
+        else
+        {
+            ret = SDH_ReadSG(sdh, seg, 3, sector);
+            memcpy(buff, bounce, DMABOUNCE_SS);
+            memcpy(buff + (count - 1) * DMABOUNCE_SS, bounce + DMABOUNCE_SS, DMABOUNCE_SS);
+        }
+    }
+    else
+    {
+        for (; (count > 0) && (ret == 0); count -= n, sector += n, buff += n * DMABOUNCE_SS)
+        {
+            n = (count < DMABOUNCE_SECS) ? count : DMABOUNCE_SECS;
+            if (write)
+            {
+                memcpy(bounce, buff, n * DMABOUNCE_SS);
+                ret = (int)SDH_Write(sdh, bounce, sector, n);
+            }
+            else
+            {
+                ret = SDH_Read(sdh, bounce, sector, n);
+                memcpy(buff, bounce, n * DMABOUNCE_SS);
+            }
+        }
+    }
+
+    dmabounce_put(bounce);
+    return ret;
+}
+
+static int sd_dev_read(void *ctx, uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    return sd_dev_rw((SDH_T *)ctx, buff, sector, count, 0);
+}
+
+static int sd_dev_write(void *ctx, const uint8_t *buff, uint32_t sector, uint32_t count)
+{
+    return sd_dev_rw((SDH_T *)ctx, (uint8_t *)buff, sector, count, 1);
+}
+
 /*-----------------------------------------------------------------------*/
 /* Initialize a Drive                                                    */
 /*-----------------------------------------------------------------------*/
@@ -41,12 +146,21 @@ DSTATUS disk_initialize (BYTE pdrv)       /* Physical drive number (0..) */
     {
         if (SDH_GET_CARD_CAPACITY(SDH0) == 0)
             return STA_NOINIT;
+        sd_dev[0].ctx = SDH0;
+        sd_dev[0].sectors = SD0.totalSectorN;
     }
     else if (pdrv == 1)
     {
         if (SDH_GET_CARD_CAPACITY(SDH1) == 0)
             return STA_NOINIT;
+        sd_dev[1].ctx = SDH1;
+        sd_dev[1].sectors = SD1.totalSectorN;
     }
+    else
+        return STA_NOINIT;
+
+    /* The card may have changed since the last mount */
+    diskcache_init(&sd_cache[pdrv], &sd_dev[pdrv]);
 
     return RES_OK;
 }
@@ -84,60 +198,12 @@ DRESULT disk_read (
     UINT count      /* Number of sectors to read (1..128) */
 )
 {
-    DRESULT   ret;
-    uint32_t shift_buf_flag = 0;
-    uint64_t tmp_StartBufAddr;
-
     //printf("disk_read - drv:%d, sec:%d, cnt:%d, buff:0x%x\n", pdrv, sector, count, (uint32_t)buff);
 
-    if (ptr_to_u32(buff)%4)
-    {
-        shift_buf_flag = 1;
-    }
+    if (pdrv > 1)
+        return RES_PARERR;
 
-    if (pdrv == 0)
-    {
-        if(shift_buf_flag == 1)
-        {
-            if(count == 1)
-            {
-                ret = (DRESULT) SDH_Read(SDH0, (uint8_t*)(&Tmp_Buffer), sector, count);
-                memcpy(buff, (&Tmp_Buffer), count*SD0.sectorSize);
-            }
-            else
-            {
-                tmp_StartBufAddr = ((ptr_to_u32(buff)/4 + 1) * 4);
-                ret = (DRESULT) SDH_Read(SDH0, ((uint8_t*)(tmp_StartBufAddr)), sector, (count -1));
-                memcpy(buff, (void*)(tmp_StartBufAddr), (SD0.sectorSize*(count-1)) );
-                ret = (DRESULT) SDH_Read(SDH0, (uint8_t*)(&Tmp_Buffer), (sector+count-1), 1);
-                memcpy( (buff+(SD0.sectorSize*(count-1))), (void*)Tmp_Buffer, SD0.sectorSize);
-            }
-        }
-        else
-            ret = (DRESULT) SDH_Read(SDH0, buff, sector, count);
-    }
-    else if (pdrv == 1)
-    {
-        if(shift_buf_flag == 1)
-        {
-            if(count == 1)
-            {
-                ret = (DRESULT) SDH_Read(SDH1, (uint8_t*)(&Tmp_Buffer), sector, count);
-                memcpy(buff, (&Tmp_Buffer), count*SD1.sectorSize);
-            }
-            else
-            {
-                tmp_StartBufAddr = ((ptr_to_u32(buff)/4 + 1) * 4);
-                ret = (DRESULT) SDH_Read(SDH1, ((uint8_t*)tmp_StartBufAddr), sector, (count -1));
-                memcpy(buff, (void*)tmp_StartBufAddr, (SD1.sectorSize*(count-1)) );
-                ret = (DRESULT) SDH_Read(SDH1, (uint8_t*)(&Tmp_Buffer), (sector+count-1), 1);
-                memcpy( (buff+(SD1.sectorSize*(count-1))), (void*)Tmp_Buffer, SD1.sectorSize);
-            }
-        }
-        else
-            ret = (DRESULT) SDH_Read(SDH1, buff, sector, count);
-    }
-    return ret;
+    return diskcache_read(&sd_cache[pdrv], buff, sector, count) ? RES_ERROR : RES_OK;
 }
 
 
@@ -153,70 +219,12 @@ DRESULT disk_write (
     UINT count          /* Number of sectors to write (1..128) */
 )
 {
-    DRESULT  ret;
-    uint32_t shift_buf_flag = 0;
-    uint64_t tmp_StartBufAddr;
-    uint32_t volatile i;
-
     //printf("disk_write - drv:%d, sec:%d, cnt:%d, buff:0x%x\n", pdrv, sector, count, (uint32_t)buff);
-    if (ptr_to_u32(buff)%4)
-    {
-        shift_buf_flag = 1;
-    }
 
-    if (pdrv == 0)
-    {
-        if(shift_buf_flag == 1)
-        {
-            if(count == 1)
-            {
-                memcpy((&Tmp_Buffer), buff, count*SD0.sectorSize);
-                ret = (DRESULT) SDH_Write(SDH0, (uint8_t*)(&Tmp_Buffer), sector, count);
-            }
-            else
-            {
-                tmp_StartBufAddr = ((ptr_to_u32(buff)/4 + 1) * 4);
-                memcpy((void*)Tmp_Buffer, (buff+(SD0.sectorSize*(count-1))), SD0.sectorSize);
-
-                for(i = (SD0.sectorSize*(count-1)); i > 0; i--)
-                {
-                    memcpy((void *)(tmp_StartBufAddr + i - 1), (buff + i -1), 1);
-                }
-
-                ret = (DRESULT) SDH_Write(SDH0, ((uint8_t*)tmp_StartBufAddr), sector, (count -1));
-                ret = (DRESULT) SDH_Write(SDH0, (uint8_t*)(&Tmp_Buffer), (sector+count-1), 1);
-            }
-        }
-        else
-            ret = (DRESULT) SDH_Write(SDH0, (uint8_t *)buff, sector, count);
-    }
-    else if (pdrv == 1)
-    {
-        if(shift_buf_flag == 1)
-        {
-            if(count == 1)
-            {
-                memcpy((&Tmp_Buffer), buff, count*SD1.sectorSize);
-                ret = (DRESULT) SDH_Write(SDH1, (uint8_t*)(&Tmp_Buffer), sector, count);
-            }
-            else
-            {
-                tmp_StartBufAddr = ((ptr_to_u32(buff)/4 + 1) * 4);
-                memcpy((void*)Tmp_Buffer, (buff+(SD1.sectorSize*(count-1))), SD1.sectorSize);
+    if (pdrv > 1)
+        return RES_PARERR;
 
-                for(i = (SD1.sectorSize*(count-1)); i > 0; i--)
-                {
-                    memcpy((void *)(tmp_StartBufAddr + i - 1), (buff + i -1), 1);
-                }
-
-                ret = (DRESULT) SDH_Write(SDH1, ((uint8_t*)tmp_StartBufAddr), sector, (count -1));
-                ret = (DRESULT) SDH_Write(SDH1, (uint8_t*)(&Tmp_Buffer), (sector+count-1), 1);
-            }
-        }
-        else
-            ret = (DRESULT) SDH_Write(SDH1, (uint8_t *)buff, sector, count);
-    }
-    return ret;
+    return diskcache_write(&sd_cache[pdrv], buff, sector, count) ? RES_ERROR : RES_OK;
 }
 
 
@@ -236,6 +244,9 @@ DRESULT disk_ioctl (
     switch(cmd)
     {
     case CTRL_SYNC:
+        /* Write back what the cache holds */
+        if ((pdrv > 1) || diskcache_flush(&sd_cache[pdrv]))
+            res = RES_ERROR;
         break;
     case GET_SECTOR_COUNT:
         *(DWORD*)buff = SD0.totalSectorN;
@@ -0,0 +1,173 @@
+/**************************************************************************//**
+ * @file     NuMicro.h
+ * @brief    Stand-in for the BSP header on a Linux host, for the host check
+ *           of the SDH request queue (see Makefile.host).
+ *
+ * The SDH driver header of the BSP is used as it is. Registers are plain
+ * memory, but for the write-1-to-clear interrupt status (see SDH_HOST_W1C),
+ * and addresses are not remapped, NON_CACHE is 0. The IRQ mask is a
+ * variable the check can look at, and the millisecond tick is read through
+ * sdh_host_tick(), which lets the time pass and ends a controller reset so
+ * that the waits of the driver come back. The system and GPIO controllers
+ * are declared for sdh.c to compile, the code paths the check runs do not
+ * touch them.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUMICRO_H__
+#define __NUMICRO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/types.h>
+
+#define sysprintf       printf
+
+#define __I             volatile const
+#define __O             volatile
+#define __IO            volatile
+#define __STATIC_INLINE static inline
+
+typedef enum
+{
+    SDH0_IRQn = 62,
+    SDH1_IRQn = 63,
+} IRQn_Type;
+
+#include "types.h"
+#include "irq_ctrl.h"
+
+#define NON_CACHE       0
+
+#define ptr_to_u32(x)   ((uint32_t)(uintptr_t)(x))
+#define nc_ptr(x)       ((void *)(uintptr_t)ptr_to_u32(x))
+#define addr_s(x)       ((uint64_t)ptr_to_u32(x))
+
+static inline uint8_t read8(const void *addr)
+{
+    return *(volatile const uint8_t *)addr;
+}
+
+static inline uint32_t read32(const void *addr)
+{
+    return *(volatile const uint32_t *)addr;
+}
+
+static inline void write8(void *addr, uint8_t value)
+{
+    *(volatile uint8_t *)addr = value;
+}
+
+static inline void write32(void *addr, uint32_t value)
+{
+    *(volatile uint32_t *)addr = value;
+}
+
+#define inpb(x)             read8((const void *)(uintptr_t)(x))
+#define inpw(x)             read32((const void *)(uintptr_t)(x))
+#define outpb(addr, val)    write8((void *)(uintptr_t)(addr), val)
+#define outpw(addr, val)    write32((void *)(uintptr_t)(addr), val)
+#define outp32(addr, val)   write32((void *)(uintptr_t)(addr), val)
+
+#define __DSB()         __sync_synchronize()
+
+/* DAIF with only the I bit, set while the IRQs are masked */
+#define HOST_DAIF_I     0x80u
+
+extern uint64_t host_daif;
+
+static inline uint64_t raw_read_daif(void)
+{
+    return host_daif;
+}
+
+static inline void raw_write_daif(uint64_t daif)
+{
+    host_daif = daif;
+}
+
+static inline void disable_irq(void)
+{
+    host_daif |= HOST_DAIF_I;
+}
+
+/* Caches are coherent on the host */
+static inline void dcache_clean_by_mva(void const *addr, size_t len)
+{
+    (void)addr;
+    (void)len;
+}
+
+static inline void dcache_invalidate_by_mva(void const *addr, size_t len)
+{
+    (void)addr;
+    (void)len;
+}
+
+static inline void dcache_clean_invalidate_by_mva(void const *addr, size_t len)
+{
+    (void)addr;
+    (void)len;
+}
+
+#define BIT0     (0x00000001UL)
+#define BIT1     (0x00000002UL)
+#define BIT2     (0x00000004UL)
+#define BIT3     (0x00000008UL)
+#define BIT4     (0x00000010UL)
+#define BIT5     (0x00000020UL)
+#define BIT6     (0x00000040UL)
+#define BIT7     (0x00000080UL)
+#define BIT8     (0x00000100UL)
+#define BIT9     (0x00000200UL)
+#define BIT10    (0x00000400UL)
+#define BIT11    (0x00000800UL)
+#define BIT12    (0x00001000UL)
+#define BIT13    (0x00002000UL)
+#define BIT14    (0x00004000UL)
+#define BIT15    (0x00008000UL)
+#define BIT16    (0x00010000UL)
+#define BIT17    (0x00020000UL)
+#define BIT18    (0x00040000UL)
+#define BIT19    (0x00080000UL)
+#define BIT20    (0x00100000UL)
+#define BIT21    (0x00200000UL)
+#define BIT22    (0x00400000UL)
+#define BIT23    (0x00800000UL)
+#define BIT24    (0x01000000UL)
+#define BIT25    (0x02000000UL)
+#define BIT26    (0x04000000UL)
+#define BIT27    (0x08000000UL)
+#define BIT28    (0x10000000UL)
+#define BIT29    (0x20000000UL)
+#define BIT30    (0x40000000UL)
+#define BIT31    (0x80000000UL)
+
+#include "gpio_reg.h"
+#include "sdh_reg.h"
+#include "sys_reg.h"
+
+extern SYS_T host_sys;
+extern SDH_T host_sdh0, host_sdh1;
+#define SYS             (&host_sys)
+#define SDH0            (&host_sdh0)
+#define SDH1            (&host_sdh1)
+#define PN              ((GPIO_T *)0)
+#define GPIOJ_BASE      0x40040240UL
+#define GPIO_PIN_DATA_BASE  0x40040800UL
+#define SDH0_BASE       0x40180000UL
+#define SDH1_BASE       0x40190000UL
+
+/* Makefile.host turns the writes of sdh.c to the interrupt status into this */
+#define SDH_HOST_W1C(reg, val)  ((reg) &= (uint16_t)~(val))
+
+/* sdh.c declares msTicks0 itself, the name is taken over by the hook */
+uint32_t volatile *sdh_host_tick(void);
+#define msTicks0        (*sdh_host_tick())
+
+#include "gpio.h"
+#include "sdh.h"
+#include "sys.h"
+
+#endif /* __NUMICRO_H__ */
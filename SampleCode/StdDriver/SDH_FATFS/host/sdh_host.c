@@ -0,0 +1,424 @@
+/**************************************************************************//**
+ * @file     sdh_host.c
+ * @brief    Checks the request queue of SDH_Submit() in sdh.c on a Linux
+ *           host, against a model of the two controllers and their cards.
+ *           Build with Makefile.host.
+ *
+ * Rounds of scattered reads and writes are submitted to SDH0 (SDHC, sector
+ * addresses) and SDH1 (SD, byte addresses) in between the commands the
+ * controllers finish. The model checks each command the driver puts on the
+ * bus, moves the data along the ADMA2 descriptor table and raises transfer
+ * complete, a data timeout or a data CRC error, or an interrupt that is not
+ * for the queue. A failed multi-block command must be stopped with CMD12
+ * before the card takes another one, the stop itself may time out. Card
+ * detection pends alongside, and must be left to the application in the
+ * write-1-to-clear status. The table is cut down to a few descriptors and
+ * the buffers lie across a 128 MB boundary, so that requests take several
+ * commands and some tables end inside a sector. Every request must end
+ * once, in the order of its controller and with its status, and the reads
+ * and the cards must hold what the same requests give run one after the
+ * other on plain arrays.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "NuMicro.h"
+
+#define SDHH_ROUNDS     3000
+#define SDHH_REQS       6
+#define SDHH_SEGS       12
+#define SDHH_CARD_SECS  4096
+#define SDHH_REQ_SECS   600
+
+/* The buffers, mapped low with a 128 MB boundary in the middle */
+#define SDHH_BUF_ADDR   0x07c00000ul
+#define SDHH_BUF_SIZE   0x00800000ul
+
+/* Descriptor as sdh.c writes it */
+typedef struct
+{
+    uint16_t attr;
+    uint16_t len;
+    uint32_t addr;
+}
+sdhh_desc_t;
+
+typedef struct
+{
+    SDH_REQ_T req;
+    SDH_SEG_T seg[SDHH_SEGS];
+    int ctrl;
+    uint32_t secs;
+    int fail;           /* error to raise on its first command, 0 for none */
+    int done;
+}
+sdhh_req_t;
+
+/* A controller with its card, and the requests it has not ended yet */
+typedef struct
+{
+    SDH_T *sdh;
+    const char *name;
+    int byte_addr;
+    uint8_t *card;
+    uint8_t *ref;
+    sdhh_req_t *pend[SDHH_REQS];
+    int npend;
+    int started;        /* the first pending request had a command */
+    uint32_t pos;       /* sector its next command starts at */
+    int stop_due;       /* a failed multi-block command left the card in a transfer */
+    uint8_t resets;
+    unsigned long requests, commands, sectors, errors, stops;
+}
+sdhh_ctrl_t;
+
+SYS_T host_sys;
+SDH_T host_sdh0, host_sdh1;
+uint64_t host_daif;
+
+static uint32_t volatile sdhh_ticks;
+static uint8_t sdhh_card[2][SDHH_CARD_SECS * 512];
+static uint8_t sdhh_ref[2][SDHH_CARD_SECS * 512];
+static uint8_t *sdhh_buf;
+static sdhh_ctrl_t sdhh_ctrl[2];
+static int sdhh_reported;
+
+/* The tick of SDH_DelayMicrosecond(), a reset is over by the next one */
+uint32_t volatile *sdh_host_tick(void)
+{
+    sdhh_ctrl[0].resets |= host_sdh0.SW_RST_R;
+    sdhh_ctrl[1].resets |= host_sdh1.SW_RST_R;
+    host_sdh0.SW_RST_R = 0;
+    host_sdh1.SW_RST_R = 0;
+    sdhh_ticks++;
+    return &sdhh_ticks;
+}
+
+/* 1 and a report if ok is not set */
+static int sdhh_check(int ok, const sdhh_ctrl_t *c, const char *what)
+{
+    if (ok)
+        return 0;
+    if (sdhh_reported++ < 10)
+        printf("%s: %s\n", c->name, what);
+    return 1;
+}
+
+/* A command is on the bus while the driver waits for transfer complete */
+static int sdhh_busy(const sdhh_ctrl_t *c)
+{
+    return (c->sdh->NORMAL_INT_SIGNAL_EN_R & 0x2) != 0;
+}
+
+static void sdhh_done(SDH_REQ_T *pReq)
+{
+    sdhh_req_t *r = pReq->pvParam;
+    sdhh_ctrl_t *c = &sdhh_ctrl[r->ctrl];
+
+    r->done++;
+    sdhh_check(!c->stop_due, c, "request ended before its stop");
+    if (sdhh_check((c->npend > 0) && (c->pend[0] == r), c, "request ended out of order"))
+        return;
+    memmove(c->pend, c->pend + 1, --c->npend * sizeof(c->pend[0]));
+    c->started = 0;
+}
+
+/* The CMD12 that ends a failed multi-block command, see sdhh_command() */
+static uint32_t sdhh_stop(sdhh_ctrl_t *c, uint32_t *err)
+{
+    int bad = 0;
+
+    bad |= sdhh_check(c->stop_due, c, "CMD12 without a failed multi-block command");
+    bad |= sdhh_check((c->sdh->CMD_R & 0xff) == (SDH_CMD_RESP_SHORT_BUSY | SDH_CMD_CRC | SDH_CMD_INDEX),
+                      c, "CMD12 flags");
+    if (bad)
+        return 0;
+
+    c->stop_due = 0;
+    c->stops++;
+    if (rand() % 4 == 0)
+    {
+        /* no response, the request keeps the error of its command */
+        c->errors++;
+        *err = 0x1;
+        c->resets = 0;
+        return 0x8000;
+    }
+    *err = 0;
+    return 0x2 | 0x1;
+}
+
+/*
+ * Checks the command on the bus of c, and moves its data or sets the error
+ * of its request. Returns the interrupt status to raise, 0 if the command is
+ * wrong.
+ */
+static uint32_t sdhh_command(sdhh_ctrl_t *c, uint32_t *err)
+{
+    SDH_T *sdh = c->sdh;
+    sdhh_req_t *r = c->pend[0];
+    const sdhh_desc_t *d = (const sdhh_desc_t *)(uintptr_t)sdh->ADMA_SA_LOW_R;
+    uint32_t cnt = sdh->BLOCKCOUNT_R, cmd = sdh->CMD_R >> 8, mode = sdh->XFER_MODE_R;
+    uint32_t sec = sdh->ARGUMENT_R, pos, len, addr;
+    int write = r->req.i32Write, bad = 0, k;
+
+    if (cmd == MMC_CMD_STOP_TRANSMISSION)
+        return sdhh_stop(c, err);
+    if (sdhh_check(!c->stop_due, c, "command while the card is still in the failed transfer"))
+        return 0;
+
+    if (c->byte_addr)
+    {
+        bad |= sdhh_check((sec % 512) == 0, c, "byte address not on a sector");
+        sec /= 512;
+    }
+    if (!c->started)
+    {
+        c->started = 1;
+        c->pos = r->req.u32StartSec;
+    }
+
+    bad |= sdhh_check(sec == c->pos, c, "command does not go on from the last one");
+    bad |= sdhh_check((cnt > 0) && (sec + cnt <= SDHH_CARD_SECS), c, "command beyond the card");
+    bad |= sdhh_check(sdh->BLOCKSIZE_R == 512, c, "block size");
+    bad |= sdhh_check((mode & 0x3) == 0x3, c, "no DMA or block count");
+    bad |= sdhh_check(((mode & 0x10) == 0) == write, c, "direction");
+    bad |= sdhh_check(((mode & 0x24) == 0x24) == (cnt > 1), c, "multi-block or Auto CMD12");
+    bad |= sdhh_check(cmd == (write ? (cnt > 1 ? 25u : 24u) : (cnt > 1 ? 18u : 17u)), c, "command index");
+    bad |= sdhh_check((sdh->HOST_CTRL1_R & 0x18) == 0x10, c, "not ADMA2");
+    bad |= sdhh_check((sdh->ADMA_SA_HIGH_R == 0) && (d != NULL), c, "descriptor table address");
+    if (bad)
+        return 0;
+
+    c->commands++;
+    if (r->fail)
+    {
+        /* nothing moves, the request ends with the error */
+        c->errors++;
+        *err = r->fail;
+        c->resets = 0;
+        c->stop_due = (cnt > 1);
+        return 0x8000;
+    }
+
+    pos = sec * 512;
+    for (k = 0; k < SDH_ADMA_DESC_NUM; k++)
+    {
+        len = d[k].len ? d[k].len : 0x10000;
+        addr = d[k].addr;
+        if (sdhh_check(((d[k].attr & 0x21) == 0x21) && ((addr & 3) == 0) &&
+                       (addr >= SDHH_BUF_ADDR) && (addr + len <= SDHH_BUF_ADDR + SDHH_BUF_SIZE) &&
+                       ((addr ^ (addr + len - 1)) < 0x8000000u) && (pos + len <= (sec + cnt) * 512),
+                       c, "descriptor"))
+            return 0;
+        if (write)
+            memcpy(c->card + pos, sdhh_buf + (addr - SDHH_BUF_ADDR), len);
+        else
+            memcpy(sdhh_buf + (addr - SDHH_BUF_ADDR), c->card + pos, len);
+        pos += len;
+        if (d[k].attr & 0x2)
+            break;
+    }
+    if (sdhh_check((k < SDH_ADMA_DESC_NUM) && (pos == (sec + cnt) * 512), c, "table does not match the block count"))
+        return 0;
+
+    c->pos += cnt;
+    c->sectors += cnt;
+    *err = 0;
+    return 0x2 | 0x1;
+}
+
+/* Raises the interrupt of the command on the bus of c, 1 if it goes wrong */
+static int sdhh_step(sdhh_ctrl_t *c)
+{
+    SDH_T *sdh = c->sdh;
+    uint16_t cmd = sdh->CMD_R;
+    uint32_t arg = sdh->ARGUMENT_R, stat, err, detect;
+    int fails = 0;
+
+    fails += sdhh_check((host_daif & HOST_DAIF_I) == 0, c, "IRQs left masked");
+    fails += sdhh_check(c->npend > 0, c, "command without a request");
+    if (fails)
+        return fails;
+
+    /* card detection, alone with the command kept on the bus, or with its end */
+    detect = (rand() % 4 == 0) ? 0x40 : 0;
+    if (detect && (rand() & 1))
+    {
+        sdh->NORMAL_INT_STAT_R |= detect;
+        SDH_IntHandler(sdh);
+        fails += sdhh_check(sdhh_busy(c) && (sdh->CMD_R == cmd) && (sdh->ARGUMENT_R == arg),
+                            c, "interrupt not for the queue taken");
+        fails += sdhh_check(sdh->NORMAL_INT_STAT_R == detect, c, "card detection cleared");
+        sdh->NORMAL_INT_STAT_R &= ~detect;      /* as the application does */
+        detect = 0;
+    }
+
+    stat = sdhh_command(c, &err);
+    if (stat == 0)
+        return fails + 1;
+    sdh->NORMAL_INT_STAT_R |= stat | detect;
+    sdh->ERROR_INT_STAT_R |= err;
+    SDH_IntHandler(sdh);
+    if (err)
+        fails += sdhh_check(c->resets == (SDH_RESET_CMD | SDH_RESET_DATA), c, "no reset after the error");
+    fails += sdhh_check(sdh->NORMAL_INT_STAT_R == detect, c,
+                        detect ? "card detection cleared" : "transfer status left pending");
+    fails += sdhh_check(sdh->ERROR_INT_STAT_R == 0, c, "error status left pending");
+    sdh->NORMAL_INT_STAT_R &= ~detect;
+    return fails;
+}
+
+/* Random request on a random controller, its buffers from *hp on */
+static void sdhh_make(sdhh_req_t *r, uint32_t *hp)
+{
+    uint32_t i, n, j, secs = 0;
+    SDH_SEG_T *s;
+
+    memset(r, 0, sizeof(*r));
+    r->ctrl = rand() & 1;
+    n = 1 + rand() % SDHH_SEGS;
+    for (i = 0; i < n; i++)
+    {
+        s = &r->seg[i];
+        *hp += 4 * (rand() % 64);
+        s->pu8BufAddr = sdhh_buf + *hp;
+        if (rand() % 4 == 0)
+            s->u32SecCount = 0;
+        else if ((i == 0) && (rand() % 4 == 0))
+            s->u32SecCount = 129 + rand() % 100;    /* above the 64 KB of a descriptor */
+        else
+            s->u32SecCount = 1 + rand() % 30;
+        for (j = 0; j < s->u32SecCount * 512; j++)
+            s->pu8BufAddr[j] = (uint8_t)rand();
+        *hp += s->u32SecCount * 512;
+        secs += s->u32SecCount;
+    }
+
+    r->secs = secs;
+    r->req.pSeg = r->seg;
+    r->req.i32SegCount = (int)n;
+    r->req.u32StartSec = rand() % (SDHH_CARD_SECS - SDHH_REQ_SECS);
+    r->req.i32Write = rand() & 1;
+    r->req.pfnDone = sdhh_done;
+    r->req.pvParam = r;
+    if (rand() % 6 == 0)
+        r->fail = (rand() & 1) ? 0x10 : 0x20;   /* data timeout, data CRC */
+}
+
+/* The requests of a round one after the other on the reference cards */
+static int sdhh_settle(sdhh_req_t *r, int n)
+{
+    sdhh_ctrl_t *c;
+    uint32_t pos, len;
+    int i, j, exp, fails = 0;
+
+    for (i = 0; i < n; i++)
+    {
+        c = &sdhh_ctrl[r[i].ctrl];
+        exp = (r[i].fail && r[i].secs) ? ((r[i].fail == 0x10) ? -2 : -1) : 0;
+        fails += sdhh_check(r[i].done == 1, c, "request not ended once");
+        fails += sdhh_check(r[i].req.i32Status == exp, c, "status");
+        if (exp != 0)
+            continue;
+
+        pos = r[i].req.u32StartSec * 512;
+        for (j = 0; j < r[i].req.i32SegCount; j++)
+        {
+            len = r[i].seg[j].u32SecCount * 512;
+            if (r[i].req.i32Write)
+                memcpy(c->ref + pos, r[i].seg[j].pu8BufAddr, len);
+            else
+                fails += sdhh_check(memcmp(r[i].seg[j].pu8BufAddr, c->ref + pos, len) == 0, c, "read differs");
+            pos += len;
+        }
+        c->requests++;
+    }
+
+    for (i = 0; i < 2; i++)
+        fails += sdhh_check(memcmp(sdhh_ctrl[i].card, sdhh_ctrl[i].ref, SDHH_CARD_SECS * 512) == 0,
+                            &sdhh_ctrl[i], "card differs");
+    return fails;
+}
+
+int main(void)
+{
+    sdhh_req_t req[SDHH_REQS];
+    sdhh_ctrl_t *c;
+    uint32_t hp;
+    int round, i, n, sub, fails = 0;
+
+    srand(5);
+
+    sdhh_buf = mmap((void *)SDHH_BUF_ADDR, SDHH_BUF_SIZE, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (sdhh_buf != (uint8_t *)SDHH_BUF_ADDR)
+    {
+        printf("no buffers at 0x%lx\n", SDHH_BUF_ADDR);
+        return 1;
+    }
+
+    SD0.CardType = SDH_TYPE_SD_HIGH;
+    SD1.CardType = SDH_TYPE_SD_LOW;
+    for (i = 0; i < 2; i++)
+    {
+        c = &sdhh_ctrl[i];
+        c->sdh = i ? SDH1 : SDH0;
+        c->name = i ? "SDH1" : "SDH0";
+        c->byte_addr = i;
+        c->card = sdhh_card[i];
+        c->ref = sdhh_ref[i];
+        for (n = 0; n < SDHH_CARD_SECS * 512; n++)
+            c->card[n] = (uint8_t)rand();
+        memcpy(c->ref, c->card, SDHH_CARD_SECS * 512);
+    }
+
+    for (round = 0; (round < SDHH_ROUNDS) && (fails == 0); round++)
+    {
+        n = 1 + rand() % SDHH_REQS;
+        hp = (SDHH_BUF_SIZE / 4 + rand() % (SDHH_BUF_SIZE / 4)) & ~3u;
+        for (i = 0; i < n; i++)
+            sdhh_make(&req[i], &hp);
+
+        /* submits in between the commands of both controllers */
+        sub = 0;
+        while ((fails == 0) && ((sub < n) || sdhh_busy(&sdhh_ctrl[0]) || sdhh_busy(&sdhh_ctrl[1])))
+        {
+            if ((sub < n) && ((rand() & 1) || (!sdhh_busy(&sdhh_ctrl[0]) && !sdhh_busy(&sdhh_ctrl[1]))))
+            {
+                c = &sdhh_ctrl[req[sub].ctrl];
+                c->pend[c->npend++] = &req[sub];
+                fails += sdhh_check(SDH_Submit(c->sdh, &req[sub].req) == Successful, c, "submit failed");
+                fails += sdhh_check((host_daif & HOST_DAIF_I) == 0, c, "IRQs left masked");
+                fails += sdhh_check(req[sub].done || (req[sub].req.i32Status == (int)SDH_BUSY), c,
+                                    "pending request not busy");
+                sub++;
+                continue;
+            }
+            i = rand() & 1;
+            if (!sdhh_busy(&sdhh_ctrl[i]))
+                i ^= 1;
+            fails += sdhh_step(&sdhh_ctrl[i]);
+        }
+
+        for (i = 0; i < 2; i++)
+            fails += sdhh_check(sdhh_ctrl[i].npend == 0, &sdhh_ctrl[i], "request left in the queue");
+        if (fails == 0)
+            fails += sdhh_settle(req, n);
+    }
+
+    for (i = 0; i < 2; i++)
+    {
+        c = &sdhh_ctrl[i];
+        printf("%s, %s addresses: %lu requests, %lu commands, %lu sectors, %lu errors raised, %lu stops\n",
+               c->name, c->byte_addr ? "byte" : "sector", c->requests, c->commands, c->sectors, c->errors,
+               c->stops);
+    }
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
@@ -267,6 +267,10 @@ volatile int int_wait_data = 0;
 void SDH_IRQHandler(void)
 {
     uint16_t status;
+
+    /* Transfers queued by SDH_Submit() */
+    SDH_IntHandler(SDH);
+
     status =SDH->NORMAL_INT_STAT_R;
     if(status & SDH_INT_CARD_INSERT) {
     	sysprintf("***** card insert !\n");
@@ -13,6 +13,7 @@
 #include "usbh_lib.h"
 #include "ff.h"
 #include "diskio.h"
+#include "ffstream.h"
 #include "displib.h"
 #include "vc8000_lib.h"
 
@@ -23,9 +24,10 @@
 
 uint8_t  _DisplayBuff[LCD_WIDTH * LCD_HEIGHT * 4 * 4] __attribute__((aligned(32)));  /* 1024 x 600 RGB888 */
 uint8_t  _VC8000Buff[0x2000000] __attribute__((aligned(32)));  /* 32 MB */
-uint8_t  _FileBuff[0x2000000] __attribute__((aligned(32)));  /* 32 MB */
+uint8_t  _FileBuff[0x2000000] __attribute__((aligned(FSTREAM_ALIGN)));  /* 32 MB */
 
 static  struct pp_params _pp;
+static  ffstream_t _FileStream;
 
 /* LCD attributes 1024x600 */
 DISP_LCD_INFO LcdPanelInfo =
@@ -211,6 +213,7 @@ int do_jpeg_decode(char *fname, uint32_t fsize)
 {
     FIL   hfile, *pFile;
     int   handle, count, ret;
+    uint8_t  *buf;
 
     pFile = nc_ptr(&hfile);   /* make FIL->buff be non-cache */
     /*
@@ -222,12 +225,20 @@ int do_jpeg_decode(char *fname, uint32_t fsize)
         sysprintf("Failed to open JPEG file <%s>! (%d)\n", fname, ret);
         return -1;
     }
-    ret = f_read(pFile, nc_ptr(_FileBuff), fsize, &count);
+    /*
+     *  One buffer of the file size, read along the cluster link map in as few
+     *  multi-sector reads as the fragments allow
+     */
+    ret = ffstream_open(&_FileStream, pFile, NULL, _FileBuff, (fsize + FSTREAM_SS - 1) & ~(FSTREAM_SS - 1), 1);
+    if (ret == 0)
+        ret = ffstream_next(&_FileStream, &buf, (UINT *)&count);
     if (ret != 0)
     {
         sysprintf("Failed to read JPEG file <%s>! (%d)\n", fname, ret);
+        f_close(pFile);
         return -1;
     }
+    ffstream_close(&_FileStream);
     if (count != fsize)
     {
         sysprintf("Failed to read the whole JPEG file! (%d / %d)\n", count, fsize);
@@ -249,7 +260,7 @@ int do_jpeg_decode(char *fname, uint32_t fsize)
         goto err_out;
     }
 
-    ret = VC8000_JPEG_Decode_Run(handle, nc_ptr(_FileBuff), fsize, NULL);
+    ret = VC8000_JPEG_Decode_Run(handle, nc_ptr(buf), fsize, NULL);
     if (ret != 0)
     {
         sysprintf("VC8000_JPEG_Decode_Run error: %d\n", ret);
@@ -96,6 +96,8 @@ extern uint32_t SystemCoreClock;
 #define configUSE_APPLICATION_TASK_TAG          0
 #define configUSE_COUNTING_SEMAPHORES           1
 #define configUSE_QUEUE_SETS                    1
+/* index 1 wakes tasks waiting for the crypto engines, see crypto_hw.h */
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   2
 
 #define configSUPPORT_STATIC_ALLOCATION			1
 #define configSUPPORT_DYNAMIC_ALLOCATION		FIXED_TO(1)
@@ -316,7 +316,7 @@ extern void platform_alt_free(void *);
  *            digests and ciphers instead.
  *
  */
-//#define MBEDTLS_AES_ALT
+#define MBEDTLS_AES_ALT
 //#define MBEDTLS_ARIA_ALT
 //#define MBEDTLS_CAMELLIA_ALT
 //#define MBEDTLS_CCM_ALT
@@ -326,15 +326,15 @@ extern void platform_alt_free(void *);
 //#define MBEDTLS_DES_ALT
 //#define MBEDTLS_DHM_ALT
 //#define MBEDTLS_ECJPAKE_ALT
-//#define MBEDTLS_GCM_ALT
+#define MBEDTLS_GCM_ALT
 //#define MBEDTLS_NIST_KW_ALT
 //#define MBEDTLS_MD5_ALT
 //#define MBEDTLS_POLY1305_ALT
 //#define MBEDTLS_RIPEMD160_ALT
 //#define MBEDTLS_RSA_ALT
-//#define MBEDTLS_SHA1_ALT
-//#define MBEDTLS_SHA256_ALT
-//#define MBEDTLS_SHA512_ALT
+#define MBEDTLS_SHA1_ALT
+#define MBEDTLS_SHA256_ALT
+#define MBEDTLS_SHA512_ALT
 
 /*
  * When replacing the elliptic curve module, pleace consider, that it is
@@ -396,12 +396,19 @@ extern void platform_alt_free(void *);
 //#define MBEDTLS_AES_SETKEY_DEC_ALT
 //#define MBEDTLS_AES_ENCRYPT_ALT
 //#define MBEDTLS_AES_DECRYPT_ALT
-//#define MBEDTLS_ECDH_GEN_PUBLIC_ALT
-//#define MBEDTLS_ECDH_COMPUTE_SHARED_ALT
-//#define MBEDTLS_ECDSA_VERIFY_ALT
-//#define MBEDTLS_ECDSA_SIGN_ALT
+#define MBEDTLS_ECDH_GEN_PUBLIC_ALT
+#define MBEDTLS_ECDH_COMPUTE_SHARED_ALT
+#define MBEDTLS_ECDSA_VERIFY_ALT
+#define MBEDTLS_ECDSA_SIGN_ALT
 //#define MBEDTLS_ECDSA_GENKEY_ALT
 
+/* Not part of mbed TLS: hooks of mbedtls_rsa_public() and mbedtls_rsa_private()
+ * added to rsa.c, see rsa.h */
+#define MBEDTLS_RSA_PUBLIC_ALT
+#define MBEDTLS_RSA_PRIVATE_ALT
+/* Private keys on the engine too, without exponent blinding (rsa_alt.c) */
+//#define MBEDTLS_RSA_PRIVATE_ALT_NO_EXP_BLINDING
+
 /**
  * \def MBEDTLS_ECP_INTERNAL_ALT
  *
@@ -479,7 +486,7 @@ extern void platform_alt_free(void *);
  *
  * Uncomment to use your own hardware entropy collector.
  */
-//#define MBEDTLS_ENTROPY_HARDWARE_ALT
+#define MBEDTLS_ENTROPY_HARDWARE_ALT
 
 /**
  * \def MBEDTLS_AES_ROM_TABLES
@@ -3333,16 +3340,3 @@ extern void platform_alt_free(void *);
 //#define MBEDTLS_ECDH_VARIANT_EVEREST_ENABLED
 
 /* \} name SECTION: Customisation configuration options */
-
-/**
-* Configuration check for M460
-*
-*/
-
-#if (defined(MBEDTLS_ECDH_GEN_PUBLIC_ALT) || defined(MBEDTLS_ECDH_COMPUTE_SHARED_ALT) || defined(MBEDTLS_ECDSA_VERIFY_ALT) || defined(MBEDTLS_ECDSA_SIGN_ALT)) && defined(MBEDTLS_SHA256_ALT)
-#error "SHA256_ALT cannot work with ECDH or ECDSA ALT"
-#endif
-
-#if (defined(MBEDTLS_ECDH_GEN_PUBLIC_ALT) || defined(MBEDTLS_ECDH_COMPUTE_SHARED_ALT) || defined(MBEDTLS_ECDSA_VERIFY_ALT) || defined(MBEDTLS_ECDSA_SIGN_ALT)) && defined(MBEDTLS_ECP_DP_CURVE25519_ENABLED)
-#error "MBEDTLS_ECP_DP_CURVE25519_ENABLED cannot work with ECDH or ECDSA ALT"
-#endif
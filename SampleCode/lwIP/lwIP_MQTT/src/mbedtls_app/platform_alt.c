@@ -3,7 +3,8 @@
     @author Nishant Agrawal
     @org        Real Time Solutions Pvt. Ltd.
     @date       19/4/2018
-    @brief  Platform specific implementation for memory allocation, free and hardware_poll using freertos
+    @brief  Platform specific implementation for memory allocation and free using freertos,
+            mbedtls_hardware_poll() is in mbedtls_port/rng_pool.c
 */
 #include "mbedtls/platform.h"
 #include "FreeRTOS.h"
@@ -40,39 +41,3 @@ void platform_alt_free(void * spc)
     }
     vPortFree(spc);
 }
-
-int mbedtls_hardware_poll( void *data, unsigned char *output, size_t len, size_t *olen )
-{
-    uint32_t i = 0;
-    uint32_t j = 0;
-    uint32_t round_len = len >> 2;
-
-    while(j < round_len)
-    {
-        union
-        {
-            uint8_t byte[4];
-            uint32_t number;
-        } temp;
-
-        temp.number = rand();
-
-        output[i++] = temp.byte[0];
-        output[i++] = temp.byte[1];
-        output[i++] = temp.byte[2];
-        output[i++] = temp.byte[3];
-        j++;
-    }
-
-    while(i < len)
-    {
-        output[i++] = rand();
-    }
-
-    if(olen)
-    {
-        *olen = len;
-    }
-    return 0;
-}
-
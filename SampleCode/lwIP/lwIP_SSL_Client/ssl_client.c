@@ -50,6 +50,7 @@
 
 #include "mbedtls/entropy.h"
 #include "mbedtls/ctr_drbg.h"
+#include "rng_pool.h"
 #include "test/certs.h"
 #include "mbedtls/x509.h"
 #include "mbedtls/ssl.h"
@@ -112,22 +113,6 @@ static void *mbedtls_calloc_wrapper( size_t n, size_t size )
     return ptr;
 }
 
-static int custom_entropy_poll( void *data, unsigned char *output, size_t len )
-{
-    size_t i;
-    uint32_t seed;
-    (void) data;
-
-    for( i = 0; i < len; i++ )
-    {
-        seed = xTaskGetTickCount();
-        seed ^= (uint32_t)( (uintptr_t) &seed >> 16 );
-        output[i] = (unsigned char)( seed >> ( ( i % 8 ) * 4 ) ) & 0xFF;
-    }
-
-    return( 0 );
-}
-
 static void ssl_main(void *arg)
 {
     int ret = 1, len;
@@ -153,7 +138,7 @@ static void ssl_main(void *arg)
     mbedtls_x509_crt_init( &cacert );
     mbedtls_ctr_drbg_init( &ctr_drbg );
 
-    ret = mbedtls_ctr_drbg_seed( &ctr_drbg, custom_entropy_poll, NULL,
+    ret = mbedtls_ctr_drbg_seed( &ctr_drbg, rng_pool_entropy, NULL,
                                (const unsigned char *) pers, strlen( pers ) );
     if( ret != 0 )
     {
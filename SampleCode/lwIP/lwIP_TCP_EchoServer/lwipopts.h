@@ -47,7 +47,8 @@
 
 #define NO_SYS                          0
 #define MEM_ALIGNMENT                   4
-#define LWIP_STATS                      0
+#define LWIP_STATS                      1
+#define LWIP_STATS_DISPLAY              1
 #define LWIP_SOCKET_SET_ERRNO           0
 #define LWIP_NETCONN                    1
 #define LWIP_SOCKET                     0
@@ -63,6 +64,10 @@
 
 #define MEMP_NUM_NETCONN                8
 #define MEM_SIZE                        1600
+/* Heap served from the size classes of lwippools.h, poolstats_display() shows their usage */
+#define MEM_USE_POOLS                   1
+#define MEMP_USE_CUSTOM_POOLS           1
+#define MEM_USE_POOLS_TRY_BIGGER_POOL   1
 #define MEMP_NUM_PBUF                   32
 #define PBUF_POOL_SIZE                  64
 #define TCP_WND                         16384 //Max: 65535
@@ -79,17 +84,16 @@
 #define DEFAULT_UDP_RECVMBOX_SIZE       5
 #define DEFAULT_RAW_RECVMBOX_SIZE       5
 
+/* Socket/netconn calls and received frames are processed in the calling task
+   under the core lock instead of being passed to the tcpip thread */
+#define LWIP_TCPIP_CORE_LOCKING         1
+#define LWIP_TCPIP_CORE_LOCKING_INPUT   1
+
 #define LWIP_USING_HW_CHECKSUM          1
 /* ---------- Checksum options ---------- */
 #if (LWIP_USING_HW_CHECKSUM == 1)
-#define CHECKSUM_GEN_IP                 0
-#define CHECKSUM_GEN_UDP                0
-#define CHECKSUM_GEN_TCP                0
-#define CHECKSUM_GEN_ICMP               0
-#define CHECKSUM_CHECK_IP               0
-#define CHECKSUM_CHECK_UDP              0
-#define CHECKSUM_CHECK_TCP              0
-#define CHECKSUM_CHECK_ICMP             0
+/* Software checksums are turned off on the EMAC netifs only, see NETIF_SET_CHECKSUM_CTRL() in ethernetif.c */
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    1
 #endif
 
 
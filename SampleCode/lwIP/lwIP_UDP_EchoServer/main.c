@@ -5,6 +5,8 @@
  *           The server listen to port 80, IP address is configured statically
  *           to 192.168.1.2. After receiving any string from its peer, this 
  *           sample code reply with "Hello World!!"
+ *           The EMAC clock follows a PTP master on the LAN, its state is
+ *           printed every 10 seconds.
  *
  * @note     TIMER11 has been assigned to FreeRTOS kernel.
  *
@@ -25,6 +27,7 @@
 #include "lwip/tcpip.h"
 #include "netif/ethernetif.h"
 #include "udp_echoserver-netconn.h"
+#include "ptpd.h"
 #if (LWIP_DHCP == 1)
 #include "lwip/dhcp.h"
 #endif
@@ -240,7 +243,27 @@ static void vUdpTask( void *pvParameters )
 
     udp_echoserver_netconn_init();
 
-    vTaskSuspend( NULL );
+    if(ptpd_init(&netif) != ERR_OK)
+    {
+        sysprintf("PTP clock failed to start\n");
+        vTaskSuspend( NULL );
+    }
+
+    for( ;; )
+    {
+        static const char *const state[] = { "disabled", "listening", "uncalibrated", "slave" };
+        struct ptpd_status status;
+        struct ptpd_time now;
+
+        vTaskDelay( pdMS_TO_TICKS( 10000 ) );
+
+        ptpd_get_status(&status);
+        ptpd_get_time(&now);
+        sysprintf("PTP %s: time %lu.%09lu, offset %ld ns, delay %ld ns, %ld ppb, %lu syncs, %lu steps\n",
+                  state[status.state], (unsigned long)now.sec, (unsigned long)now.nsec,
+                  (long)status.offset_ns, (long)status.mean_path_delay_ns, (long)status.freq_adj_ppb,
+                  (unsigned long)status.syncs, (unsigned long)status.steps);
+    }
 }
 
 /* main function */
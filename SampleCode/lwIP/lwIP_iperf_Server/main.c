@@ -24,6 +24,7 @@
 #include "lwip/tcpip.h"
 #include "netif/ethernetif.h"
 #include "lwip/apps/lwiperf.h"
+#include "poolstats.h"
 #if (LWIP_DHCP == 1)
 #include "lwip/dhcp.h"
 #endif
@@ -240,7 +241,16 @@ static void vTcpTask( void *pvParameters )
     lwiperf_start_tcp_server_default(NULL, NULL);
 #endif
 
+#if LWIP_STATS && MEMP_STATS
+    /* Show which pools run short under load */
+    for( ;; )
+    {
+        vTaskDelay( pdMS_TO_TICKS( 10000 ) );
+        poolstats_display();
+    }
+#else
     vTaskSuspend( NULL );
+#endif
 }
 
 /* main function */
@@ -0,0 +1,352 @@
+/**************************************************************************//**
+ * @file     aes_alt.c
+ * @brief    mbedtls AES on the CRPT AES engine (MBEDTLS_AES_ALT)
+ *
+ * The engine is loaded with key and IV for every request, so contexts are
+ * never bound to it and any number of them can be used from any task. The
+ * chaining value (IV or counter) is carried in the caller's buffers exactly
+ * as the software implementation does. Requests the DMA can take in place
+ * are jobs of the AES queue, the others hold the engine to go through the
+ * bounce buffer of crypto_hw_aes_sg().
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_AES_C) && defined(MBEDTLS_AES_ALT)
+
+#include "mbedtls/aes.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
+#include "crypto_hw.h"
+
+#define GET_UINT32_BE(b, i)     (((uint32_t)(b)[(i)] << 24) | ((uint32_t)(b)[(i) + 1] << 16) | \
+                                 ((uint32_t)(b)[(i) + 2] << 8) | ((uint32_t)(b)[(i) + 3]))
+
+/* A request run as a job of the AES queue */
+typedef struct aes_hw_job
+{
+    crypto_hw_job_t job;
+    mbedtls_aes_context *ctx;
+    int mode;
+    uint32_t opmode;
+    const unsigned char *iv;
+    const unsigned char *input;
+    unsigned char *output;
+    size_t len;
+}
+aes_hw_job_t;
+
+/* crypto_hw_job_t start(), in the task or from the interrupt */
+static int aes_hw_job_start(crypto_hw_job_t *job)
+{
+    aes_hw_job_t *j = job->arg;
+    uint32_t ivw[4];
+    int i;
+
+    AES_Open(CRPT, (j->mode == MBEDTLS_AES_ENCRYPT) ? AES_MODE_ENCRYPT : AES_MODE_DECRYPT,
+             j->opmode, j->ctx->keysize, AES_IN_OUT_SWAP);
+    AES_SetKey(CRPT, j->ctx->keys, j->ctx->keysize);
+    for (i = 0; i < 4; i++)
+        ivw[i] = GET_UINT32_BE(j->iv, i * 4);
+    AES_SetInitVect(CRPT, ivw);
+
+    crypto_hw_dma_prepare(j->input, j->output, j->len);
+    AES_SetDMATransfer(CRPT, 0, 0, ptr_to_u32(j->input), ptr_to_u32(j->output), j->len);
+    AES_Trigger(CRPT, 0, CRYPTO_DMA_ONE_SHOT);
+    return 0;
+}
+
+/*
+ * Runs whole blocks the DMA takes in place through the job queue, and
+ * sleeps until the engine is done.
+ */
+static int aes_hw_queue(mbedtls_aes_context *ctx, int mode, uint32_t opmode,
+                        const unsigned char iv[16], const unsigned char *input,
+                        unsigned char *output, size_t len)
+{
+    aes_hw_job_t j;
+
+    j.job.start = aes_hw_job_start;
+    j.job.done = NULL;
+    j.job.arg = &j;
+    j.ctx = ctx;
+    j.mode = mode;
+    j.opmode = opmode;
+    j.iv = iv;
+    j.input = input;
+    j.output = output;
+    j.len = len;
+
+    crypto_hw_submit(CRYPTO_HW_AES, &j.job);
+    if (crypto_hw_job_wait(&j.job) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+
+    crypto_hw_dma_complete(output, len);
+    return 0;
+}
+
+/*
+ * Runs whole blocks the DMA cannot take in place with the engine locked, as
+ * a one-segment scatter-gather request: its bounce buffer goes through the
+ * engine in one DMA cascade, and it leaves in iv what the software
+ * implementation would.
+ */
+static int aes_hw_locked(mbedtls_aes_context *ctx, int mode, uint32_t opmode,
+                         unsigned char iv[16], const unsigned char *input,
+                         unsigned char *output, size_t len)
+{
+    crypto_hw_seg_t seg;
+
+    seg.in = input;
+    seg.out = output;
+    seg.len = len;
+    if (crypto_hw_aes_sg(opmode, mode == MBEDTLS_AES_ENCRYPT, ctx->keys, ctx->keysize,
+                         iv, &seg, 1) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    return 0;
+}
+
+/* Adds n to the 128-bit big-endian counter */
+static void aes_ctr_add(unsigned char counter[16], uint32_t n)
+{
+    int i;
+
+    for (i = 15; (i >= 0) && (n != 0); i--)
+    {
+        n += counter[i];
+        counter[i] = (unsigned char)n;
+        n >>= 8;
+    }
+}
+
+/*
+ * Runs CBC, CFB or CTR requests of whole blocks through the engine, as a
+ * job when the DMA can take the buffers in place, else with the engine
+ * locked. Leaves in iv what the software implementation would.
+ */
+static int aes_hw_crypt(mbedtls_aes_context *ctx, int mode, uint32_t opmode,
+                        unsigned char iv[16], const unsigned char *input,
+                        unsigned char *output, size_t length)
+{
+    unsigned char last[16];
+    int ret;
+
+    if (!crypto_hw_dma_direct(input, output, length))
+        return aes_hw_locked(ctx, mode, opmode, iv, input, output, length);
+
+    /* the next IV of a decryption is the last cipher block, which an
+     * in-place request overwrites */
+    if ((opmode != AES_MODE_CTR) && (mode == MBEDTLS_AES_DECRYPT))
+        memcpy(last, input + length - 16, 16);
+
+    ret = aes_hw_queue(ctx, mode, opmode, iv, input, output, length);
+    if (ret == 0)
+    {
+        if (opmode == AES_MODE_CTR)
+            aes_ctr_add(iv, (uint32_t)(length / 16));
+        else if (mode == MBEDTLS_AES_DECRYPT)
+            memcpy(iv, last, 16);
+        else
+            memcpy(iv, output + length - 16, 16);
+    }
+
+    mbedtls_platform_zeroize(last, sizeof(last));
+    return ret;
+}
+
+void mbedtls_aes_init(mbedtls_aes_context *ctx)
+{
+    memset(ctx, 0, sizeof(mbedtls_aes_context));
+    mbedtls_aes_sw_init(&ctx->sw);
+}
+
+void mbedtls_aes_free(mbedtls_aes_context *ctx)
+{
+    if (ctx == NULL)
+        return;
+
+    mbedtls_aes_sw_free(&ctx->sw);
+    mbedtls_platform_zeroize(ctx, sizeof(mbedtls_aes_context));
+}
+
+/* Keeps the key in the word order AES_SetKey() takes, the engine expands
+ * it for both directions */
+static void aes_save_key(mbedtls_aes_context *ctx, const unsigned char *key,
+                         unsigned int keybits)
+{
+    unsigned int i;
+
+    for (i = 0; i < keybits / 32; i++)
+        ctx->keys[i] = GET_UINT32_BE(key, i * 4);
+
+    ctx->keysize = (keybits == 128) ? AES_KEY_SIZE_128 :
+                   (keybits == 192) ? AES_KEY_SIZE_192 : AES_KEY_SIZE_256;
+}
+
+int mbedtls_aes_setkey_enc(mbedtls_aes_context *ctx, const unsigned char *key,
+                           unsigned int keybits)
+{
+    int ret;
+
+    ret = mbedtls_aes_sw_setkey_enc(&ctx->sw, key, keybits);
+    if (ret == 0)
+        aes_save_key(ctx, key, keybits);
+    return ret;
+}
+
+int mbedtls_aes_setkey_dec(mbedtls_aes_context *ctx, const unsigned char *key,
+                           unsigned int keybits)
+{
+    int ret;
+
+    ret = mbedtls_aes_sw_setkey_dec(&ctx->sw, key, keybits);
+    if (ret == 0)
+        aes_save_key(ctx, key, keybits);
+    return ret;
+}
+
+int mbedtls_internal_aes_encrypt(mbedtls_aes_context *ctx,
+                                 const unsigned char input[16],
+                                 unsigned char output[16])
+{
+    return mbedtls_internal_aes_sw_encrypt(&ctx->sw, input, output);
+}
+
+int mbedtls_internal_aes_decrypt(mbedtls_aes_context *ctx,
+                                 const unsigned char input[16],
+                                 unsigned char output[16])
+{
+    return mbedtls_internal_aes_sw_decrypt(&ctx->sw, input, output);
+}
+
+/* One block per call, below any sensible AES_ALT_HW_MIN_LEN */
+int mbedtls_aes_crypt_ecb(mbedtls_aes_context *ctx, int mode,
+                          const unsigned char input[16],
+                          unsigned char output[16])
+{
+    if ((16 >= AES_ALT_HW_MIN_LEN) && crypto_hw_available() &&
+        ((mode == MBEDTLS_AES_ENCRYPT) || (mode == MBEDTLS_AES_DECRYPT)))
+        return aes_hw_locked(ctx, mode, AES_MODE_ECB, NULL, input, output, 16);
+
+    return mbedtls_aes_sw_crypt_ecb(&ctx->sw, mode, input, output);
+}
+
+#if defined(MBEDTLS_CIPHER_MODE_CBC)
+int mbedtls_aes_crypt_cbc(mbedtls_aes_context *ctx, int mode, size_t length,
+                          unsigned char iv[16], const unsigned char *input,
+                          unsigned char *output)
+{
+    /* anything odd is left to the software for the error code */
+    if ((length < AES_ALT_HW_MIN_LEN) || (length % 16) || !crypto_hw_available() ||
+        ((mode != MBEDTLS_AES_ENCRYPT) && (mode != MBEDTLS_AES_DECRYPT)))
+        return mbedtls_aes_sw_crypt_cbc(&ctx->sw, mode, length, iv, input, output);
+
+    return aes_hw_crypt(ctx, mode, AES_MODE_CBC, iv, input, output, length);
+}
+#endif /* MBEDTLS_CIPHER_MODE_CBC */
+
+#if defined(MBEDTLS_CIPHER_MODE_CFB)
+int mbedtls_aes_crypt_cfb128(mbedtls_aes_context *ctx, int mode, size_t length,
+                             size_t *iv_off, unsigned char iv[16],
+                             const unsigned char *input, unsigned char *output)
+{
+    size_t n;
+    int ret;
+
+    if ((length < AES_ALT_HW_MIN_LEN) || (*iv_off > 15) || !crypto_hw_available() ||
+        ((mode != MBEDTLS_AES_ENCRYPT) && (mode != MBEDTLS_AES_DECRYPT)))
+        return mbedtls_aes_sw_crypt_cfb128(&ctx->sw, mode, length, iv_off, iv, input, output);
+
+    /* finish the block a previous call left open */
+    if (*iv_off != 0)
+    {
+        n = 16 - *iv_off;
+        ret = mbedtls_aes_sw_crypt_cfb128(&ctx->sw, mode, n, iv_off, iv, input, output);
+        if (ret != 0)
+            return ret;
+        input += n;
+        output += n;
+        length -= n;
+    }
+
+    n = length & ~(size_t)15;
+    if (n != 0)
+    {
+        ret = aes_hw_crypt(ctx, mode, AES_MODE_CFB, iv, input, output, n);
+        if (ret != 0)
+            return ret;
+    }
+
+    if (length > n)
+        return mbedtls_aes_sw_crypt_cfb128(&ctx->sw, mode, length - n, iv_off, iv,
+                                           input + n, output + n);
+    return 0;
+}
+
+int mbedtls_aes_crypt_cfb8(mbedtls_aes_context *ctx, int mode, size_t length,
+                           unsigned char iv[16], const unsigned char *input,
+                           unsigned char *output)
+{
+    return mbedtls_aes_sw_crypt_cfb8(&ctx->sw, mode, length, iv, input, output);
+}
+#endif /* MBEDTLS_CIPHER_MODE_CFB */
+
+#if defined(MBEDTLS_CIPHER_MODE_OFB)
+int mbedtls_aes_crypt_ofb(mbedtls_aes_context *ctx, size_t length, size_t *iv_off,
+                          unsigned char iv[16], const unsigned char *input,
+                          unsigned char *output)
+{
+    return mbedtls_aes_sw_crypt_ofb(&ctx->sw, length, iv_off, iv, input, output);
+}
+#endif /* MBEDTLS_CIPHER_MODE_OFB */
+
+#if defined(MBEDTLS_CIPHER_MODE_CTR)
+int mbedtls_aes_crypt_ctr(mbedtls_aes_context *ctx, size_t length, size_t *nc_off,
+                          unsigned char nonce_counter[16], unsigned char stream_block[16],
+                          const unsigned char *input, unsigned char *output)
+{
+    size_t n;
+    int ret;
+
+    if ((length < AES_ALT_HW_MIN_LEN) || (*nc_off > 15) || !crypto_hw_available())
+        return mbedtls_aes_sw_crypt_ctr(&ctx->sw, length, nc_off, nonce_counter,
+                                        stream_block, input, output);
+
+    /* use up the key stream of a previous call */
+    if (*nc_off != 0)
+    {
+        n = 16 - *nc_off;
+        ret = mbedtls_aes_sw_crypt_ctr(&ctx->sw, n, nc_off, nonce_counter,
+                                       stream_block, input, output);
+        if (ret != 0)
+            return ret;
+        input += n;
+        output += n;
+        length -= n;
+    }
+
+    /* The engine may only count in the low word, keep carries in software */
+    n = length & ~(size_t)15;
+    if ((n != 0) &&
+        ((uint64_t)GET_UINT32_BE(nonce_counter, 12) + n / 16 <= 0x100000000ULL))
+    {
+        ret = aes_hw_crypt(ctx, MBEDTLS_AES_ENCRYPT, AES_MODE_CTR, nonce_counter,
+                           input, output, n);
+        if (ret != 0)
+            return ret;
+        input += n;
+        output += n;
+        length -= n;
+    }
+
+    if (length == 0)
+        return 0;
+    return mbedtls_aes_sw_crypt_ctr(&ctx->sw, length, nc_off, nonce_counter,
+                                    stream_block, input, output);
+}
+#endif /* MBEDTLS_CIPHER_MODE_CTR */
+
+#endif /* MBEDTLS_AES_C && MBEDTLS_AES_ALT */
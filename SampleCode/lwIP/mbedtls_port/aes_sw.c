@@ -0,0 +1,37 @@
+/**************************************************************************//**
+ * @file     aes_sw.c
+ * @brief    Software AES of mbedtls under the mbedtls_aes_sw_ names
+ *
+ * With MBEDTLS_AES_ALT, library/aes.c builds nothing but its self test. The
+ * software implementation is built here a second time, renamed, as the
+ * fallback of aes_alt.c for short requests, the modes the engine does not
+ * run, and parts without access to the engine. XTS is only available from
+ * here and keeps its mbedtls names.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_AES_C) && defined(MBEDTLS_AES_ALT)
+
+#undef MBEDTLS_AES_ALT
+#undef MBEDTLS_SELF_TEST
+
+#define mbedtls_aes_context             mbedtls_aes_sw_context
+#define mbedtls_aes_xts_context         mbedtls_aes_sw_xts_context
+#define mbedtls_aes_init                mbedtls_aes_sw_init
+#define mbedtls_aes_free                mbedtls_aes_sw_free
+#define mbedtls_aes_setkey_enc          mbedtls_aes_sw_setkey_enc
+#define mbedtls_aes_setkey_dec          mbedtls_aes_sw_setkey_dec
+#define mbedtls_aes_crypt_ecb           mbedtls_aes_sw_crypt_ecb
+#define mbedtls_aes_crypt_cbc           mbedtls_aes_sw_crypt_cbc
+#define mbedtls_aes_crypt_cfb128        mbedtls_aes_sw_crypt_cfb128
+#define mbedtls_aes_crypt_cfb8          mbedtls_aes_sw_crypt_cfb8
+#define mbedtls_aes_crypt_ofb           mbedtls_aes_sw_crypt_ofb
+#define mbedtls_aes_crypt_ctr           mbedtls_aes_sw_crypt_ctr
+#define mbedtls_internal_aes_encrypt    mbedtls_internal_aes_sw_encrypt
+#define mbedtls_internal_aes_decrypt    mbedtls_internal_aes_sw_decrypt
+
+#include "aes.c"
+
+#endif /* MBEDTLS_AES_C && MBEDTLS_AES_ALT */
@@ -0,0 +1,826 @@
+/**************************************************************************//**
+ * @file     crypto_hw.c
+ * @brief    Shared access to the CRPT engine for the mbedtls alternative
+ *           implementations
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "crypto_hw.h"
+
+#if (configTASK_NOTIFICATION_ARRAY_ENTRIES <= CRYPTO_HW_NOTIFY_INDEX)
+#error "configTASK_NOTIFICATION_ARRAY_ENTRIES must be above CRYPTO_HW_NOTIFY_INDEX"
+#endif
+
+/* Owner of one engine: the task in holder, or the job queue while running.
+ * Changed by tasks in critical sections and by the crypto interrupt. */
+typedef struct crypto_hw_engine
+{
+    SemaphoreHandle_t mutex;            /* orders the tasks calling crypto_hw_lock() */
+    TaskHandle_t volatile holder;       /* task holding the engine */
+    TaskHandle_t volatile waiter;       /* task in crypto_hw_lock() until the running job ends */
+    crypto_hw_job_t *head, *tail;       /* queued jobs, head is on the engine while running */
+    volatile int running;
+}
+crypto_hw_engine_t;
+
+static volatile int crypto_hw_state;    /* 0: not probed, 1: usable, -1: not accessible */
+static crypto_hw_engine_t crypto_hw_engine[CRYPTO_HW_CNT];
+
+/* SHA engine state of the digest on the engine, and input that is not word
+ * aligned or straddles segments, SHA lock held */
+static uint32_t sha_fdbck[CRYPTO_HW_SHA_FDBCK] __attribute__((aligned(CRYPTO_HW_LINE)));
+static uint32_t sha_dma_buf[1024] __attribute__((aligned(CRYPTO_HW_LINE)));
+
+/* Blocks of scatter-gather AES requests that straddle segments or lie in
+ * buffers the DMA cannot use, AES lock held */
+static unsigned char aes_sg_buf[CRYPTO_HW_SG_BUF_SIZE] __attribute__((aligned(CRYPTO_HW_LINE)));
+
+static void crypto_hw_irq(uint32_t u32IntSts);
+static void crypto_hw_wait(uint32_t u32IntMsk);
+
+/**
+ * Checks if the CRPT engine can be driven from this core, and initializes it
+ * on first use.
+ *
+ * @return 1 if the engine is usable, 0 if software must be used
+ */
+int crypto_hw_available(void)
+{
+    if (crypto_hw_state == 0)
+    {
+        if (Is_MA35D05K())
+        {
+            crypto_hw_state = -1;
+        }
+        else
+        {
+            /* Enables the engine clock and interrupt, harmless if done twice */
+            Crypto_Init();
+            CRYPTO_SetCallback(crypto_hw_irq, crypto_hw_wait);
+            crypto_hw_state = 1;
+        }
+    }
+
+    return (crypto_hw_state > 0);
+}
+
+/*
+ * Ends a job and wakes whoever waits for it, woken is set in the interrupt.
+ */
+static void crypto_hw_job_end(crypto_hw_job_t *job, int status, BaseType_t *woken)
+{
+    void (*done)(crypto_hw_job_t *job) = job->done;
+    TaskHandle_t task = job->task;
+
+    /* the job may be gone once its status is written */
+    job->status = status;
+    if (done != NULL)
+        done(job);
+    else if (woken != NULL)
+        vTaskNotifyGiveIndexedFromISR(task, CRYPTO_HW_NOTIFY_INDEX, woken);
+    else
+        xTaskNotifyGiveIndexed(task, CRYPTO_HW_NOTIFY_INDEX);
+}
+
+/*
+ * Starts the next job of an engine owned by the queue, or hands the engine
+ * to the task waiting in crypto_hw_lock(). woken is NULL in a task and points
+ * to the yield request in the interrupt, where no critical section is needed.
+ * The waiting task goes first when a job ended, the queue when a task
+ * released the engine, so neither side starves the other.
+ */
+static void crypto_hw_next(crypto_hw_engine_t *eng, BaseType_t *woken)
+{
+    crypto_hw_job_t *job;
+
+    for (;;)
+    {
+        if (woken == NULL)
+            taskENTER_CRITICAL();
+
+        job = NULL;
+        if ((eng->waiter != NULL) && ((woken != NULL) || (eng->head == NULL)))
+        {
+            eng->holder = eng->waiter;
+            eng->waiter = NULL;
+            eng->running = 0;
+            if (woken != NULL)
+                vTaskNotifyGiveIndexedFromISR(eng->holder, CRYPTO_HW_NOTIFY_INDEX, woken);
+            else
+                xTaskNotifyGiveIndexed(eng->holder, CRYPTO_HW_NOTIFY_INDEX);
+        }
+        else if (eng->head == NULL)
+        {
+            eng->running = 0;
+        }
+        else
+        {
+            job = eng->head;
+        }
+
+        if (woken == NULL)
+            taskEXIT_CRITICAL();
+
+        /* the interrupt of a started job carries on */
+        if ((job == NULL) || (job->start(job) == 0))
+            return;
+
+        if (woken == NULL)
+            taskENTER_CRITICAL();
+        eng->head = job->next;
+        if (eng->head == NULL)
+            eng->tail = NULL;
+        if (woken == NULL)
+            taskEXIT_CRITICAL();
+
+        crypto_hw_job_end(job, -1, woken);
+    }
+}
+
+/*
+ * End of an engine run: wakes the holder sleeping in a blocking driver call,
+ * or ends the running job and chains the next one.
+ */
+static void crypto_hw_engine_irq(int engine, int status, BaseType_t *woken)
+{
+    crypto_hw_engine_t *eng = &crypto_hw_engine[engine];
+    crypto_hw_job_t *job;
+
+    if (eng->holder != NULL)
+    {
+        vTaskNotifyGiveIndexedFromISR(eng->holder, CRYPTO_HW_NOTIFY_INDEX, woken);
+        return;
+    }
+
+    job = eng->head;
+    if (!eng->running || (job == NULL))
+        return;
+
+    eng->head = job->next;
+    if (eng->head == NULL)
+        eng->tail = NULL;
+    crypto_hw_job_end(job, status, woken);
+
+    crypto_hw_next(eng, woken);
+}
+
+/* CRYPTO_SetCallback() interrupt callback */
+static void crypto_hw_irq(uint32_t u32IntSts)
+{
+    BaseType_t woken = pdFALSE;
+
+    if (u32IntSts & (CRPT_INTSTS_AESIF_Msk | CRPT_INTSTS_AESEIF_Msk))
+        crypto_hw_engine_irq(CRYPTO_HW_AES, (u32IntSts & CRPT_INTSTS_AESEIF_Msk) ? -1 : 0, &woken);
+
+    if (u32IntSts & (CRPT_INTSTS_HMACIF_Msk | CRPT_INTSTS_HMACEIF_Msk))
+        crypto_hw_engine_irq(CRYPTO_HW_SHA, (u32IntSts & CRPT_INTSTS_HMACEIF_Msk) ? -1 : 0, &woken);
+
+    if (u32IntSts & (CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk |
+                     CRPT_INTSTS_RSAIF_Msk | CRPT_INTSTS_RSAEIF_Msk))
+        crypto_hw_engine_irq(CRYPTO_HW_PKA,
+                             (u32IntSts & (CRPT_INTSTS_ECCEIF_Msk | CRPT_INTSTS_RSAEIF_Msk)) ? -1 : 0,
+                             &woken);
+
+    portYIELD_FROM_ISR(woken);
+}
+
+/*
+ * CRYPTO_SetCallback() wait callback, sleeps until the engine interrupt.
+ * The tick timeout covers driver calls made without crypto_hw_lock().
+ */
+static void crypto_hw_wait(uint32_t u32IntMsk)
+{
+    (void)u32IntMsk;
+
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+        ulTaskNotifyTakeIndexed(CRYPTO_HW_NOTIFY_INDEX, pdTRUE, 1);
+}
+
+/**
+ * Takes ownership of one engine, blocking until it is free. Queued jobs wait
+ * until the engine is released.
+ *
+ * @param engine CRYPTO_HW_AES, CRYPTO_HW_SHA or CRYPTO_HW_PKA
+ */
+void crypto_hw_lock(int engine)
+{
+    crypto_hw_engine_t *eng = &crypto_hw_engine[engine];
+    SemaphoreHandle_t mutex = eng->mutex;
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+
+    if (mutex == NULL)
+    {
+        /* First user, several tasks may race to create the mutex */
+        mutex = xSemaphoreCreateMutex();
+        configASSERT(mutex != NULL);
+
+        taskENTER_CRITICAL();
+        if (eng->mutex == NULL)
+        {
+            eng->mutex = mutex;
+            mutex = NULL;
+        }
+        taskEXIT_CRITICAL();
+
+        if (mutex != NULL)
+            vSemaphoreDelete(mutex);
+        mutex = eng->mutex;
+    }
+
+    xSemaphoreTake(mutex, portMAX_DELAY);
+
+    taskENTER_CRITICAL();
+    if (eng->running)
+        eng->waiter = self;
+    else
+        eng->holder = self;
+    taskEXIT_CRITICAL();
+
+    while (eng->holder != self)
+        ulTaskNotifyTakeIndexed(CRYPTO_HW_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+}
+
+/**
+ * Releases an engine taken by crypto_hw_lock(), and starts the jobs queued
+ * meanwhile.
+ *
+ * @param engine CRYPTO_HW_AES, CRYPTO_HW_SHA or CRYPTO_HW_PKA
+ */
+void crypto_hw_unlock(int engine)
+{
+    crypto_hw_engine_t *eng = &crypto_hw_engine[engine];
+    int start;
+
+    taskENTER_CRITICAL();
+    eng->holder = NULL;
+    start = (eng->head != NULL);
+    eng->running = start;
+    taskEXIT_CRITICAL();
+
+    xSemaphoreGive(eng->mutex);
+
+    if (start)
+        crypto_hw_next(eng, NULL);
+}
+
+/**
+ * Queues a job on an engine, it is started at once if the engine is idle.
+ * The job must stay in place until it ends.
+ *
+ * @param engine CRYPTO_HW_AES or CRYPTO_HW_SHA
+ * @param job start() and done() callbacks and their argument, the rest is
+ *            set here
+ */
+void crypto_hw_submit(int engine, crypto_hw_job_t *job)
+{
+    crypto_hw_engine_t *eng = &crypto_hw_engine[engine];
+    int start;
+
+    job->next = NULL;
+    job->task = xTaskGetCurrentTaskHandle();
+    job->status = 1;
+
+    taskENTER_CRITICAL();
+    if (eng->tail != NULL)
+        eng->tail->next = job;
+    else
+        eng->head = job;
+    eng->tail = job;
+
+    start = (!eng->running && (eng->holder == NULL));
+    if (start)
+        eng->running = 1;
+    taskEXIT_CRITICAL();
+
+    if (start)
+        crypto_hw_next(eng, NULL);
+}
+
+/**
+ * Waits for a job submitted without done() callback by this task.
+ *
+ * @param job the job
+ * @return 0 on success, -1 on engine failure
+ */
+int crypto_hw_job_wait(crypto_hw_job_t *job)
+{
+    while (job->status > 0)
+        ulTaskNotifyTakeIndexed(CRYPTO_HW_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+
+    return job->status;
+}
+
+/**
+ * Tells if the engine can transfer straight between two caller buffers.
+ * The output must own whole cache lines, or invalidating it could drop
+ * data the CPU wrote next to it.
+ *
+ * @return 1 if in and out can be handed to the DMA as they are
+ */
+int crypto_hw_dma_direct(const void *in, const void *out, size_t len)
+{
+    /* The DMA takes 32-bit word aligned addresses, see ptr_to_u32() */
+    if (((uint64_t)in & 3) || (((uint64_t)out | len) & (CRYPTO_HW_LINE - 1)))
+        return 0;
+
+    return 1;
+}
+
+/**
+ * Cache maintenance before the engine reads in and writes out.
+ *
+ * @param in data read by the engine, may be NULL
+ * @param out buffer written by the engine, cache line aligned, may be NULL
+ * @param len number of bytes
+ */
+void crypto_hw_dma_prepare(const void *in, void *out, size_t len)
+{
+    if (in != NULL)
+        dcache_clean_by_mva(in, len);
+    /* no dirty line may be evicted on top of the engine output */
+    if ((out != NULL) && (out != in))
+        dcache_clean_invalidate_by_mva(out, len);
+}
+
+/**
+ * Cache maintenance once the engine has written out.
+ *
+ * @param out buffer written by the engine, cache line aligned
+ * @param len number of bytes
+ */
+void crypto_hw_dma_complete(void *out, size_t len)
+{
+    dcache_invalidate_by_mva(out, len);
+}
+
+/* Position in the byte stream of a segment list */
+typedef struct crypto_hw_sg_pos
+{
+    const crypto_hw_seg_t *seg;
+    int nseg;
+    size_t off;                         /* into seg[0] */
+}
+crypto_hw_sg_pos_t;
+
+static size_t crypto_hw_sg_total(const crypto_hw_seg_t *seg, int nseg)
+{
+    size_t total = 0;
+
+    while (nseg-- > 0)
+        total += (seg++)->len;
+    return total;
+}
+
+/* Moves to the next segment with data left */
+static void crypto_hw_sg_settle(crypto_hw_sg_pos_t *pos)
+{
+    while ((pos->nseg > 0) && (pos->off == pos->seg->len))
+    {
+        pos->seg++;
+        pos->nseg--;
+        pos->off = 0;
+    }
+}
+
+static void crypto_hw_sg_skip(crypto_hw_sg_pos_t *pos, size_t n)
+{
+    size_t chunk;
+
+    while (n != 0)
+    {
+        crypto_hw_sg_settle(pos);
+        chunk = pos->seg->len - pos->off;
+        if (chunk > n)
+            chunk = n;
+        pos->off += chunk;
+        n -= chunk;
+    }
+}
+
+/* Copies n bytes of the stream into buf, from the input or the output side */
+static void crypto_hw_sg_read(crypto_hw_sg_pos_t *pos, void *buf, size_t n, int out)
+{
+    const unsigned char *src;
+    size_t chunk;
+
+    while (n != 0)
+    {
+        crypto_hw_sg_settle(pos);
+        src = (const unsigned char *)(out ? pos->seg->out : pos->seg->in) + pos->off;
+        chunk = pos->seg->len - pos->off;
+        if (chunk > n)
+            chunk = n;
+        memcpy(buf, src, chunk);
+        buf = (unsigned char *)buf + chunk;
+        pos->off += chunk;
+        n -= chunk;
+    }
+}
+
+/* Copies n bytes of buf to the output side of the stream */
+static void crypto_hw_sg_write(crypto_hw_sg_pos_t *pos, const void *buf, size_t n)
+{
+    size_t chunk;
+
+    while (n != 0)
+    {
+        crypto_hw_sg_settle(pos);
+        chunk = pos->seg->len - pos->off;
+        if (chunk > n)
+            chunk = n;
+        memcpy((unsigned char *)pos->seg->out + pos->off, buf, chunk);
+        buf = (const unsigned char *)buf + chunk;
+        pos->off += chunk;
+        n -= chunk;
+    }
+}
+
+/*
+ * Bytes the DMA can take in place from the current segment, at most left and
+ * a multiple of unit (a power of 2), 0 if it must go through a bounce buffer.
+ * With out the output must be usable too, see crypto_hw_dma_direct().
+ */
+static size_t crypto_hw_sg_direct(crypto_hw_sg_pos_t *pos, size_t left, size_t unit, int out)
+{
+    const unsigned char *in;
+    size_t n;
+
+    crypto_hw_sg_settle(pos);
+    if (pos->nseg == 0)
+        return 0;
+
+    n = pos->seg->len - pos->off;
+    if (n > left)
+        n = left;
+    n &= ~(unit - 1);
+    in = (const unsigned char *)pos->seg->in + pos->off;
+
+    if ((n == 0) || ((uint64_t)in & 3))
+        return 0;
+    if (out && !crypto_hw_dma_direct(in, (unsigned char *)pos->seg->out + pos->off, n))
+        return 0;
+    return n;
+}
+
+/*
+ * Fills a bounce buffer of size bytes from the stream, with blocks that
+ * straddle segments or lie in buffers the DMA cannot use. Stops at a block
+ * boundary where the rest can go in place again. Returns the bytes taken, a
+ * multiple of block unless the stream ends.
+ */
+static size_t crypto_hw_sg_gather(crypto_hw_sg_pos_t *pos, unsigned char *buf, size_t size,
+                                  size_t left, size_t block, size_t unit, int out)
+{
+    size_t n = 0, chunk;
+
+    while ((n < left) && (n < size))
+    {
+        if ((n & (block - 1)) == 0)
+        {
+            if ((n != 0) && (crypto_hw_sg_direct(pos, left - n, unit, out) != 0))
+                break;
+            chunk = size - n;
+        }
+        else
+        {
+            /* up to the block boundary, where the next check is */
+            chunk = block - (n & (block - 1));
+        }
+        if (chunk > left - n)
+            chunk = left - n;
+
+        crypto_hw_sg_settle(pos);
+        if (chunk > pos->seg->len - pos->off)
+            chunk = pos->seg->len - pos->off;
+        crypto_hw_sg_read(pos, buf + n, chunk, 0);
+        n += chunk;
+    }
+    return n;
+}
+
+/**
+ * Encrypts or decrypts a message spread over several buffers, e.g. the
+ * payloads of a pbuf chain, as one DMA cascade on the AES engine. Segments
+ * are used in place where the DMA allows it, the rest and the blocks that
+ * straddle two segments go through a bounce buffer.
+ *
+ * @param opmode AES_MODE_ECB, AES_MODE_CBC, AES_MODE_CFB or AES_MODE_CTR
+ * @param encrypt 1 to encrypt, 0 to decrypt
+ * @param keys key as big-endian words, as for AES_SetKey()
+ * @param keysize AES_KEY_SIZE_128, AES_KEY_SIZE_192 or AES_KEY_SIZE_256
+ * @param iv IV or counter block, may be NULL for ECB. It is updated for a
+ *           following request as mbedtls does; after a partial final CTR
+ *           block it holds the next unused counter.
+ * @param seg segments, the output of each may be its input
+ * @param nseg number of segments
+ * @return 0 on success, -1 if ECB, CBC or CFB is given partial blocks, if
+ *         the low word of the CTR counter would wrap, or on engine failure
+ */
+int crypto_hw_aes_sg(uint32_t opmode, int encrypt, const uint32_t keys[8], uint32_t keysize,
+                     unsigned char iv[16], const crypto_hw_seg_t *seg, int nseg)
+{
+    crypto_hw_sg_pos_t pos = { seg, nseg, 0 }, at;
+    size_t total = crypto_hw_sg_total(seg, nseg), left, n, len;
+    uint32_t ivw[4], ctr, dma_mode;
+    unsigned char last[16];
+    const void *src;
+    void *dst;
+    int i, chain, first = 1, ret = 0;
+
+    if (total == 0)
+        return 0;
+    /* the CFB state after a partial block is part key stream, which
+     * mbedtls_aes_crypt_cfb128() keeps with an offset this call has not */
+    if ((opmode != AES_MODE_CTR) && (total & 15))
+        return -1;
+
+    if (opmode == AES_MODE_CTR)
+    {
+        /* the engine may only count in the low word */
+        ctr = ((uint32_t)iv[12] << 24) | ((uint32_t)iv[13] << 16) | ((uint32_t)iv[14] << 8) | iv[15];
+        if ((uint64_t)ctr + (total + 15) / 16 > 0x100000000ULL)
+            return -1;
+    }
+
+    /* the next IV of a decryption is the last cipher block, which an
+     * in-place request overwrites */
+    chain = (opmode == AES_MODE_CBC) || (opmode == AES_MODE_CFB);
+    if (chain && !encrypt)
+    {
+        at = pos;
+        crypto_hw_sg_skip(&at, total - 16);
+        crypto_hw_sg_read(&at, last, 16, 0);
+    }
+
+    crypto_hw_lock(CRYPTO_HW_AES);
+
+    AES_Open(CRPT, encrypt ? AES_MODE_ENCRYPT : AES_MODE_DECRYPT, opmode, keysize,
+             AES_IN_OUT_SWAP);
+    AES_SetKey(CRPT, (uint32_t *)keys, keysize);
+    if (opmode != AES_MODE_ECB)
+    {
+        for (i = 0; i < 4; i++)
+            ivw[i] = ((uint32_t)iv[i * 4] << 24) | ((uint32_t)iv[i * 4 + 1] << 16) |
+                     ((uint32_t)iv[i * 4 + 2] << 8) | iv[i * 4 + 3];
+        AES_SetInitVect(CRPT, ivw);
+    }
+
+    for (left = total; (ret == 0) && (left != 0); left -= n)
+    {
+        at = pos;
+        n = crypto_hw_sg_direct(&pos, left, CRYPTO_HW_LINE, 1);
+        if (n != 0)
+        {
+            src = (const unsigned char *)pos.seg->in + pos.off;
+            dst = (unsigned char *)pos.seg->out + pos.off;
+            crypto_hw_sg_skip(&pos, n);
+            len = n;
+        }
+        else
+        {
+            n = crypto_hw_sg_gather(&pos, aes_sg_buf, sizeof(aes_sg_buf), left, 16,
+                                    CRYPTO_HW_LINE, 1);
+            /* a partial CTR block at the end is padded, only its own
+             * bytes are kept */
+            len = (n + 15) & ~(size_t)15;
+            memset(aes_sg_buf + n, 0, len - n);
+            src = dst = aes_sg_buf;
+        }
+
+        if (n == left)
+            dma_mode = first ? CRYPTO_DMA_ONE_SHOT : CRYPTO_DMA_LAST;
+        else
+            dma_mode = first ? CRYPTO_DMA_FIRST : CRYPTO_DMA_CONTINUE;
+        first = 0;
+
+        crypto_hw_dma_prepare(src, dst, len);
+        AES_SetDMATransfer(CRPT, 0, 0, ptr_to_u32(src), ptr_to_u32(dst), len);
+        ret = AES_Start(CRPT, 0, dma_mode);
+        crypto_hw_dma_complete(dst, len);
+
+        if ((ret == 0) && (dst == aes_sg_buf))
+            crypto_hw_sg_write(&at, aes_sg_buf, n);
+    }
+
+    crypto_hw_unlock(CRYPTO_HW_AES);
+
+    if (ret != 0)
+        return -1;
+
+    if (opmode == AES_MODE_CTR)
+    {
+        /* 128-bit add, the last block may have used counter 0xffffffff */
+        n = (total + 15) / 16;
+        for (i = 15; (i >= 0) && (n != 0); i--)
+        {
+            n += iv[i];
+            iv[i] = (unsigned char)n;
+            n >>= 8;
+        }
+    }
+    else if (chain)
+    {
+        if (encrypt)
+        {
+            at.seg = seg;
+            at.nseg = nseg;
+            at.off = 0;
+            crypto_hw_sg_skip(&at, total - 16);
+            crypto_hw_sg_read(&at, last, 16, 1);
+        }
+        memcpy(iv, last, 16);
+    }
+    return 0;
+}
+
+/**
+ * Starts a digest on the SHA engine.
+ *
+ * @param sha digest state
+ * @param mode SHA_MODE_SHA1, SHA_MODE_SHA224, SHA_MODE_SHA256, SHA_MODE_SHA384
+ *             or SHA_MODE_SHA512
+ * @param block block size of the algorithm in bytes
+ * @param dgst_len digest size in bytes
+ */
+void crypto_hw_sha_starts(crypto_hw_sha_t *sha, uint32_t mode, uint32_t block, uint32_t dgst_len)
+{
+    sha->mode = mode;
+    sha->block = block;
+    sha->dgst_len = dgst_len;
+    sha->started = 0;
+    sha->buf_len = 0;
+}
+
+/* Place of a DMA in the run of one digest on the engine under one lock */
+#define SHA_RUN_RESUME      1   /* first DMA, the state comes from the context */
+#define SHA_RUN_SUSPEND     2   /* last DMA before unlocking, the state goes back to it */
+#define SHA_RUN_FINAL       4   /* last DMA of the message, the digest is read */
+
+/*
+ * Hashes len bytes of data, a multiple of the block size unless this is the
+ * final DMA. Between the DMA of one run the state stays on the engine as a
+ * cascade, it only moves through sha_fdbck from and to the context at the
+ * ends of the run. Called with the SHA engine locked.
+ */
+static int crypto_hw_sha_run(crypto_hw_sha_t *sha, const void *data, size_t len,
+                             int flags, uint32_t digest[16])
+{
+    int load = (flags & SHA_RUN_RESUME) && sha->started;
+    int save = (flags & (SHA_RUN_SUSPEND | SHA_RUN_FINAL)) == SHA_RUN_SUSPEND;
+    uint32_t dma_mode;
+
+    SHA_Open(CRPT, sha->mode, SHA_IN_SWAP, 0);
+
+    if (sha->started)
+        dma_mode = (flags & SHA_RUN_FINAL) ? CRYPTO_DMA_LAST : CRYPTO_DMA_CONTINUE;
+    else
+        dma_mode = (flags & SHA_RUN_FINAL) ? CRYPTO_DMA_ONE_SHOT : CRYPTO_DMA_FIRST;
+
+    if (load)
+        memcpy(sha_fdbck, sha->fdbck, sizeof(sha_fdbck));
+    SHA_SetFeedback(CRPT, load ? ptr_to_u32(sha_fdbck) : 0, save ? ptr_to_u32(sha_fdbck) : 0);
+
+    /* the engine reads the saved state and writes the new one */
+    crypto_hw_dma_prepare(data, NULL, len);
+    if (load || save)
+        crypto_hw_dma_prepare(NULL, sha_fdbck, sizeof(sha_fdbck));
+
+    SHA_SetDMATransfer(CRPT, ptr_to_u32(data), len);
+    if (SHA_Start(CRPT, dma_mode) != 0)
+        return -1;
+
+    if (flags & SHA_RUN_FINAL)
+    {
+        SHA_Read(CRPT, digest);
+        return 0;
+    }
+
+    if (save)
+    {
+        crypto_hw_dma_complete(sha_fdbck, sizeof(sha_fdbck));
+        memcpy(sha->fdbck, sha_fdbck, sizeof(sha_fdbck));
+    }
+    sha->started = 1;
+    return 0;
+}
+
+/**
+ * Adds input spread over several buffers to a digest, as one DMA cascade.
+ * Short input is only buffered, the engine is fed whole blocks, straight
+ * from word aligned segments and through a bounce buffer for the rest, and
+ * the final bytes are always kept for crypto_hw_sha_finish().
+ *
+ * @param sha digest state
+ * @param seg segments, their out is not used
+ * @param nseg number of segments
+ * @return 0 on success, -1 on engine failure
+ */
+int crypto_hw_sha_update_sg(crypto_hw_sha_t *sha, const crypto_hw_seg_t *seg, int nseg)
+{
+    crypto_hw_sg_pos_t pos = { seg, nseg, 0 };
+    unsigned char *buf = (unsigned char *)sha->buf;
+    size_t total = crypto_hw_sg_total(seg, nseg), left, n;
+    const void *src;
+    int flags = SHA_RUN_RESUME, ret = 0;
+
+    if (sha->buf_len + total <= CRYPTO_HW_SHA_BUF_SIZE)
+    {
+        crypto_hw_sg_read(&pos, buf + sha->buf_len, total, 0);
+        sha->buf_len += total;
+        return 0;
+    }
+
+    /* bytes of the segments hashed now, 1 to block bytes are held back */
+    left = ((sha->buf_len + total - 1) / sha->block) * sha->block - sha->buf_len;
+
+    /* round the buffer up to whole blocks, it goes first */
+    n = (sha->block - (sha->buf_len & (sha->block - 1))) & (sha->block - 1);
+    crypto_hw_sg_read(&pos, buf + sha->buf_len, n, 0);
+    sha->buf_len += n;
+    total -= n;
+    left -= n;
+
+    crypto_hw_lock(CRYPTO_HW_SHA);
+
+    if (sha->buf_len != 0)
+    {
+        ret = crypto_hw_sha_run(sha, buf, sha->buf_len,
+                                flags | ((left == 0) ? SHA_RUN_SUSPEND : 0), NULL);
+        flags = 0;
+        sha->buf_len = 0;
+    }
+
+    for (; (ret == 0) && (left != 0); left -= n, total -= n)
+    {
+        n = crypto_hw_sg_direct(&pos, left, sha->block, 0);
+        if (n != 0)
+        {
+            src = (const unsigned char *)pos.seg->in + pos.off;
+            crypto_hw_sg_skip(&pos, n);
+        }
+        else
+        {
+            n = crypto_hw_sg_gather(&pos, (unsigned char *)sha_dma_buf, sizeof(sha_dma_buf),
+                                    left, sha->block, sha->block, 0);
+            src = sha_dma_buf;
+        }
+
+        ret = crypto_hw_sha_run(sha, src, n, flags | ((n == left) ? SHA_RUN_SUSPEND : 0), NULL);
+        flags = 0;
+    }
+
+    crypto_hw_unlock(CRYPTO_HW_SHA);
+
+    if (ret == 0)
+    {
+        crypto_hw_sg_read(&pos, buf, total, 0);
+        sha->buf_len = total;
+    }
+    return ret;
+}
+
+/**
+ * Adds input to a digest, see crypto_hw_sha_update_sg().
+ *
+ * @param sha digest state
+ * @param input data to hash
+ * @param ilen length of input in bytes
+ * @return 0 on success, -1 on engine failure
+ */
+int crypto_hw_sha_update(crypto_hw_sha_t *sha, const unsigned char *input, size_t ilen)
+{
+    crypto_hw_seg_t seg;
+
+    seg.in = input;
+    seg.out = NULL;
+    seg.len = ilen;
+    return crypto_hw_sha_update_sg(sha, &seg, 1);
+}
+
+/**
+ * Completes a digest. At least one byte must have been hashed, the engine
+ * cannot produce the digest of an empty message.
+ *
+ * @param sha digest state
+ * @param output dgst_len bytes of digest
+ * @return 0 on success, -1 on engine failure
+ */
+int crypto_hw_sha_finish(crypto_hw_sha_t *sha, unsigned char *output)
+{
+    uint32_t digest[16];
+    int ret;
+
+    crypto_hw_lock(CRYPTO_HW_SHA);
+    ret = crypto_hw_sha_run(sha, sha->buf, sha->buf_len, SHA_RUN_RESUME | SHA_RUN_FINAL, digest);
+    crypto_hw_unlock(CRYPTO_HW_SHA);
+
+    /* digest words are in message byte order with SHA_IN_SWAP */
+    if (ret == 0)
+        memcpy(output, digest, sha->dgst_len);
+    return ret;
+}
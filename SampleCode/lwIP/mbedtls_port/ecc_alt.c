@@ -0,0 +1,285 @@
+/**************************************************************************//**
+ * @file     ecc_alt.c
+ * @brief    mbedtls ECDSA and ECDH on the CRPT ECC engine
+ *
+ * Numbers go to the engine as big-endian byte arrays through the ECC_xxx_Bin()
+ * functions of the crypto driver. Keys and points coming from outside are
+ * checked in software first, the engine takes them as they are.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "mbedtls/build_info.h"
+
+#if (defined(MBEDTLS_ECDSA_C) && (defined(MBEDTLS_ECDSA_SIGN_ALT) || defined(MBEDTLS_ECDSA_VERIFY_ALT))) || \
+    (defined(MBEDTLS_ECDH_C) && (defined(MBEDTLS_ECDH_GEN_PUBLIC_ALT) || defined(MBEDTLS_ECDH_COMPUTE_SHARED_ALT)))
+
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
+#include "crypto_hw.h"
+#include "ecc_alt.h"
+
+/* Longest coordinate the engine takes, 18 words */
+#define ECC_ALT_MAX_BYTES   72
+
+/*
+ * Curve of the engine for a group, CURVE_UNDEF if the group is done in
+ * software.
+ */
+static E_ECC_CURVE ecc_alt_curve(const mbedtls_ecp_group *grp)
+{
+    if (!crypto_hw_available())
+        return CURVE_UNDEF;
+
+    switch (grp->id)
+    {
+    case MBEDTLS_ECP_DP_SECP256R1:
+        return CURVE_P_256;
+    case MBEDTLS_ECP_DP_SECP384R1:
+        return CURVE_P_384;
+    case MBEDTLS_ECP_DP_SECP521R1:
+        return CURVE_P_521;
+    default:
+        return CURVE_UNDEF;
+    }
+}
+
+#if defined(MBEDTLS_ECDSA_C) && (defined(MBEDTLS_ECDSA_SIGN_ALT) || defined(MBEDTLS_ECDSA_VERIFY_ALT))
+
+/*
+ * Integer of the hashed message as derive_mpi() of ecdsa.c, the leftmost
+ * bits of the hash reduced modulo N (SEC1 4.1.3 step 5)
+ */
+static int ecc_alt_derive_mpi(const mbedtls_ecp_group *grp, mbedtls_mpi *x,
+                              const unsigned char *buf, size_t blen)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t n_size = (grp->nbits + 7) / 8;
+    size_t use_size = blen > n_size ? n_size : blen;
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(x, buf, use_size));
+    if (use_size * 8 > grp->nbits)
+        MBEDTLS_MPI_CHK(mbedtls_mpi_shift_r(x, use_size * 8 - grp->nbits));
+
+    if (mbedtls_mpi_cmp_mpi(x, &grp->N) >= 0)
+        MBEDTLS_MPI_CHK(mbedtls_mpi_sub_mpi(x, x, &grp->N));
+
+cleanup:
+    return ret;
+}
+
+#endif /* MBEDTLS_ECDSA_C && (MBEDTLS_ECDSA_SIGN_ALT || MBEDTLS_ECDSA_VERIFY_ALT) */
+
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_ECDSA_SIGN_ALT)
+
+/* ecdsa.c only builds this along with the software signature */
+int mbedtls_ecdsa_can_do(mbedtls_ecp_group_id gid)
+{
+    return mbedtls_ecdsa_sw_can_do(gid);
+}
+
+int mbedtls_ecdsa_sign(mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
+                       const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
+                       int (*f_rng)(void *, unsigned char *, size_t), void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char msg[ECC_ALT_MAX_BYTES], key[ECC_ALT_MAX_BYTES], nonce[ECC_ALT_MAX_BYTES];
+    unsigned char sig_r[ECC_ALT_MAX_BYTES], sig_s[ECC_ALT_MAX_BYTES];
+    E_ECC_CURVE curve;
+    mbedtls_mpi k, e;
+    size_t len;
+    int tries;
+
+    curve = ecc_alt_curve(grp);
+    if (curve == CURVE_UNDEF)
+        return mbedtls_ecdsa_sw_sign(grp, r, s, d, buf, blen, f_rng, p_rng);
+
+    /* Make sure d is in range 1..n-1 */
+    if (mbedtls_mpi_cmp_int(d, 1) < 0 || mbedtls_mpi_cmp_mpi(d, &grp->N) >= 0)
+        return MBEDTLS_ERR_ECP_INVALID_KEY;
+
+    len = (size_t)ECC_GetCurveBytes(curve);
+    mbedtls_mpi_init(&k);
+    mbedtls_mpi_init(&e);
+
+    MBEDTLS_MPI_CHK(ecc_alt_derive_mpi(grp, &e, buf, blen));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&e, msg, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(d, key, len));
+
+    /* a new k as long as r or s comes out zero */
+    tries = 0;
+    do
+    {
+        if (tries++ > 10)
+        {
+            ret = MBEDTLS_ERR_ECP_RANDOM_FAILED;
+            goto cleanup;
+        }
+
+        MBEDTLS_MPI_CHK(mbedtls_ecp_gen_privkey(grp, &k, f_rng, p_rng));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&k, nonce, len));
+
+        crypto_hw_lock(CRYPTO_HW_PKA);
+        ret = ECC_GenerateSignature_Bin(CRPT, curve, msg, key, nonce, sig_r, sig_s);
+        crypto_hw_unlock(CRYPTO_HW_PKA);
+        if (ret != 0)
+        {
+            ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+            goto cleanup;
+        }
+
+        MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(r, sig_r, len));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(s, sig_s, len));
+    }
+    while (mbedtls_mpi_cmp_int(r, 0) == 0 || mbedtls_mpi_cmp_int(s, 0) == 0);
+
+cleanup:
+    mbedtls_platform_zeroize(key, sizeof(key));
+    mbedtls_platform_zeroize(nonce, sizeof(nonce));
+    mbedtls_mpi_free(&k);
+    mbedtls_mpi_free(&e);
+    return ret;
+}
+
+#endif /* MBEDTLS_ECDSA_C && MBEDTLS_ECDSA_SIGN_ALT */
+
+#if defined(MBEDTLS_ECDSA_C) && defined(MBEDTLS_ECDSA_VERIFY_ALT)
+
+int mbedtls_ecdsa_verify(mbedtls_ecp_group *grp, const unsigned char *buf, size_t blen,
+                         const mbedtls_ecp_point *Q, const mbedtls_mpi *r,
+                         const mbedtls_mpi *s)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char msg[ECC_ALT_MAX_BYTES], qx[ECC_ALT_MAX_BYTES], qy[ECC_ALT_MAX_BYTES];
+    unsigned char sig_r[ECC_ALT_MAX_BYTES], sig_s[ECC_ALT_MAX_BYTES];
+    E_ECC_CURVE curve;
+    mbedtls_mpi e;
+    size_t len;
+
+    curve = ecc_alt_curve(grp);
+    if (curve == CURVE_UNDEF)
+        return mbedtls_ecdsa_sw_verify(grp, buf, blen, Q, r, s);
+
+    /* Make sure r and s are in range 1..n-1 */
+    if (mbedtls_mpi_cmp_int(r, 1) < 0 || mbedtls_mpi_cmp_mpi(r, &grp->N) >= 0 ||
+        mbedtls_mpi_cmp_int(s, 1) < 0 || mbedtls_mpi_cmp_mpi(s, &grp->N) >= 0)
+        return MBEDTLS_ERR_ECP_VERIFY_FAILED;
+
+    ret = mbedtls_ecp_check_pubkey(grp, Q);
+    if (ret != 0)
+        return ret;
+
+    len = (size_t)ECC_GetCurveBytes(curve);
+    mbedtls_mpi_init(&e);
+
+    MBEDTLS_MPI_CHK(ecc_alt_derive_mpi(grp, &e, buf, blen));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&e, msg, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&Q->X, qx, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&Q->Y, qy, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(r, sig_r, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(s, sig_s, len));
+
+    crypto_hw_lock(CRYPTO_HW_PKA);
+    ret = ECC_VerifySignature_Bin(CRPT, curve, msg, qx, qy, sig_r, sig_s);
+    crypto_hw_unlock(CRYPTO_HW_PKA);
+
+    if (ret == -2)
+        ret = MBEDTLS_ERR_ECP_VERIFY_FAILED;
+    else if (ret != 0)
+        ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+
+cleanup:
+    mbedtls_mpi_free(&e);
+    return ret;
+}
+
+#endif /* MBEDTLS_ECDSA_C && MBEDTLS_ECDSA_VERIFY_ALT */
+
+#if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECDH_GEN_PUBLIC_ALT)
+
+int mbedtls_ecdh_gen_public(mbedtls_ecp_group *grp, mbedtls_mpi *d, mbedtls_ecp_point *Q,
+                            int (*f_rng)(void *, unsigned char *, size_t), void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char key[ECC_ALT_MAX_BYTES], qx[ECC_ALT_MAX_BYTES], qy[ECC_ALT_MAX_BYTES];
+    E_ECC_CURVE curve;
+    size_t len;
+
+    curve = ecc_alt_curve(grp);
+    if (curve == CURVE_UNDEF)
+        return mbedtls_ecdh_sw_gen_public(grp, d, Q, f_rng, p_rng);
+
+    len = (size_t)ECC_GetCurveBytes(curve);
+
+    MBEDTLS_MPI_CHK(mbedtls_ecp_gen_privkey(grp, d, f_rng, p_rng));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(d, key, len));
+
+    crypto_hw_lock(CRYPTO_HW_PKA);
+    ret = ECC_GeneratePublicKey_Bin(CRPT, curve, key, qx, qy);
+    crypto_hw_unlock(CRYPTO_HW_PKA);
+    if (ret != 0)
+    {
+        ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&Q->X, qx, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&Q->Y, qy, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_lset(&Q->Z, 1));
+
+cleanup:
+    mbedtls_platform_zeroize(key, sizeof(key));
+    return ret;
+}
+
+#endif /* MBEDTLS_ECDH_C && MBEDTLS_ECDH_GEN_PUBLIC_ALT */
+
+#if defined(MBEDTLS_ECDH_C) && defined(MBEDTLS_ECDH_COMPUTE_SHARED_ALT)
+
+int mbedtls_ecdh_compute_shared(mbedtls_ecp_group *grp, mbedtls_mpi *z,
+                                const mbedtls_ecp_point *Q, const mbedtls_mpi *d,
+                                int (*f_rng)(void *, unsigned char *, size_t), void *p_rng)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    unsigned char key[ECC_ALT_MAX_BYTES], qx[ECC_ALT_MAX_BYTES], qy[ECC_ALT_MAX_BYTES];
+    unsigned char secret[ECC_ALT_MAX_BYTES];
+    E_ECC_CURVE curve;
+    size_t len;
+
+    curve = ecc_alt_curve(grp);
+    if (curve == CURVE_UNDEF)
+        return mbedtls_ecdh_sw_compute_shared(grp, z, Q, d, f_rng, p_rng);
+
+    /* the peer point must be on the curve, or the engine leaks d */
+    MBEDTLS_MPI_CHK(mbedtls_ecp_check_privkey(grp, d));
+    MBEDTLS_MPI_CHK(mbedtls_ecp_check_pubkey(grp, Q));
+
+    len = (size_t)ECC_GetCurveBytes(curve);
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(d, key, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&Q->X, qx, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&Q->Y, qy, len));
+
+    crypto_hw_lock(CRYPTO_HW_PKA);
+    ret = ECC_GenerateSecretZ_Bin(CRPT, curve, key, qx, qy, secret);
+    crypto_hw_unlock(CRYPTO_HW_PKA);
+    if (ret != 0)
+    {
+        ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(z, secret, len));
+
+cleanup:
+    mbedtls_platform_zeroize(key, sizeof(key));
+    mbedtls_platform_zeroize(secret, sizeof(secret));
+    return ret;
+}
+
+#endif /* MBEDTLS_ECDH_C && MBEDTLS_ECDH_COMPUTE_SHARED_ALT */
+
+#endif /* ECDSA or ECDH alternative */
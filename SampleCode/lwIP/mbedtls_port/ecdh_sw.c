@@ -0,0 +1,37 @@
+/**************************************************************************//**
+ * @file     ecdh_sw.c
+ * @brief    Software ECDH of mbedtls under the mbedtls_ecdh_sw_ names
+ *
+ * Built from library/ecdh.c for the curves ecc_alt.c leaves in software,
+ * see aes_sw.c.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_ECDH_C) && (defined(MBEDTLS_ECDH_GEN_PUBLIC_ALT) || defined(MBEDTLS_ECDH_COMPUTE_SHARED_ALT))
+
+#undef MBEDTLS_ECDH_GEN_PUBLIC_ALT
+#undef MBEDTLS_ECDH_COMPUTE_SHARED_ALT
+#undef MBEDTLS_SELF_TEST
+
+#define mbedtls_ecdh_can_do                 mbedtls_ecdh_sw_can_do
+#define mbedtls_ecdh_gen_public             mbedtls_ecdh_sw_gen_public
+#define mbedtls_ecdh_compute_shared         mbedtls_ecdh_sw_compute_shared
+#define mbedtls_ecdh_init                   mbedtls_ecdh_sw_init
+#define mbedtls_ecdh_setup                  mbedtls_ecdh_sw_setup
+#define mbedtls_ecdh_free                   mbedtls_ecdh_sw_free
+#define mbedtls_ecdh_enable_restart         mbedtls_ecdh_sw_enable_restart
+#define mbedtls_ecdh_make_params            mbedtls_ecdh_sw_make_params
+#define mbedtls_ecdh_read_params            mbedtls_ecdh_sw_read_params
+#define mbedtls_ecdh_get_params             mbedtls_ecdh_sw_get_params
+#define mbedtls_ecdh_make_public            mbedtls_ecdh_sw_make_public
+#define mbedtls_ecdh_read_public            mbedtls_ecdh_sw_read_public
+#define mbedtls_ecdh_calc_secret            mbedtls_ecdh_sw_calc_secret
+#define mbedtls_ecdh_tls13_make_params      mbedtls_ecdh_sw_tls13_make_params
+#define mbedtls_ecdh_tls13_read_public      mbedtls_ecdh_sw_tls13_read_public
+#define mbedtls_ecdh_setup_no_everest       mbedtls_ecdh_sw_setup_no_everest
+
+#include "ecdh.c"
+
+#endif /* MBEDTLS_ECDH_C && (MBEDTLS_ECDH_GEN_PUBLIC_ALT || MBEDTLS_ECDH_COMPUTE_SHARED_ALT) */
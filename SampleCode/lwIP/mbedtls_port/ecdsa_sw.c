@@ -0,0 +1,35 @@
+/**************************************************************************//**
+ * @file     ecdsa_sw.c
+ * @brief    Software ECDSA of mbedtls under the mbedtls_ecdsa_sw_ names
+ *
+ * Built from library/ecdsa.c for the curves ecc_alt.c leaves in software,
+ * see aes_sw.c.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_ECDSA_C) && (defined(MBEDTLS_ECDSA_SIGN_ALT) || defined(MBEDTLS_ECDSA_VERIFY_ALT))
+
+#undef MBEDTLS_ECDSA_SIGN_ALT
+#undef MBEDTLS_ECDSA_VERIFY_ALT
+#undef MBEDTLS_SELF_TEST
+
+#define mbedtls_ecdsa_can_do                        mbedtls_ecdsa_sw_can_do
+#define mbedtls_ecdsa_sign                          mbedtls_ecdsa_sw_sign
+#define mbedtls_ecdsa_sign_det_ext                  mbedtls_ecdsa_sw_sign_det_ext
+#define mbedtls_ecdsa_verify                        mbedtls_ecdsa_sw_verify
+#define mbedtls_ecdsa_write_signature               mbedtls_ecdsa_sw_write_signature
+#define mbedtls_ecdsa_write_signature_restartable   mbedtls_ecdsa_sw_write_signature_restartable
+#define mbedtls_ecdsa_read_signature                mbedtls_ecdsa_sw_read_signature
+#define mbedtls_ecdsa_read_signature_restartable    mbedtls_ecdsa_sw_read_signature_restartable
+#define mbedtls_ecdsa_genkey                        mbedtls_ecdsa_sw_genkey
+#define mbedtls_ecdsa_from_keypair                  mbedtls_ecdsa_sw_from_keypair
+#define mbedtls_ecdsa_init                          mbedtls_ecdsa_sw_init
+#define mbedtls_ecdsa_free                          mbedtls_ecdsa_sw_free
+#define mbedtls_ecdsa_restart_init                  mbedtls_ecdsa_sw_restart_init
+#define mbedtls_ecdsa_restart_free                  mbedtls_ecdsa_sw_restart_free
+
+#include "ecdsa.c"
+
+#endif /* MBEDTLS_ECDSA_C && (MBEDTLS_ECDSA_SIGN_ALT || MBEDTLS_ECDSA_VERIFY_ALT) */
@@ -0,0 +1,215 @@
+/**************************************************************************//**
+ * @file     gcm_alt.c
+ * @brief    mbedtls AES-GCM on the CRPT AES engine (MBEDTLS_GCM_ALT)
+ *
+ * The engine runs GHASH and the counter mode of a whole request in one DMA
+ * pass. It takes the IV, the additional data and the text packed into one
+ * buffer and writes the text back followed by the tag, so requests always
+ * go through gcm_dma_buf. As with aes_alt.c the key is loaded for every
+ * request and contexts are never bound to the engine.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_GCM_C) && defined(MBEDTLS_GCM_ALT)
+
+#include "mbedtls/gcm.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
+#include "crypto_hw.h"
+
+#define GET_UINT32_BE(b, i)     (((uint32_t)(b)[(i)] << 24) | ((uint32_t)(b)[(i) + 1] << 16) | \
+                                 ((uint32_t)(b)[(i) + 2] << 8) | ((uint32_t)(b)[(i) + 3]))
+
+#define GCM_PAD16(n)            (((n) + 15) & ~(size_t)15)
+
+/* IV block, additional data and text in, text and tag out, AES lock held.
+ * The engine writes behind what it reads, so one buffer does for both. */
+static uint8_t gcm_dma_buf[16 + GCM_PAD16(GCM_ALT_HW_MAX_AAD) + GCM_PAD16(GCM_ALT_HW_MAX_LEN)]
+__attribute__((aligned(CRYPTO_HW_LINE)));
+
+/* Whether the engine takes the request, anything else goes to the software,
+ * which also reports the errors */
+static int gcm_hw_usable(mbedtls_gcm_context *ctx, int mode, size_t length,
+                         size_t iv_len, size_t add_len, size_t tag_len)
+{
+    return ctx->use_hw &&
+           ((mode == MBEDTLS_GCM_ENCRYPT) || (mode == MBEDTLS_GCM_DECRYPT)) &&
+           (iv_len == 12) && (tag_len >= 4) && (tag_len <= 16) &&
+           (length >= GCM_ALT_HW_MIN_LEN) && (length <= GCM_ALT_HW_MAX_LEN) &&
+           (add_len <= GCM_ALT_HW_MAX_AAD) && crypto_hw_available();
+}
+
+/*
+ * Encrypts or decrypts length bytes and computes the full 16-byte tag over
+ * the additional data and the cipher text.
+ */
+static int gcm_hw_run(mbedtls_gcm_context *ctx, int mode, size_t length,
+                      const unsigned char *iv, const unsigned char *add,
+                      size_t add_len, const unsigned char *input,
+                      unsigned char *output, unsigned char tag[16])
+{
+    size_t alen = GCM_PAD16(add_len), plen = GCM_PAD16(length);
+    size_t size = 16 + alen + plen;
+    uint8_t *text = gcm_dma_buf + 16 + alen;
+    int ret;
+
+    crypto_hw_lock(CRYPTO_HW_AES);
+
+    memcpy(gcm_dma_buf, iv, 12);
+    memset(gcm_dma_buf + 12, 0, 4);
+    if (add_len != 0)
+        memcpy(gcm_dma_buf + 16, add, add_len);
+    memset(gcm_dma_buf + 16 + add_len, 0, alen - add_len);
+    memcpy(text, input, length);
+    memset(text + length, 0, plen - length);
+
+    AES_Open(CRPT, (mode == MBEDTLS_GCM_ENCRYPT) ? AES_MODE_ENCRYPT : AES_MODE_DECRYPT,
+             AES_MODE_GCM, ctx->keysize, AES_IN_OUT_SWAP);
+    AES_SetKey(CRPT, ctx->keys, ctx->keysize);
+    AES_SetGCMCount(CRPT, 12, (uint32_t)add_len, (uint32_t)length);
+
+    crypto_hw_dma_prepare(gcm_dma_buf, gcm_dma_buf, size);
+    AES_SetDMATransfer(CRPT, 0, 0, ptr_to_u32(gcm_dma_buf), ptr_to_u32(gcm_dma_buf),
+                       (uint32_t)size);
+    ret = AES_Start(CRPT, 0, CRYPTO_DMA_ONE_SHOT);
+    crypto_hw_dma_complete(gcm_dma_buf, plen + 16);
+
+    if (ret == 0)
+    {
+        memcpy(output, gcm_dma_buf, length);
+        memcpy(tag, gcm_dma_buf + plen, 16);
+    }
+
+    crypto_hw_unlock(CRYPTO_HW_AES);
+
+    return (ret == 0) ? 0 : MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+}
+
+void mbedtls_gcm_init(mbedtls_gcm_context *ctx)
+{
+    memset(ctx, 0, sizeof(mbedtls_gcm_context));
+    mbedtls_gcm_sw_init(&ctx->sw);
+}
+
+void mbedtls_gcm_free(mbedtls_gcm_context *ctx)
+{
+    if (ctx == NULL)
+        return;
+
+    mbedtls_gcm_sw_free(&ctx->sw);
+    mbedtls_platform_zeroize(ctx, sizeof(mbedtls_gcm_context));
+}
+
+int mbedtls_gcm_setkey(mbedtls_gcm_context *ctx, mbedtls_cipher_id_t cipher,
+                       const unsigned char *key, unsigned int keybits)
+{
+    unsigned int i;
+    int ret;
+
+    /* also checks the cipher and the key size */
+    ret = mbedtls_gcm_sw_setkey(&ctx->sw, cipher, key, keybits);
+    if (ret != 0)
+        return ret;
+
+    ctx->use_hw = (cipher == MBEDTLS_CIPHER_ID_AES);
+    if (ctx->use_hw)
+    {
+        for (i = 0; i < keybits / 32; i++)
+            ctx->keys[i] = GET_UINT32_BE(key, i * 4);
+
+        ctx->keysize = (keybits == 128) ? AES_KEY_SIZE_128 :
+                       (keybits == 192) ? AES_KEY_SIZE_192 : AES_KEY_SIZE_256;
+    }
+    return 0;
+}
+
+int mbedtls_gcm_starts(mbedtls_gcm_context *ctx, int mode,
+                       const unsigned char *iv, size_t iv_len)
+{
+    return mbedtls_gcm_sw_starts(&ctx->sw, mode, iv, iv_len);
+}
+
+int mbedtls_gcm_update_ad(mbedtls_gcm_context *ctx,
+                          const unsigned char *add, size_t add_len)
+{
+    return mbedtls_gcm_sw_update_ad(&ctx->sw, add, add_len);
+}
+
+int mbedtls_gcm_update(mbedtls_gcm_context *ctx,
+                       const unsigned char *input, size_t input_length,
+                       unsigned char *output, size_t output_size,
+                       size_t *output_length)
+{
+    return mbedtls_gcm_sw_update(&ctx->sw, input, input_length,
+                                 output, output_size, output_length);
+}
+
+int mbedtls_gcm_finish(mbedtls_gcm_context *ctx,
+                       unsigned char *output, size_t output_size,
+                       size_t *output_length,
+                       unsigned char *tag, size_t tag_len)
+{
+    return mbedtls_gcm_sw_finish(&ctx->sw, output, output_size, output_length,
+                                 tag, tag_len);
+}
+
+int mbedtls_gcm_crypt_and_tag(mbedtls_gcm_context *ctx, int mode, size_t length,
+                              const unsigned char *iv, size_t iv_len,
+                              const unsigned char *add, size_t add_len,
+                              const unsigned char *input, unsigned char *output,
+                              size_t tag_len, unsigned char *tag)
+{
+    unsigned char full_tag[16];
+    int ret;
+
+    if (!gcm_hw_usable(ctx, mode, length, iv_len, add_len, tag_len))
+        return mbedtls_gcm_sw_crypt_and_tag(&ctx->sw, mode, length, iv, iv_len,
+                                            add, add_len, input, output, tag_len, tag);
+
+    ret = gcm_hw_run(ctx, mode, length, iv, add, add_len, input, output, full_tag);
+    if (ret == 0)
+        memcpy(tag, full_tag, tag_len);
+
+    mbedtls_platform_zeroize(full_tag, sizeof(full_tag));
+    return ret;
+}
+
+int mbedtls_gcm_auth_decrypt(mbedtls_gcm_context *ctx, size_t length,
+                             const unsigned char *iv, size_t iv_len,
+                             const unsigned char *add, size_t add_len,
+                             const unsigned char *tag, size_t tag_len,
+                             const unsigned char *input, unsigned char *output)
+{
+    unsigned char check_tag[16];
+    size_t i;
+    int diff, ret;
+
+    if (!gcm_hw_usable(ctx, MBEDTLS_GCM_DECRYPT, length, iv_len, add_len, tag_len))
+        return mbedtls_gcm_sw_auth_decrypt(&ctx->sw, length, iv, iv_len, add, add_len,
+                                           tag, tag_len, input, output);
+
+    ret = gcm_hw_run(ctx, MBEDTLS_GCM_DECRYPT, length, iv, add, add_len,
+                     input, output, check_tag);
+    if (ret != 0)
+        return ret;
+
+    /* Check tag in "constant-time" */
+    for (diff = 0, i = 0; i < tag_len; i++)
+        diff |= tag[i] ^ check_tag[i];
+
+    mbedtls_platform_zeroize(check_tag, sizeof(check_tag));
+
+    if (diff != 0)
+    {
+        mbedtls_platform_zeroize(output, length);
+        return MBEDTLS_ERR_GCM_AUTH_FAILED;
+    }
+
+    return 0;
+}
+
+#endif /* MBEDTLS_GCM_C && MBEDTLS_GCM_ALT */
@@ -0,0 +1,29 @@
+/**************************************************************************//**
+ * @file     gcm_sw.c
+ * @brief    Software GCM of mbedtls under the mbedtls_gcm_sw_ names
+ *
+ * Built from library/gcm.c for gcm_alt.c, see aes_sw.c.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_GCM_C) && defined(MBEDTLS_GCM_ALT)
+
+#undef MBEDTLS_GCM_ALT
+#undef MBEDTLS_SELF_TEST
+
+#define mbedtls_gcm_context             mbedtls_gcm_sw_context
+#define mbedtls_gcm_init                mbedtls_gcm_sw_init
+#define mbedtls_gcm_free                mbedtls_gcm_sw_free
+#define mbedtls_gcm_setkey              mbedtls_gcm_sw_setkey
+#define mbedtls_gcm_starts              mbedtls_gcm_sw_starts
+#define mbedtls_gcm_update_ad           mbedtls_gcm_sw_update_ad
+#define mbedtls_gcm_update              mbedtls_gcm_sw_update
+#define mbedtls_gcm_finish              mbedtls_gcm_sw_finish
+#define mbedtls_gcm_crypt_and_tag       mbedtls_gcm_sw_crypt_and_tag
+#define mbedtls_gcm_auth_decrypt        mbedtls_gcm_sw_auth_decrypt
+
+#include "gcm.c"
+
+#endif /* MBEDTLS_GCM_C && MBEDTLS_GCM_ALT */
@@ -0,0 +1,38 @@
+/**************************************************************************//**
+ * @file     FreeRTOS.h
+ * @brief    Stand-in for the FreeRTOS headers on a Linux host, for the host
+ *           checks of the mbedtls port. There is one task and no scheduler
+ *           switch: crpt_host.c implements the calls crypto_hw.c makes, takes
+ *           the engine interrupt while the task sleeps, and fails a check
+ *           that would block forever.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+
+typedef long            BaseType_t;
+typedef unsigned long   UBaseType_t;
+typedef uint32_t        TickType_t;
+
+typedef void *          TaskHandle_t;
+typedef void *          SemaphoreHandle_t;
+
+#define pdFALSE                     ((BaseType_t)0)
+#define pdTRUE                      ((BaseType_t)1)
+#define portMAX_DELAY               ((TickType_t)0xFFFFFFFFUL)
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES   3
+
+void crpt_host_assert(const char *expr, const char *file, int line);
+#define configASSERT(x)             do { if (!(x)) crpt_host_assert(#x, __FILE__, __LINE__); } while (0)
+
+/* The critical sections mask the interrupt of the engine model */
+void crpt_host_enter_critical(void);
+void crpt_host_exit_critical(void);
+#define taskENTER_CRITICAL()        crpt_host_enter_critical()
+#define taskEXIT_CRITICAL()         crpt_host_exit_critical()
+#define portYIELD_FROM_ISR(x)       ((void)(x))
+
+#endif /* INC_FREERTOS_H */
@@ -0,0 +1,58 @@
+/**************************************************************************//**
+ * @file     NuMicro.h
+ * @brief    Stand-in for the BSP header on a Linux host, for the host checks
+ *           of the mbedtls port (see Makefile.host).
+ *
+ * The crypto driver header of the BSP is used as it is, its functions are
+ * the engine model of crpt_host.c. Caches are coherent and the part is not
+ * an MA35D05K. Host addresses do not fit the 32-bit DMA address registers:
+ * ptr_to_u32() keeps the pointers it converts, and the model finds them
+ * again with crpt_host_ptr().
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUMICRO_H__
+#define __NUMICRO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define sysprintf       printf
+
+#define __I             volatile const
+#define __O             volatile
+#define __IO            volatile
+
+#include "crypto_reg.h"
+
+extern CRPT_T host_crpt;
+#define CRPT            (&host_crpt)
+
+#include "crypto.h"
+
+uint32_t crpt_host_addr(const void *ptr);
+void *crpt_host_ptr(uint32_t addr);
+#define ptr_to_u32(x)   crpt_host_addr((const void *)(x))
+
+int32_t Is_MA35D05K(void);
+
+static inline void dcache_clean_by_mva(void const *addr, size_t len)
+{
+    (void)addr;
+    (void)len;
+}
+
+static inline void dcache_invalidate_by_mva(void const *addr, size_t len)
+{
+    (void)addr;
+    (void)len;
+}
+
+static inline void dcache_clean_invalidate_by_mva(void const *addr, size_t len)
+{
+    (void)addr;
+    (void)len;
+}
+
+#endif /* __NUMICRO_H__ */
@@ -0,0 +1,538 @@
+/**************************************************************************//**
+ * @file     aes_host.c
+ * @brief    Checks the AES alternative of aes_alt.c against the software AES
+ *           of mbedtls on a Linux host, with the engine model of
+ *           crpt_host.c. Build with Makefile.host.
+ *
+ * Runs the mbedtls AES self test with its standard vectors, then random
+ * requests in every mode against mbedtls_aes_sw_xxx(): all key sizes, both
+ * directions, lengths across the bounce buffer, buffers the DMA can use in
+ * place or not, in-place requests, CFB and CTR streams continued over
+ * several calls, and CTR counters about to carry out of the low word. An
+ * engine error must come back as MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED, from
+ * a job of the queue and with the engine locked.
+ *
+ * Then crypto_hw_aes_sg() on its own, ECB, CBC, CFB and CTR against the
+ * software on the same stream: lists of segments of any length, empty ones
+ * too, at cache line aligned, word aligned and odd addresses, each written
+ * in place or elsewhere, so that blocks straddle segments and the cascade
+ * mixes segments the DMA takes in place with the bounce buffer. The IV must
+ * be left as mbedtls leaves it; partial CFB blocks and CTR counters that
+ * would wrap the low word must be refused.
+ *
+ * Then the job queue of crypto_hw.c: jobs of their own with and without a
+ * done() callback, some failing to start or failing on the engine, queued
+ * in between mbedtls requests that lock the engine or are jobs themselves,
+ * or while the check holds the engine.
+ * The interrupts of the engine model come when the task sleeps or leaves a
+ * critical section. Jobs must end once, in order and with their status,
+ * and the engine must never be started before its last run ended.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "NuMicro.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/error.h"
+
+#include "crypto_hw.h"
+#include "crpt_host.h"
+
+#define AESH_MAX_LEN    1100
+#define AESH_LOOPS      4000
+#define AESH_Q_ROUNDS   300
+#define AESH_Q_JOBS     8
+#define AESH_SG_LOOPS   2000
+#define AESH_SG_SEGS    12
+#define AESH_SG_LEN     320
+
+enum { AESH_ECB, AESH_CBC, AESH_CFB128, AESH_CFB8, AESH_OFB, AESH_CTR, AESH_MODES };
+
+static const char *aesh_name[AESH_MODES] = { "ECB", "CBC", "CFB128", "CFB8", "OFB", "CTR" };
+
+static int aesh_reported;
+
+static unsigned char aesh_in[AESH_MAX_LEN + 64] __attribute__((aligned(64)));
+static unsigned char aesh_hw[AESH_MAX_LEN + 64] __attribute__((aligned(64)));
+static unsigned char aesh_sw[AESH_MAX_LEN + 64] __attribute__((aligned(64)));
+
+/* Segment buffers of crypto_hw_aes_sg(), each segment in its own, and the
+ * joined stream for the software */
+static unsigned char aesh_sg_in[AESH_SG_SEGS][AESH_SG_LEN + 64] __attribute__((aligned(64)));
+static unsigned char aesh_sg_out[AESH_SG_SEGS][AESH_SG_LEN + 64] __attribute__((aligned(64)));
+static unsigned char aesh_sg_ref[AESH_SG_SEGS * AESH_SG_LEN];
+
+/* A job of the check: one ECB block set by the engine, see aesh_job_start() */
+typedef struct
+{
+    crypto_hw_job_t job;
+    int fail_start, fail_run;
+    int ended;
+    unsigned char key[16];
+    unsigned char in[64] __attribute__((aligned(64)));
+    unsigned char out[64] __attribute__((aligned(64)));
+}
+aesh_job_t;
+
+static aesh_job_t aesh_job[AESH_Q_JOBS + 1];
+static aesh_job_t *aesh_order[AESH_Q_JOBS + 1];
+static int aesh_ended;
+
+static void aesh_rand(unsigned char *buf, size_t len)
+{
+    while (len--)
+        *buf++ = (unsigned char)rand();
+}
+
+/* Offset of a buffer: cache line aligned, word aligned or odd */
+static size_t aesh_offset(void)
+{
+    static const size_t offs[] = { 0, 0, 4, 7, 32 };
+
+    return offs[rand() % (int)(sizeof(offs) / sizeof(offs[0]))];
+}
+
+/*
+ * One request, then a second one continuing the stream. The stream block of
+ * CTR only counts while the offset is not 0.
+ */
+static int aesh_one(int mode)
+{
+    mbedtls_aes_context hw;
+    mbedtls_aes_sw_context sw;
+    unsigned char key[32], iv_hw[16], iv_sw[16], sb_hw[16], sb_sw[16];
+    unsigned char *in, *out_hw, *out_sw;
+    size_t len, off_hw = 0, off_sw = 0, ioff, ooff;
+    int bits = 128 + 64 * (rand() % 3), dir = rand() % 2, inplace = rand() % 4 == 0;
+    int ret_hw, ret_sw, call, fails = 0;
+
+    aesh_rand(key, sizeof(key));
+    aesh_rand(iv_hw, sizeof(iv_hw));
+    if ((mode == AESH_CTR) && (rand() % 4 == 0))
+        memset(iv_hw + 12, 0xFF, 3 + rand() % 2);
+    memcpy(iv_sw, iv_hw, 16);
+    memset(sb_hw, 0, 16);
+    memset(sb_sw, 0, 16);
+
+    mbedtls_aes_init(&hw);
+    mbedtls_aes_sw_init(&sw);
+    if (!dir && ((mode == AESH_ECB) || (mode == AESH_CBC)))
+    {
+        mbedtls_aes_setkey_dec(&hw, key, bits);
+        mbedtls_aes_sw_setkey_dec(&sw, key, bits);
+    }
+    else
+    {
+        mbedtls_aes_setkey_enc(&hw, key, bits);
+        mbedtls_aes_sw_setkey_enc(&sw, key, bits);
+    }
+
+    for (call = 0; call < 2; call++)
+    {
+        len = (rand() % 8 == 0) ? (size_t)(rand() % 16) : (size_t)(rand() % AESH_MAX_LEN);
+        if (((mode == AESH_ECB) && (len > 16)) || (mode == AESH_CBC))
+            len &= ~(size_t)15;
+        if (mode == AESH_ECB)
+            len = 16;
+
+        ioff = aesh_offset();
+        ooff = inplace ? ioff : aesh_offset();
+        in = aesh_in + ioff;
+        out_hw = inplace ? in : aesh_hw + ooff;
+        out_sw = aesh_sw + ooff;
+        aesh_rand(aesh_in, sizeof(aesh_in));
+        memcpy(out_sw, in, len);
+
+        switch (mode)
+        {
+        case AESH_ECB:
+            ret_hw = mbedtls_aes_crypt_ecb(&hw, dir, in, out_hw);
+            ret_sw = mbedtls_aes_sw_crypt_ecb(&sw, dir, out_sw, out_sw);
+            break;
+        case AESH_CBC:
+            ret_hw = mbedtls_aes_crypt_cbc(&hw, dir, len, iv_hw, in, out_hw);
+            ret_sw = mbedtls_aes_sw_crypt_cbc(&sw, dir, len, iv_sw, out_sw, out_sw);
+            break;
+        case AESH_CFB128:
+            ret_hw = mbedtls_aes_crypt_cfb128(&hw, dir, len, &off_hw, iv_hw, in, out_hw);
+            ret_sw = mbedtls_aes_sw_crypt_cfb128(&sw, dir, len, &off_sw, iv_sw, out_sw, out_sw);
+            break;
+        case AESH_CFB8:
+            ret_hw = mbedtls_aes_crypt_cfb8(&hw, dir, len, iv_hw, in, out_hw);
+            ret_sw = mbedtls_aes_sw_crypt_cfb8(&sw, dir, len, iv_sw, out_sw, out_sw);
+            break;
+        case AESH_OFB:
+            ret_hw = mbedtls_aes_crypt_ofb(&hw, len, &off_hw, iv_hw, in, out_hw);
+            ret_sw = mbedtls_aes_sw_crypt_ofb(&sw, len, &off_sw, iv_sw, out_sw, out_sw);
+            break;
+        default:
+            ret_hw = mbedtls_aes_crypt_ctr(&hw, len, &off_hw, iv_hw, sb_hw, in, out_hw);
+            ret_sw = mbedtls_aes_sw_crypt_ctr(&sw, len, &off_sw, iv_sw, sb_sw, out_sw, out_sw);
+            break;
+        }
+
+        if ((ret_hw != ret_sw) || memcmp(out_hw, out_sw, len) || memcmp(iv_hw, iv_sw, 16) ||
+            (off_hw != off_sw) || ((off_hw != 0) && memcmp(sb_hw, sb_sw, 16)))
+        {
+            fails++;
+            if (aesh_reported++ < 10)
+                printf("%s %d-bit %s, call %d, %u bytes, in +%u, out +%u%s: mismatch\n",
+                       aesh_name[mode], bits, dir ? "encrypt" : "decrypt", call, (unsigned)len,
+                       (unsigned)ioff, (unsigned)ooff, inplace ? " in place" : "");
+            break;
+        }
+    }
+
+    mbedtls_aes_free(&hw);
+    mbedtls_aes_sw_free(&sw);
+    return fails;
+}
+
+/* Length of a segment: some empty, some whole cache lines, the rest odd */
+static size_t aesh_seg_len(void)
+{
+    switch (rand() % 8)
+    {
+    case 0:
+        return 0;
+    case 1:
+    case 2:
+        return 64 * (size_t)(1 + rand() % 4);
+    default:
+        return (size_t)(rand() % (AESH_SG_LEN - 32));
+    }
+}
+
+/*
+ * One scatter-gather request against the software on the joined stream.
+ * partial leaves a CFB stream with a partial block, which must be refused.
+ */
+static int aesh_sg_one(int mode, int partial)
+{
+    static const uint32_t opmode[AESH_MODES] = { AES_MODE_ECB, AES_MODE_CBC, AES_MODE_CFB, 0, 0,
+                                                 AES_MODE_CTR };
+    mbedtls_aes_sw_context sw;
+    crypto_hw_seg_t seg[AESH_SG_SEGS];
+    unsigned char key[32], iv_hw[16], iv_sw[16], iv_in[16], sb[16];
+    uint32_t keyw[8], ctr;
+    size_t total = 0, pos, off = 0, pad, ioff, ooff;
+    int bits = 128 + 64 * (rand() % 3), dir = rand() % 2, nseg = 1 + rand() % AESH_SG_SEGS;
+    int i, ret, refuse, fails = 0;
+
+    aesh_rand(key, sizeof(key));
+    for (i = 0; i < bits / 32; i++)
+        keyw[i] = ((uint32_t)key[i * 4] << 24) | ((uint32_t)key[i * 4 + 1] << 16) |
+                  ((uint32_t)key[i * 4 + 2] << 8) | key[i * 4 + 3];
+    aesh_rand(iv_hw, sizeof(iv_hw));
+    if ((mode == AESH_CTR) && (rand() % 4 == 0))
+        memset(iv_hw + 12, 0xFF, 3);
+    memcpy(iv_in, iv_hw, 16);
+
+    for (i = 0; i < nseg; i++)
+    {
+        seg[i].len = aesh_seg_len();
+        total += seg[i].len;
+    }
+    /* whole blocks but for CTR, or a partial CFB block on purpose */
+    if ((mode != AESH_CTR) && ((total & 15) || partial))
+    {
+        pad = (16 - (total & 15)) & 15;
+        if (partial)
+            pad += 1 + (size_t)(rand() % 15);
+        seg[nseg - 1].len += pad;
+        total += pad;
+    }
+
+    pos = 0;
+    for (i = 0; i < nseg; i++)
+    {
+        ioff = aesh_offset();
+        ooff = aesh_offset();
+        aesh_rand(aesh_sg_in[i], sizeof(aesh_sg_in[i]));
+        seg[i].in = aesh_sg_in[i] + ioff;
+        seg[i].out = (rand() % 3 == 0) ? (void *)(aesh_sg_in[i] + ioff) : aesh_sg_out[i] + ooff;
+        memcpy(aesh_sg_ref + pos, seg[i].in, seg[i].len);
+        pos += seg[i].len;
+    }
+
+    ctr = ((uint32_t)iv_in[12] << 24) | ((uint32_t)iv_in[13] << 16) |
+          ((uint32_t)iv_in[14] << 8) | iv_in[15];
+    refuse = partial ||
+             ((mode == AESH_CTR) && ((uint64_t)ctr + (total + 15) / 16 > 0x100000000ULL));
+
+    ret = crypto_hw_aes_sg(opmode[mode], dir, keyw, (uint32_t)(bits - 128) / 64,
+                           (mode == AESH_ECB) ? NULL : iv_hw, seg, nseg);
+    if (refuse)
+    {
+        fails += (ret != -1) || memcmp(iv_hw, iv_in, 16);
+    }
+    else
+    {
+        mbedtls_aes_sw_init(&sw);
+        if (!dir && ((mode == AESH_ECB) || (mode == AESH_CBC)))
+            mbedtls_aes_sw_setkey_dec(&sw, key, bits);
+        else
+            mbedtls_aes_sw_setkey_enc(&sw, key, bits);
+        memcpy(iv_sw, iv_in, 16);
+        switch (mode)
+        {
+        case AESH_ECB:
+            for (pos = 0; pos < total; pos += 16)
+                mbedtls_aes_sw_crypt_ecb(&sw, dir, aesh_sg_ref + pos, aesh_sg_ref + pos);
+            break;
+        case AESH_CBC:
+            mbedtls_aes_sw_crypt_cbc(&sw, dir, total, iv_sw, aesh_sg_ref, aesh_sg_ref);
+            break;
+        case AESH_CFB128:
+            mbedtls_aes_sw_crypt_cfb128(&sw, dir, total, &off, iv_sw, aesh_sg_ref, aesh_sg_ref);
+            break;
+        default:
+            mbedtls_aes_sw_crypt_ctr(&sw, total, &off, iv_sw, sb, aesh_sg_ref, aesh_sg_ref);
+            break;
+        }
+        mbedtls_aes_sw_free(&sw);
+
+        fails += (ret != 0) || ((mode != AESH_ECB) && memcmp(iv_hw, iv_sw, 16));
+        for (i = 0, pos = 0; i < nseg; pos += seg[i++].len)
+            fails += memcmp(seg[i].out, aesh_sg_ref + pos, seg[i].len) != 0;
+    }
+
+    if (fails && (aesh_reported++ < 10))
+        printf("scatter-gather %s %d-bit %s, %d segments, %u bytes: %s\n", aesh_name[mode], bits,
+               dir ? "encrypt" : "decrypt", nseg, (unsigned)total,
+               refuse ? "not refused" : "mismatch");
+    return fails ? 1 : 0;
+}
+
+/* crypto_hw_aes_sg() in every mode it takes, and an engine error */
+static int aesh_sg(void)
+{
+    static const int modes[] = { AESH_ECB, AESH_CBC, AESH_CFB128, AESH_CTR };
+    crypto_hw_seg_t seg;
+    unsigned char iv[16] = { 0 };
+    uint32_t keyw[8] = { 0 };
+    unsigned long before = crpt_host_aes_runs;
+    int i, mode, fails = 0;
+
+    for (i = 0; i < AESH_SG_LOOPS; i++)
+    {
+        mode = modes[i % 4];
+        fails += aesh_sg_one(mode, (mode == AESH_CFB128) && (rand() % 8 == 0));
+    }
+    printf("scatter-gather: %d requests against software, %lu engine runs\n", AESH_SG_LOOPS,
+           crpt_host_aes_runs - before);
+
+    seg.in = seg.out = aesh_in;
+    seg.len = 256;
+    crpt_host_fail = 1;
+    if ((crypto_hw_aes_sg(AES_MODE_CBC, 1, keyw, AES_KEY_SIZE_128, iv, &seg, 1) != -1) ||
+        crpt_host_fail)
+    {
+        printf("scatter-gather: engine error not returned\n");
+        fails++;
+    }
+    return fails;
+}
+
+/* An engine error must not be taken for a result, in a job or locked */
+static int aesh_fail(int queue)
+{
+    mbedtls_aes_context hw;
+    unsigned char key[16] = { 0 }, iv[16] = { 0 };
+    unsigned long jobs = crpt_host_aes_jobs;
+    int ret;
+
+    mbedtls_aes_init(&hw);
+    mbedtls_aes_setkey_enc(&hw, key, 128);
+    crpt_host_fail = 1;
+    ret = mbedtls_aes_crypt_cbc(&hw, MBEDTLS_AES_ENCRYPT, 256, iv, aesh_in, aesh_hw + (queue ? 0 : 4));
+    mbedtls_aes_free(&hw);
+
+    if ((ret == MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED) && !crpt_host_fail &&
+        ((crpt_host_aes_jobs != jobs) == queue))
+        return 0;
+    printf("engine error %s: returned -0x%04x\n", queue ? "in a job" : "locked", (unsigned)-ret);
+    return 1;
+}
+
+/* crypto_hw_job_t start(): ECB encryption of in to out */
+static int aesh_job_start(crypto_hw_job_t *job)
+{
+    aesh_job_t *j = job->arg;
+    uint32_t key[8];
+    int i;
+
+    if (j->fail_start)
+        return -1;
+
+    for (i = 0; i < 4; i++)
+        key[i] = ((uint32_t)j->key[i * 4] << 24) | ((uint32_t)j->key[i * 4 + 1] << 16) |
+                 ((uint32_t)j->key[i * 4 + 2] << 8) | j->key[i * 4 + 3];
+    AES_Open(CRPT, AES_MODE_ENCRYPT, AES_MODE_ECB, AES_KEY_SIZE_128, AES_IN_OUT_SWAP);
+    AES_SetKey(CRPT, key, AES_KEY_SIZE_128);
+    AES_SetDMATransfer(CRPT, 0, 0, ptr_to_u32(j->in), ptr_to_u32(j->out), sizeof(j->in));
+    crpt_host_fail = j->fail_run;
+    AES_Trigger(CRPT, 0, CRYPTO_DMA_ONE_SHOT);
+    return 0;
+}
+
+/* crypto_hw_job_t done(), from the interrupt */
+static void aesh_job_done(crypto_hw_job_t *job)
+{
+    aesh_job_t *j = job->arg;
+
+    j->ended++;
+    aesh_order[aesh_ended++] = j;
+}
+
+/* An mbedtls request in between the jobs, locked or a job of its own */
+static int aesh_between(void)
+{
+    mbedtls_aes_context hw;
+    mbedtls_aes_sw_context sw;
+    unsigned char key[16], iv_hw[16], iv_sw[16];
+    size_t len = 64 * (1 + rand() % 8), off = (rand() & 1) ? 0 : 4;
+    int fails = 0;
+
+    aesh_rand(key, sizeof(key));
+    aesh_rand(iv_hw, sizeof(iv_hw));
+    memcpy(iv_sw, iv_hw, 16);
+    aesh_rand(aesh_in, len);
+    memcpy(aesh_sw, aesh_in, len);
+
+    mbedtls_aes_init(&hw);
+    mbedtls_aes_sw_init(&sw);
+    mbedtls_aes_setkey_enc(&hw, key, 128);
+    mbedtls_aes_sw_setkey_enc(&sw, key, 128);
+    fails += mbedtls_aes_crypt_cbc(&hw, MBEDTLS_AES_ENCRYPT, len, iv_hw, aesh_in, aesh_hw + off) != 0;
+    mbedtls_aes_sw_crypt_cbc(&sw, MBEDTLS_AES_ENCRYPT, len, iv_sw, aesh_sw, aesh_sw);
+    fails += memcmp(aesh_hw + off, aesh_sw, len) || memcmp(iv_hw, iv_sw, 16);
+    mbedtls_aes_free(&hw);
+    mbedtls_aes_sw_free(&sw);
+
+    if (fails && (aesh_reported++ < 10))
+        printf("queue: request %s between the jobs differs\n", off ? "locked" : "in a job");
+    return fails;
+}
+
+/* Jobs of their own queued in between mbedtls requests */
+static int aesh_queue(void)
+{
+    mbedtls_aes_sw_context sw;
+    unsigned char exp[64];
+    aesh_job_t *j;
+    int round, n, i, k, held, fails = 0;
+
+    for (round = 0; (round < AESH_Q_ROUNDS) && (fails == 0); round++)
+    {
+        n = 1 + rand() % AESH_Q_JOBS;
+        aesh_ended = 0;
+        for (i = 0; i <= n; i++)
+        {
+            j = &aesh_job[i];
+            memset(j, 0, sizeof(*j));
+            aesh_rand(j->key, sizeof(j->key));
+            aesh_rand(j->in, sizeof(j->in));
+            j->job.start = aesh_job_start;
+            /* the last one is waited for, the others call back */
+            j->job.done = (i < n) ? aesh_job_done : NULL;
+            j->job.arg = j;
+            if (i < n)
+            {
+                j->fail_start = rand() % 8 == 0;
+                j->fail_run = !j->fail_start && (rand() % 8 == 0);
+            }
+        }
+
+        /* queued while the check holds the engine, nothing may start */
+        held = rand() % 4 == 0;
+        if (held)
+            crypto_hw_lock(CRYPTO_HW_AES);
+        for (i = 0; i <= n; i++)
+        {
+            if (!held && (rand() % 3 == 0))
+                fails += aesh_between();
+            crypto_hw_submit(CRYPTO_HW_AES, &aesh_job[i].job);
+        }
+        if (held)
+        {
+            crpt_host_idle();
+            fails += (aesh_ended != 0) || (aesh_job[0].job.status != 1);
+            crypto_hw_unlock(CRYPTO_HW_AES);
+        }
+        if (rand() & 1)
+            fails += aesh_between();
+        fails += crypto_hw_job_wait(&aesh_job[n].job) != 0;
+
+        fails += aesh_ended != n;
+        for (i = 0; (i < n) && (i < aesh_ended); i++)
+        {
+            j = &aesh_job[i];
+            fails += (aesh_order[i] != j) || (j->ended != 1) ||
+                     (j->job.status != ((j->fail_start || j->fail_run) ? -1 : 0));
+        }
+        for (i = 0; i <= n; i++)
+        {
+            j = &aesh_job[i];
+            if (j->job.status != 0)
+                continue;
+            mbedtls_aes_sw_init(&sw);
+            mbedtls_aes_sw_setkey_enc(&sw, j->key, 128);
+            for (k = 0; k < 64; k += 16)
+                mbedtls_aes_sw_crypt_ecb(&sw, MBEDTLS_AES_ENCRYPT, j->in + k, exp + k);
+            mbedtls_aes_sw_free(&sw);
+            fails += memcmp(j->out, exp, 64) != 0;
+        }
+        fails += !crpt_host_idle();
+
+        if (fails && (aesh_reported++ < 10))
+            printf("queue: round %d of %d jobs, %d ended\n", round, n + 1, aesh_ended);
+    }
+
+    printf("queue: %d rounds of jobs, %lu engine runs in jobs\n", round, crpt_host_aes_jobs);
+    return fails;
+}
+
+int main(void)
+{
+    unsigned long runs[AESH_MODES], before;
+    int i, mode, fails = 0;
+
+    srand(1);
+
+    before = crpt_host_aes_runs;
+    if (mbedtls_aes_self_test(0) != 0)
+        fails++;
+    printf("self test: %lu engine runs\n", crpt_host_aes_runs - before);
+    if (crpt_host_aes_runs == before)
+        fails++;
+
+    memset(runs, 0, sizeof(runs));
+    for (i = 0; i < AESH_LOOPS; i++)
+    {
+        mode = i % AESH_MODES;
+        before = crpt_host_aes_runs;
+        fails += aesh_one(mode);
+        runs[mode] += crpt_host_aes_runs - before;
+    }
+    for (mode = 0; mode < AESH_MODES; mode++)
+        printf("%-6s %d requests against software, %lu engine runs\n", aesh_name[mode],
+               AESH_LOOPS / AESH_MODES, runs[mode]);
+
+    fails += aesh_fail(1);
+    fails += aesh_fail(0);
+    fails += aesh_sg();
+    fails += aesh_queue();
+
+    if (crpt_host_locked() != 0)
+    {
+        printf("engine left locked\n");
+        fails++;
+    }
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,1103 @@
+/**************************************************************************//**
+ * @file     crpt_host.c
+ * @brief    Software model of the CRPT engine behind the crypto.c driver
+ *           calls, and the FreeRTOS calls of crypto_hw.c, for the host
+ *           checks of the mbedtls port. Build with Makefile.host.
+ *
+ * The engine runs are computed with the software implementations of
+ * mbedtls when they are started, their interrupt is pending until the task
+ * sleeps in ulTaskNotifyTakeIndexed(), or at random when it leaves a
+ * critical section. It goes to the callback crypto_hw.c installed, which
+ * may start the next job of a queue. The model holds the caller to what
+ * the engine takes:
+ *  - the blocking driver calls are only made with a crypto_hw_lock() held,
+ *    AES_Trigger() and SHA_Trigger() come from the jobs of a queue; an
+ *    engine is not started again before the interrupt of its last run
+ *  - the interrupt side only uses the FromISR calls and no critical section
+ *  - AES data is byte swapped in and out (AES_IN_OUT_SWAP), DMA addresses
+ *    are word aligned and come from ptr_to_u32(), lengths are whole blocks
+ *  - a DMA cascade starts with CRYPTO_DMA_FIRST and carries the chaining
+ *    value of the previous run, the IV registers are only loaded by
+ *    CRYPTO_DMA_FIRST and CRYPTO_DMA_ONE_SHOT
+ *  - the CTR counter is the low word of the IV and wraps on its own
+ *  - a GCM run is one shot with its byte counts set after AES_Open(), a
+ *    12-byte IV and the IV, additional data and text each zero padded to
+ *    whole blocks in the source; it writes the text, padded the same way,
+ *    then the tag. GHASH is computed here bit by bit, not by mbedtls.
+ *  - SHA input is byte swapped (SHA_IN_SWAP), word aligned and whole blocks
+ *    but in the last run of a message, which is not empty
+ *  - a SHA cascade goes on from the state of the previous run only while
+ *    the engine keeps it: after a run that saved its state to the feedback
+ *    buffer the state must be loaded back from there
+ *  - ECC points are on the curve and scalars in 1..n-1, the engine does not
+ *    check them
+ *  - RSA operands are below the modulus, and the primes of a CRT run are
+ *    the factors of the modulus
+ * A broken rule ends the check with the place it was found.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+
+#include "NuMicro.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "mbedtls/aes.h"
+#include "mbedtls/sha1.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#include "mbedtls/ecp.h"
+#include "mbedtls/bignum.h"
+
+#include "crypto_hw.h"
+#include "crpt_host.h"
+
+#define CRPT_HOST_ADDRS     64      /* addresses ptr_to_u32() remembers */
+#define CRPT_HOST_MUTEXES   8
+
+CRPT_T host_crpt;
+
+int crpt_host_fail;
+int crpt_host_corrupt;
+unsigned long crpt_host_aes_runs;
+unsigned long crpt_host_sha_runs;
+unsigned long crpt_host_pka_runs;
+unsigned long crpt_host_aes_jobs;
+unsigned long crpt_host_gcm_runs;
+unsigned long crpt_host_sha_jobs;
+
+static CRYPTO_IRQ_CB crpt_irq;
+static CRYPTO_WAIT_CB crpt_wait;
+
+static const void *crpt_addr[CRPT_HOST_ADDRS];
+static int crpt_addr_next;
+
+/* Interrupt status of the runs that ended, until the interrupt is taken,
+ * and the one taken last for the blocking calls */
+static uint32_t crpt_pending;
+static uint32_t crpt_taken;
+static int crpt_in_irq;
+static int crpt_critical;
+
+static uint32_t crpt_notify[configTASK_NOTIFICATION_ARRAY_ENTRIES];
+static int crpt_mutex[CRPT_HOST_MUTEXES];   /* 0 free, 1 created, 2 taken */
+static int crpt_locks;                      /* mutexes taken */
+
+/* AES engine registers and the chaining value kept through a cascade */
+static struct
+{
+    uint32_t encrypt, opmode, keysize, swap;
+    uint32_t key[8], iv[4];
+    uint32_t src, dst, cnt;
+    uint32_t ivcnt, acnt, pcnt;
+    int gcm_count;                  /* AES_SetGCMCount() since AES_Open() */
+    int cascade;
+    uint8_t chain[16];
+}
+crpt_aes;
+
+/* State of a digest, what the model keeps in the feedback buffer */
+typedef struct
+{
+    uint32_t mode;
+    union
+    {
+        mbedtls_sha1_sw_context sha1;
+        mbedtls_sha256_sw_context sha256;
+        mbedtls_sha512_sw_context sha512;
+    } u;
+}
+crpt_sha_state_t;
+
+_Static_assert(sizeof(crpt_sha_state_t) <= CRYPTO_HW_SHA_FDBCK * 4,
+               "the state of a digest must fit the SHA feedback buffer");
+
+/* SHA engine registers and the state kept through a cascade */
+static struct
+{
+    uint32_t mode, swap;
+    uint32_t fbi, fbo;
+    uint32_t src, cnt;
+    int cascade;
+    crpt_sha_state_t state;
+    unsigned char digest[64];
+}
+crpt_sha;
+
+void crpt_host_assert(const char *expr, const char *file, int line)
+{
+    printf("%s:%d: %s\nFAILED\n", file, line, expr);
+    exit(1);
+}
+
+uint32_t crpt_host_addr(const void *ptr)
+{
+    crpt_addr[crpt_addr_next] = ptr;
+    crpt_addr_next = (crpt_addr_next + 1) % CRPT_HOST_ADDRS;
+    return (uint32_t)(uintptr_t)ptr;
+}
+
+/* The latest pointer given to ptr_to_u32() with these low 32 bits */
+void *crpt_host_ptr(uint32_t addr)
+{
+    int i, n;
+
+    if (addr == 0)
+        return NULL;
+
+    for (i = 1; i <= CRPT_HOST_ADDRS; i++)
+    {
+        n = (crpt_addr_next + CRPT_HOST_ADDRS - i) % CRPT_HOST_ADDRS;
+        if ((crpt_addr[n] != NULL) && ((uint32_t)(uintptr_t)crpt_addr[n] == addr))
+            return (void *)crpt_addr[n];
+    }
+
+    configASSERT(!"DMA address not from ptr_to_u32()");
+    return NULL;
+}
+
+static void crpt_put_be(uint8_t *b, const uint32_t *w, int words)
+{
+    int i;
+
+    for (i = 0; i < words * 4; i++)
+        b[i] = (uint8_t)(w[i / 4] >> (24 - 8 * (i % 4)));
+}
+
+#define CRPT_AES_INTS   (CRPT_INTSTS_AESIF_Msk | CRPT_INTSTS_AESEIF_Msk)
+#define CRPT_SHA_INTS   (CRPT_INTSTS_HMACIF_Msk | CRPT_INTSTS_HMACEIF_Msk)
+#define CRPT_PKA_INTS   (CRPT_INTSTS_ECCIF_Msk | CRPT_INTSTS_ECCEIF_Msk | \
+                         CRPT_INTSTS_RSAIF_Msk | CRPT_INTSTS_RSAEIF_Msk)
+#define CRPT_ERR_INTS   (CRPT_INTSTS_AESEIF_Msk | CRPT_INTSTS_HMACEIF_Msk | \
+                         CRPT_INTSTS_ECCEIF_Msk | CRPT_INTSTS_RSAEIF_Msk)
+
+/* The interrupt bits of the engine raising sts */
+static uint32_t crpt_engine_ints(uint32_t sts)
+{
+    if (sts & CRPT_AES_INTS)
+        return CRPT_AES_INTS;
+    if (sts & CRPT_SHA_INTS)
+        return CRPT_SHA_INTS;
+    return CRPT_PKA_INTS;
+}
+
+/* Takes the pending interrupt, unless the task masks it or it is running */
+static void crpt_take_irq(void)
+{
+    static const uint32_t ints[] = { CRPT_AES_INTS, CRPT_SHA_INTS, CRPT_PKA_INTS };
+    uint32_t sts = crpt_pending;
+    int i;
+
+    if ((sts == 0) || crpt_in_irq || crpt_critical)
+        return;
+
+    crpt_pending = 0;
+    for (i = 0; i < 3; i++)
+    {
+        if (sts & ints[i])
+            crpt_taken = (crpt_taken & ~ints[i]) | (sts & ints[i]);
+    }
+    crpt_in_irq = 1;
+    if (crpt_irq != NULL)
+        crpt_irq(sts);
+    crpt_in_irq = 0;
+}
+
+/* An engine run ended with sts, its interrupt is pending */
+static void crpt_end(uint32_t sts)
+{
+    configASSERT(!(crpt_pending & crpt_engine_ints(sts)));
+    crpt_pending |= sts;
+}
+
+/*
+ * The wait of a blocking driver call, until the interrupt of its run has
+ * been taken: the callback crypto_hw.c installed sleeps on the notification
+ * the interrupt gives. 0, or -1 if the run ended with an error.
+ */
+static int crpt_finish(uint32_t ints)
+{
+    while (crpt_pending & ints)
+    {
+        if (crpt_wait != NULL)
+            crpt_wait(ints);
+        else
+            crpt_take_irq();
+    }
+    return (crpt_taken & ints & CRPT_ERR_INTS) ? -1 : 0;
+}
+
+/* End of a run of a blocking driver call */
+static int crpt_done(uint32_t sts)
+{
+    crpt_end(sts);
+    return crpt_finish(crpt_engine_ints(sts));
+}
+
+/* The next engine run fails once after crpt_host_fail is set */
+static int crpt_fail(void)
+{
+    if (!crpt_host_fail)
+        return 0;
+    crpt_host_fail = 0;
+    return 1;
+}
+
+/*---------------------------------------------------------------------------*/
+/* BSP                                                                       */
+/*---------------------------------------------------------------------------*/
+
+int32_t Is_MA35D05K(void)
+{
+    return 0;
+}
+
+void Crypto_Init(void)
+{
+}
+
+void CRYPTO_SetCallback(CRYPTO_IRQ_CB pfnIrq, CRYPTO_WAIT_CB pfnWait)
+{
+    crpt_irq = pfnIrq;
+    crpt_wait = pfnWait;
+}
+
+/*---------------------------------------------------------------------------*/
+/* AES                                                                       */
+/*---------------------------------------------------------------------------*/
+
+void AES_Open(CRPT_T *crpt, uint32_t u32EncDec, uint32_t u32OpMode, uint32_t u32KeySize,
+              uint32_t u32SwapType)
+{
+    (void)crpt;
+    crpt_aes.encrypt = u32EncDec;
+    crpt_aes.opmode = u32OpMode;
+    crpt_aes.keysize = u32KeySize;
+    crpt_aes.swap = u32SwapType;
+    crpt_aes.gcm_count = 0;
+    crpt_aes.cascade = 0;
+}
+
+void AES_SetKey(CRPT_T *crpt, uint32_t au32Keys[], uint32_t u32KeySize)
+{
+    (void)crpt;
+    configASSERT(u32KeySize <= AES_KEY_SIZE_256);
+    memcpy(crpt_aes.key, au32Keys, (4 + 2 * u32KeySize) * 4);
+}
+
+void AES_SetInitVect(CRPT_T *crpt, uint32_t au32IV[])
+{
+    (void)crpt;
+    memcpy(crpt_aes.iv, au32IV, sizeof(crpt_aes.iv));
+}
+
+void AES_SetDMATransfer(CRPT_T *crpt, uint32_t u32FBIAddr, uint32_t u32FBOAddr,
+                        uint32_t u32SrcAddr, uint32_t u32DstAddr, uint32_t u32TransCnt)
+{
+    (void)crpt;
+    configASSERT((u32FBIAddr == 0) && (u32FBOAddr == 0));
+    crpt_aes.src = u32SrcAddr;
+    crpt_aes.dst = u32DstAddr;
+    crpt_aes.cnt = u32TransCnt;
+}
+
+void AES_SetGCMCount(CRPT_T *crpt, uint32_t u32IVCnt, uint32_t u32ACnt, uint32_t u32PCnt)
+{
+    (void)crpt;
+    crpt_aes.ivcnt = u32IVCnt;
+    crpt_aes.acnt = u32ACnt;
+    crpt_aes.pcnt = u32PCnt;
+    crpt_aes.gcm_count = 1;
+}
+
+/* x = x * h in GF(2^128), bit 0 the high bit of byte 0 as GCM has it */
+static void crpt_gf_mul(uint8_t x[16], const uint8_t h[16])
+{
+    uint8_t z[16], v[16];
+    int i, j, lsb;
+
+    memset(z, 0, sizeof(z));
+    memcpy(v, h, sizeof(v));
+    for (i = 0; i < 128; i++)
+    {
+        if (x[i / 8] & (0x80 >> (i % 8)))
+        {
+            for (j = 0; j < 16; j++)
+                z[j] ^= v[j];
+        }
+        lsb = v[15] & 1;
+        for (j = 15; j > 0; j--)
+            v[j] = (uint8_t)((v[j] >> 1) | (v[j - 1] << 7));
+        v[0] >>= 1;
+        if (lsb)
+            v[0] ^= 0xE1;
+    }
+    memcpy(x, z, 16);
+}
+
+/* Adds n bytes of data, zero padded to a block, to the GHASH in y */
+static void crpt_ghash(uint8_t y[16], const uint8_t h[16], const uint8_t *data, uint32_t n)
+{
+    uint32_t i, j;
+
+    for (i = 0; i < n; i += 16)
+    {
+        for (j = 0; (j < 16) && (i + j < n); j++)
+            y[j] ^= data[i + j];
+        crpt_gf_mul(y, h);
+    }
+}
+
+/*
+ * A GCM run on the DMA buffers. The blocks are read in order and each text
+ * block is written before the next is read, so that a source overwritten
+ * by the output shows.
+ */
+static void crpt_aes_gcm(mbedtls_aes_sw_context *sw)
+{
+    uint32_t alen = (crpt_aes.acnt + 15) & ~15U, plen = (crpt_aes.pcnt + 15) & ~15U;
+    uint8_t h[16], j0[16], ctr[16], y[16], blk[16], in[16];
+    const uint8_t *src;
+    uint8_t *dst;
+    uint32_t i, j, n;
+
+    crpt_host_gcm_runs++;
+    configASSERT(crpt_aes.gcm_count);
+    configASSERT(crpt_aes.ivcnt == 12);
+    configASSERT(crpt_aes.cnt == 16 + alen + plen);
+
+    src = crpt_host_ptr(crpt_aes.src);
+    dst = crpt_host_ptr(crpt_aes.dst);
+
+    /* the padding of each part must be zero */
+    for (i = 12; i < 16; i++)
+        configASSERT(src[i] == 0);
+    for (i = crpt_aes.acnt; i < alen; i++)
+        configASSERT(src[16 + i] == 0);
+    for (i = crpt_aes.pcnt; i < plen; i++)
+        configASSERT(src[16 + alen + i] == 0);
+
+    memset(h, 0, sizeof(h));
+    mbedtls_aes_sw_crypt_ecb(sw, MBEDTLS_AES_ENCRYPT, h, h);
+    memcpy(j0, src, 12);
+    j0[12] = j0[13] = j0[14] = 0;
+    j0[15] = 1;
+    memcpy(ctr, j0, 16);
+
+    memset(y, 0, sizeof(y));
+    crpt_ghash(y, h, src + 16, crpt_aes.acnt);
+
+    for (i = 0; i < plen; i += 16)
+    {
+        n = (crpt_aes.pcnt - i < 16) ? crpt_aes.pcnt - i : 16;
+        memcpy(in, src + 16 + alen + i, 16);
+        for (j = 15; (j >= 12) && (++ctr[j] == 0); j--)
+            ;
+        mbedtls_aes_sw_crypt_ecb(sw, MBEDTLS_AES_ENCRYPT, ctr, blk);
+        for (j = 0; j < 16; j++)
+            blk[j] = (j < n) ? (uint8_t)(in[j] ^ blk[j]) : 0;
+        crpt_ghash(y, h, crpt_aes.encrypt ? blk : in, n);
+        memcpy(dst + i, blk, 16);
+    }
+
+    /* bit lengths of the additional data and the text */
+    memset(blk, 0, sizeof(blk));
+    for (j = 0; j < 4; j++)
+    {
+        blk[4 + j] = (uint8_t)((uint64_t)crpt_aes.acnt * 8 >> (24 - 8 * j));
+        blk[12 + j] = (uint8_t)((uint64_t)crpt_aes.pcnt * 8 >> (24 - 8 * j));
+    }
+    blk[3] = (uint8_t)(crpt_aes.acnt >> 29);
+    blk[11] = (uint8_t)(crpt_aes.pcnt >> 29);
+    crpt_ghash(y, h, blk, 16);
+
+    mbedtls_aes_sw_crypt_ecb(sw, MBEDTLS_AES_ENCRYPT, j0, blk);
+    for (j = 0; j < 16; j++)
+        dst[plen + j] = y[j] ^ blk[j];
+}
+
+/* Computes an AES run, its interrupt is left pending */
+static void crpt_aes_run(int is_sm4, uint32_t u32DMAMode)
+{
+    mbedtls_aes_sw_context sw;
+    const uint8_t *src;
+    uint8_t *dst, *v = crpt_aes.chain, key[32], in[16], blk[16];
+    int first, i, j, keybits = 128 + 64 * crpt_aes.keysize;
+    uint32_t ctr;
+
+    configASSERT(!(crpt_pending & CRPT_AES_INTS));
+    configASSERT(!is_sm4);
+    configASSERT(crpt_aes.swap == AES_IN_OUT_SWAP);
+    configASSERT((crpt_aes.opmode == AES_MODE_ECB) || (crpt_aes.opmode == AES_MODE_CBC) ||
+                 (crpt_aes.opmode == AES_MODE_CFB) || (crpt_aes.opmode == AES_MODE_OFB) ||
+                 (crpt_aes.opmode == AES_MODE_CTR) || (crpt_aes.opmode == AES_MODE_GCM));
+    configASSERT(((crpt_aes.src | crpt_aes.dst) & 3) == 0);
+    configASSERT((crpt_aes.cnt != 0) && (crpt_aes.cnt % 16 == 0));
+
+    first = (u32DMAMode == CRYPTO_DMA_ONE_SHOT) || (u32DMAMode == CRYPTO_DMA_FIRST);
+    configASSERT(first || (u32DMAMode == CRYPTO_DMA_CONTINUE) || (u32DMAMode == CRYPTO_DMA_LAST));
+    configASSERT(first == !crpt_aes.cascade);
+    configASSERT((crpt_aes.opmode != AES_MODE_GCM) || (u32DMAMode == CRYPTO_DMA_ONE_SHOT));
+    crpt_aes.cascade = (u32DMAMode == CRYPTO_DMA_FIRST) || (u32DMAMode == CRYPTO_DMA_CONTINUE);
+    if (first)
+        crpt_put_be(v, crpt_aes.iv, 4);
+
+    crpt_host_aes_runs++;
+    if (crpt_fail())
+    {
+        crpt_end(CRPT_INTSTS_AESEIF_Msk);
+        return;
+    }
+
+    crpt_put_be(key, crpt_aes.key, 8);
+    mbedtls_aes_sw_init(&sw);
+    if (!crpt_aes.encrypt && ((crpt_aes.opmode == AES_MODE_ECB) || (crpt_aes.opmode == AES_MODE_CBC)))
+        mbedtls_aes_sw_setkey_dec(&sw, key, keybits);
+    else
+        mbedtls_aes_sw_setkey_enc(&sw, key, keybits);
+
+    if (crpt_aes.opmode == AES_MODE_GCM)
+    {
+        crpt_aes_gcm(&sw);
+        mbedtls_aes_sw_free(&sw);
+        crpt_end(CRPT_INTSTS_AESIF_Msk);
+        return;
+    }
+
+    src = crpt_host_ptr(crpt_aes.src);
+    dst = crpt_host_ptr(crpt_aes.dst);
+    for (i = 0; i < (int)crpt_aes.cnt; i += 16)
+    {
+        memcpy(in, src + i, 16);
+        switch (crpt_aes.opmode)
+        {
+        case AES_MODE_ECB:
+            mbedtls_aes_sw_crypt_ecb(&sw, crpt_aes.encrypt, in, dst + i);
+            break;
+        case AES_MODE_CBC:
+            if (crpt_aes.encrypt)
+            {
+                for (j = 0; j < 16; j++)
+                    blk[j] = in[j] ^ v[j];
+                mbedtls_aes_sw_crypt_ecb(&sw, MBEDTLS_AES_ENCRYPT, blk, v);
+                memcpy(dst + i, v, 16);
+            }
+            else
+            {
+                mbedtls_aes_sw_crypt_ecb(&sw, MBEDTLS_AES_DECRYPT, in, blk);
+                for (j = 0; j < 16; j++)
+                    dst[i + j] = blk[j] ^ v[j];
+                memcpy(v, in, 16);
+            }
+            break;
+        case AES_MODE_CFB:
+            mbedtls_aes_sw_crypt_ecb(&sw, MBEDTLS_AES_ENCRYPT, v, blk);
+            for (j = 0; j < 16; j++)
+                dst[i + j] = in[j] ^ blk[j];
+            memcpy(v, crpt_aes.encrypt ? dst + i : in, 16);
+            break;
+        case AES_MODE_OFB:
+            mbedtls_aes_sw_crypt_ecb(&sw, MBEDTLS_AES_ENCRYPT, v, v);
+            for (j = 0; j < 16; j++)
+                dst[i + j] = in[j] ^ v[j];
+            break;
+        default:
+            mbedtls_aes_sw_crypt_ecb(&sw, MBEDTLS_AES_ENCRYPT, v, blk);
+            for (j = 0; j < 16; j++)
+                dst[i + j] = in[j] ^ blk[j];
+            ctr = (((uint32_t)v[12] << 24) | ((uint32_t)v[13] << 16) |
+                   ((uint32_t)v[14] << 8) | v[15]) + 1;
+            for (j = 0; j < 4; j++)
+                v[12 + j] = (uint8_t)(ctr >> (24 - 8 * j));
+            break;
+        }
+    }
+    mbedtls_aes_sw_free(&sw);
+
+    crpt_end(CRPT_INTSTS_AESIF_Msk);
+}
+
+void AES_Trigger(CRPT_T *crpt, int is_sm4, uint32_t u32DMAMode)
+{
+    (void)crpt;
+    crpt_host_aes_jobs++;
+    crpt_aes_run(is_sm4, u32DMAMode);
+}
+
+int AES_Start(CRPT_T *crpt, int is_sm4, uint32_t u32DMAMode)
+{
+    (void)crpt;
+    configASSERT(crpt_locks > 0);
+    configASSERT(!crpt_in_irq);
+    crpt_aes_run(is_sm4, u32DMAMode);
+    return crpt_finish(CRPT_AES_INTS);
+}
+
+/*---------------------------------------------------------------------------*/
+/* SHA                                                                       */
+/*---------------------------------------------------------------------------*/
+
+void SHA_Open(CRPT_T *crpt, uint32_t u32OpMode, uint32_t u32SwapType, uint32_t hmac_key_len)
+{
+    (void)crpt;
+    configASSERT(hmac_key_len == 0);
+    crpt_sha.mode = u32OpMode;
+    crpt_sha.swap = u32SwapType;
+}
+
+void SHA_SetFeedback(CRPT_T *crpt, uint32_t u32FBIAddr, uint32_t u32FBOAddr)
+{
+    (void)crpt;
+    crpt_sha.fbi = u32FBIAddr;
+    crpt_sha.fbo = u32FBOAddr;
+}
+
+void SHA_SetDMATransfer(CRPT_T *crpt, uint32_t u32SrcAddr, uint32_t u32TransCnt)
+{
+    (void)crpt;
+    crpt_sha.src = u32SrcAddr;
+    crpt_sha.cnt = u32TransCnt;
+}
+
+void SHA_Read(CRPT_T *crpt, uint32_t u32Digest[])
+{
+    (void)crpt;
+    memcpy(u32Digest, crpt_sha.digest, sizeof(crpt_sha.digest));
+}
+
+/* Computes a SHA run, its interrupt is left pending */
+static void crpt_sha_run(uint32_t u32DMAMode)
+{
+    crpt_sha_state_t *st = &crpt_sha.state;
+    const unsigned char *src;
+    uint32_t block = ((crpt_sha.mode == SHA_MODE_SHA384) || (crpt_sha.mode == SHA_MODE_SHA512)) ? 128 : 64;
+    int first, last;
+
+    configASSERT(!(crpt_pending & CRPT_SHA_INTS));
+    configASSERT(crpt_sha.swap == SHA_IN_SWAP);
+    configASSERT((crpt_sha.mode == SHA_MODE_SHA1) || (crpt_sha.mode == SHA_MODE_SHA224) ||
+                 (crpt_sha.mode == SHA_MODE_SHA256) || (crpt_sha.mode == SHA_MODE_SHA384) ||
+                 (crpt_sha.mode == SHA_MODE_SHA512));
+    configASSERT(((crpt_sha.src | crpt_sha.fbi | crpt_sha.fbo) & 3) == 0);
+
+    first = (u32DMAMode == CRYPTO_DMA_ONE_SHOT) || (u32DMAMode == CRYPTO_DMA_FIRST);
+    last = (u32DMAMode == CRYPTO_DMA_ONE_SHOT) || (u32DMAMode == CRYPTO_DMA_LAST);
+    configASSERT(first || (u32DMAMode == CRYPTO_DMA_CONTINUE) || (u32DMAMode == CRYPTO_DMA_LAST));
+    configASSERT(crpt_sha.cnt != 0);
+    configASSERT(last || (crpt_sha.cnt % block == 0));
+    configASSERT(!last || (crpt_sha.fbo == 0));
+
+    if (first)
+    {
+        configASSERT(crpt_sha.fbi == 0);
+        st->mode = crpt_sha.mode;
+        if (crpt_sha.mode == SHA_MODE_SHA1)
+            mbedtls_sha1_sw_starts(&st->u.sha1);
+        else if (block == 64)
+            mbedtls_sha256_sw_starts(&st->u.sha256, crpt_sha.mode == SHA_MODE_SHA224);
+        else
+            mbedtls_sha512_sw_starts(&st->u.sha512, crpt_sha.mode == SHA_MODE_SHA384);
+    }
+    else if (crpt_sha.fbi != 0)
+    {
+        memcpy(st, crpt_host_ptr(crpt_sha.fbi), sizeof(*st));
+    }
+    else
+    {
+        configASSERT(crpt_sha.cascade);
+    }
+    configASSERT(st->mode == crpt_sha.mode);
+    crpt_sha.cascade = 0;
+
+    crpt_host_sha_runs++;
+    if (crpt_fail())
+    {
+        crpt_end(CRPT_INTSTS_HMACEIF_Msk);
+        return;
+    }
+
+    src = crpt_host_ptr(crpt_sha.src);
+    if (crpt_sha.mode == SHA_MODE_SHA1)
+        mbedtls_sha1_sw_update(&st->u.sha1, src, crpt_sha.cnt);
+    else if (block == 64)
+        mbedtls_sha256_sw_update(&st->u.sha256, src, crpt_sha.cnt);
+    else
+        mbedtls_sha512_sw_update(&st->u.sha512, src, crpt_sha.cnt);
+
+    if (last)
+    {
+        memset(crpt_sha.digest, 0, sizeof(crpt_sha.digest));
+        if (crpt_sha.mode == SHA_MODE_SHA1)
+            mbedtls_sha1_sw_finish(&st->u.sha1, crpt_sha.digest);
+        else if (block == 64)
+            mbedtls_sha256_sw_finish(&st->u.sha256, crpt_sha.digest);
+        else
+            mbedtls_sha512_sw_finish(&st->u.sha512, crpt_sha.digest);
+    }
+    else if (crpt_sha.fbo != 0)
+    {
+        /* the state is back in the context, the engine is free for another digest */
+        memset(crpt_host_ptr(crpt_sha.fbo), 0xA5, CRYPTO_HW_SHA_FDBCK * 4);
+        memcpy(crpt_host_ptr(crpt_sha.fbo), st, sizeof(*st));
+    }
+    else
+    {
+        crpt_sha.cascade = 1;
+    }
+
+    crpt_end(CRPT_INTSTS_HMACIF_Msk);
+}
+
+void SHA_Trigger(CRPT_T *crpt, uint32_t u32DMAMode)
+{
+    (void)crpt;
+    crpt_host_sha_jobs++;
+    crpt_sha_run(u32DMAMode);
+}
+
+int SHA_Start(CRPT_T *crpt, uint32_t u32DMAMode)
+{
+    (void)crpt;
+    configASSERT(crpt_locks > 0);
+    configASSERT(!crpt_in_irq);
+    crpt_sha_run(u32DMAMode);
+    return crpt_finish(CRPT_SHA_INTS);
+}
+
+/*---------------------------------------------------------------------------*/
+/* ECC                                                                       */
+/*---------------------------------------------------------------------------*/
+
+static int crpt_ecc_rng(void *ctx, unsigned char *buf, size_t len)
+{
+    (void)ctx;
+    while (len--)
+        *buf++ = (unsigned char)rand();
+    return 0;
+}
+
+int ECC_GetCurveBytes(E_ECC_CURVE ecc_curve)
+{
+    switch (ecc_curve)
+    {
+    case CURVE_P_256:
+        return 32;
+    case CURVE_P_384:
+        return 48;
+    case CURVE_P_521:
+        return 66;
+    default:
+        return -1;
+    }
+}
+
+/*
+ * Start of an ECC call, -1 as the driver returns for a curve it cannot load.
+ * An engine error interrupt hangs the driver in ECC_Complete(), a failed
+ * call is this -1 with nothing written.
+ */
+static int crpt_ecc_open(E_ECC_CURVE ecc_curve, mbedtls_ecp_group *grp)
+{
+    mbedtls_ecp_group_id id;
+
+    configASSERT(crpt_locks > 0);
+
+    switch (ecc_curve)
+    {
+    case CURVE_P_256:
+        id = MBEDTLS_ECP_DP_SECP256R1;
+        break;
+    case CURVE_P_384:
+        id = MBEDTLS_ECP_DP_SECP384R1;
+        break;
+    case CURVE_P_521:
+        id = MBEDTLS_ECP_DP_SECP521R1;
+        break;
+    default:
+        return -1;
+    }
+
+    if (crpt_fail())
+        return -1;
+
+    mbedtls_ecp_group_init(grp);
+    configASSERT(mbedtls_ecp_group_load(grp, id) == 0);
+    return 0;
+}
+
+/* A number below n, and not 0 unless zero is set */
+static void crpt_ecc_mpi(const mbedtls_ecp_group *grp, mbedtls_mpi *x, const uint8_t *b, int zero)
+{
+    mbedtls_mpi_init(x);
+    configASSERT(mbedtls_mpi_read_binary(x, b, (grp->pbits + 7) / 8) == 0);
+    configASSERT(mbedtls_mpi_cmp_mpi(x, &grp->N) < 0);
+    configASSERT(zero || (mbedtls_mpi_cmp_int(x, 0) != 0));
+}
+
+/* A point of the curve */
+static void crpt_ecc_point(const mbedtls_ecp_group *grp, mbedtls_ecp_point *P,
+                           const uint8_t *x, const uint8_t *y)
+{
+    size_t len = (grp->pbits + 7) / 8;
+
+    mbedtls_ecp_point_init(P);
+    configASSERT(mbedtls_mpi_read_binary(&P->X, x, len) == 0);
+    configASSERT(mbedtls_mpi_read_binary(&P->Y, y, len) == 0);
+    configASSERT(mbedtls_mpi_lset(&P->Z, 1) == 0);
+    configASSERT(mbedtls_ecp_check_pubkey(grp, P) == 0);
+}
+
+/* One point multiplication of the engine, R = m * P */
+static void crpt_ecc_mul(mbedtls_ecp_group *grp, mbedtls_ecp_point *R, const mbedtls_mpi *m,
+                         const mbedtls_ecp_point *P)
+{
+    crpt_host_pka_runs++;
+    configASSERT(mbedtls_ecp_mul(grp, R, m, P, crpt_ecc_rng, NULL) == 0);
+    crpt_done(CRPT_INTSTS_ECCIF_Msk);
+}
+
+static void crpt_ecc_write(const mbedtls_ecp_group *grp, const mbedtls_mpi *x, uint8_t *b)
+{
+    configASSERT(mbedtls_mpi_write_binary(x, b, (grp->pbits + 7) / 8) == 0);
+}
+
+int ECC_GeneratePublicKey_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t private_k[],
+                              uint8_t public_x[], uint8_t public_y[])
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point Q;
+    mbedtls_mpi d;
+
+    (void)crpt;
+    if (crpt_ecc_open(ecc_curve, &grp) != 0)
+        return -1;
+
+    crpt_ecc_mpi(&grp, &d, private_k, 0);
+    mbedtls_ecp_point_init(&Q);
+    crpt_ecc_mul(&grp, &Q, &d, &grp.G);
+    crpt_ecc_write(&grp, &Q.X, public_x);
+    crpt_ecc_write(&grp, &Q.Y, public_y);
+
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&Q);
+    mbedtls_ecp_group_free(&grp);
+    return 0;
+}
+
+int ECC_GenerateSecretZ_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t private_k[],
+                            const uint8_t public_x[], const uint8_t public_y[], uint8_t secret_z[])
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point P, Z;
+    mbedtls_mpi d;
+
+    (void)crpt;
+    if (crpt_ecc_open(ecc_curve, &grp) != 0)
+        return -1;
+
+    crpt_ecc_mpi(&grp, &d, private_k, 0);
+    crpt_ecc_point(&grp, &P, public_x, public_y);
+    mbedtls_ecp_point_init(&Z);
+    crpt_ecc_mul(&grp, &Z, &d, &P);
+    crpt_ecc_write(&grp, &Z.X, secret_z);
+
+    mbedtls_mpi_free(&d);
+    mbedtls_ecp_point_free(&P);
+    mbedtls_ecp_point_free(&Z);
+    mbedtls_ecp_group_free(&grp);
+    return 0;
+}
+
+/* s = k^-1 * (e + d * r) mod n with r = x of k * G mod n, as the driver does it */
+int ECC_GenerateSignature_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t message[],
+                              const uint8_t d[], const uint8_t k[], uint8_t R[], uint8_t S[])
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point X;
+    mbedtls_mpi e, md, mk, r, s;
+
+    (void)crpt;
+    if (crpt_ecc_open(ecc_curve, &grp) != 0)
+        return -1;
+
+    crpt_ecc_mpi(&grp, &e, message, 1);
+    crpt_ecc_mpi(&grp, &md, d, 0);
+    crpt_ecc_mpi(&grp, &mk, k, 0);
+    mbedtls_ecp_point_init(&X);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    crpt_ecc_mul(&grp, &X, &mk, &grp.G);
+    configASSERT(mbedtls_mpi_mod_mpi(&r, &X.X, &grp.N) == 0);
+    configASSERT(mbedtls_mpi_mul_mpi(&s, &md, &r) == 0);
+    configASSERT(mbedtls_mpi_add_mpi(&s, &s, &e) == 0);
+    configASSERT(mbedtls_mpi_inv_mod(&mk, &mk, &grp.N) == 0);
+    configASSERT(mbedtls_mpi_mul_mpi(&s, &s, &mk) == 0);
+    configASSERT(mbedtls_mpi_mod_mpi(&s, &s, &grp.N) == 0);
+    crpt_ecc_write(&grp, &r, R);
+    crpt_ecc_write(&grp, &s, S);
+
+    mbedtls_mpi_free(&e);
+    mbedtls_mpi_free(&md);
+    mbedtls_mpi_free(&mk);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    mbedtls_ecp_point_free(&X);
+    mbedtls_ecp_group_free(&grp);
+    return 0;
+}
+
+/* -2 unless x of e / s * G + r / s * Q mod n is r */
+int ECC_VerifySignature_Bin(CRPT_T *crpt, E_ECC_CURVE ecc_curve, const uint8_t message[],
+                            const uint8_t public_x[], const uint8_t public_y[],
+                            const uint8_t R[], const uint8_t S[])
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point Q, U1, U2;
+    mbedtls_mpi e, r, s, u;
+    int ret;
+
+    (void)crpt;
+    if (crpt_ecc_open(ecc_curve, &grp) != 0)
+        return -1;
+
+    crpt_ecc_mpi(&grp, &e, message, 1);
+    crpt_ecc_mpi(&grp, &r, R, 0);
+    crpt_ecc_mpi(&grp, &s, S, 0);
+    crpt_ecc_point(&grp, &Q, public_x, public_y);
+    mbedtls_ecp_point_init(&U1);
+    mbedtls_ecp_point_init(&U2);
+    mbedtls_mpi_init(&u);
+
+    configASSERT(mbedtls_mpi_inv_mod(&s, &s, &grp.N) == 0);
+    configASSERT(mbedtls_mpi_mul_mpi(&u, &e, &s) == 0);
+    configASSERT(mbedtls_mpi_mod_mpi(&u, &u, &grp.N) == 0);
+    crpt_ecc_mul(&grp, &U1, &u, &grp.G);
+    configASSERT(mbedtls_mpi_mul_mpi(&u, &r, &s) == 0);
+    configASSERT(mbedtls_mpi_mod_mpi(&u, &u, &grp.N) == 0);
+    crpt_ecc_mul(&grp, &U2, &u, &Q);
+
+    /* U1 + U2, the point at infinity is no signature */
+    configASSERT(mbedtls_mpi_lset(&u, 1) == 0);
+    ret = mbedtls_ecp_muladd(&grp, &U1, &u, &U1, &u, &U2);
+    crpt_done(CRPT_INTSTS_ECCIF_Msk);
+    if (ret == 0)
+        ret = mbedtls_mpi_mod_mpi(&u, &U1.X, &grp.N);
+    if ((ret != 0) || (mbedtls_mpi_cmp_mpi(&u, &r) != 0))
+        ret = -2;
+
+    mbedtls_mpi_free(&e);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&u);
+    mbedtls_ecp_point_free(&Q);
+    mbedtls_ecp_point_free(&U1);
+    mbedtls_ecp_point_free(&U2);
+    mbedtls_ecp_group_free(&grp);
+    return ret;
+}
+
+/*---------------------------------------------------------------------------*/
+/* RSA                                                                       */
+/*---------------------------------------------------------------------------*/
+
+/* out = m^e mod n of a key of blen bits, e the private exponent in CRT mode */
+static int crpt_rsa_run(int blen, const uint8_t *m, int mlen, const uint8_t *e, int elen,
+                        const uint8_t *n, int nlen, uint8_t *out, int *olen)
+{
+    mbedtls_mpi M, E, N, X;
+
+    configASSERT(crpt_locks > 0);
+    configASSERT((mlen <= blen / 8) && (elen <= blen / 8) && (nlen <= blen / 8));
+
+    mbedtls_mpi_init(&M);
+    mbedtls_mpi_init(&E);
+    mbedtls_mpi_init(&N);
+    mbedtls_mpi_init(&X);
+    configASSERT(mbedtls_mpi_read_binary(&M, m, (size_t)mlen) == 0);
+    configASSERT(mbedtls_mpi_read_binary(&E, e, (size_t)elen) == 0);
+    configASSERT(mbedtls_mpi_read_binary(&N, n, (size_t)nlen) == 0);
+    configASSERT(mbedtls_mpi_bitlen(&N) == (size_t)blen);
+    configASSERT(mbedtls_mpi_cmp_mpi(&M, &N) < 0);
+
+    crpt_host_pka_runs++;
+    if (crpt_fail())
+    {
+        mbedtls_mpi_free(&M);
+        mbedtls_mpi_free(&E);
+        mbedtls_mpi_free(&N);
+        mbedtls_mpi_free(&X);
+        return crpt_done(CRPT_INTSTS_RSAEIF_Msk);
+    }
+
+    configASSERT(mbedtls_mpi_exp_mod(&X, &M, &E, &N, NULL) == 0);
+    *olen = blen / 8;
+    configASSERT(mbedtls_mpi_write_binary(&X, out, (size_t)*olen) == 0);
+    if (crpt_host_corrupt)
+    {
+        /* a fault in the engine, the result is wrong with no error */
+        crpt_host_corrupt = 0;
+        out[*olen / 2] ^= 0x10;
+    }
+
+    mbedtls_mpi_free(&M);
+    mbedtls_mpi_free(&E);
+    mbedtls_mpi_free(&N);
+    mbedtls_mpi_free(&X);
+    return crpt_done(CRPT_INTSTS_RSAIF_Msk);
+}
+
+int RSA_Encrypt(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
+                uint8_t *pubk, int klen, uint8_t *n, int nlen, uint8_t *out, int *olen)
+{
+    (void)crpt;
+    if ((ras_blen % 1024) || (ras_blen > 4096))
+        return -2;
+
+    return crpt_rsa_run(ras_blen, data, dlen, pubk, klen, n, nlen, out, olen);
+}
+
+int RSA_DecryptCRT(CRPT_T *crpt, int ras_blen, uint8_t *data, int dlen,
+                   uint8_t *privk, int klen, uint8_t *n, int nlen,
+                   uint8_t *p, int plen, uint8_t *q, int qlen, uint8_t *out, int *olen)
+{
+    mbedtls_mpi P, Q, N;
+
+    (void)crpt;
+    if ((ras_blen % 1024) || (ras_blen > 4096))
+        return -2;
+
+    configASSERT((plen <= ras_blen / 16) && (qlen <= ras_blen / 16));
+    mbedtls_mpi_init(&P);
+    mbedtls_mpi_init(&Q);
+    mbedtls_mpi_init(&N);
+    configASSERT(mbedtls_mpi_read_binary(&P, p, (size_t)plen) == 0);
+    configASSERT(mbedtls_mpi_read_binary(&Q, q, (size_t)qlen) == 0);
+    configASSERT(mbedtls_mpi_read_binary(&N, n, (size_t)nlen) == 0);
+    configASSERT(mbedtls_mpi_mul_mpi(&P, &P, &Q) == 0);
+    configASSERT(mbedtls_mpi_cmp_mpi(&P, &N) == 0);
+    mbedtls_mpi_free(&P);
+    mbedtls_mpi_free(&Q);
+    mbedtls_mpi_free(&N);
+
+    return crpt_rsa_run(ras_blen, data, dlen, privk, klen, n, nlen, out, olen);
+}
+
+/*---------------------------------------------------------------------------*/
+/* FreeRTOS, one task                                                        */
+/*---------------------------------------------------------------------------*/
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return taskSCHEDULER_RUNNING;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void)
+{
+    return (TaskHandle_t)&crpt_notify;
+}
+
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit,
+                                 TickType_t xTicksToWait)
+{
+    uint32_t n;
+
+    configASSERT(!crpt_in_irq && !crpt_critical);
+
+    /* the task sleeps, the engines end their runs meanwhile */
+    while ((crpt_notify[uxIndexToWaitOn] == 0) && (crpt_pending != 0))
+        crpt_take_irq();
+    n = crpt_notify[uxIndexToWaitOn];
+
+    /* nothing else runs that could give it */
+    configASSERT((n != 0) || (xTicksToWait != portMAX_DELAY));
+    if (n != 0)
+        crpt_notify[uxIndexToWaitOn] = xClearCountOnExit ? 0 : n - 1;
+    return n;
+}
+
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify)
+{
+    configASSERT(!crpt_in_irq);
+    configASSERT(xTaskToNotify == xTaskGetCurrentTaskHandle());
+    crpt_notify[uxIndexToNotify]++;
+    return pdTRUE;
+}
+
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify,
+                                   BaseType_t *pxHigherPriorityTaskWoken)
+{
+    configASSERT(crpt_in_irq);
+    configASSERT(xTaskToNotify == xTaskGetCurrentTaskHandle());
+    crpt_notify[uxIndexToNotify]++;
+    if (pxHigherPriorityTaskWoken != NULL)
+        *pxHigherPriorityTaskWoken = pdTRUE;
+}
+
+void crpt_host_enter_critical(void)
+{
+    configASSERT(!crpt_in_irq);
+    crpt_critical++;
+}
+
+/* The interrupt masked meanwhile may come at once */
+void crpt_host_exit_critical(void)
+{
+    configASSERT(crpt_critical > 0);
+    if ((--crpt_critical == 0) && (rand() & 1))
+        crpt_take_irq();
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void)
+{
+    int i;
+
+    for (i = 0; i < CRPT_HOST_MUTEXES; i++)
+    {
+        if (crpt_mutex[i] == 0)
+        {
+            crpt_mutex[i] = 1;
+            return &crpt_mutex[i];
+        }
+    }
+    return NULL;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore)
+{
+    configASSERT(*(int *)xSemaphore == 1);
+    *(int *)xSemaphore = 0;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime)
+{
+    /* the one task already holds it */
+    configASSERT((*(int *)xSemaphore == 1) || (xBlockTime != portMAX_DELAY));
+    if (*(int *)xSemaphore != 1)
+        return pdFALSE;
+    *(int *)xSemaphore = 2;
+    crpt_locks++;
+    return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore)
+{
+    configASSERT(*(int *)xSemaphore == 2);
+    *(int *)xSemaphore = 1;
+    crpt_locks--;
+    return pdTRUE;
+}
+
+int crpt_host_locked(void)
+{
+    return crpt_locks;
+}
+
+int crpt_host_idle(void)
+{
+    while (crpt_pending != 0)
+        crpt_take_irq();
+    return (crpt_locks == 0) && !crpt_critical;
+}
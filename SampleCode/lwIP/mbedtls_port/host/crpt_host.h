@@ -0,0 +1,32 @@
+/**************************************************************************//**
+ * @file     crpt_host.h
+ * @brief    Controls and counters of the CRPT engine model, see crpt_host.c
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __CRPT_HOST_H__
+#define __CRPT_HOST_H__
+
+/* Set to fail the next engine run: AES, SHA and RSA end with the error
+ * interrupt, the ECC calls return -1 */
+extern int crpt_host_fail;
+
+/* Set to flip a bit of the next RSA result, with no error */
+extern int crpt_host_corrupt;
+
+/* Engine runs so far, those started by a job of the queue, and the AES
+ * runs in GCM mode */
+extern unsigned long crpt_host_aes_runs;
+extern unsigned long crpt_host_sha_runs;
+extern unsigned long crpt_host_pka_runs;
+extern unsigned long crpt_host_aes_jobs;
+extern unsigned long crpt_host_sha_jobs;
+extern unsigned long crpt_host_gcm_runs;
+
+/* crypto_hw_lock() calls without their crypto_hw_unlock() */
+int crpt_host_locked(void);
+
+/* Takes the pending interrupts, 1 if then no engine is locked or running */
+int crpt_host_idle(void);
+
+#endif /* __CRPT_HOST_H__ */
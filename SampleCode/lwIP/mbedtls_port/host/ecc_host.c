@@ -0,0 +1,281 @@
+/**************************************************************************//**
+ * @file     ecc_host.c
+ * @brief    Checks the ECDSA and ECDH alternatives of ecc_alt.c against the
+ *           software ECC of mbedtls on a Linux host, with the engine model
+ *           of crpt_host.c. Build with Makefile.host.
+ *
+ * Signs the P-256 vector of RFC 6979 deterministically, then random keys and
+ * hashes on the engine curves and two software ones against
+ * mbedtls_ecdsa_sw_xxx() and mbedtls_ecdh_sw_xxx(): signatures of one side
+ * verified by the other, hashes longer and shorter than the order, altered
+ * hashes and signatures rejected, shared secrets computed both ways, and a
+ * peer point off the curve refused before it reaches the engine. A driver
+ * error must come back as MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbedtls/ecdsa.h"
+#include "mbedtls/ecdh.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/error.h"
+
+#include "ecc_alt.h"
+#include "crpt_host.h"
+
+#define ECCH_LOOPS      12
+
+typedef struct
+{
+    mbedtls_ecp_group_id id;
+    const char *name;
+    int engine;
+}
+ecch_curve_t;
+
+static const ecch_curve_t ecch_curves[] =
+{
+    { MBEDTLS_ECP_DP_SECP256R1, "P-256", 1 },
+    { MBEDTLS_ECP_DP_SECP384R1, "P-384", 1 },
+    { MBEDTLS_ECP_DP_SECP521R1, "P-521", 1 },
+    { MBEDTLS_ECP_DP_SECP192R1, "P-192", 0 },
+    { MBEDTLS_ECP_DP_BP256R1, "BP-256", 0 },
+};
+
+#define ECCH_CURVES     ((int)(sizeof(ecch_curves) / sizeof(ecch_curves[0])))
+
+static int ecch_reported;
+
+static int ecch_rand(void *ctx, unsigned char *buf, size_t len)
+{
+    (void)ctx;
+    while (len--)
+        *buf++ = (unsigned char)rand();
+    return 0;
+}
+
+/* 1 and a report if ok is not set */
+static int ecch_check(int ok, const char *curve, const char *what)
+{
+    if (ok)
+        return 0;
+    if (ecch_reported++ < 10)
+        printf("%s: %s\n", curve, what);
+    return 1;
+}
+
+/* RFC 6979 A.2.5, P-256 with SHA-256 and the message "sample" */
+static int ecch_vector(void)
+{
+    static const char d_hex[] = "C9AFA9D845BA75166B5C215767B1D6934E50C3DB36E89B127B8A622B120F6721";
+    static const char qx_hex[] = "60FED4BA255A9D31C961EB74C6356D68C049B8923B61FA6CE669622E60F29FB6";
+    static const char qy_hex[] = "7903FE1008B8BC99A41AE9E95628BC64F2F1B20C2D7E9F5177A3C294D4462299";
+    static const char r_hex[] = "EFD48B2AACB6A8FD1140DD9CD45E81D69D2C877B56AAF991C34D0EA84EAF3716";
+    static const char s_hex[] = "F7CB1C942D657C41D436C7A1B6E29F65F3E900DBB9AFF4064DC4AB2F843ACDA8";
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point Q;
+    mbedtls_mpi d, r, s, r0, s0;
+    unsigned char hash[32];
+    int fails = 0;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&Q);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    mbedtls_mpi_init(&r0);
+    mbedtls_mpi_init(&s0);
+
+    mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1);
+    mbedtls_mpi_read_string(&d, 16, d_hex);
+    mbedtls_mpi_read_string(&Q.X, 16, qx_hex);
+    mbedtls_mpi_read_string(&Q.Y, 16, qy_hex);
+    mbedtls_mpi_lset(&Q.Z, 1);
+    mbedtls_mpi_read_string(&r0, 16, r_hex);
+    mbedtls_mpi_read_string(&s0, 16, s_hex);
+    mbedtls_sha256((const unsigned char *)"sample", 6, hash, 0);
+
+    fails += ecch_check((mbedtls_ecdsa_sign_det_ext(&grp, &r, &s, &d, hash, sizeof(hash),
+                                                    MBEDTLS_MD_SHA256, ecch_rand, NULL) == 0) &&
+                        (mbedtls_mpi_cmp_mpi(&r, &r0) == 0) && (mbedtls_mpi_cmp_mpi(&s, &s0) == 0),
+                        "P-256", "RFC 6979 signature differs");
+    fails += ecch_check(mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &Q, &r0, &s0) == 0,
+                        "P-256", "RFC 6979 signature not verified");
+
+    mbedtls_ecp_group_free(&grp);
+    mbedtls_ecp_point_free(&Q);
+    mbedtls_mpi_free(&d);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r0);
+    mbedtls_mpi_free(&s0);
+    return fails;
+}
+
+/* Keys of both sides, signatures both ways and a shared secret */
+static int ecch_one(const ecch_curve_t *c)
+{
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point Q, Q2;
+    mbedtls_mpi d, d2, r, s, r2, s2, z, z2;
+    unsigned char hash[80];
+    size_t hlen = 20 + (size_t)(rand() % 60);
+    int fails = 0;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&Q);
+    mbedtls_ecp_point_init(&Q2);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&d2);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+    mbedtls_mpi_init(&r2);
+    mbedtls_mpi_init(&s2);
+    mbedtls_mpi_init(&z);
+    mbedtls_mpi_init(&z2);
+
+    mbedtls_ecp_group_load(&grp, c->id);
+    ecch_rand(NULL, hash, hlen);
+
+    fails += ecch_check((mbedtls_ecdh_gen_public(&grp, &d, &Q, ecch_rand, NULL) == 0) &&
+                        (mbedtls_ecp_mul(&grp, &Q2, &d, &grp.G, ecch_rand, NULL) == 0) &&
+                        (mbedtls_ecp_point_cmp(&Q, &Q2) == 0), c->name, "public key is not d * G");
+    mbedtls_ecdh_sw_gen_public(&grp, &d2, &Q2, ecch_rand, NULL);
+
+    /* a signature of the alternative verified in software, and the other way */
+    fails += ecch_check((mbedtls_ecdsa_sign(&grp, &r, &s, &d, hash, hlen, ecch_rand, NULL) == 0) &&
+                        (mbedtls_ecdsa_sw_verify(&grp, hash, hlen, &Q, &r, &s) == 0),
+                        c->name, "signature not verified in software");
+    fails += ecch_check(mbedtls_ecdsa_verify(&grp, hash, hlen, &Q, &r, &s) == 0,
+                        c->name, "own signature not verified");
+    mbedtls_ecdsa_sw_sign(&grp, &r2, &s2, &d2, hash, hlen, ecch_rand, NULL);
+    fails += ecch_check(mbedtls_ecdsa_verify(&grp, hash, hlen, &Q2, &r2, &s2) == 0,
+                        c->name, "software signature not verified");
+
+    /* wrong key, hash or signature */
+    fails += ecch_check(mbedtls_ecdsa_verify(&grp, hash, hlen, &Q2, &r, &s) ==
+                        MBEDTLS_ERR_ECP_VERIFY_FAILED, c->name, "wrong key verified");
+    fails += ecch_check(mbedtls_ecdsa_verify(&grp, hash, hlen, &Q, &r, &grp.N) ==
+                        MBEDTLS_ERR_ECP_VERIFY_FAILED, c->name, "s = n verified");
+    mbedtls_mpi_add_int(&s2, &s2, 1);
+    fails += ecch_check(mbedtls_ecdsa_verify(&grp, hash, hlen, &Q2, &r2, &s2) ==
+                        MBEDTLS_ERR_ECP_VERIFY_FAILED, c->name, "altered signature verified");
+    hash[0] ^= 1;
+    fails += ecch_check(mbedtls_ecdsa_verify(&grp, hash, hlen, &Q, &r, &s) ==
+                        MBEDTLS_ERR_ECP_VERIFY_FAILED, c->name, "altered hash verified");
+
+    /* one secret from both sides */
+    fails += ecch_check((mbedtls_ecdh_compute_shared(&grp, &z, &Q2, &d, ecch_rand, NULL) == 0) &&
+                        (mbedtls_ecdh_sw_compute_shared(&grp, &z2, &Q, &d2, ecch_rand, NULL) == 0) &&
+                        (mbedtls_mpi_cmp_mpi(&z, &z2) == 0), c->name, "shared secrets differ");
+
+    mbedtls_mpi_add_int(&Q2.Y, &Q2.Y, 1);
+    fails += ecch_check(mbedtls_ecdh_compute_shared(&grp, &z, &Q2, &d, ecch_rand, NULL) != 0,
+                        c->name, "peer point off the curve taken");
+
+    mbedtls_ecp_group_free(&grp);
+    mbedtls_ecp_point_free(&Q);
+    mbedtls_ecp_point_free(&Q2);
+    mbedtls_mpi_free(&d);
+    mbedtls_mpi_free(&d2);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    mbedtls_mpi_free(&r2);
+    mbedtls_mpi_free(&s2);
+    mbedtls_mpi_free(&z);
+    mbedtls_mpi_free(&z2);
+    return fails;
+}
+
+/* A driver error must not be taken for a result, in any of the calls */
+static int ecch_fail(void)
+{
+    static const char *what[] = { "key generation", "signature", "verification", "shared secret" };
+    mbedtls_ecp_group grp;
+    mbedtls_ecp_point Q;
+    mbedtls_mpi d, r, s;
+    unsigned char hash[32] = { 1 };
+    int i, ret, fails = 0;
+
+    mbedtls_ecp_group_init(&grp);
+    mbedtls_ecp_point_init(&Q);
+    mbedtls_mpi_init(&d);
+    mbedtls_mpi_init(&r);
+    mbedtls_mpi_init(&s);
+
+    mbedtls_ecp_group_load(&grp, MBEDTLS_ECP_DP_SECP256R1);
+    mbedtls_ecdh_sw_gen_public(&grp, &d, &Q, ecch_rand, NULL);
+    mbedtls_ecdsa_sw_sign(&grp, &r, &s, &d, hash, sizeof(hash), ecch_rand, NULL);
+
+    for (i = 0; i < 4; i++)
+    {
+        crpt_host_fail = 1;
+        switch (i)
+        {
+        case 0:
+            ret = mbedtls_ecdh_gen_public(&grp, &d, &Q, ecch_rand, NULL);
+            break;
+        case 1:
+            ret = mbedtls_ecdsa_sign(&grp, &r, &s, &d, hash, sizeof(hash), ecch_rand, NULL);
+            break;
+        case 2:
+            ret = mbedtls_ecdsa_verify(&grp, hash, sizeof(hash), &Q, &r, &s);
+            break;
+        default:
+            ret = mbedtls_ecdh_compute_shared(&grp, &s, &Q, &d, ecch_rand, NULL);
+            break;
+        }
+
+        if ((ret != MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED) || crpt_host_fail)
+        {
+            printf("engine error in %s: returned -0x%04x\n", what[i], (unsigned)-ret);
+            fails++;
+        }
+    }
+    crpt_host_fail = 0;
+
+    mbedtls_ecp_group_free(&grp);
+    mbedtls_ecp_point_free(&Q);
+    mbedtls_mpi_free(&d);
+    mbedtls_mpi_free(&r);
+    mbedtls_mpi_free(&s);
+    return fails;
+}
+
+int main(void)
+{
+    unsigned long runs, before;
+    int i, n, fails = 0;
+
+    srand(3);
+
+    before = crpt_host_pka_runs;
+    fails += ecch_vector();
+    printf("RFC 6979 vector: %lu engine runs\n", crpt_host_pka_runs - before);
+
+    for (i = 0; i < ECCH_CURVES; i++)
+    {
+        before = crpt_host_pka_runs;
+        for (n = 0; n < ECCH_LOOPS; n++)
+            fails += ecch_one(&ecch_curves[i]);
+        runs = crpt_host_pka_runs - before;
+        printf("%-6s %d key pairs against software, %lu engine runs\n", ecch_curves[i].name,
+               ECCH_LOOPS, runs);
+        fails += ecch_check((runs != 0) == ecch_curves[i].engine, ecch_curves[i].name,
+                            ecch_curves[i].engine ? "not run on the engine" : "run on the engine");
+    }
+
+    fails += ecch_fail();
+
+    if (crpt_host_locked() != 0)
+    {
+        printf("engine left locked\n");
+        fails++;
+    }
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
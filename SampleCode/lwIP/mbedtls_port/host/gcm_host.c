@@ -0,0 +1,199 @@
+/**************************************************************************//**
+ * @file     gcm_host.c
+ * @brief    Checks the AES-GCM alternative of gcm_alt.c against the software
+ *           GCM of mbedtls on a Linux host, with the engine model of
+ *           crpt_host.c. Build with Makefile.host.
+ *
+ * Runs the mbedtls GCM self test with its standard vectors, then random
+ * requests of mbedtls_gcm_crypt_and_tag() and mbedtls_gcm_auth_decrypt()
+ * against mbedtls_gcm_sw_xxx(): all key sizes, additional data and text of
+ * any length, most not whole blocks, some beyond what the engine takes,
+ * IVs of other sizes, short tags, odd addresses and in place. The engine
+ * model checks the packing of IV, additional data and text in the DMA
+ * buffer and writes text and tag where the engine does. A tag, text or
+ * additional data changed by one bit must fail the authentication and
+ * leave no plain text behind, and an engine error must come back as
+ * MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbedtls/gcm.h"
+#include "mbedtls/error.h"
+
+#include "crpt_host.h"
+
+#define GCMH_MAX_LEN    (GCM_ALT_HW_MAX_LEN + 100)
+#define GCMH_MAX_AAD    (GCM_ALT_HW_MAX_AAD + 16)
+#define GCMH_LOOPS      3000
+
+static unsigned char gcmh_in[GCMH_MAX_LEN + 8];
+static unsigned char gcmh_hw[GCMH_MAX_LEN + 8];
+static unsigned char gcmh_sw[GCMH_MAX_LEN + 8];
+static unsigned char gcmh_aad[GCMH_MAX_AAD + 8];
+static int gcmh_reported;
+
+static void gcmh_rand(unsigned char *buf, size_t len)
+{
+    while (len--)
+        *buf++ = (unsigned char)rand();
+}
+
+/* Length up to max: mostly odd, some whole blocks, some empty */
+static size_t gcmh_len(size_t max)
+{
+    switch (rand() % 8)
+    {
+    case 0:
+        return 0;
+    case 1:
+        return 16 * (size_t)(rand() % (int)(max / 16 + 1));
+    default:
+        return (size_t)(rand() % (int)(max + 1));
+    }
+}
+
+/* 1 and a report if ok is not set */
+static int gcmh_check(int ok, const char *what, unsigned int bits, size_t len, size_t add_len)
+{
+    if (ok)
+        return 0;
+    if (gcmh_reported++ < 10)
+        printf("%u-bit key, %u bytes, %u bytes of additional data: %s\n", bits,
+               (unsigned)len, (unsigned)add_len, what);
+    return 1;
+}
+
+/*
+ * Encrypts with both, then decrypts the cipher text with the alternative as
+ * it is and with one bit changed in the tag, the text or the additional data
+ */
+static int gcmh_one(void)
+{
+    mbedtls_gcm_context hw;
+    mbedtls_gcm_sw_context sw;
+    unsigned char key[32], iv[16], tag_hw[16], tag_sw[16];
+    unsigned int bits = 128 + 64 * (unsigned int)(rand() % 3);
+    size_t len = gcmh_len(GCMH_MAX_LEN), add_len = gcmh_len(GCMH_MAX_AAD);
+    size_t iv_len = (rand() % 8 == 0) ? (size_t)(8 + 4 * (rand() % 3)) : 12;
+    size_t tag_len = (rand() % 4 == 0) ? (size_t)(4 + rand() % 12) : 16, pos;
+    unsigned char *in = gcmh_in + rand() % 8, *aad = gcmh_aad + rand() % 8;
+    unsigned char *out = (rand() % 4 == 0) ? in : gcmh_hw + rand() % 8;
+    int ret_hw, ret_sw, bad, fails = 0;
+
+    gcmh_rand(key, sizeof(key));
+    gcmh_rand(iv, sizeof(iv));
+    gcmh_rand(gcmh_in, sizeof(gcmh_in));
+    gcmh_rand(gcmh_aad, sizeof(gcmh_aad));
+    memcpy(gcmh_sw, in, len);
+
+    mbedtls_gcm_init(&hw);
+    mbedtls_gcm_sw_init(&sw);
+    mbedtls_gcm_setkey(&hw, MBEDTLS_CIPHER_ID_AES, key, bits);
+    mbedtls_gcm_sw_setkey(&sw, MBEDTLS_CIPHER_ID_AES, key, bits);
+
+    ret_hw = mbedtls_gcm_crypt_and_tag(&hw, MBEDTLS_GCM_ENCRYPT, len, iv, iv_len, aad, add_len,
+                                       in, out, tag_len, tag_hw);
+    ret_sw = mbedtls_gcm_sw_crypt_and_tag(&sw, MBEDTLS_GCM_ENCRYPT, len, iv, iv_len, aad, add_len,
+                                          gcmh_sw, gcmh_sw, tag_len, tag_sw);
+    fails += gcmh_check((ret_hw == 0) && (ret_sw == 0) && !memcmp(out, gcmh_sw, len) &&
+                        !memcmp(tag_hw, tag_sw, tag_len), "encryption differs", bits, len, add_len);
+
+    /* the cipher text goes back in place, the plain text is in gcmh_sw no more */
+    if (fails == 0)
+    {
+        memcpy(gcmh_sw, out, len);
+        ret_sw = mbedtls_gcm_sw_auth_decrypt(&sw, len, iv, iv_len, aad, add_len, tag_sw, tag_len,
+                                             gcmh_sw, gcmh_sw);
+        ret_hw = mbedtls_gcm_auth_decrypt(&hw, len, iv, iv_len, aad, add_len, tag_hw, tag_len,
+                                          out, out);
+        fails += gcmh_check((ret_hw == 0) && (ret_sw == 0) && !memcmp(out, gcmh_sw, len),
+                            "decryption differs", bits, len, add_len);
+    }
+
+    /* one bit changed: out holds the plain text again, encrypt it back */
+    if (fails == 0)
+    {
+        mbedtls_gcm_crypt_and_tag(&hw, MBEDTLS_GCM_ENCRYPT, len, iv, iv_len, aad, add_len,
+                                  out, out, tag_len, tag_hw);
+        bad = rand() % 3;
+        if ((bad == 1) && (len == 0))
+            bad = 0;
+        if ((bad == 2) && (add_len == 0))
+            bad = 0;
+        pos = (size_t)rand();
+        if (bad == 0)
+            tag_hw[pos % tag_len] ^= (unsigned char)(1 << (pos % 8));
+        else if (bad == 1)
+            out[pos % len] ^= (unsigned char)(1 << (pos % 8));
+        else
+            aad[pos % add_len] ^= (unsigned char)(1 << (pos % 8));
+
+        ret_hw = mbedtls_gcm_auth_decrypt(&hw, len, iv, iv_len, aad, add_len, tag_hw, tag_len,
+                                          out, gcmh_hw);
+        fails += gcmh_check(ret_hw == MBEDTLS_ERR_GCM_AUTH_FAILED, "change not detected",
+                            bits, len, add_len);
+        for (pos = 0; (pos < len) && (fails == 0); pos++)
+            fails += gcmh_check(gcmh_hw[pos] == 0, "plain text left after a failure",
+                                bits, len, add_len);
+    }
+
+    mbedtls_gcm_free(&hw);
+    mbedtls_gcm_sw_free(&sw);
+    return fails;
+}
+
+/* An engine error must not be taken for a result */
+static int gcmh_fail(void)
+{
+    mbedtls_gcm_context hw;
+    unsigned char key[16] = { 0 }, iv[12] = { 0 }, tag[16];
+    int ret;
+
+    mbedtls_gcm_init(&hw);
+    mbedtls_gcm_setkey(&hw, MBEDTLS_CIPHER_ID_AES, key, 128);
+    crpt_host_fail = 1;
+    ret = mbedtls_gcm_crypt_and_tag(&hw, MBEDTLS_GCM_ENCRYPT, 100, iv, 12, gcmh_aad, 13,
+                                    gcmh_in, gcmh_hw, 16, tag);
+    mbedtls_gcm_free(&hw);
+
+    if ((ret == MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED) && !crpt_host_fail)
+        return 0;
+    printf("engine error: returned -0x%04x\n", (unsigned)-ret);
+    return 1;
+}
+
+int main(void)
+{
+    unsigned long before;
+    int i, fails = 0;
+
+    srand(3);
+
+    before = crpt_host_gcm_runs;
+    if (mbedtls_gcm_self_test(0) != 0)
+        fails++;
+    printf("self test: %lu engine runs\n", crpt_host_gcm_runs - before);
+    if (crpt_host_gcm_runs == before)
+        fails++;
+
+    before = crpt_host_gcm_runs;
+    for (i = 0; i < GCMH_LOOPS; i++)
+        fails += gcmh_one();
+    printf("%d requests against software, %lu engine runs\n", GCMH_LOOPS,
+           crpt_host_gcm_runs - before);
+
+    fails += gcmh_fail();
+
+    if (crpt_host_locked() != 0)
+    {
+        printf("engine left locked\n");
+        fails++;
+    }
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
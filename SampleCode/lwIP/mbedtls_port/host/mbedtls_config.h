@@ -0,0 +1,83 @@
+/**************************************************************************//**
+ * @file     mbedtls_config.h
+ * @brief    mbedtls configuration of the host checks of the mbedtls port:
+ *           the alternative implementations under test, their software
+ *           fallbacks and the self tests with the standard vectors.
+ *
+ * The engine thresholds are lowered so that the short vectors of the self
+ * tests run on the engine model, and the GCM limit so that the checks also
+ * see requests too long for the engine. The bounce buffers of crypto_hw.c
+ * are set in Makefile.host.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __MBEDTLS_CONFIG_H__
+#define __MBEDTLS_CONFIG_H__
+
+#define MBEDTLS_SELF_TEST
+
+/* The self tests of the mbedtls in ThirdParty print with sysprintf, not all
+ * of the library includes NuMicro.h */
+#include <stdio.h>
+#define sysprintf       printf
+
+/* AES */
+#define MBEDTLS_AES_C
+#define MBEDTLS_AES_ALT
+#define MBEDTLS_CIPHER_MODE_CBC
+#define MBEDTLS_CIPHER_MODE_CFB
+#define MBEDTLS_CIPHER_MODE_CTR
+#define MBEDTLS_CIPHER_MODE_OFB
+#define MBEDTLS_CIPHER_MODE_XTS
+
+/* AES-GCM, its software path goes through the cipher layer */
+#define MBEDTLS_CIPHER_C
+#define MBEDTLS_GCM_C
+#define MBEDTLS_GCM_ALT
+
+/* SHA */
+#define MBEDTLS_SHA1_C
+#define MBEDTLS_SHA1_ALT
+#define MBEDTLS_SHA224_C
+#define MBEDTLS_SHA256_C
+#define MBEDTLS_SHA256_ALT
+#define MBEDTLS_SHA384_C
+#define MBEDTLS_SHA512_C
+#define MBEDTLS_SHA512_ALT
+
+/* ECDSA and ECDH, the engine curves and two done in software */
+#define MBEDTLS_BIGNUM_C
+#define MBEDTLS_ECP_C
+#define MBEDTLS_ECP_DP_SECP192R1_ENABLED
+#define MBEDTLS_ECP_DP_SECP256R1_ENABLED
+#define MBEDTLS_ECP_DP_SECP384R1_ENABLED
+#define MBEDTLS_ECP_DP_SECP521R1_ENABLED
+#define MBEDTLS_ECP_DP_BP256R1_ENABLED
+#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECDSA_DETERMINISTIC
+#define MBEDTLS_ECDSA_SIGN_ALT
+#define MBEDTLS_ECDSA_VERIFY_ALT
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_ECDH_GEN_PUBLIC_ALT
+#define MBEDTLS_ECDH_COMPUTE_SHARED_ALT
+#define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
+#define MBEDTLS_HMAC_DRBG_C
+#define MBEDTLS_MD_C
+
+/* RSA, private keys on the engine too */
+#define MBEDTLS_RSA_C
+#define MBEDTLS_RSA_PUBLIC_ALT
+#define MBEDTLS_RSA_PRIVATE_ALT
+#define MBEDTLS_RSA_PRIVATE_ALT_NO_EXP_BLINDING
+#define MBEDTLS_PKCS1_V15
+#define MBEDTLS_PKCS1_V21
+#define MBEDTLS_GENPRIME
+#define MBEDTLS_OID_C
+
+#define AES_ALT_HW_MIN_LEN      16
+#define GCM_ALT_HW_MIN_LEN      16
+#define GCM_ALT_HW_MAX_LEN      1024
+
+#endif /* __MBEDTLS_CONFIG_H__ */
@@ -0,0 +1,207 @@
+/**************************************************************************//**
+ * @file     rsa_host.c
+ * @brief    Checks the RSA alternative of rsa_alt.c against the software
+ *           big numbers of mbedtls on a Linux host, with the engine model of
+ *           crpt_host.c. Build with Makefile.host.
+ *
+ * Runs the mbedtls RSA self test with its standard key, then generated keys
+ * of the engine sizes and one rsa.c keeps: public and private operations
+ * against mbedtls_mpi_exp_mod(), inputs with leading zeros and one above the
+ * modulus, PKCS#1 v1.5 and v2.1 signatures and encryption round trips. An
+ * engine error must come back as MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED, and
+ * a wrong private result must be caught before it leaves.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbedtls/rsa.h"
+#include "mbedtls/error.h"
+
+#include "crpt_host.h"
+
+#define RSAH_LOOPS      6
+
+typedef struct
+{
+    unsigned int bits;
+    int engine;
+}
+rsah_key_t;
+
+static const rsah_key_t rsah_keys[] =
+{
+    { 1024, 1 },
+    { 2048, 1 },
+    { 3072, 1 },
+    { 1536, 0 },
+};
+
+#define RSAH_KEYS       ((int)(sizeof(rsah_keys) / sizeof(rsah_keys[0])))
+
+static int rsah_reported;
+
+static int rsah_rand(void *ctx, unsigned char *buf, size_t len)
+{
+    (void)ctx;
+    while (len--)
+        *buf++ = (unsigned char)rand();
+    return 0;
+}
+
+/* 1 and a report if ok is not set */
+static int rsah_check(int ok, unsigned int bits, const char *what)
+{
+    if (ok)
+        return 0;
+    if (rsah_reported++ < 10)
+        printf("%u bits: %s\n", bits, what);
+    return 1;
+}
+
+/* out = in^exp mod N in software */
+static void rsah_exp(const mbedtls_rsa_context *k, const mbedtls_mpi *exp,
+                     const unsigned char *in, unsigned char *out)
+{
+    mbedtls_mpi X;
+
+    mbedtls_mpi_init(&X);
+    mbedtls_mpi_read_binary(&X, in, k->len);
+    mbedtls_mpi_exp_mod(&X, &X, exp, &k->N, NULL);
+    mbedtls_mpi_write_binary(&X, out, k->len);
+    mbedtls_mpi_free(&X);
+}
+
+/* Raw operations against software, then the PKCS#1 schemes */
+static int rsah_one(mbedtls_rsa_context *k, unsigned int bits)
+{
+    unsigned char in[512], hw[512], sw[512], hash[32], pt[64];
+    size_t olen, len = k->len;
+    int fails = 0;
+
+    /* below the modulus, sometimes with leading zero bytes */
+    rsah_rand(NULL, in, len);
+    in[0] &= 0x3F;
+    if (rand() % 3 == 0)
+        memset(in, 0, 1 + rand() % 8);
+
+    rsah_exp(k, &k->E, in, sw);
+    fails += rsah_check((mbedtls_rsa_public(k, in, hw) == 0) && (memcmp(hw, sw, len) == 0),
+                        bits, "public operation differs");
+    rsah_exp(k, &k->D, in, sw);
+    fails += rsah_check((mbedtls_rsa_private(k, rsah_rand, NULL, in, hw) == 0) &&
+                        (memcmp(hw, sw, len) == 0), bits, "private operation differs");
+
+    /* the modulus itself is no input */
+    mbedtls_mpi_write_binary(&k->N, in, len);
+    fails += rsah_check(mbedtls_rsa_public(k, in, hw) != 0, bits, "input = N taken");
+
+    rsah_rand(NULL, hash, sizeof(hash));
+    mbedtls_rsa_set_padding(k, MBEDTLS_RSA_PKCS_V15, MBEDTLS_MD_NONE);
+    fails += rsah_check((mbedtls_rsa_pkcs1_sign(k, rsah_rand, NULL, MBEDTLS_MD_SHA256, 32, hash, hw) == 0) &&
+                        (mbedtls_rsa_pkcs1_verify(k, MBEDTLS_MD_SHA256, 32, hash, hw) == 0),
+                        bits, "PKCS#1 v1.5 signature not verified");
+    hash[0] ^= 1;
+    fails += rsah_check(mbedtls_rsa_pkcs1_verify(k, MBEDTLS_MD_SHA256, 32, hash, hw) != 0,
+                        bits, "PKCS#1 v1.5 signature of another hash verified");
+
+    mbedtls_rsa_set_padding(k, MBEDTLS_RSA_PKCS_V21, MBEDTLS_MD_SHA256);
+    fails += rsah_check((mbedtls_rsa_pkcs1_sign(k, rsah_rand, NULL, MBEDTLS_MD_SHA256, 32, hash, hw) == 0) &&
+                        (mbedtls_rsa_pkcs1_verify(k, MBEDTLS_MD_SHA256, 32, hash, hw) == 0),
+                        bits, "PSS signature not verified");
+    fails += rsah_check((mbedtls_rsa_pkcs1_encrypt(k, rsah_rand, NULL, 20, hash, hw) == 0) &&
+                        (mbedtls_rsa_pkcs1_decrypt(k, rsah_rand, NULL, &olen, hw, pt, sizeof(pt)) == 0) &&
+                        (olen == 20) && (memcmp(pt, hash, 20) == 0), bits, "OAEP round trip differs");
+
+    return fails;
+}
+
+/* An engine error, or a wrong private result, must not be taken for a result */
+static int rsah_fail(mbedtls_rsa_context *k)
+{
+    unsigned char in[512] = { 1 }, out[512];
+    int ret, fails = 0;
+
+    crpt_host_fail = 1;
+    ret = mbedtls_rsa_public(k, in, out);
+    if ((ret != MBEDTLS_ERROR_ADD(MBEDTLS_ERR_RSA_PUBLIC_FAILED, MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED)) ||
+        crpt_host_fail)
+    {
+        printf("engine error in the public operation: returned -0x%04x\n", (unsigned)-ret);
+        fails++;
+    }
+
+    crpt_host_fail = 1;
+    ret = mbedtls_rsa_private(k, rsah_rand, NULL, in, out);
+    if ((ret != MBEDTLS_ERROR_ADD(MBEDTLS_ERR_RSA_PRIVATE_FAILED, MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED)) ||
+        crpt_host_fail)
+    {
+        printf("engine error in the private operation: returned -0x%04x\n", (unsigned)-ret);
+        fails++;
+    }
+
+    /* the blinding values are in place, the next run is the private one */
+    crpt_host_corrupt = 1;
+    ret = mbedtls_rsa_private(k, rsah_rand, NULL, in, out);
+    if ((ret != MBEDTLS_ERR_RSA_VERIFY_FAILED) || crpt_host_corrupt)
+    {
+        printf("wrong private result: returned -0x%04x\n", (unsigned)-ret);
+        fails++;
+    }
+    crpt_host_fail = crpt_host_corrupt = 0;
+
+    return fails;
+}
+
+int main(void)
+{
+    mbedtls_rsa_context k;
+    unsigned long runs, before;
+    int i, n, fails = 0;
+
+    srand(4);
+
+    before = crpt_host_pka_runs;
+    if (mbedtls_rsa_self_test(0) != 0)
+        fails++;
+    printf("self test: %lu engine runs\n", crpt_host_pka_runs - before);
+    if (crpt_host_pka_runs == before)
+        fails++;
+
+    for (i = 0; i < RSAH_KEYS; i++)
+    {
+        mbedtls_rsa_init(&k);
+        if (mbedtls_rsa_gen_key(&k, rsah_rand, NULL, rsah_keys[i].bits, 65537) != 0)
+        {
+            printf("%u bits: no key\n", rsah_keys[i].bits);
+            mbedtls_rsa_free(&k);
+            fails++;
+            continue;
+        }
+
+        before = crpt_host_pka_runs;
+        for (n = 0; n < RSAH_LOOPS; n++)
+            fails += rsah_one(&k, rsah_keys[i].bits);
+        runs = crpt_host_pka_runs - before;
+        printf("%u-bit key, %d rounds against software, %lu engine runs\n", rsah_keys[i].bits,
+               RSAH_LOOPS, runs);
+        fails += rsah_check((runs != 0) == rsah_keys[i].engine, rsah_keys[i].bits,
+                            rsah_keys[i].engine ? "not run on the engine" : "run on the engine");
+
+        /* the faults on the first key */
+        if (i == 0)
+            fails += rsah_fail(&k);
+        mbedtls_rsa_free(&k);
+    }
+
+    if (crpt_host_locked() != 0)
+    {
+        printf("engine left locked\n");
+        fails++;
+    }
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,12 @@
+/**************************************************************************//**
+ * @file     semphr.h
+ * @brief    Stand-in for the FreeRTOS semphr.h on a Linux host, see FreeRTOS.h.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "FreeRTOS.h"
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+void vSemaphoreDelete(SemaphoreHandle_t xSemaphore);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t xSemaphore);
@@ -0,0 +1,345 @@
+/**************************************************************************//**
+ * @file     sha_host.c
+ * @brief    Checks the SHA-1/SHA-2 alternatives of sha1_alt.c, sha256_alt.c
+ *           and sha512_alt.c against the software hashes of mbedtls on a
+ *           Linux host, with the engine model of crpt_host.c. Build with
+ *           Makefile.host.
+ *
+ * Runs the mbedtls self tests with their standard vectors, then random
+ * messages for every digest against mbedtls_shaxxx_sw_xxx(): updates from
+ * empty to several times the input buffer, at word aligned and odd
+ * addresses, two digests fed in turns so that each one resumes from its
+ * saved state, and a clone finished halfway while the original goes on. An
+ * engine error must come back as MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED.
+ *
+ * Then crypto_hw_sha_update_sg() on its own: messages given as several
+ * lists of segments of any length, empty ones too, at word aligned and odd
+ * addresses, against the software digest of the joined message.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mbedtls/sha1.h"
+#include "mbedtls/sha256.h"
+#include "mbedtls/sha512.h"
+#include "mbedtls/error.h"
+
+#include "NuMicro.h"
+#include "crypto_hw.h"
+#include "crpt_host.h"
+
+#define SHAH_DATA_LEN   20000
+#define SHAH_LOOPS      600
+#define SHAH_UPDATES    12
+#define SHAH_SG_LOOPS   1000
+#define SHAH_SG_SEGS    8
+
+enum { SHAH_SHA1, SHAH_SHA224, SHAH_SHA256, SHAH_SHA384, SHAH_SHA512, SHAH_ALGS };
+
+static const char *shah_name[SHAH_ALGS] = { "SHA-1", "SHA-224", "SHA-256", "SHA-384", "SHA-512" };
+static const size_t shah_len[SHAH_ALGS] = { 20, 28, 32, 48, 64 };
+static const uint32_t shah_mode[SHAH_ALGS] = { SHA_MODE_SHA1, SHA_MODE_SHA224, SHA_MODE_SHA256,
+                                               SHA_MODE_SHA384, SHA_MODE_SHA512 };
+
+/* A digest on the alternative and the same one in software */
+typedef struct
+{
+    int alg;
+    union
+    {
+        mbedtls_sha1_context sha1;
+        mbedtls_sha256_context sha256;
+        mbedtls_sha512_context sha512;
+    } hw;
+    union
+    {
+        mbedtls_sha1_sw_context sha1;
+        mbedtls_sha256_sw_context sha256;
+        mbedtls_sha512_sw_context sha512;
+    } sw;
+}
+shah_ctx_t;
+
+static unsigned char shah_data[SHAH_DATA_LEN + 8] __attribute__((aligned(64)));
+static int shah_reported;
+
+static void shah_starts(shah_ctx_t *c, int alg)
+{
+    c->alg = alg;
+    switch (alg)
+    {
+    case SHAH_SHA1:
+        mbedtls_sha1_init(&c->hw.sha1);
+        mbedtls_sha1_starts(&c->hw.sha1);
+        mbedtls_sha1_sw_init(&c->sw.sha1);
+        mbedtls_sha1_sw_starts(&c->sw.sha1);
+        break;
+    case SHAH_SHA224:
+    case SHAH_SHA256:
+        mbedtls_sha256_init(&c->hw.sha256);
+        mbedtls_sha256_starts(&c->hw.sha256, alg == SHAH_SHA224);
+        mbedtls_sha256_sw_init(&c->sw.sha256);
+        mbedtls_sha256_sw_starts(&c->sw.sha256, alg == SHAH_SHA224);
+        break;
+    default:
+        mbedtls_sha512_init(&c->hw.sha512);
+        mbedtls_sha512_starts(&c->hw.sha512, alg == SHAH_SHA384);
+        mbedtls_sha512_sw_init(&c->sw.sha512);
+        mbedtls_sha512_sw_starts(&c->sw.sha512, alg == SHAH_SHA384);
+        break;
+    }
+}
+
+static int shah_update(shah_ctx_t *c, const unsigned char *data, size_t len)
+{
+    switch (c->alg)
+    {
+    case SHAH_SHA1:
+        mbedtls_sha1_sw_update(&c->sw.sha1, data, len);
+        return mbedtls_sha1_update(&c->hw.sha1, data, len);
+    case SHAH_SHA224:
+    case SHAH_SHA256:
+        mbedtls_sha256_sw_update(&c->sw.sha256, data, len);
+        return mbedtls_sha256_update(&c->hw.sha256, data, len);
+    default:
+        mbedtls_sha512_sw_update(&c->sw.sha512, data, len);
+        return mbedtls_sha512_update(&c->hw.sha512, data, len);
+    }
+}
+
+static void shah_clone(shah_ctx_t *dst, const shah_ctx_t *src)
+{
+    dst->alg = src->alg;
+    dst->sw = src->sw;
+    switch (src->alg)
+    {
+    case SHAH_SHA1:
+        mbedtls_sha1_init(&dst->hw.sha1);
+        mbedtls_sha1_clone(&dst->hw.sha1, &src->hw.sha1);
+        break;
+    case SHAH_SHA224:
+    case SHAH_SHA256:
+        mbedtls_sha256_init(&dst->hw.sha256);
+        mbedtls_sha256_clone(&dst->hw.sha256, &src->hw.sha256);
+        break;
+    default:
+        mbedtls_sha512_init(&dst->hw.sha512);
+        mbedtls_sha512_clone(&dst->hw.sha512, &src->hw.sha512);
+        break;
+    }
+}
+
+/* Finishes both digests, 1 if they differ. digest gets the software one
+ * unless NULL. */
+static int shah_finish(shah_ctx_t *c, const char *what, unsigned char *digest)
+{
+    unsigned char hw[64], sw[64];
+    int ret;
+
+    switch (c->alg)
+    {
+    case SHAH_SHA1:
+        ret = mbedtls_sha1_finish(&c->hw.sha1, hw);
+        mbedtls_sha1_sw_finish(&c->sw.sha1, sw);
+        mbedtls_sha1_free(&c->hw.sha1);
+        break;
+    case SHAH_SHA224:
+    case SHAH_SHA256:
+        ret = mbedtls_sha256_finish(&c->hw.sha256, hw);
+        mbedtls_sha256_sw_finish(&c->sw.sha256, sw);
+        mbedtls_sha256_free(&c->hw.sha256);
+        break;
+    default:
+        ret = mbedtls_sha512_finish(&c->hw.sha512, hw);
+        mbedtls_sha512_sw_finish(&c->sw.sha512, sw);
+        mbedtls_sha512_free(&c->hw.sha512);
+        break;
+    }
+
+    if (digest != NULL)
+        memcpy(digest, sw, shah_len[c->alg]);
+    if ((ret == 0) && (memcmp(hw, sw, shah_len[c->alg]) == 0))
+        return 0;
+    if (shah_reported++ < 10)
+        printf("%s, %s: digest differs (%d)\n", shah_name[c->alg], what, ret);
+    return 1;
+}
+
+/* Length of one update: mostly short, some empty, some above the buffer */
+static size_t shah_rand_len(void)
+{
+    switch (rand() % 8)
+    {
+    case 0:
+        return 0;
+    case 1:
+    case 2:
+        return (size_t)(rand() % 4000);
+    default:
+        return (size_t)(rand() % 300);
+    }
+}
+
+/* Two messages fed in turns, and a clone of the first one finished halfway */
+static int shah_one(int alg)
+{
+    shah_ctx_t c[2], half;
+    size_t pos[2] = { 0, SHAH_DATA_LEN / 2 }, len;
+    int i, k, n = rand() % SHAH_UPDATES, fails = 0, ret;
+
+    shah_starts(&c[0], alg);
+    shah_starts(&c[1], alg);
+
+    for (i = 0; i < n; i++)
+    {
+        for (k = 0; k < 2; k++)
+        {
+            len = shah_rand_len();
+            pos[k] += rand() % 5;
+            if (pos[k] + len > SHAH_DATA_LEN)
+                pos[k] = (size_t)(rand() % 5);
+            if (pos[k] + len > SHAH_DATA_LEN)
+                continue;
+            ret = shah_update(&c[k], shah_data + pos[k], len);
+            if (ret != 0)
+            {
+                printf("%s: update returned -0x%04x\n", shah_name[alg], (unsigned)-ret);
+                fails++;
+            }
+            pos[k] += len;
+        }
+
+        if (i == n / 2)
+        {
+            shah_clone(&half, &c[0]);
+            fails += shah_finish(&half, "clone", NULL);
+        }
+    }
+
+    fails += shah_finish(&c[0], "first message", NULL);
+    fails += shah_finish(&c[1], "second message", NULL);
+    return fails;
+}
+
+/*
+ * A message in several updates of segment lists, each segment somewhere in
+ * the data, against the software digest of the segments joined. The
+ * alternative gets the segments one by one alongside.
+ */
+static int shah_sg_one(int alg)
+{
+    crypto_hw_sha_t sha;
+    crypto_hw_seg_t seg[SHAH_SG_SEGS];
+    shah_ctx_t c;
+    unsigned char hw[64], ref[64];
+    size_t len, total = 0;
+    int i, k, nseg, n = 1 + rand() % 4, ret = 0, fails;
+
+    crypto_hw_sha_starts(&sha, shah_mode[alg], (alg >= SHAH_SHA384) ? 128 : 64,
+                         (uint32_t)shah_len[alg]);
+    shah_starts(&c, alg);
+
+    for (i = 0; (i < n) && (ret == 0); i++)
+    {
+        nseg = 1 + rand() % SHAH_SG_SEGS;
+        for (k = 0; k < nseg; k++)
+        {
+            len = (rand() % 3 == 0) ? 64 * (size_t)(rand() % 8) : shah_rand_len() % 1000;
+            seg[k].in = shah_data + (size_t)(rand() % (SHAH_DATA_LEN - 1000));
+            seg[k].out = NULL;
+            seg[k].len = len;
+            total += len;
+            shah_update(&c, seg[k].in, len);
+        }
+        ret = crypto_hw_sha_update_sg(&sha, seg, nseg);
+    }
+    /* the engine needs a byte to finish with */
+    if ((ret == 0) && (total == 0))
+    {
+        ret = crypto_hw_sha_update(&sha, shah_data, 1);
+        shah_update(&c, shah_data, 1);
+    }
+    if (ret == 0)
+        ret = crypto_hw_sha_finish(&sha, hw);
+
+    /* the alternative was fed the message in one piece per segment */
+    fails = shah_finish(&c, "segments one by one", ref);
+
+    if ((ret == 0) && (memcmp(hw, ref, shah_len[alg]) == 0))
+        return fails;
+    if (shah_reported++ < 10)
+        printf("%s scatter-gather, %d updates, %u bytes: digest differs (%d)\n", shah_name[alg],
+               n, (unsigned)total, ret);
+    return 1;
+}
+
+/* An engine error must not be taken for a result */
+static int shah_fail(void)
+{
+    mbedtls_sha256_context hw;
+    int ret;
+
+    mbedtls_sha256_init(&hw);
+    mbedtls_sha256_starts(&hw, 0);
+    crpt_host_fail = 1;
+    ret = mbedtls_sha256_update(&hw, shah_data, 1000);
+    mbedtls_sha256_free(&hw);
+
+    if ((ret == MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED) && !crpt_host_fail)
+        return 0;
+    printf("engine error: returned -0x%04x\n", (unsigned)-ret);
+    return 1;
+}
+
+int main(void)
+{
+    unsigned long runs[SHAH_ALGS], before;
+    int i, alg, fails = 0;
+
+    srand(2);
+    for (i = 0; i < (int)sizeof(shah_data); i++)
+        shah_data[i] = (unsigned char)rand();
+
+    before = crpt_host_sha_runs;
+    if ((mbedtls_sha1_self_test(0) != 0) || (mbedtls_sha256_self_test(0) != 0) ||
+        (mbedtls_sha512_self_test(0) != 0))
+    {
+        printf("self test failed\n");
+        fails++;
+    }
+    printf("self tests: %lu engine runs\n", crpt_host_sha_runs - before);
+    if (crpt_host_sha_runs == before)
+        fails++;
+
+    memset(runs, 0, sizeof(runs));
+    for (i = 0; i < SHAH_LOOPS * SHAH_ALGS; i++)
+    {
+        alg = i % SHAH_ALGS;
+        before = crpt_host_sha_runs;
+        fails += shah_one(alg);
+        runs[alg] += crpt_host_sha_runs - before;
+    }
+    for (alg = 0; alg < SHAH_ALGS; alg++)
+        printf("%-7s %d message pairs against software, %lu engine runs\n", shah_name[alg],
+               SHAH_LOOPS, runs[alg]);
+
+    before = crpt_host_sha_runs;
+    for (i = 0; i < SHAH_SG_LOOPS; i++)
+        fails += shah_sg_one(i % SHAH_ALGS);
+    printf("scatter-gather: %d messages against software, %lu engine runs\n", SHAH_SG_LOOPS,
+           crpt_host_sha_runs - before);
+
+    fails += shah_fail();
+
+    if (crpt_host_locked() != 0)
+    {
+        printf("engine left locked\n");
+        fails++;
+    }
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
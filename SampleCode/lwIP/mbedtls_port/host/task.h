@@ -0,0 +1,17 @@
+/**************************************************************************//**
+ * @file     task.h
+ * @brief    Stand-in for the FreeRTOS task.h on a Linux host, see FreeRTOS.h.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "FreeRTOS.h"
+
+#define taskSCHEDULER_RUNNING       ((BaseType_t)2)
+
+BaseType_t xTaskGetSchedulerState(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t ulTaskNotifyTakeIndexed(UBaseType_t uxIndexToWaitOn, BaseType_t xClearCountOnExit,
+                                 TickType_t xTicksToWait);
+BaseType_t xTaskNotifyGiveIndexed(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify);
+void vTaskNotifyGiveIndexedFromISR(TaskHandle_t xTaskToNotify, UBaseType_t uxIndexToNotify,
+                                   BaseType_t *pxHigherPriorityTaskWoken);
@@ -0,0 +1,89 @@
+/**************************************************************************//**
+ * @file     aes_alt.h
+ * @brief    mbedtls AES on the CRPT AES engine (MBEDTLS_AES_ALT)
+ *
+ * ECB, CBC, CFB128 and CTR requests of at least AES_ALT_HW_MIN_LEN bytes are
+ * run by the engine, anything shorter is done in software where the engine
+ * setup would cost more than the computation. OFB, CFB8 and XTS are always
+ * done in software. Requests the engine cannot DMA in place go through the
+ * bounce buffer of crypto_hw.c, see CRYPTO_HW_SG_BUF_SIZE.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __AES_ALT_H__
+#define __AES_ALT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Smallest request handed to the engine, in bytes */
+#ifndef AES_ALT_HW_MIN_LEN
+#define AES_ALT_HW_MIN_LEN      256
+#endif
+
+/* Software AES of mbedtls, built from library/aes.c by aes_sw.c.
+ * Must keep the layout of mbedtls_aes_context in mbedtls/aes.h. */
+typedef struct mbedtls_aes_sw_context
+{
+    int MBEDTLS_PRIVATE(nr);
+    uint32_t *MBEDTLS_PRIVATE(rk);
+    uint32_t MBEDTLS_PRIVATE(buf)[68];
+}
+mbedtls_aes_sw_context;
+
+typedef struct mbedtls_aes_context
+{
+    mbedtls_aes_sw_context MBEDTLS_PRIVATE(sw);     /* round keys of the software path */
+    uint32_t MBEDTLS_PRIVATE(keys)[8];              /* key as big-endian words for AES_SetKey() */
+    uint32_t MBEDTLS_PRIVATE(keysize);              /* AES_KEY_SIZE_128/192/256 */
+}
+mbedtls_aes_context;
+
+#if defined(MBEDTLS_CIPHER_MODE_XTS)
+typedef struct mbedtls_aes_sw_xts_context
+{
+    mbedtls_aes_sw_context MBEDTLS_PRIVATE(crypt);
+    mbedtls_aes_sw_context MBEDTLS_PRIVATE(tweak);
+}
+mbedtls_aes_sw_xts_context;
+
+typedef mbedtls_aes_sw_xts_context mbedtls_aes_xts_context;
+#endif /* MBEDTLS_CIPHER_MODE_XTS */
+
+void mbedtls_aes_sw_init(mbedtls_aes_sw_context *ctx);
+void mbedtls_aes_sw_free(mbedtls_aes_sw_context *ctx);
+int mbedtls_aes_sw_setkey_enc(mbedtls_aes_sw_context *ctx, const unsigned char *key,
+                              unsigned int keybits);
+int mbedtls_aes_sw_setkey_dec(mbedtls_aes_sw_context *ctx, const unsigned char *key,
+                              unsigned int keybits);
+int mbedtls_aes_sw_crypt_ecb(mbedtls_aes_sw_context *ctx, int mode,
+                             const unsigned char input[16], unsigned char output[16]);
+int mbedtls_internal_aes_sw_encrypt(mbedtls_aes_sw_context *ctx,
+                                    const unsigned char input[16], unsigned char output[16]);
+int mbedtls_internal_aes_sw_decrypt(mbedtls_aes_sw_context *ctx,
+                                    const unsigned char input[16], unsigned char output[16]);
+int mbedtls_aes_sw_crypt_cbc(mbedtls_aes_sw_context *ctx, int mode, size_t length,
+                             unsigned char iv[16], const unsigned char *input,
+                             unsigned char *output);
+int mbedtls_aes_sw_crypt_cfb128(mbedtls_aes_sw_context *ctx, int mode, size_t length,
+                                size_t *iv_off, unsigned char iv[16],
+                                const unsigned char *input, unsigned char *output);
+int mbedtls_aes_sw_crypt_cfb8(mbedtls_aes_sw_context *ctx, int mode, size_t length,
+                              unsigned char iv[16], const unsigned char *input,
+                              unsigned char *output);
+int mbedtls_aes_sw_crypt_ofb(mbedtls_aes_sw_context *ctx, size_t length, size_t *iv_off,
+                             unsigned char iv[16], const unsigned char *input,
+                             unsigned char *output);
+int mbedtls_aes_sw_crypt_ctr(mbedtls_aes_sw_context *ctx, size_t length, size_t *nc_off,
+                             unsigned char nonce_counter[16], unsigned char stream_block[16],
+                             const unsigned char *input, unsigned char *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __AES_ALT_H__ */
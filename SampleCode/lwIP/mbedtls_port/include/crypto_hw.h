@@ -0,0 +1,117 @@
+/**************************************************************************//**
+ * @file     crypto_hw.h
+ * @brief    Shared access to the CRPT engine for the mbedtls alternative
+ *           implementations
+ *
+ * Each engine of CRPT (AES, SHA, ECC/RSA) is owned by one task at a time.
+ * The engine is used directly on parts where the application core has
+ * access to CRPT; on MA35D05K crypto goes through the TSI and the alternative
+ * implementations fall back to software.
+ *
+ * An engine is either held by a task through crypto_hw_lock(), whose blocking
+ * driver calls then sleep until the engine interrupt, or it runs the queue of
+ * asynchronous jobs given to crypto_hw_submit(). Jobs are started one after
+ * the other from the interrupt; a task asking for the lock gets the engine
+ * once the running job ends. The AES and SHA engines work in parallel.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __CRYPTO_HW_H__
+#define __CRYPTO_HW_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRYPTO_HW_AES       0   /* AES/SM4 engine */
+#define CRYPTO_HW_SHA       1   /* SHA/HMAC engine */
+#define CRYPTO_HW_PKA       2   /* ECC and RSA engines, they share the big number buffers */
+#define CRYPTO_HW_CNT       3
+
+/* Task notification index used to wake tasks waiting for an engine, needs
+ * configTASK_NOTIFICATION_ARRAY_ENTRIES above it */
+#ifndef CRYPTO_HW_NOTIFY_INDEX
+#define CRYPTO_HW_NOTIFY_INDEX  1
+#endif
+
+/* Cache line of the Cortex-A35, buffers written by the engine are aligned to it */
+#define CRYPTO_HW_LINE      64
+
+/* Words of SHA engine state saved between the DMA of a cascade */
+#define CRYPTO_HW_SHA_FDBCK     88
+
+/* Input kept back from the SHA engine until more arrives, a multiple of the
+ * largest block size. Small updates are only copied. */
+#ifndef CRYPTO_HW_SHA_BUF_SIZE
+#define CRYPTO_HW_SHA_BUF_SIZE  256
+#endif
+
+/* Bounce buffer of scatter-gather AES requests, also taking the aes_alt.c
+ * requests the DMA cannot use in place, a multiple of 64 */
+#ifndef CRYPTO_HW_SG_BUF_SIZE
+#define CRYPTO_HW_SG_BUF_SIZE   1024
+#endif
+
+/* One buffer of a scatter-gather request. For a pbuf chain there is one per
+ * pbuf with in = out = p->payload and len = p->len. */
+typedef struct crypto_hw_seg
+{
+    const void *in;
+    void *out;                                  /* AES output, may be in */
+    size_t len;
+}
+crypto_hw_seg_t;
+
+/* A digest in progress on the SHA engine. Everything the engine needs to
+ * resume is in here, so contexts can be copied and interleaved freely. */
+typedef struct crypto_hw_sha
+{
+    uint32_t mode;                              /* SHA_MODE_xxx */
+    uint32_t block;                             /* block size in bytes, 64 or 128 */
+    uint32_t dgst_len;                          /* digest size in bytes */
+    uint32_t started;                           /* fdbck holds the engine state */
+    uint32_t buf_len;                           /* bytes in buf */
+    uint32_t buf[CRYPTO_HW_SHA_BUF_SIZE / 4];   /* word aligned for the DMA */
+    uint32_t fdbck[CRYPTO_HW_SHA_FDBCK];
+}
+crypto_hw_sha_t;
+
+/* An asynchronous request on one engine. ECC and RSA operations take several
+ * engine runs with software steps in between, they go through crypto_hw_lock()
+ * instead. */
+typedef struct crypto_hw_job
+{
+    struct crypto_hw_job *next;                 /* queue link, owned by crypto_hw.c */
+    /* Programs the engine and starts it with AES_Trigger() or SHA_Trigger()
+     * without waiting, returns 0 once started. Called in the submitting task
+     * or from the interrupt when the previous job ends. */
+    int (*start)(struct crypto_hw_job *job);
+    /* Called from the interrupt when the engine is done, or in the task
+     * starting the job if start() failed. NULL to wake the submitting task,
+     * see crypto_hw_job_wait(). */
+    void (*done)(struct crypto_hw_job *job);
+    void *arg;                                  /* for start() and done() */
+    void *task;                                 /* submitting task */
+    volatile int status;                        /* 1 pending, 0 done, -1 failed */
+}
+crypto_hw_job_t;
+
+int  crypto_hw_available(void);
+void crypto_hw_lock(int engine);
+void crypto_hw_unlock(int engine);
+
+void crypto_hw_submit(int engine, crypto_hw_job_t *job);
+int  crypto_hw_job_wait(crypto_hw_job_t *job);
+
+int  crypto_hw_dma_direct(const void *in, const void *out, size_t len);
+void crypto_hw_dma_prepare(const void *in, void *out, size_t len);
+void crypto_hw_dma_complete(void *out, size_t len);
+
+int  crypto_hw_aes_sg(uint32_t opmode, int encrypt, const uint32_t keys[8], uint32_t keysize,
+                      unsigned char iv[16], const crypto_hw_seg_t *seg, int nseg);
+
+void crypto_hw_sha_starts(crypto_hw_sha_t *sha, uint32_t mode, uint32_t block, uint32_t dgst_len);
+int  crypto_hw_sha_update(crypto_hw_sha_t *sha, const unsigned char *input, size_t ilen);
+int  crypto_hw_sha_update_sg(crypto_hw_sha_t *sha, const crypto_hw_seg_t *seg, int nseg);
+int  crypto_hw_sha_finish(crypto_hw_sha_t *sha, unsigned char *output);
+
+#endif
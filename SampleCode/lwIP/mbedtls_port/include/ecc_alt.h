@@ -0,0 +1,41 @@
+/**************************************************************************//**
+ * @file     ecc_alt.h
+ * @brief    mbedtls ECDSA and ECDH on the CRPT ECC engine
+ *           (MBEDTLS_ECDSA_SIGN_ALT, MBEDTLS_ECDSA_VERIFY_ALT,
+ *           MBEDTLS_ECDH_GEN_PUBLIC_ALT, MBEDTLS_ECDH_COMPUTE_SHARED_ALT)
+ *
+ * P-256, P-384 and P-521 are run by the engine. Other curves, and parts
+ * without access to the engine, use the software implementation of mbedtls,
+ * built a second time under the names below by ecdsa_sw.c and ecdh_sw.c.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __ECC_ALT_H__
+#define __ECC_ALT_H__
+
+#include <stddef.h>
+#include "mbedtls/ecp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int mbedtls_ecdsa_sw_can_do(mbedtls_ecp_group_id gid);
+int mbedtls_ecdsa_sw_sign(mbedtls_ecp_group *grp, mbedtls_mpi *r, mbedtls_mpi *s,
+                          const mbedtls_mpi *d, const unsigned char *buf, size_t blen,
+                          int (*f_rng)(void *, unsigned char *, size_t), void *p_rng);
+int mbedtls_ecdsa_sw_verify(mbedtls_ecp_group *grp, const unsigned char *buf, size_t blen,
+                            const mbedtls_ecp_point *Q, const mbedtls_mpi *r,
+                            const mbedtls_mpi *s);
+
+int mbedtls_ecdh_sw_gen_public(mbedtls_ecp_group *grp, mbedtls_mpi *d, mbedtls_ecp_point *Q,
+                               int (*f_rng)(void *, unsigned char *, size_t), void *p_rng);
+int mbedtls_ecdh_sw_compute_shared(mbedtls_ecp_group *grp, mbedtls_mpi *z,
+                                   const mbedtls_ecp_point *Q, const mbedtls_mpi *d,
+                                   int (*f_rng)(void *, unsigned char *, size_t), void *p_rng);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __ECC_ALT_H__ */
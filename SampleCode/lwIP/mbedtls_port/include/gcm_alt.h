@@ -0,0 +1,97 @@
+/**************************************************************************//**
+ * @file     gcm_alt.h
+ * @brief    mbedtls AES-GCM on the CRPT AES engine (MBEDTLS_GCM_ALT)
+ *
+ * mbedtls_gcm_crypt_and_tag() and mbedtls_gcm_auth_decrypt(), which the
+ * cipher layer uses for TLS records, run on the engine in one pass for AES
+ * keys, 12-byte IVs and requests of GCM_ALT_HW_MIN_LEN up to
+ * GCM_ALT_HW_MAX_LEN bytes. The streaming functions, other IV sizes and
+ * other block ciphers are done in software.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __GCM_ALT_H__
+#define __GCM_ALT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "mbedtls/cipher.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Smallest request handed to the engine, in bytes */
+#ifndef GCM_ALT_HW_MIN_LEN
+#define GCM_ALT_HW_MIN_LEN      64
+#endif
+
+/* Largest request handed to the engine, in bytes. The default covers the
+ * default MBEDTLS_SSL_IN_CONTENT_LEN and MBEDTLS_SSL_OUT_CONTENT_LEN. */
+#ifndef GCM_ALT_HW_MAX_LEN
+#define GCM_ALT_HW_MAX_LEN      16384
+#endif
+
+/* Largest additional data handed to the engine, in bytes. TLS uses 13 bytes,
+ * more with a connection ID. */
+#ifndef GCM_ALT_HW_MAX_AAD
+#define GCM_ALT_HW_MAX_AAD      64
+#endif
+
+/* Software GCM of mbedtls, built from library/gcm.c by gcm_sw.c.
+ * Must keep the layout of mbedtls_gcm_context in mbedtls/gcm.h. */
+typedef struct mbedtls_gcm_sw_context
+{
+    mbedtls_cipher_context_t MBEDTLS_PRIVATE(cipher_ctx);
+    uint64_t MBEDTLS_PRIVATE(HL)[16];
+    uint64_t MBEDTLS_PRIVATE(HH)[16];
+    uint64_t MBEDTLS_PRIVATE(len);
+    uint64_t MBEDTLS_PRIVATE(add_len);
+    unsigned char MBEDTLS_PRIVATE(base_ectr)[16];
+    unsigned char MBEDTLS_PRIVATE(y)[16];
+    unsigned char MBEDTLS_PRIVATE(buf)[16];
+    int MBEDTLS_PRIVATE(mode);
+}
+mbedtls_gcm_sw_context;
+
+typedef struct mbedtls_gcm_context
+{
+    mbedtls_gcm_sw_context MBEDTLS_PRIVATE(sw);     /* software path and streaming */
+    uint32_t MBEDTLS_PRIVATE(keys)[8];              /* key as big-endian words for AES_SetKey() */
+    uint32_t MBEDTLS_PRIVATE(keysize);              /* AES_KEY_SIZE_128/192/256 */
+    int MBEDTLS_PRIVATE(use_hw);                    /* AES key, the engine can run it */
+}
+mbedtls_gcm_context;
+
+void mbedtls_gcm_sw_init(mbedtls_gcm_sw_context *ctx);
+void mbedtls_gcm_sw_free(mbedtls_gcm_sw_context *ctx);
+int mbedtls_gcm_sw_setkey(mbedtls_gcm_sw_context *ctx, mbedtls_cipher_id_t cipher,
+                          const unsigned char *key, unsigned int keybits);
+int mbedtls_gcm_sw_starts(mbedtls_gcm_sw_context *ctx, int mode,
+                          const unsigned char *iv, size_t iv_len);
+int mbedtls_gcm_sw_update_ad(mbedtls_gcm_sw_context *ctx,
+                             const unsigned char *add, size_t add_len);
+int mbedtls_gcm_sw_update(mbedtls_gcm_sw_context *ctx,
+                          const unsigned char *input, size_t input_length,
+                          unsigned char *output, size_t output_size,
+                          size_t *output_length);
+int mbedtls_gcm_sw_finish(mbedtls_gcm_sw_context *ctx,
+                          unsigned char *output, size_t output_size,
+                          size_t *output_length,
+                          unsigned char *tag, size_t tag_len);
+int mbedtls_gcm_sw_crypt_and_tag(mbedtls_gcm_sw_context *ctx, int mode, size_t length,
+                                 const unsigned char *iv, size_t iv_len,
+                                 const unsigned char *add, size_t add_len,
+                                 const unsigned char *input, unsigned char *output,
+                                 size_t tag_len, unsigned char *tag);
+int mbedtls_gcm_sw_auth_decrypt(mbedtls_gcm_sw_context *ctx, size_t length,
+                                const unsigned char *iv, size_t iv_len,
+                                const unsigned char *add, size_t add_len,
+                                const unsigned char *tag, size_t tag_len,
+                                const unsigned char *input, unsigned char *output);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __GCM_ALT_H__ */
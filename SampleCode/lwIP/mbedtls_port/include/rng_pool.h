@@ -0,0 +1,52 @@
+/**************************************************************************//**
+ * @file     rng_pool.h
+ * @brief    Pool of TRNG random bytes refilled in the background
+ *
+ * A low priority task keeps a ring of random bytes full from the TRNG, on
+ * MA35D05K through the TSI, which must have been initialized with TSI_Init().
+ * Readers take bytes from the ring without locks and never wait for the
+ * generator unless they ask to. The pool is the mbedtls hardware entropy
+ * source (MBEDTLS_ENTROPY_HARDWARE_ALT) and rng_pool_entropy() can seed a
+ * CTR_DRBG directly.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __RNG_POOL_H__
+#define __RNG_POOL_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+
+/* Ring size in bytes, a power of 2. The task refills it when it falls to
+ * half. */
+#ifndef RNG_POOL_SIZE
+#define RNG_POOL_SIZE           1024
+#endif
+
+/* Priority of the refill task, it may spin on the TRNG while it works */
+#ifndef RNG_POOL_TASK_PRIORITY
+#define RNG_POOL_TASK_PRIORITY  (tskIDLE_PRIORITY + 1)
+#endif
+
+#ifndef RNG_POOL_TASK_STACK
+#define RNG_POOL_TASK_STACK     (configMINIMAL_STACK_SIZE * 2)
+#endif
+
+/* The TRNG is instantiated again from fresh noise after this many bytes */
+#ifndef RNG_POOL_RESEED_BYTES
+#define RNG_POOL_RESEED_BYTES   (64 * 1024)
+#endif
+
+/* Longest wait of the mbedtls entropy callbacks for a pool that is still
+ * filling, right after boot */
+#ifndef RNG_POOL_SEED_WAIT
+#define RNG_POOL_SEED_WAIT      pdMS_TO_TICKS(1000)
+#endif
+
+int    rng_pool_start(void);
+size_t rng_pool_get(void *buf, size_t len);
+int    rng_pool_read(void *buf, size_t len, TickType_t wait);
+int    rng_pool_entropy(void *data, unsigned char *output, size_t len);
+
+#endif
@@ -0,0 +1,52 @@
+/**************************************************************************//**
+ * @file     sha1_alt.h
+ * @brief    mbedtls SHA-1 on the CRPT SHA engine (MBEDTLS_SHA1_ALT)
+ *
+ * Updates of any size are accepted, see crypto_hw_sha_update(). Parts without
+ * access to the engine use the software implementation of mbedtls.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __SHA1_ALT_H__
+#define __SHA1_ALT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto_hw.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Software SHA-1 of mbedtls, built from library/sha1.c by sha1_sw.c.
+ * Must keep the layout of mbedtls_sha1_context in mbedtls/sha1.h. */
+typedef struct mbedtls_sha1_sw_context
+{
+    uint32_t MBEDTLS_PRIVATE(total)[2];
+    uint32_t MBEDTLS_PRIVATE(state)[5];
+    unsigned char MBEDTLS_PRIVATE(buffer)[64];
+}
+mbedtls_sha1_sw_context;
+
+typedef struct mbedtls_sha1_context
+{
+    mbedtls_sha1_sw_context MBEDTLS_PRIVATE(sw);  /* empty message, or no engine */
+    crypto_hw_sha_t MBEDTLS_PRIVATE(hw);
+    int MBEDTLS_PRIVATE(use_hw);
+}
+mbedtls_sha1_context;
+
+void mbedtls_sha1_sw_init(mbedtls_sha1_sw_context *ctx);
+void mbedtls_sha1_sw_free(mbedtls_sha1_sw_context *ctx);
+int mbedtls_sha1_sw_starts(mbedtls_sha1_sw_context *ctx);
+int mbedtls_sha1_sw_update(mbedtls_sha1_sw_context *ctx, const unsigned char *input,
+                           size_t ilen);
+int mbedtls_sha1_sw_finish(mbedtls_sha1_sw_context *ctx, unsigned char output[20]);
+int mbedtls_internal_sha1_sw_process(mbedtls_sha1_sw_context *ctx,
+                                     const unsigned char data[64]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SHA1_ALT_H__ */
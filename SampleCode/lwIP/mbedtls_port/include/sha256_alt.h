@@ -0,0 +1,53 @@
+/**************************************************************************//**
+ * @file     sha256_alt.h
+ * @brief    mbedtls SHA-224/SHA-256 on the CRPT SHA engine (MBEDTLS_SHA256_ALT)
+ *
+ * Updates of any size are accepted, see crypto_hw_sha_update(). Parts without
+ * access to the engine use the software implementation of mbedtls.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __SHA256_ALT_H__
+#define __SHA256_ALT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto_hw.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Software SHA-256 of mbedtls, built from library/sha256.c by sha256_sw.c.
+ * Must keep the layout of mbedtls_sha256_context in mbedtls/sha256.h. */
+typedef struct mbedtls_sha256_sw_context
+{
+    uint32_t MBEDTLS_PRIVATE(total)[2];
+    uint32_t MBEDTLS_PRIVATE(state)[8];
+    unsigned char MBEDTLS_PRIVATE(buffer)[64];
+    int MBEDTLS_PRIVATE(is224);
+}
+mbedtls_sha256_sw_context;
+
+typedef struct mbedtls_sha256_context
+{
+    mbedtls_sha256_sw_context MBEDTLS_PRIVATE(sw);  /* empty message, or no engine */
+    crypto_hw_sha_t MBEDTLS_PRIVATE(hw);
+    int MBEDTLS_PRIVATE(use_hw);
+}
+mbedtls_sha256_context;
+
+void mbedtls_sha256_sw_init(mbedtls_sha256_sw_context *ctx);
+void mbedtls_sha256_sw_free(mbedtls_sha256_sw_context *ctx);
+int mbedtls_sha256_sw_starts(mbedtls_sha256_sw_context *ctx, int is224);
+int mbedtls_sha256_sw_update(mbedtls_sha256_sw_context *ctx, const unsigned char *input,
+                             size_t ilen);
+int mbedtls_sha256_sw_finish(mbedtls_sha256_sw_context *ctx, unsigned char *output);
+int mbedtls_internal_sha256_sw_process(mbedtls_sha256_sw_context *ctx,
+                                       const unsigned char data[64]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SHA256_ALT_H__ */
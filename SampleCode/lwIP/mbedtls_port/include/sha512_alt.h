@@ -0,0 +1,55 @@
+/**************************************************************************//**
+ * @file     sha512_alt.h
+ * @brief    mbedtls SHA-384/SHA-512 on the CRPT SHA engine (MBEDTLS_SHA512_ALT)
+ *
+ * Updates of any size are accepted, see crypto_hw_sha_update(). Parts without
+ * access to the engine use the software implementation of mbedtls.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __SHA512_ALT_H__
+#define __SHA512_ALT_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include "crypto_hw.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Software SHA-512 of mbedtls, built from library/sha512.c by sha512_sw.c.
+ * Must keep the layout of mbedtls_sha512_context in mbedtls/sha512.h. */
+typedef struct mbedtls_sha512_sw_context
+{
+    uint64_t MBEDTLS_PRIVATE(total)[2];
+    uint64_t MBEDTLS_PRIVATE(state)[8];
+    unsigned char MBEDTLS_PRIVATE(buffer)[128];
+#if defined(MBEDTLS_SHA384_C)
+    int MBEDTLS_PRIVATE(is384);
+#endif
+}
+mbedtls_sha512_sw_context;
+
+typedef struct mbedtls_sha512_context
+{
+    mbedtls_sha512_sw_context MBEDTLS_PRIVATE(sw);  /* empty message, or no engine */
+    crypto_hw_sha_t MBEDTLS_PRIVATE(hw);
+    int MBEDTLS_PRIVATE(use_hw);
+}
+mbedtls_sha512_context;
+
+void mbedtls_sha512_sw_init(mbedtls_sha512_sw_context *ctx);
+void mbedtls_sha512_sw_free(mbedtls_sha512_sw_context *ctx);
+int mbedtls_sha512_sw_starts(mbedtls_sha512_sw_context *ctx, int is384);
+int mbedtls_sha512_sw_update(mbedtls_sha512_sw_context *ctx, const unsigned char *input,
+                             size_t ilen);
+int mbedtls_sha512_sw_finish(mbedtls_sha512_sw_context *ctx, unsigned char *output);
+int mbedtls_internal_sha512_sw_process(mbedtls_sha512_sw_context *ctx,
+                                       const unsigned char data[128]);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SHA512_ALT_H__ */
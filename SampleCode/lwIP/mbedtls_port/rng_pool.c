@@ -0,0 +1,237 @@
+/**************************************************************************//**
+ * @file     rng_pool.c
+ * @brief    Pool of TRNG random bytes refilled in the background
+ *
+ * The refill task is the only writer of rng_head and of the ring, readers
+ * claim bytes by moving rng_tail with a compare and swap. The TRNG driver
+ * busy-waits on its interrupt, so it is only ever run from the refill task,
+ * at low priority, and never on behalf of a reader.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "tsi_cmd.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "crypto_hw.h"
+#include "rng_pool.h"
+
+#include "mbedtls/build_info.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/platform_util.h"
+
+/* Bytes generated per step of the refill task, the ring is made of them */
+#define RNG_POOL_CHUNK          64
+
+#if (RNG_POOL_SIZE & (RNG_POOL_SIZE - 1)) || (RNG_POOL_SIZE < 2 * RNG_POOL_CHUNK)
+#error "RNG_POOL_SIZE must be a power of 2 of at least 2 * RNG_POOL_CHUNK"
+#endif
+
+/* The task sleeps once the ring is full and is woken at this level */
+#define RNG_POOL_LOW_WATER      (RNG_POOL_SIZE / 2)
+
+static uint8_t rng_ring[RNG_POOL_SIZE];
+static uint32_t rng_head;               /* bytes produced, written by the task */
+static uint32_t rng_tail;               /* bytes handed out */
+static int rng_state;                   /* 0 not started, 1 running, -1 TRNG failed */
+static TaskHandle_t rng_task;
+
+/* Destination of the TSI, read through its non-cacheable alias */
+static uint32_t rng_tsi_buf[RNG_POOL_CHUNK / 4] __attribute__((aligned(CRYPTO_HW_LINE)));
+
+/*
+ * Seeds the TRNG from its noise source and instantiates its DRBG. The first
+ * call also resets the engine and installs its interrupt handler.
+ */
+static int rng_hw_seed(void)
+{
+    static int opened;
+
+    if (Is_MA35D05K())
+        return (TSI_TRNG_Init(0, 0) == 0) ? 0 : -1;
+
+    if (!opened)
+    {
+        /* Enable TRNG engine clock */
+        outpw(TSI_CLK_BASE + 0xC, inpw(TSI_CLK_BASE + 0xC) | (1 << 25));
+
+        if (TRNG_Init() != 0)
+            return -1;
+        opened = 1;
+    }
+
+    if ((TRNG_GenNoise() != 0) || (TRNG_CreateState() != 0))
+        return -1;
+
+    return 0;
+}
+
+static int rng_hw_generate(uint32_t *words, int wcnt)
+{
+    uint32_t *buf;
+
+    if (!Is_MA35D05K())
+        return TRNG_GenerateRandomNumber(words, wcnt);
+
+    buf = nc_ptr(rng_tsi_buf);
+    if (TSI_TRNG_Gen_Random((uint32_t)wcnt, ptr_to_u32(buf)) != 0)
+        return -1;
+
+    memcpy(words, buf, (size_t)wcnt * 4);
+    memset(buf, 0, (size_t)wcnt * 4);
+    return 0;
+}
+
+static void rng_pool_task(void *arg)
+{
+    uint32_t words[RNG_POOL_CHUNK / 4];
+    uint32_t head, since_seed = RNG_POOL_RESEED_BYTES;
+
+    (void)arg;
+
+    for (;;)
+    {
+        head = rng_head;
+        if (head - __atomic_load_n(&rng_tail, __ATOMIC_ACQUIRE) > RNG_POOL_SIZE - RNG_POOL_CHUNK)
+        {
+            /* Full, a notification may be left over from an earlier refill */
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        if (since_seed >= RNG_POOL_RESEED_BYTES)
+        {
+            if (rng_hw_seed() != 0)
+                break;
+            since_seed = 0;
+        }
+
+        if (rng_hw_generate(words, RNG_POOL_CHUNK / 4) != 0)
+            break;
+        since_seed += RNG_POOL_CHUNK;
+
+        /* head only moves by whole chunks, so a chunk never wraps */
+        memcpy(&rng_ring[head & (RNG_POOL_SIZE - 1)], words, RNG_POOL_CHUNK);
+        __atomic_store_n(&rng_head, head + RNG_POOL_CHUNK, __ATOMIC_RELEASE);
+    }
+
+    mbedtls_platform_zeroize(words, sizeof(words));
+    __atomic_store_n(&rng_state, -1, __ATOMIC_RELEASE);
+    vTaskDelete(NULL);
+}
+
+/**
+ * Starts the refill task. Called on first use by the other functions,
+ * calling it at boot has the pool full by the time it is needed.
+ *
+ * @return 0 if the task runs, -1 if it could not be created or the TRNG failed
+ */
+int rng_pool_start(void)
+{
+    int state = 0;
+
+    if (__atomic_compare_exchange_n(&rng_state, &state, 1, 0,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+    {
+        if (xTaskCreate(rng_pool_task, "RngPool", RNG_POOL_TASK_STACK, NULL,
+                        RNG_POOL_TASK_PRIORITY, &rng_task) != pdPASS)
+        {
+            __atomic_store_n(&rng_state, -1, __ATOMIC_RELEASE);
+            return -1;
+        }
+        return 0;
+    }
+
+    return (state > 0) ? 0 : -1;
+}
+
+/**
+ * Takes up to len random bytes from the pool without waiting. Task context
+ * only; any number of tasks can read at the same time.
+ *
+ * @return the number of bytes copied to buf, 0 if the pool is empty
+ */
+size_t rng_pool_get(void *buf, size_t len)
+{
+    uint32_t head, tail, level, n, off, first;
+
+    /* What is left in the pool is still handed out if the TRNG failed */
+    rng_pool_start();
+
+    tail = __atomic_load_n(&rng_tail, __ATOMIC_ACQUIRE);
+    do
+    {
+        head = __atomic_load_n(&rng_head, __ATOMIC_ACQUIRE);
+        level = head - tail;
+        n = (len < level) ? (uint32_t)len : level;
+        if (n == 0)
+            return 0;
+
+        /* Copied before claiming; if another reader claims them first the
+         * swap fails and the copy is redone, the task never overwrites
+         * bytes that are not claimed yet */
+        off = tail & (RNG_POOL_SIZE - 1);
+        first = (n < RNG_POOL_SIZE - off) ? n : RNG_POOL_SIZE - off;
+        memcpy(buf, &rng_ring[off], first);
+        memcpy((uint8_t *)buf + first, rng_ring, n - first);
+    }
+    while (!__atomic_compare_exchange_n(&rng_tail, &tail, tail + n, 0,
+                                        __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    /* The reader that takes the level down to the low water wakes the task */
+    if ((level > RNG_POOL_LOW_WATER) && (level - n <= RNG_POOL_LOW_WATER) && (rng_task != NULL))
+        xTaskNotifyGive(rng_task);
+
+    return n;
+}
+
+/**
+ * Fills buf with len random bytes, waiting for the pool to be refilled if
+ * needed. Task context only.
+ *
+ * @param[in] wait  longest wait in ticks
+ * @return 0 on success, -1 on timeout or if the TRNG failed
+ */
+int rng_pool_read(void *buf, size_t len, TickType_t wait)
+{
+    TickType_t start = xTaskGetTickCount();
+    size_t done = 0;
+
+    for (;;)
+    {
+        done += rng_pool_get((uint8_t *)buf + done, len - done);
+        if (done == len)
+            return 0;
+
+        if ((__atomic_load_n(&rng_state, __ATOMIC_ACQUIRE) < 0) ||
+                (xTaskGetTickCount() - start >= wait))
+            return -1;
+
+        vTaskDelay(1);
+    }
+}
+
+/**
+ * Entropy callback for mbedtls_ctr_drbg_seed() and mbedtls_entropy_add_source().
+ */
+int rng_pool_entropy(void *data, unsigned char *output, size_t len)
+{
+    (void)data;
+
+    if (rng_pool_read(output, len, RNG_POOL_SEED_WAIT) != 0)
+        return MBEDTLS_ERR_ENTROPY_SOURCE_FAILED;
+
+    return 0;
+}
+
+#if defined(MBEDTLS_ENTROPY_HARDWARE_ALT)
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen)
+{
+    int ret;
+
+    ret = rng_pool_entropy(data, output, len);
+    *olen = (ret == 0) ? len : 0;
+    return ret;
+}
+#endif
@@ -0,0 +1,276 @@
+/**************************************************************************//**
+ * @file     rsa_alt.c
+ * @brief    mbedtls RSA public and private operations on the CRPT RSA engine
+ *           (MBEDTLS_RSA_PUBLIC_ALT, MBEDTLS_RSA_PRIVATE_ALT)
+ *
+ * Moduli of 1024, 2048, 3072 and 4096 bits go to the engine. Anything else is
+ * left to rsa.c.
+ *
+ * The engine cannot blind the private exponent, D + k * phi(N) does not fit
+ * its key buffer. Private keys therefore stay in rsa.c unless
+ * MBEDTLS_RSA_PRIVATE_ALT_NO_EXP_BLINDING is defined as well, which accepts
+ * the weaker side channel protection. The engine then runs them in CRT mode,
+ * the message is blinded in software as rsa.c does, and the result checked
+ * with the public key before it is released.
+ *
+ * The engine has one buffer pool for all operands, the PKA lock is held from
+ * loading the operands to reading the result.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_RSA_C) && (defined(MBEDTLS_RSA_PUBLIC_ALT) || defined(MBEDTLS_RSA_PRIVATE_ALT))
+
+#include "mbedtls/rsa.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
+#include "crypto_hw.h"
+
+/* Longest modulus the engine takes, 4096 bits */
+#define RSA_ALT_MAX_BYTES   512
+
+/* Operands of the engine as big-endian byte arrays, PKA lock held */
+static struct
+{
+    unsigned char m[RSA_ALT_MAX_BYTES];
+    unsigned char n[RSA_ALT_MAX_BYTES];
+    unsigned char e[RSA_ALT_MAX_BYTES];
+    unsigned char p[RSA_ALT_MAX_BYTES / 2];
+    unsigned char q[RSA_ALT_MAX_BYTES / 2];
+    unsigned char out[RSA_ALT_MAX_BYTES];
+} rsa_alt_buf;
+
+/*
+ * Checks if the engine takes the key, 1 if it does, 0 if the operation is
+ * done in software.
+ */
+static int rsa_alt_usable(const mbedtls_rsa_context *ctx, int is_priv)
+{
+    size_t nbits = mbedtls_mpi_bitlen(&ctx->N);
+
+    if (!crypto_hw_available())
+        return 0;
+
+#if !defined(MBEDTLS_RSA_PRIVATE_ALT_NO_EXP_BLINDING)
+    /* Exponent blinding only in rsa.c */
+    if (is_priv)
+        return 0;
+#endif
+
+    if ((nbits % 1024) != 0 || nbits > RSA_ALT_MAX_BYTES * 8)
+        return 0;
+
+    if (mbedtls_mpi_size(&ctx->E) > ctx->len)
+        return 0;
+
+    /* CRT mode takes both primes, each at most half the modulus */
+    if (is_priv &&
+        (mbedtls_mpi_cmp_int(&ctx->D, 0) <= 0 ||
+         mbedtls_mpi_size(&ctx->D) > ctx->len ||
+         mbedtls_mpi_cmp_int(&ctx->P, 0) <= 0 ||
+         mbedtls_mpi_bitlen(&ctx->P) > nbits / 2 ||
+         mbedtls_mpi_cmp_int(&ctx->Q, 0) <= 0 ||
+         mbedtls_mpi_bitlen(&ctx->Q) > nbits / 2))
+        return 0;
+
+    return 1;
+}
+
+/*
+ * X = A^E mod N, or A^D mod N in CRT mode with is_priv, on the engine.
+ * A must be lower than N.
+ */
+static int rsa_alt_exp(mbedtls_rsa_context *ctx, mbedtls_mpi *X,
+                       const mbedtls_mpi *A, int is_priv)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    size_t len = ctx->len;
+    int hw_ret, olen;
+
+    crypto_hw_lock(CRYPTO_HW_PKA);
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(A, rsa_alt_buf.m, len));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&ctx->N, rsa_alt_buf.n, len));
+
+    if (is_priv)
+    {
+        MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&ctx->D, rsa_alt_buf.e, len));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&ctx->P, rsa_alt_buf.p, len / 2));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&ctx->Q, rsa_alt_buf.q, len / 2));
+        hw_ret = RSA_DecryptCRT(CRPT, (int)(len * 8), rsa_alt_buf.m, (int)len,
+                                rsa_alt_buf.e, (int)len, rsa_alt_buf.n, (int)len,
+                                rsa_alt_buf.p, (int)(len / 2), rsa_alt_buf.q, (int)(len / 2),
+                                rsa_alt_buf.out, &olen);
+    }
+    else
+    {
+        MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&ctx->E, rsa_alt_buf.e, len));
+        hw_ret = RSA_Encrypt(CRPT, (int)(len * 8), rsa_alt_buf.m, (int)len,
+                             rsa_alt_buf.e, (int)len, rsa_alt_buf.n, (int)len,
+                             rsa_alt_buf.out, &olen);
+    }
+
+    if (hw_ret != 0)
+    {
+        ret = MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(X, rsa_alt_buf.out, olen));
+
+cleanup:
+    mbedtls_platform_zeroize(&rsa_alt_buf, sizeof(rsa_alt_buf));
+    crypto_hw_unlock(CRYPTO_HW_PKA);
+    return ret;
+}
+
+#if defined(MBEDTLS_RSA_PUBLIC_ALT)
+
+int mbedtls_rsa_public_alt(mbedtls_rsa_context *ctx,
+                           const unsigned char *input,
+                           unsigned char *output)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi T;
+
+    if (!rsa_alt_usable(ctx, 0))
+        return MBEDTLS_ERR_PLATFORM_FEATURE_UNSUPPORTED;
+
+    mbedtls_mpi_init(&T);
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&T, input, ctx->len));
+    if (mbedtls_mpi_cmp_mpi(&T, &ctx->N) >= 0)
+    {
+        ret = MBEDTLS_ERR_MPI_BAD_INPUT_DATA;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(rsa_alt_exp(ctx, &T, &T, 0));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&T, output, ctx->len));
+
+cleanup:
+    mbedtls_mpi_free(&T);
+
+    if (ret != 0)
+        return MBEDTLS_ERROR_ADD(MBEDTLS_ERR_RSA_PUBLIC_FAILED, ret);
+    return ret;
+}
+
+#endif /* MBEDTLS_RSA_PUBLIC_ALT */
+
+#if defined(MBEDTLS_RSA_PRIVATE_ALT)
+
+/*
+ * Blinding values as rsa_prepare_blinding() of rsa.c, kept in the same
+ * context fields: Vf random and invertible mod N, Vi = Vf^-E mod N, both
+ * squared on every further use. rsa.c holds the context mutex.
+ */
+static int rsa_alt_prepare_blinding(mbedtls_rsa_context *ctx,
+                                    int (*f_rng)(void *, unsigned char *, size_t),
+                                    void *p_rng)
+{
+    int ret, count = 0;
+    mbedtls_mpi R;
+
+    mbedtls_mpi_init(&R);
+
+    if (ctx->Vf.p != NULL)
+    {
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&ctx->Vi, &ctx->Vi, &ctx->Vi));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&ctx->Vi, &ctx->Vi, &ctx->N));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&ctx->Vf, &ctx->Vf, &ctx->Vf));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&ctx->Vf, &ctx->Vf, &ctx->N));
+        goto cleanup;
+    }
+
+    do
+    {
+        if (count++ > 10)
+        {
+            ret = MBEDTLS_ERR_RSA_RNG_FAILED;
+            goto cleanup;
+        }
+
+        MBEDTLS_MPI_CHK(mbedtls_mpi_fill_random(&ctx->Vf, ctx->len - 1, f_rng, p_rng));
+
+        /* Vf^-1 as R * (R Vf)^-1, inv_mod() never sees Vf */
+        MBEDTLS_MPI_CHK(mbedtls_mpi_fill_random(&R, ctx->len - 1, f_rng, p_rng));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&ctx->Vi, &ctx->Vf, &R));
+        MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&ctx->Vi, &ctx->Vi, &ctx->N));
+
+        ret = mbedtls_mpi_inv_mod(&ctx->Vi, &ctx->Vi, &ctx->N);
+        if (ret != 0 && ret != MBEDTLS_ERR_MPI_NOT_ACCEPTABLE)
+            goto cleanup;
+    } while (ret == MBEDTLS_ERR_MPI_NOT_ACCEPTABLE);
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&ctx->Vi, &ctx->Vi, &R));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&ctx->Vi, &ctx->Vi, &ctx->N));
+
+    MBEDTLS_MPI_CHK(rsa_alt_exp(ctx, &ctx->Vi, &ctx->Vi, 0));
+
+cleanup:
+    mbedtls_mpi_free(&R);
+    return ret;
+}
+
+int mbedtls_rsa_private_alt(mbedtls_rsa_context *ctx,
+                            int (*f_rng)(void *, unsigned char *, size_t),
+                            void *p_rng,
+                            const unsigned char *input,
+                            unsigned char *output)
+{
+    int ret = MBEDTLS_ERR_ERROR_CORRUPTION_DETECTED;
+    mbedtls_mpi T, I, C;
+
+    if (!rsa_alt_usable(ctx, 1))
+        return MBEDTLS_ERR_PLATFORM_FEATURE_UNSUPPORTED;
+
+    mbedtls_mpi_init(&T);
+    mbedtls_mpi_init(&I);
+    mbedtls_mpi_init(&C);
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&T, input, ctx->len));
+    if (mbedtls_mpi_cmp_mpi(&T, &ctx->N) >= 0)
+    {
+        ret = MBEDTLS_ERR_MPI_BAD_INPUT_DATA;
+        goto cleanup;
+    }
+    MBEDTLS_MPI_CHK(mbedtls_mpi_copy(&I, &T));
+
+    /* T = T * Vi mod N */
+    MBEDTLS_MPI_CHK(rsa_alt_prepare_blinding(ctx, f_rng, p_rng));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&T, &T, &ctx->Vi));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&T, &T, &ctx->N));
+
+    MBEDTLS_MPI_CHK(rsa_alt_exp(ctx, &T, &T, 1));
+
+    /* T = T * Vf mod N */
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&T, &T, &ctx->Vf));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&T, &T, &ctx->N));
+
+    /* A faulty result must not leave, it could give the primes away */
+    MBEDTLS_MPI_CHK(rsa_alt_exp(ctx, &C, &T, 0));
+    if (mbedtls_mpi_cmp_mpi(&C, &I) != 0)
+    {
+        ret = MBEDTLS_ERR_RSA_VERIFY_FAILED;
+        goto cleanup;
+    }
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&T, output, ctx->len));
+
+cleanup:
+    mbedtls_mpi_free(&T);
+    mbedtls_mpi_free(&I);
+    mbedtls_mpi_free(&C);
+
+    if (ret != 0 && ret >= -0x007f)
+        return MBEDTLS_ERROR_ADD(MBEDTLS_ERR_RSA_PRIVATE_FAILED, ret);
+    return ret;
+}
+
+#endif /* MBEDTLS_RSA_PRIVATE_ALT */
+
+#endif /* MBEDTLS_RSA_C && (MBEDTLS_RSA_PUBLIC_ALT || MBEDTLS_RSA_PRIVATE_ALT) */
@@ -0,0 +1,83 @@
+/**************************************************************************//**
+ * @file     sha1_alt.c
+ * @brief    mbedtls SHA-1 on the CRPT SHA engine (MBEDTLS_SHA1_ALT)
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_SHA1_C) && defined(MBEDTLS_SHA1_ALT)
+
+#include "mbedtls/sha1.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
+
+void mbedtls_sha1_init(mbedtls_sha1_context *ctx)
+{
+    memset(ctx, 0, sizeof(mbedtls_sha1_context));
+    mbedtls_sha1_sw_init(&ctx->sw);
+}
+
+void mbedtls_sha1_free(mbedtls_sha1_context *ctx)
+{
+    if (ctx == NULL)
+        return;
+
+    mbedtls_sha1_sw_free(&ctx->sw);
+    mbedtls_platform_zeroize(ctx, sizeof(mbedtls_sha1_context));
+}
+
+void mbedtls_sha1_clone(mbedtls_sha1_context *dst,
+                        const mbedtls_sha1_context *src)
+{
+    *dst = *src;
+}
+
+int mbedtls_sha1_starts(mbedtls_sha1_context *ctx)
+{
+    int ret;
+
+    ret = mbedtls_sha1_sw_starts(&ctx->sw);
+    if (ret != 0)
+        return ret;
+
+    ctx->use_hw = crypto_hw_available();
+    if (ctx->use_hw)
+        crypto_hw_sha_starts(&ctx->hw, SHA_MODE_SHA1, 64, 20);
+    return 0;
+}
+
+int mbedtls_sha1_update(mbedtls_sha1_context *ctx, const unsigned char *input,
+                        size_t ilen)
+{
+    if (!ctx->use_hw)
+        return mbedtls_sha1_sw_update(&ctx->sw, input, ilen);
+
+    if (crypto_hw_sha_update(&ctx->hw, input, ilen) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    return 0;
+}
+
+int mbedtls_internal_sha1_process(mbedtls_sha1_context *ctx,
+                                  const unsigned char data[64])
+{
+    if (!ctx->use_hw)
+        return mbedtls_internal_sha1_sw_process(&ctx->sw, data);
+
+    return mbedtls_sha1_update(ctx, data, 64);
+}
+
+int mbedtls_sha1_finish(mbedtls_sha1_context *ctx, unsigned char output[20])
+{
+    /* the engine needs at least one byte */
+    if (!ctx->use_hw || ((ctx->hw.started == 0) && (ctx->hw.buf_len == 0)))
+        return mbedtls_sha1_sw_finish(&ctx->sw, output);
+
+    if (crypto_hw_sha_finish(&ctx->hw, output) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    return 0;
+}
+
+#endif /* MBEDTLS_SHA1_C && MBEDTLS_SHA1_ALT */
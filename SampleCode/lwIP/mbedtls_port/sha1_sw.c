@@ -0,0 +1,28 @@
+/**************************************************************************//**
+ * @file     sha1_sw.c
+ * @brief    Software SHA-1 of mbedtls under the mbedtls_sha1_sw_ names
+ *
+ * Built from library/sha1.c for sha1_alt.c, see aes_sw.c.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_SHA1_C) && defined(MBEDTLS_SHA1_ALT)
+
+#undef MBEDTLS_SHA1_ALT
+#undef MBEDTLS_SELF_TEST
+
+#define mbedtls_sha1_context              mbedtls_sha1_sw_context
+#define mbedtls_sha1_init                 mbedtls_sha1_sw_init
+#define mbedtls_sha1_free                 mbedtls_sha1_sw_free
+#define mbedtls_sha1_clone                mbedtls_sha1_sw_clone
+#define mbedtls_sha1_starts               mbedtls_sha1_sw_starts
+#define mbedtls_sha1_update               mbedtls_sha1_sw_update
+#define mbedtls_sha1_finish               mbedtls_sha1_sw_finish
+#define mbedtls_internal_sha1_process     mbedtls_internal_sha1_sw_process
+#define mbedtls_sha1                      mbedtls_sha1_sw
+
+#include "sha1.c"
+
+#endif /* MBEDTLS_SHA1_C && MBEDTLS_SHA1_ALT */
@@ -0,0 +1,85 @@
+/**************************************************************************//**
+ * @file     sha256_alt.c
+ * @brief    mbedtls SHA-224/SHA-256 on the CRPT SHA engine (MBEDTLS_SHA256_ALT)
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_SHA256_C) && defined(MBEDTLS_SHA256_ALT)
+
+#include "mbedtls/sha256.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
+
+void mbedtls_sha256_init(mbedtls_sha256_context *ctx)
+{
+    memset(ctx, 0, sizeof(mbedtls_sha256_context));
+    mbedtls_sha256_sw_init(&ctx->sw);
+}
+
+void mbedtls_sha256_free(mbedtls_sha256_context *ctx)
+{
+    if (ctx == NULL)
+        return;
+
+    mbedtls_sha256_sw_free(&ctx->sw);
+    mbedtls_platform_zeroize(ctx, sizeof(mbedtls_sha256_context));
+}
+
+void mbedtls_sha256_clone(mbedtls_sha256_context *dst,
+                          const mbedtls_sha256_context *src)
+{
+    *dst = *src;
+}
+
+int mbedtls_sha256_starts(mbedtls_sha256_context *ctx, int is224)
+{
+    int ret;
+
+    /* also checks is224 against the configuration */
+    ret = mbedtls_sha256_sw_starts(&ctx->sw, is224);
+    if (ret != 0)
+        return ret;
+
+    ctx->use_hw = crypto_hw_available();
+    if (ctx->use_hw)
+        crypto_hw_sha_starts(&ctx->hw, is224 ? SHA_MODE_SHA224 : SHA_MODE_SHA256,
+                             64, is224 ? 28 : 32);
+    return 0;
+}
+
+int mbedtls_sha256_update(mbedtls_sha256_context *ctx, const unsigned char *input,
+                          size_t ilen)
+{
+    if (!ctx->use_hw)
+        return mbedtls_sha256_sw_update(&ctx->sw, input, ilen);
+
+    if (crypto_hw_sha_update(&ctx->hw, input, ilen) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    return 0;
+}
+
+int mbedtls_internal_sha256_process(mbedtls_sha256_context *ctx,
+                                    const unsigned char data[64])
+{
+    if (!ctx->use_hw)
+        return mbedtls_internal_sha256_sw_process(&ctx->sw, data);
+
+    return mbedtls_sha256_update(ctx, data, 64);
+}
+
+int mbedtls_sha256_finish(mbedtls_sha256_context *ctx, unsigned char *output)
+{
+    /* the engine needs at least one byte */
+    if (!ctx->use_hw || ((ctx->hw.started == 0) && (ctx->hw.buf_len == 0)))
+        return mbedtls_sha256_sw_finish(&ctx->sw, output);
+
+    if (crypto_hw_sha_finish(&ctx->hw, output) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    return 0;
+}
+
+#endif /* MBEDTLS_SHA256_C && MBEDTLS_SHA256_ALT */
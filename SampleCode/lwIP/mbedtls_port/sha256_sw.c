@@ -0,0 +1,28 @@
+/**************************************************************************//**
+ * @file     sha256_sw.c
+ * @brief    Software SHA-256 of mbedtls under the mbedtls_sha256_sw_ names
+ *
+ * Built from library/sha256.c for sha256_alt.c, see aes_sw.c.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_SHA256_C) && defined(MBEDTLS_SHA256_ALT)
+
+#undef MBEDTLS_SHA256_ALT
+#undef MBEDTLS_SELF_TEST
+
+#define mbedtls_sha256_context              mbedtls_sha256_sw_context
+#define mbedtls_sha256_init                 mbedtls_sha256_sw_init
+#define mbedtls_sha256_free                 mbedtls_sha256_sw_free
+#define mbedtls_sha256_clone                mbedtls_sha256_sw_clone
+#define mbedtls_sha256_starts               mbedtls_sha256_sw_starts
+#define mbedtls_sha256_update               mbedtls_sha256_sw_update
+#define mbedtls_sha256_finish               mbedtls_sha256_sw_finish
+#define mbedtls_internal_sha256_process     mbedtls_internal_sha256_sw_process
+#define mbedtls_sha256                      mbedtls_sha256_sw
+
+#include "sha256.c"
+
+#endif /* MBEDTLS_SHA256_C && MBEDTLS_SHA256_ALT */
@@ -0,0 +1,85 @@
+/**************************************************************************//**
+ * @file     sha512_alt.c
+ * @brief    mbedtls SHA-384/SHA-512 on the CRPT SHA engine (MBEDTLS_SHA512_ALT)
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <string.h>
+#include "NuMicro.h"
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_SHA512_C) && defined(MBEDTLS_SHA512_ALT)
+
+#include "mbedtls/sha512.h"
+#include "mbedtls/error.h"
+#include "mbedtls/platform_util.h"
+
+void mbedtls_sha512_init(mbedtls_sha512_context *ctx)
+{
+    memset(ctx, 0, sizeof(mbedtls_sha512_context));
+    mbedtls_sha512_sw_init(&ctx->sw);
+}
+
+void mbedtls_sha512_free(mbedtls_sha512_context *ctx)
+{
+    if (ctx == NULL)
+        return;
+
+    mbedtls_sha512_sw_free(&ctx->sw);
+    mbedtls_platform_zeroize(ctx, sizeof(mbedtls_sha512_context));
+}
+
+void mbedtls_sha512_clone(mbedtls_sha512_context *dst,
+                          const mbedtls_sha512_context *src)
+{
+    *dst = *src;
+}
+
+int mbedtls_sha512_starts(mbedtls_sha512_context *ctx, int is384)
+{
+    int ret;
+
+    /* also checks is384 against the configuration */
+    ret = mbedtls_sha512_sw_starts(&ctx->sw, is384);
+    if (ret != 0)
+        return ret;
+
+    ctx->use_hw = crypto_hw_available();
+    if (ctx->use_hw)
+        crypto_hw_sha_starts(&ctx->hw, is384 ? SHA_MODE_SHA384 : SHA_MODE_SHA512,
+                             128, is384 ? 48 : 64);
+    return 0;
+}
+
+int mbedtls_sha512_update(mbedtls_sha512_context *ctx, const unsigned char *input,
+                          size_t ilen)
+{
+    if (!ctx->use_hw)
+        return mbedtls_sha512_sw_update(&ctx->sw, input, ilen);
+
+    if (crypto_hw_sha_update(&ctx->hw, input, ilen) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    return 0;
+}
+
+int mbedtls_internal_sha512_process(mbedtls_sha512_context *ctx,
+                                    const unsigned char data[128])
+{
+    if (!ctx->use_hw)
+        return mbedtls_internal_sha512_sw_process(&ctx->sw, data);
+
+    return mbedtls_sha512_update(ctx, data, 128);
+}
+
+int mbedtls_sha512_finish(mbedtls_sha512_context *ctx, unsigned char *output)
+{
+    /* the engine needs at least one byte */
+    if (!ctx->use_hw || ((ctx->hw.started == 0) && (ctx->hw.buf_len == 0)))
+        return mbedtls_sha512_sw_finish(&ctx->sw, output);
+
+    if (crypto_hw_sha_finish(&ctx->hw, output) != 0)
+        return MBEDTLS_ERR_PLATFORM_HW_ACCEL_FAILED;
+    return 0;
+}
+
+#endif /* MBEDTLS_SHA512_C && MBEDTLS_SHA512_ALT */
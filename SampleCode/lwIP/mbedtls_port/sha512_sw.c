@@ -0,0 +1,28 @@
+/**************************************************************************//**
+ * @file     sha512_sw.c
+ * @brief    Software SHA-512 of mbedtls under the mbedtls_sha512_sw_ names
+ *
+ * Built from library/sha512.c for sha512_alt.c, see aes_sw.c.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "mbedtls/build_info.h"
+
+#if defined(MBEDTLS_SHA512_C) && defined(MBEDTLS_SHA512_ALT)
+
+#undef MBEDTLS_SHA512_ALT
+#undef MBEDTLS_SELF_TEST
+
+#define mbedtls_sha512_context              mbedtls_sha512_sw_context
+#define mbedtls_sha512_init                 mbedtls_sha512_sw_init
+#define mbedtls_sha512_free                 mbedtls_sha512_sw_free
+#define mbedtls_sha512_clone                mbedtls_sha512_sw_clone
+#define mbedtls_sha512_starts               mbedtls_sha512_sw_starts
+#define mbedtls_sha512_update               mbedtls_sha512_sw_update
+#define mbedtls_sha512_finish               mbedtls_sha512_sw_finish
+#define mbedtls_internal_sha512_process     mbedtls_internal_sha512_sw_process
+#define mbedtls_sha512                      mbedtls_sha512_sw
+
+#include "sha512.c"
+
+#endif /* MBEDTLS_SHA512_C && MBEDTLS_SHA512_ALT */
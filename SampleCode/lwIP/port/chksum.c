@@ -0,0 +1,142 @@
+/**************************************************************************//**
+ * @file     chksum.c
+ * @brief    Internet checksum for lwIP on AArch64
+ *
+ * Replaces lwip_standard_chksum() through LWIP_CHKSUM (see arch/cc.h). The
+ * result follows the same convention: the folded 16-bit one's complement sum
+ * of the data as stored in memory, not inverted.
+ *
+ * The default version sums 64-bit words with end-around carry. Setting
+ * LWIP_CHKSUM_NEON to 1 selects an Advanced SIMD version, which touches the
+ * FPU registers: every task that runs the stack must have called
+ * portTASK_USES_FLOATING_POINT() first.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "lwip/opt.h"
+#include "lwip/def.h"
+#include "lwip/inet_chksum.h"
+
+#if LWIP_CHKSUM_NEON
+#include <arm_neon.h>
+#endif
+
+#define FOLD_U64(s)     (((s) >> 32) + ((s) & 0xFFFFFFFFULL))
+#define FOLD_U32(s)     (((s) >> 16) + ((s) & 0xFFFFUL))
+
+/* One's complement sum of len bytes from an 8-byte aligned address */
+#if LWIP_CHKSUM_NEON
+
+static uint64_t chksum_block(const u8_t *pb, int len, uint64_t sum)
+{
+    uint32x4_t acc0, acc1;
+    int chunk;
+
+    while (len >= 32) {
+        /* Each lane gains at most 2 * 0xFFFF per 32 bytes, add the lanes
+           to the 64-bit sum every 64KB before they can overflow */
+        chunk = (len > 0x10000) ? 0x10000 : (len & ~31);
+        len -= chunk;
+
+        acc0 = vdupq_n_u32(0);
+        acc1 = vdupq_n_u32(0);
+        for (; chunk > 0; chunk -= 32, pb += 32) {
+            acc0 = vpadalq_u16(acc0, vld1q_u16((const uint16_t *)(const void *)pb));
+            acc1 = vpadalq_u16(acc1, vld1q_u16((const uint16_t *)(const void *)(pb + 16)));
+        }
+        sum += vaddlvq_u32(acc0) + vaddlvq_u32(acc1);
+    }
+
+    for (; len >= 8; len -= 8, pb += 8) {
+        uint64_t w = *(const uint64_t *)(const void *)pb;
+        sum += (w >> 32) + (w & 0xFFFFFFFFULL);
+    }
+
+    for (; len >= 2; len -= 2, pb += 2) {
+        sum += *(const u16_t *)(const void *)pb;
+    }
+
+    return sum;
+}
+
+#else
+
+static uint64_t chksum_block(const u8_t *pb, int len, uint64_t sum)
+{
+    const uint64_t *pw = (const uint64_t *)(const void *)pb;
+    uint64_t sum1 = 0, carry = 0, carry1 = 0;
+    uint64_t w;
+
+    /* Two independent add-with-carry chains per 16 bytes */
+    for (; len >= 16; len -= 16, pw += 2) {
+        w = pw[0];
+        sum += w;
+        carry += (sum < w);
+        w = pw[1];
+        sum1 += w;
+        carry1 += (sum1 < w);
+    }
+    if (len >= 8) {
+        w = *pw++;
+        sum += w;
+        carry += (sum < w);
+        len -= 8;
+    }
+
+    /* Fold down to 33 bits before adding the halves and carries */
+    sum = FOLD_U64(sum) + FOLD_U64(sum1) + carry + carry1;
+
+    for (pb = (const u8_t *)pw; len >= 2; len -= 2, pb += 2) {
+        sum += *(const u16_t *)(const void *)pb;
+    }
+
+    return sum;
+}
+
+#endif /* LWIP_CHKSUM_NEON */
+
+u16_t
+lwip_fast_chksum(const void *dataptr, int len)
+{
+    const u8_t *pb = (const u8_t *)dataptr;
+    u16_t t = 0;
+    uint64_t sum = 0;
+    int odd = ((mem_ptr_t)pb & 1);
+
+    /* Get aligned to u16_t */
+    if (odd && len > 0) {
+        ((u8_t *)&t)[1] = *pb++;
+        len--;
+    }
+
+    /* Get aligned to 8 bytes */
+    while (((mem_ptr_t)pb & 7) && len > 1) {
+        sum += *(const u16_t *)(const void *)pb;
+        pb += 2;
+        len -= 2;
+    }
+
+    sum = chksum_block(pb, len & ~1, sum);
+    pb += len & ~1;
+
+    /* Consume left-over byte, if any */
+    if (len & 1) {
+        ((u8_t *)&t)[0] = *pb;
+    }
+
+    /* Add end bytes */
+    sum += t;
+
+    sum = FOLD_U64(sum);
+    sum = FOLD_U64(sum);
+    sum = FOLD_U32(sum);
+    sum = FOLD_U32(sum);
+    sum = FOLD_U32(sum);
+
+    /* Swap if alignment was odd */
+    if (odd) {
+        sum = SWAP_BYTES_IN_WORD(sum);
+    }
+
+    return (u16_t)sum;
+}
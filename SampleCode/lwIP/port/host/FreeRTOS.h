@@ -0,0 +1,36 @@
+/**************************************************************************//**
+ * @file     FreeRTOS.h
+ * @brief    Stand-in for the FreeRTOS headers on a Linux host, the types
+ *           arch/sys_arch.h needs. The host checks run without a scheduler,
+ *           sys_host.c implements the lwIP system layer for one thread.
+ *           The task and semaphore calls of the port are declared for it to
+ *           compile, the code paths the checks run do not make them.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include <stdint.h>
+
+typedef long            BaseType_t;
+typedef unsigned long   UBaseType_t;
+typedef uint32_t        TickType_t;
+
+typedef void *          TaskHandle_t;
+typedef void *          QueueHandle_t;
+typedef void *          SemaphoreHandle_t;
+typedef QueueHandle_t   xQueueHandle;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+
+#define pdFALSE                     ((BaseType_t)0)
+#define pdTRUE                      ((BaseType_t)1)
+#define pdPASS                      pdTRUE
+#define pdMS_TO_TICKS(ms)           ((TickType_t)(ms))
+#define portMAX_DELAY               ((TickType_t)0xFFFFFFFFUL)
+#define configMINIMAL_STACK_SIZE    256
+#define configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY    18
+#define portPRIORITY_SHIFT          3
+#define tskIDLE_PRIORITY            ((UBaseType_t)0)
+
+#endif /* INC_FREERTOS_H */
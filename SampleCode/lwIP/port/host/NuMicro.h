@@ -0,0 +1,91 @@
+/**************************************************************************//**
+ * @file     NuMicro.h
+ * @brief    Stand-in for the BSP header on a Linux host, for the host checks
+ *           of the lwIP port (see Makefile.host).
+ *
+ * The EMAC driver headers of the BSP are used as they are. Registers are
+ * plain memory and addresses are not remapped, NON_CACHE is 0. The clock
+ * and system controllers and the EMAC register blocks are declared for the
+ * port and emac.c to compile, the code paths the checks run do not touch
+ * them.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __NUMICRO_H__
+#define __NUMICRO_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#define sysprintf       printf
+
+#define __I             volatile const
+#define __O             volatile
+#define __IO            volatile
+
+typedef enum
+{
+    EMAC0_IRQn = 55,
+    EMAC1_IRQn = 56,
+} IRQn_Type;
+
+#include "types.h"
+#include "irq_ctrl.h"
+
+#define NON_CACHE       0
+
+static inline uint32_t read32(const void *addr)
+{
+    return *(volatile const uint32_t *)addr;
+}
+
+static inline void write32(void *addr, uint32_t value)
+{
+    *(volatile uint32_t *)addr = value;
+}
+
+#define __DSB()         __sync_synchronize()
+
+/* Caches are coherent on the host */
+static inline void dcache_clean_by_mva(void const *addr, size_t len)
+{
+    (void)addr;
+    (void)len;
+}
+
+int cpuid(void);
+
+/* The generic timer of EMAC_PROFILE, the time stamp counter on the host */
+static inline uint64_t EL0_GetCurrentPhysicalValue(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + ts.tv_nsec;
+#endif
+}
+
+#include "clk_reg.h"
+#include "sys_reg.h"
+#include "emac_reg.h"
+
+extern CLK_T host_clk;
+extern SYS_T host_sys;
+extern EMAC_T host_emac0, host_emac1;
+#define CLK             (&host_clk)
+#define SYS             (&host_sys)
+#define EMAC0           (&host_emac0)
+#define EMAC1           (&host_emac1)
+
+extern uint32_t volatile msTicks0, msTicks1;
+
+#include "clk.h"
+#include "emac.h"
+#include "sys.h"
+
+#endif /* __NUMICRO_H__ */
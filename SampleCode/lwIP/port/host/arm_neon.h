@@ -0,0 +1,63 @@
+/**************************************************************************//**
+ * @file     arm_neon.h
+ * @brief    Stand-in for the Advanced SIMD intrinsics on a Linux host, for
+ *           the NEON version of chksum.c (see Makefile.host).
+ *
+ * Only the intrinsics chksum.c uses, lane by lane in plain C with the same
+ * widths, so that a lane overflow shows as it would on the target. An
+ * AArch64 host gets the intrinsics of the compiler.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __ARM_NEON_HOST_H__
+#define __ARM_NEON_HOST_H__
+
+#if defined(__aarch64__)
+
+#include_next <arm_neon.h>
+
+#else
+
+#include <stdint.h>
+#include <string.h>
+
+typedef struct { uint16_t val[8]; } uint16x8_t;
+typedef struct { uint32_t val[4]; } uint32x4_t;
+
+static inline uint32x4_t vdupq_n_u32(uint32_t x)
+{
+    uint32x4_t r;
+    int i;
+
+    for (i = 0; i < 4; i++)
+        r.val[i] = x;
+    return r;
+}
+
+static inline uint16x8_t vld1q_u16(const uint16_t *p)
+{
+    uint16x8_t r;
+
+    memcpy(r.val, p, sizeof(r.val));
+    return r;
+}
+
+/* Adds the pairs of adjacent 16-bit lanes of b to the 32-bit lanes of a */
+static inline uint32x4_t vpadalq_u16(uint32x4_t a, uint16x8_t b)
+{
+    int i;
+
+    for (i = 0; i < 4; i++)
+        a.val[i] += (uint32_t)b.val[2 * i] + b.val[2 * i + 1];
+    return a;
+}
+
+/* Sum of the 32-bit lanes, widened to 64 bits */
+static inline uint64_t vaddlvq_u32(uint32x4_t a)
+{
+    return (uint64_t)a.val[0] + a.val[1] + a.val[2] + a.val[3];
+}
+
+#endif /* __aarch64__ */
+
+#endif /* __ARM_NEON_HOST_H__ */
@@ -0,0 +1,107 @@
+/**************************************************************************//**
+ * @file     chksum_host.c
+ * @brief    Checks lwip_fast_chksum() of chksum.c against the lwIP
+ *           lwip_standard_chksum() on a Linux host. Build with Makefile.host.
+ *
+ * Every length up to CHK_MAX_LEN at every start offset within a 64-byte
+ * line, on random data and on all-0xFF data (the carries of the 64-bit sums),
+ * then lengths up to 0xFFFF, the largest pbuf. Past that the 32-bit sum of
+ * lwip_standard_chksum() may overflow. Ends with the time of both on
+ * 1500-byte frames. chksum_neon_host runs the same on LWIP_CHKSUM_NEON.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lwip/opt.h"
+#include "lwip/inet_chksum.h"
+
+u16_t lwip_standard_chksum(const void *dataptr, int len);
+
+#define CHK_MAX_LEN     2100
+#define CHK_BIG_LEN     0xFFFF
+#define CHK_TIME_LEN    1500
+#define CHK_TIME_LOOPS  200000
+
+static u8_t chk_buf[CHK_BIG_LEN + 64] __attribute__((aligned(64)));
+
+static int chk_range(const char *name, int max_len)
+{
+    int off, len, fails = 0;
+    u16_t fast, std;
+
+    for (off = 0; off < 64; off++) {
+        for (len = 0; len <= max_len; len++) {
+            fast = lwip_fast_chksum(chk_buf + off, len);
+            std = lwip_standard_chksum(chk_buf + off, len);
+            if (fast != std) {
+                if (fails++ < 10)
+                    printf("%s: offset %d length %d: fast 0x%04x, standard 0x%04x\n",
+                           name, off, len, fast, std);
+            }
+        }
+    }
+    return fails;
+}
+
+static int chk_big(const char *name)
+{
+    static const int lens[] = { 0x8000, 0xFFF0, 0xFFFE, CHK_BIG_LEN };
+    int i, off, fails = 0;
+    u16_t fast, std;
+
+    for (i = 0; i < (int)(sizeof(lens) / sizeof(lens[0])); i++) {
+        for (off = 0; off < 8; off++) {
+            fast = lwip_fast_chksum(chk_buf + off, lens[i]);
+            std = lwip_standard_chksum(chk_buf + off, lens[i]);
+            if (fast != std) {
+                fails++;
+                printf("%s: offset %d length %d: fast 0x%04x, standard 0x%04x\n",
+                       name, off, lens[i], fast, std);
+            }
+        }
+    }
+    return fails;
+}
+
+static double chk_time(u16_t (*fn)(const void *, int), int off)
+{
+    struct timespec t0, t1;
+    volatile u16_t sink = 0;
+    int i;
+
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (i = 0; i < CHK_TIME_LOOPS; i++)
+        sink += fn(chk_buf + off, CHK_TIME_LEN);
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    (void)sink;
+
+    return ((t1.tv_sec - t0.tv_sec) * 1e9 + (t1.tv_nsec - t0.tv_nsec)) / CHK_TIME_LOOPS;
+}
+
+int main(void)
+{
+    int i, fails = 0;
+
+    srand(1);
+    for (i = 0; i < (int)sizeof(chk_buf); i++)
+        chk_buf[i] = (u8_t)rand();
+    fails += chk_range("random", CHK_MAX_LEN);
+    fails += chk_big("random");
+
+    memset(chk_buf, 0xFF, sizeof(chk_buf));
+    fails += chk_range("0xFF", CHK_MAX_LEN);
+    fails += chk_big("0xFF");
+
+    for (i = 0; i < (int)sizeof(chk_buf); i++)
+        chk_buf[i] = (u8_t)rand();
+    for (i = 0; i < 2; i++)
+        printf("%d-byte frame at offset %d: fast %.1f ns, standard %.1f ns\n",
+               CHK_TIME_LEN, i * 2, chk_time(lwip_fast_chksum, i * 2),
+               chk_time(lwip_standard_chksum, i * 2));
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,40 @@
+/**************************************************************************//**
+ * @file     lwipopts.h
+ * @brief    lwIP options of the host checks of the port, see Makefile.host.
+ *           Those of the samples (lwIP_UDP_EchoServer), with PTP on and
+ *           without the netconn API. The checks call into the stack from
+ *           a single thread, through the core lock.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __LWIPOPTS_H__
+#define __LWIPOPTS_H__
+
+#include "netif/ma35d0_mac.h"
+
+#define NO_SYS                          0
+#define MEM_ALIGNMENT                   4
+#define LWIP_STATS                      1
+#define LWIP_NETCONN                    0
+#define LWIP_SOCKET                     0
+#define LWIP_PROVIDE_ERRNO              1
+
+#define TCP_MSS                         1460
+#define MEM_SIZE                        1600
+#define MEM_USE_POOLS                   1
+#define MEMP_USE_CUSTOM_POOLS           1
+#define MEM_USE_POOLS_TRY_BIGGER_POOL   1
+#define MEMP_NUM_PBUF                   32
+#define PBUF_POOL_SIZE                  64
+
+#define LWIP_TCPIP_CORE_LOCKING         1
+#define LWIP_TCPIP_CORE_LOCKING_INPUT   1
+
+#define LWIP_USING_HW_CHECKSUM          1
+#define LWIP_CHECKSUM_CTRL_PER_NETIF    1
+
+#define LWIP_IGMP                       1
+#define LWIP_PTP                        1
+#define MEMP_NUM_SYS_TIMEOUT            (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 2)
+
+#endif /* __LWIPOPTS_H__ */
@@ -0,0 +1,420 @@
+/**************************************************************************//**
+ * @file     ptpd_host.c
+ * @brief    Runs the PTP slave of ptpd.c against a simulated master and
+ *           EMAC system time on a Linux host. Build with Makefile.host.
+ *
+ * The master sends Announce and two-step Sync/Follow_Up every second and
+ * answers the Delay_Req of the slave, with a path delay and some jitter.
+ * The slave clock is the EMAC system time counter of ma35d0_mac.c: it runs
+ * from an oscillator PTPH_OSC_PPB off its nominal rate, scaled by the addend
+ * register, and EMAC_TS_timestamp_update() applies a step the way the
+ * databook describes it. The messages go straight to the UDP receive
+ * callback of ptpd.c, its Delay_Req leave through lwIP and the netif.
+ *
+ * Checks:
+ *  - convergence: from time zero to a master in 2023, one step, then locked
+ *    (PTPD_SLAVE) within PTPD_LOCK_THRESHOLD_NS of the master time, with the
+ *    oscillator error taken out by the servo
+ *  - steps: after a jump of the slave time beyond PTPD_STEP_THRESHOLD_NS,
+ *    forwards or backwards, less or more than a second, exactly one step
+ *    that brings the time back within PTPD_LOCK_THRESHOLD_NS, then locked
+ *    again. A jump under the threshold is slewed, without a step.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <math.h>
+#include <stdlib.h>
+
+#include "../ptpd.c"
+
+#include "lwip/init.h"
+#include "lwip/ip.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
+#include "sys_host.h"
+
+#define PTPH_EPLL_HZ        500000000UL     /* EMAC_PTP_REF_CLK is EPLL / 8 */
+#define PTPH_OSC_PPB        40000           /* slave oscillator error */
+#define PTPH_DELAY_NS       25000           /* path delay, each way */
+#define PTPH_JITTER_NS      40              /* largest deviation of a delay */
+#define PTPH_MASTER_SEC     1700000000LL    /* master time at the start */
+#define PTPH_LOCK_SYNCS     60              /* syncs allowed to lock */
+
+#if !LWIP_PTP
+#error "ptpd_host needs LWIP_PTP"
+#endif
+
+static const u8_t ptph_master_port[PTP_PORT_ID_LEN] = { 0x00, 0x1B, 0x19, 0xFF, 0xFE, 0x00, 0x00, 0x01, 0x00, 0x01 };
+
+/* Simulation, the master time is the reference */
+static struct
+{
+    s64 master_ns;
+    s64 slave_ns;           /* EMAC system time */
+    double slave_frac;
+    u32 ssinc;              /* EMAC_TS_subsecond_incr_init() */
+    u32 addend;             /* EMAC_TS_addend_update() */
+    u32 ms;                 /* sys_now() */
+    u16 sync_seq;
+    s64 t2;                 /* rx timestamp of the Sync being delivered */
+    int t3_valid;
+    s64 t3;                 /* tx timestamp of the last Delay_Req */
+    int update_err;
+} ptph;
+
+static EMAC_T ptph_mac;
+static struct netif ptph_netif;
+
+/*---------------------------------------------------------------------------*/
+/* EMAC system time, in place of the timestamp functions of emac.c          */
+
+static double ptph_rate(void)
+{
+    /* ssinc ns every time the 32-bit accumulator overflows */
+    return (double)ptph.ssinc * (PTPH_EPLL_HZ / 8) * ptph.addend / 4294967296.0 / 1e9 *
+           (1.0 + PTPH_OSC_PPB / 1e9);
+}
+
+static void ptph_sync_regs(void)
+{
+    *(volatile u32 *)&ptph_mac.TSSec = (u32)(ptph.slave_ns / NS_PER_SEC);
+    *(volatile u32 *)&ptph_mac.TSNanosec = (u32)(ptph.slave_ns % NS_PER_SEC);
+}
+
+static void ptph_advance(s64 dt_ns)
+{
+    double inc = dt_ns * ptph_rate() + ptph.slave_frac;
+    s64 whole = (s64)floor(inc);
+
+    ptph.slave_ns += whole;
+    ptph.slave_frac = inc - whole;
+    ptph.master_ns += dt_ns;
+    ptph_sync_regs();
+}
+
+/* Slave time dt_ns of master time from now */
+static s64 ptph_slave_after(s64 dt_ns)
+{
+    return ptph.slave_ns + (s64)floor(dt_ns * ptph_rate() + ptph.slave_frac);
+}
+
+static s64 ptph_error(void)
+{
+    return ptph.slave_ns - ptph.master_ns;
+}
+
+static s64 ptph_delay(void)
+{
+    return PTPH_DELAY_NS + (rand() % (2 * PTPH_JITTER_NS + 1)) - PTPH_JITTER_NS;
+}
+
+uint32_t CLK_GetPLLClockFreq(uint32_t u32PllIdx)
+{
+    return (u32PllIdx == EPLL) ? PTPH_EPLL_HZ : 0;
+}
+
+void plat_delay(uint32_t ticks)
+{
+    LWIP_UNUSED_ARG(ticks);
+}
+
+void EMAC_TS_set_clk_type(EMACdevice *emacdev, u32 clk_type)
+{
+    LWIP_UNUSED_ARG(emacdev);
+    LWIP_UNUSED_ARG(clk_type);
+}
+
+void EMAC_TS_subsecond_incr_init(EMACdevice *emacdev, u32 sub_sec_inc_value)
+{
+    LWIP_UNUSED_ARG(emacdev);
+    ptph.ssinc = sub_sec_inc_value;
+}
+
+s32 EMAC_TS_addend_update(EMACdevice *emacdev, u32 addend_value)
+{
+    LWIP_UNUSED_ARG(emacdev);
+    ptph.addend = addend_value;
+    return 0;
+}
+
+void EMAC_TS_load_timestamp_higher_val(EMACdevice *emacdev, u32 higher_sec_val)
+{
+    LWIP_UNUSED_ARG(emacdev);
+    LWIP_UNUSED_ARG(higher_sec_val);
+}
+
+s32 EMAC_TS_timestamp_init(EMACdevice *emacdev, u32 sec, u32 nanosec)
+{
+    LWIP_UNUSED_ARG(emacdev);
+    ptph.slave_ns = (s64)sec * NS_PER_SEC + nanosec;
+    ptph.slave_frac = 0;
+    ptph_sync_regs();
+    return 0;
+}
+
+/* With the digital rollover the nanoseconds are below 10^9, and a subtraction
+   takes away the seconds and 10^9 minus the nanoseconds */
+s32 EMAC_TS_timestamp_update(EMACdevice *emacdev, u32 sec, u32 nanosec)
+{
+    u32 ns = nanosec & ~EMAC_TSNanosecUpdate_ADDSUB_Msk;
+
+    LWIP_UNUSED_ARG(emacdev);
+
+    if (ns >= NS_PER_SEC)
+    {
+        ptph.update_err++;
+        return -1;
+    }
+
+    if (nanosec & EMAC_TSNanosecUpdate_ADDSUB_Msk)
+        ptph.slave_ns -= (s64)sec * NS_PER_SEC + ((ns != 0) ? (NS_PER_SEC - ns) : 0);
+    else
+        ptph.slave_ns += (s64)sec * NS_PER_SEC + ns;
+    ptph_sync_regs();
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+/* ethernetif.c                                                              */
+
+int ethernetif_get_intf(struct netif *netif)
+{
+    LWIP_UNUSED_ARG(netif);
+    return 0;
+}
+
+int ethernetif_get_rx_timestamp(struct pbuf *p, struct ethernetif_timestamp *ts)
+{
+    LWIP_UNUSED_ARG(p);
+    ts->sec = (uint32_t)(ptph.t2 / NS_PER_SEC);
+    ts->nsec = (uint32_t)(ptph.t2 % NS_PER_SEC);
+    return 0;
+}
+
+int ethernetif_get_tx_timestamp(struct netif *netif, struct ethernetif_timestamp *ts)
+{
+    LWIP_UNUSED_ARG(netif);
+    if (!ptph.t3_valid)
+        return -1;
+    ptph.t3_valid = 0;
+    ts->sec = (uint32_t)(ptph.t3 / NS_PER_SEC);
+    ts->nsec = (uint32_t)(ptph.t3 % NS_PER_SEC);
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Master                                                                    */
+
+static struct pbuf *ptph_msg(u8_t type, u16_t len, u16_t seq, u8_t flags)
+{
+    struct pbuf *p = pbuf_alloc(PBUF_RAW, len, PBUF_RAM);
+    u8_t *msg;
+
+    LWIP_ASSERT("pbuf", p != NULL);
+    msg = (u8_t *)p->payload;
+    memset(msg, 0, len);
+    msg[PTP_OFS_TYPE] = type;
+    msg[PTP_OFS_VERSION] = PTP_VERSION;
+    ptpd_put16(&msg[PTP_OFS_LENGTH], len);
+    msg[PTP_OFS_DOMAIN] = PTPD_DOMAIN;
+    msg[PTP_OFS_FLAGS] = flags;
+    memcpy(&msg[PTP_OFS_SOURCE_PORT], ptph_master_port, PTP_PORT_ID_LEN);
+    ptpd_put16(&msg[PTP_OFS_SEQUENCE], seq);
+    msg[PTP_OFS_LOG_INTERVAL] = 0;
+    return p;
+}
+
+static void ptph_put_ns(struct pbuf *p, s64 t)
+{
+    ptpd_put_timestamp((u8_t *)p->payload + PTP_OFS_TIMESTAMP, (u64)(t / NS_PER_SEC), (u32_t)(t % NS_PER_SEC));
+}
+
+static void ptph_send_announce(void)
+{
+    struct pbuf *p = ptph_msg(Announce, PTP_ANNOUNCE_LEN, 0, 0);
+    u8_t *msg = (u8_t *)p->payload;
+
+    msg[PTP_OFS_GM_PRIORITY1] = 128;
+    msg[PTP_OFS_GM_CLASS] = 6;
+    msg[PTP_OFS_GM_ACCURACY] = 0x21;
+    ptpd_put16(&msg[PTP_OFS_GM_VARIANCE], 0x4E5D);
+    msg[PTP_OFS_GM_PRIORITY2] = 128;
+    memcpy(&msg[PTP_OFS_GM_IDENTITY], ptph_master_port, PTP_CLOCK_ID_LEN);
+    ptpd_recv(NULL, ptpd.general_pcb, p, NULL, PTP_GENERAL_PORT);
+}
+
+static void ptph_send_sync(void)
+{
+    struct pbuf *p;
+    s64 t1 = ptph.master_ns;
+
+    ptph.sync_seq++;
+    ptph.t2 = ptph_slave_after(ptph_delay());
+    p = ptph_msg(SYNC, PTP_SYNC_LEN, ptph.sync_seq, PTP_FLAG_TWO_STEP);
+    ptpd_recv(NULL, ptpd.event_pcb, p, NULL, PTP_EVENT_PORT);
+
+    p = ptph_msg(Follow_up, PTP_FOLLOW_UP_LEN, ptph.sync_seq, 0);
+    ptph_put_ns(p, t1);
+    ptpd_recv(NULL, ptpd.general_pcb, p, NULL, PTP_GENERAL_PORT);
+}
+
+/* Output of the netif: answers a Delay_Req of the slave */
+static err_t ptph_output(struct netif *netif, struct pbuf *p, const ip4_addr_t *ipaddr)
+{
+    const struct ip_hdr *iph = (const struct ip_hdr *)p->payload;
+    u8_t msg[PTP_DELAY_REQ_LEN];
+    struct pbuf *resp;
+    u16_t seq;
+
+    LWIP_UNUSED_ARG(netif);
+    LWIP_UNUSED_ARG(ipaddr);
+
+    if ((IPH_PROTO(iph) != IP_PROTO_UDP) ||
+        (pbuf_copy_partial(p, msg, sizeof(msg), IPH_HL_BYTES(iph) + UDP_HLEN) != sizeof(msg)) ||
+        ((msg[PTP_OFS_TYPE] & 0x0F) != Delay_Req))
+        return ERR_OK;
+
+    seq = ptpd_get16(&msg[PTP_OFS_SEQUENCE]);
+    ptph.t3 = ptph.slave_ns;
+    ptph.t3_valid = 1;
+
+    resp = ptph_msg(Delay_Resp, PTP_DELAY_RESP_LEN, seq, 0);
+    ptph_put_ns(resp, ptph.master_ns + ptph_delay());
+    memcpy((u8_t *)resp->payload + PTP_OFS_REQUESTING_PORT, &msg[PTP_OFS_SOURCE_PORT], PTP_PORT_ID_LEN);
+    ptpd_recv(NULL, ptpd.general_pcb, resp, NULL, PTP_GENERAL_PORT);
+    return ERR_OK;
+}
+
+static err_t ptph_netif_init(struct netif *netif)
+{
+    static const u8_t mac[6] = DEFAULT_MAC0_ADDRESS;
+
+    memcpy(netif->hwaddr, mac, sizeof(mac));
+    netif->hwaddr_len = sizeof(mac);
+    netif->mtu = 1500;
+    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_IGMP | NETIF_FLAG_LINK_UP;
+    netif->output = ptph_output;
+    return ERR_OK;
+}
+
+/*---------------------------------------------------------------------------*/
+
+/* Runs the master for secs seconds, 1ms at a time. The Sync goes out on the second. */
+static void ptph_run(int secs)
+{
+    int ms;
+
+    for (ms = 0; ms < secs * 1000; ms++)
+    {
+        if (ptph.ms % 1000 == 0)
+        {
+            ptph_send_announce();
+            ptph_send_sync();
+        }
+        ptph_advance(1000000);
+        ptph.ms++;
+        sys_check_timeouts();
+    }
+}
+
+static int ptph_locked(void)
+{
+    return (ptpd.state == PTPD_SLAVE) && (ptph_error() < PTPD_LOCK_THRESHOLD_NS) &&
+           (ptph_error() > -PTPD_LOCK_THRESHOLD_NS);
+}
+
+static int ptph_check(int ok, const char *what)
+{
+    printf("  %-58s %s\n", what, ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
+
+static int ptph_convergence(void)
+{
+    int i, fails = 0;
+    u32_t locked_at = 0;
+
+    printf("convergence: slave at 0 s, master at %lld s, oscillator %+d ppb\n",
+           PTPH_MASTER_SEC, PTPH_OSC_PPB);
+
+    for (i = 0; i < PTPH_LOCK_SYNCS; i++)
+    {
+        ptph_run(1);
+        if (ptph_locked() && (locked_at == 0))
+            locked_at = ptpd.syncs;
+        if (!ptph_locked())
+            locked_at = 0;
+    }
+    printf("  locked from sync %u, error %lld ns, path delay %lld ns, %d ppb\n",
+           locked_at, (long long)ptph_error(), (long long)ptpd.mean_path_delay, ptpd.freq_adj_ppb);
+
+    fails += ptph_check(ptpd.steps == 1, "stepped once to the master time");
+    fails += ptph_check(locked_at != 0, "PTPD_SLAVE within the lock threshold");
+    fails += ptph_check(llabs(ptpd.mean_path_delay - PTPH_DELAY_NS) < 2 * PTPH_JITTER_NS, "mean path delay");
+    fails += ptph_check(labs((long)ptpd.freq_adj_ppb + PTPH_OSC_PPB) < 50, "oscillator error compensated");
+    return fails;
+}
+
+static int ptph_jump(s64 jump_ns, int step)
+{
+    char what[80];
+    u32_t steps = ptpd.steps;
+    s64 err;
+    int fails = 0;
+
+    printf("slave time jumps by %+lld ns\n", (long long)jump_ns);
+    ptph.slave_ns += jump_ns;
+    ptph_sync_regs();
+
+    /* The next Sync measures the offset */
+    ptph_run(1);
+    err = ptph_error();
+    snprintf(what, sizeof(what), "%s, error %lld ns after the Sync", step ? "stepped once" : "not stepped",
+             (long long)err);
+    fails += ptph_check(ptpd.steps == steps + (step ? 1 : 0), what);
+    if (step)
+        fails += ptph_check((err < PTPD_LOCK_THRESHOLD_NS) && (err > -PTPD_LOCK_THRESHOLD_NS),
+                            "back within the lock threshold");
+
+    ptph_run(PTPH_LOCK_SYNCS);
+    fails += ptph_check(ptph_locked(), "locked again");
+    fails += ptph_check(ptpd.steps == steps + (step ? 1 : 0), "no more steps");
+    return fails;
+}
+
+int main(void)
+{
+    ip4_addr_t ip, mask;
+    int fails = 0;
+
+    srand(1);
+    sys_host_time_ms = &ptph.ms;
+    lwip_init();
+
+    EMACdev[0].MacBase = &ptph_mac;
+    IP4_ADDR(&ip, 192, 168, 1, 30);
+    IP4_ADDR(&mask, 255, 255, 255, 0);
+    netif_add(&ptph_netif, &ip, &mask, IP4_ADDR_ANY4, NULL, ptph_netif_init, netif_input);
+    netif_set_default(&ptph_netif);
+    netif_set_up(&ptph_netif);
+
+    ptpd_start(&ptph_netif);
+    if (ptpd.state != PTPD_LISTENING)
+    {
+        printf("ptpd did not start\n");
+        return 1;
+    }
+    ptph.master_ns = PTPH_MASTER_SEC * NS_PER_SEC;
+
+    fails += ptph_convergence();
+    fails += ptph_jump(5000000, 1);
+    fails += ptph_jump(-5000000, 1);
+    fails += ptph_jump(2500000000LL, 1);
+    fails += ptph_jump(-3750000000LL, 1);
+    fails += ptph_jump(-2000000000LL, 1);
+    fails += ptph_jump(PTPD_STEP_THRESHOLD_NS / 4, 0);
+    fails += ptph_check(ptph.update_err == 0, "time updates in range");
+
+    printf("%s\n", fails ? "FAILED" : "PASSED");
+    return fails ? 1 : 0;
+}
@@ -0,0 +1,7 @@
+/**************************************************************************//**
+ * @file     queue.h
+ * @brief    Stand-in for the FreeRTOS queue.h on a Linux host, see FreeRTOS.h.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "FreeRTOS.h"
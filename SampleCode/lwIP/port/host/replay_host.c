@@ -0,0 +1,491 @@
+/**************************************************************************//**
+ * @file     replay_host.c
+ * @brief    Replays a pcap capture through the EMAC rx path of the port on a
+ *           Linux host. Build with Makefile.host.
+ *
+ * The rx descriptor ring of ma35d0_mac.c is plain memory here and emac.c is
+ * built as it is, so EMAC_set_rx_qptr() and EMAC_detach_rx_qptr() hand the
+ * descriptors over by their OWN bit as on the target. The rx DMA is a model:
+ * it fills the descriptor it points at with the next frame if it owns it,
+ * writes the status word, clears OWN and moves on, and counts a missed frame
+ * when the driver has not given that descriptor back yet. The rx task is
+ * low_level_rx_poll() called until the ring is drained, after every burst of
+ * frames. Frames go through EMAC_handle_received_data(), ethernetif_input()
+ * and low_level_input() into lwIP with tcpip_input(). Whatever lwIP sends
+ * back is dropped at the netif.
+ *
+ *   ./replay_host [-n loops] [-b burst] [-q held] [-i a.b.c.d] [capture.pcap]
+ *
+ * Frames to UDP port RPLH_UDP_PORT are held by the receiver until -q more
+ * have come, as by a slow application. Without a capture, UDP frames of 60
+ * to 1514 bytes to the netif address (-i) and an ARP request for it every
+ * RPLH_ARP_EVERY frames are replayed.
+ *
+ * Reports frames per second and cycles per frame of the rx polls, counted
+ * with EMAC_PROFILE on the time stamp counter, the frames the DMA missed and
+ * the high-water marks of the pbuf pools.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "../netif/ethernetif.c"
+
+#include "lwip/init.h"
+#include "lwip/inet_chksum.h"
+#include "lwip/udp.h"
+#include "sys_host.h"
+
+#define RPLH_UDP_PORT       7
+#define RPLH_ARP_EVERY      64
+#define RPLH_GEN_FRAMES     1024
+#define RPLH_MAX_HELD       (EMAC_CNT * RECEIVE_DESC_SIZE)
+#define RPLH_MAX_LEN        (sizeof(((struct sk_buff *)0)->data) - 4)   /* room for the FCS */
+
+#if (EMAC_PROFILE != 1)
+#error "replay_host needs EMAC_PROFILE"
+#endif
+
+struct rplh_frame
+{
+    const u8_t *data;
+    u16_t len;
+};
+
+static struct rplh_frame *rplh_frames;
+static int rplh_nframes;
+
+/* Rx buffers of the ring, as rx_buf of ma35d0_mac.c. Descriptors hold 32-bit addresses */
+static struct sk_buff rplh_rx_buf[RECEIVE_DESC_SIZE] __attribute__ ((aligned (64)));
+
+/* Rx DMA */
+static struct
+{
+    u32 next;               /* descriptor it writes next */
+    u32 frames;
+    u32 missed;             /* frames that found no descriptor owned by the DMA */
+} rplh_dma;
+
+/* Receiver on RPLH_UDP_PORT */
+static struct
+{
+    struct pbuf *p[RPLH_MAX_HELD];
+    int depth, rd, n;
+    u32 frames;
+} rplh_udp;
+
+static u32 rplh_tx_frames;
+static struct netif rplh_netif;
+
+/*---------------------------------------------------------------------------*/
+/* Register blocks of the BSP                                                */
+
+EMAC_T host_emac0, host_emac1;
+uint32_t volatile msTicks0, msTicks1;
+
+int cpuid(void)
+{
+    return 0;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Rx DMA                                                                    */
+
+/* Brings the ring to the state EMAC_open() leaves it in */
+static void rplh_dma_init(void)
+{
+    EMACdevice *emacdev = &EMACdev[EMACINTF0];
+    int i;
+
+    emacdev->Intf = EMACINTF0;
+    emacdev->MacBase = EMAC0;
+    emacdev->RxIntWdt = EMAC_RX_INT_WDT;
+    EMAC_setup_tx_desc_queue(emacdev, TRANSMIT_DESC_SIZE, RINGMODE);
+    EMAC_setup_rx_desc_queue(emacdev, RECEIVE_DESC_SIZE, RINGMODE);
+    EMAC_DMA_BUSMODE_INIT(emacdev, DmaBurstLength32 | DmaDescriptorSkip0 | EMAC_DmaBusMode_ATDS_Msk);
+
+    for (i = 0; i < RECEIVE_DESC_SIZE; i++)
+        EMAC_set_rx_qptr(emacdev, (u32)((u64)rplh_rx_buf[i].data & 0xFFFFFFFF), sizeof(rplh_rx_buf[i].data));
+}
+
+static void rplh_dma_rx(const struct rplh_frame *f)
+{
+    EMACdevice *emacdev = &EMACdev[EMACINTF0];
+    DmaDesc *desc = emacdev->RxDesc + rplh_dma.next;
+    u8_t *buf;
+
+    if (!EMAC_is_desc_owned_by_dma(desc))
+    {
+        /* Rx buffer unavailable, the frame is lost until a descriptor comes back */
+        rplh_dma.missed++;
+        return;
+    }
+
+    buf = (u8_t *)(u64)desc->buffer1;
+    memcpy(buf, f->data, f->len);
+    memset(buf + f->len, 0, 4);
+    desc->extstatus = 0;
+    desc->timestamplow = 0;
+    desc->timestamphigh = 0;
+    desc->status = (((u32)f->len + 4) << DescRxFrameLengthShift) | DescRxFirst | DescRxLast;
+    rplh_dma.next = EMAC_is_last_rx_desc(emacdev, desc) ? 0 : rplh_dma.next + 1;
+    rplh_dma.frames++;
+}
+
+/*---------------------------------------------------------------------------*/
+/* Stack side                                                                */
+
+static void rplh_udp_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    LWIP_UNUSED_ARG(arg);
+    LWIP_UNUSED_ARG(pcb);
+    LWIP_UNUSED_ARG(addr);
+    LWIP_UNUSED_ARG(port);
+
+    rplh_udp.frames++;
+    if (rplh_udp.depth == 0)
+    {
+        pbuf_free(p);
+        return;
+    }
+    if (rplh_udp.n == rplh_udp.depth)
+    {
+        pbuf_free(rplh_udp.p[rplh_udp.rd]);
+        rplh_udp.rd = (rplh_udp.rd + 1) % rplh_udp.depth;
+        rplh_udp.n--;
+    }
+    rplh_udp.p[(rplh_udp.rd + rplh_udp.n) % rplh_udp.depth] = p;
+    rplh_udp.n++;
+}
+
+static void rplh_udp_release(void)
+{
+    while (rplh_udp.n)
+    {
+        pbuf_free(rplh_udp.p[rplh_udp.rd]);
+        rplh_udp.rd = (rplh_udp.rd + 1) % rplh_udp.depth;
+        rplh_udp.n--;
+    }
+}
+
+static err_t rplh_linkoutput(struct netif *netif, struct pbuf *p)
+{
+    LWIP_UNUSED_ARG(netif);
+    LWIP_UNUSED_ARG(p);
+
+    rplh_tx_frames++;
+    return ERR_OK;
+}
+
+/* ethernetif_init_intf() without the hardware and the rx task */
+static err_t rplh_netif_init(struct netif *netif)
+{
+    struct ethernetif *ethernetif = &ethernetif_dev[EMACINTF0];
+
+    netif->state = ethernetif;
+    netif->name[0] = IFNAME;
+    netif->name[1] = ethernetif_config[EMACINTF0].name;
+    netif->output = etharp_output;
+    netif->linkoutput = rplh_linkoutput;
+    netif->hwaddr_len = ETHARP_HWADDR_LEN;
+    memcpy(netif->hwaddr, mac_addr0, ETHARP_HWADDR_LEN);
+    netif->mtu = 1500;
+    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP | NETIF_FLAG_IGMP;
+    NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_DISABLE_ALL);
+
+    ethernetif->ethaddr = (struct eth_addr *)&(netif->hwaddr[0]);
+    ethernetif->netif = netif;
+    ethernetif->intf = EMACINTF0;
+    ethernetif->tx_ts_desc = -1;
+
+    rx_pbuf_pool_init();
+
+    return sys_mutex_new(&ethernetif->tx_lock);
+}
+
+/*---------------------------------------------------------------------------*/
+/* Traffic                                                                   */
+
+static u32 rplh_get32(const u8_t *p, int swap)
+{
+    u32 v;
+
+    memcpy(&v, p, sizeof(v));
+    return swap ? __builtin_bswap32(v) : v;
+}
+
+static int rplh_load_pcap(const char *path)
+{
+    static const u32 magic_us = 0xA1B2C3D4, magic_ns = 0xA1B23C4D;
+    FILE *fp;
+    long size;
+    u8_t *data;
+    u32 magic, incl, orig;
+    long off;
+    int swap, skipped = 0;
+
+    fp = fopen(path, "rb");
+    if (fp == NULL)
+    {
+        perror(path);
+        return -1;
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    data = malloc(size);
+    if ((data == NULL) || (fread(data, 1, size, fp) != (size_t)size) || (size < 24))
+    {
+        printf("%s: cannot read\n", path);
+        fclose(fp);
+        return -1;
+    }
+    fclose(fp);
+
+    memcpy(&magic, data, sizeof(magic));
+    swap = (magic == __builtin_bswap32(magic_us)) || (magic == __builtin_bswap32(magic_ns));
+    if (!swap && (magic != magic_us) && (magic != magic_ns))
+    {
+        printf("%s: not a pcap file\n", path);
+        return -1;
+    }
+    if (rplh_get32(data + 20, swap) != 1)
+    {
+        printf("%s: not an Ethernet capture\n", path);
+        return -1;
+    }
+
+    rplh_frames = malloc(sizeof(*rplh_frames) * (size / 16));
+    for (off = 24; off + 16 <= size; off += 16 + incl)
+    {
+        incl = rplh_get32(data + off + 8, swap);
+        orig = rplh_get32(data + off + 12, swap);
+        if (off + 16 + incl > (u32)size)
+            break;
+        /* Frames cut by the snap length or beyond a DMA buffer are left out */
+        if ((incl != orig) || (incl < SIZEOF_ETH_HDR) || (incl > RPLH_MAX_LEN))
+        {
+            skipped++;
+            continue;
+        }
+        rplh_frames[rplh_nframes].data = data + off + 16;
+        rplh_frames[rplh_nframes].len = (u16_t)incl;
+        rplh_nframes++;
+    }
+
+    printf("%s: %d frames", path, rplh_nframes);
+    if (skipped)
+        printf(", %d left out", skipped);
+    printf("\n");
+    return rplh_nframes ? 0 : -1;
+}
+
+static void rplh_gen_udp(u8_t *f, u16_t len, const ip4_addr_t *dst, u16_t id)
+{
+    struct eth_hdr *eth = (struct eth_hdr *)f;
+    struct ip_hdr *ip = (struct ip_hdr *)(f + SIZEOF_ETH_HDR);
+    struct udp_hdr *udp = (struct udp_hdr *)(f + SIZEOF_ETH_HDR + IP_HLEN);
+    u16_t ip_len = len - SIZEOF_ETH_HDR;
+    int i;
+
+    memcpy(&eth->dest, mac_addr0, ETH_HWADDR_LEN);
+    memcpy(&eth->src, "\x02\x00\x00\x00\x00\x01", ETH_HWADDR_LEN);
+    eth->type = PP_HTONS(ETHTYPE_IP);
+
+    IPH_VHL_SET(ip, 4, IP_HLEN / 4);
+    IPH_TOS_SET(ip, 0);
+    IPH_LEN_SET(ip, lwip_htons(ip_len));
+    IPH_ID_SET(ip, lwip_htons(id));
+    IPH_OFFSET_SET(ip, 0);
+    IPH_TTL_SET(ip, 64);
+    IPH_PROTO_SET(ip, IP_PROTO_UDP);
+    IP4_ADDR(&ip->src, 192, 168, 1, 1);
+    ip4_addr_copy(ip->dest, *dst);
+    IPH_CHKSUM_SET(ip, 0);
+    IPH_CHKSUM_SET(ip, inet_chksum(ip, IP_HLEN));
+
+    udp->src = PP_HTONS(5000);
+    udp->dest = PP_HTONS(RPLH_UDP_PORT);
+    udp->len = lwip_htons(ip_len - IP_HLEN);
+    udp->chksum = 0;
+    for (i = SIZEOF_ETH_HDR + IP_HLEN + UDP_HLEN; i < len; i++)
+        f[i] = (u8_t)i;
+}
+
+static void rplh_gen_arp(u8_t *f, const ip4_addr_t *dst)
+{
+    struct eth_hdr *eth = (struct eth_hdr *)f;
+    struct etharp_hdr *arp = (struct etharp_hdr *)(f + SIZEOF_ETH_HDR);
+    ip4_addr_t src;
+
+    memset(f, 0, 60);
+    memset(&eth->dest, 0xFF, ETH_HWADDR_LEN);
+    memcpy(&eth->src, "\x02\x00\x00\x00\x00\x01", ETH_HWADDR_LEN);
+    eth->type = PP_HTONS(ETHTYPE_ARP);
+
+    arp->hwtype = PP_HTONS(1);
+    arp->proto = PP_HTONS(ETHTYPE_IP);
+    arp->hwlen = ETH_HWADDR_LEN;
+    arp->protolen = sizeof(ip4_addr_t);
+    arp->opcode = PP_HTONS(ARP_REQUEST);
+    memcpy(&arp->shwaddr, &eth->src, ETH_HWADDR_LEN);
+    IP4_ADDR(&src, 192, 168, 1, 1);
+    memcpy(&arp->sipaddr, &src, sizeof(src));
+    memcpy(&arp->dipaddr, dst, sizeof(*dst));
+}
+
+static void rplh_generate(const ip4_addr_t *dst)
+{
+    static const u16_t lens[] = { 60, 128, 256, 512, 1024, 1514 };
+    u8_t *f;
+    int i;
+
+    rplh_frames = malloc(sizeof(*rplh_frames) * RPLH_GEN_FRAMES);
+    for (i = 0; i < RPLH_GEN_FRAMES; i++)
+    {
+        f = malloc(RPLH_MAX_LEN);
+        if (i % RPLH_ARP_EVERY == RPLH_ARP_EVERY - 1)
+        {
+            rplh_gen_arp(f, dst);
+            rplh_frames[i].len = 60;
+        }
+        else
+        {
+            rplh_frames[i].len = lens[i % (sizeof(lens) / sizeof(lens[0]))];
+            rplh_gen_udp(f, rplh_frames[i].len, dst, (u16_t)i);
+        }
+        rplh_frames[i].data = f;
+    }
+    rplh_nframes = RPLH_GEN_FRAMES;
+    printf("generated: %d frames, UDP to port %d and ARP\n", rplh_nframes, RPLH_UDP_PORT);
+}
+
+/*---------------------------------------------------------------------------*/
+
+static u64 rplh_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000000000u + ts.tv_nsec;
+}
+
+static void rplh_print_pool(const char *name, const struct stats_mem *s, int size)
+{
+    printf("  %-10s max %4u of %4d, %u failed\n", name, (unsigned)s->max, size, (unsigned)s->err);
+}
+
+static void rplh_usage(const char *prog)
+{
+    printf("usage: %s [-n loops] [-b burst] [-q held] [-i a.b.c.d] [capture.pcap]\n", prog);
+}
+
+int main(int argc, char *argv[])
+{
+    struct ethernetif *ethernetif = &ethernetif_dev[EMACINTF0];
+    struct ethernetif_rx_stats stats;
+    struct udp_pcb *pcb;
+    ip4_addr_t ip, mask;
+    int loops = 100, burst = 64;
+    int opt, loop, i, n;
+    u64 ns = 0, t0;
+
+    IP4_ADDR(&ip, 192, 168, 1, 2);
+    IP4_ADDR(&mask, 255, 255, 255, 0);
+    while ((opt = getopt(argc, argv, "n:b:q:i:")) != -1)
+    {
+        switch (opt)
+        {
+        case 'n':
+            loops = atoi(optarg);
+            break;
+        case 'b':
+            burst = atoi(optarg);
+            break;
+        case 'q':
+            rplh_udp.depth = atoi(optarg);
+            break;
+        case 'i':
+            if (!ip4addr_aton(optarg, &ip))
+            {
+                rplh_usage(argv[0]);
+                return 1;
+            }
+            break;
+        default:
+            rplh_usage(argv[0]);
+            return 1;
+        }
+    }
+    if ((loops <= 0) || (burst <= 0) || (rplh_udp.depth < 0) || (rplh_udp.depth > RPLH_MAX_HELD))
+    {
+        rplh_usage(argv[0]);
+        return 1;
+    }
+
+    if ((u64)&rplh_rx_buf[RECEIVE_DESC_SIZE] > 0xFFFFFFFFu)
+    {
+        printf("rx buffers above 4 GB, link with -no-pie\n");
+        return 1;
+    }
+
+    if (optind < argc)
+    {
+        if (rplh_load_pcap(argv[optind]) != 0)
+            return 1;
+    }
+    else
+    {
+        rplh_generate(&ip);
+    }
+
+    lwip_init();
+    netif_add(&rplh_netif, &ip, &mask, IP4_ADDR_ANY4, NULL, rplh_netif_init, tcpip_input);
+    netif_set_default(&rplh_netif);
+    netif_set_up(&rplh_netif);
+
+    pcb = udp_new();
+    udp_bind(pcb, IP4_ADDR_ANY, RPLH_UDP_PORT);
+    udp_recv(pcb, rplh_udp_recv, NULL);
+
+    rplh_dma_init();
+
+    for (loop = 0; loop < loops; loop++)
+    {
+        for (i = 0; i < rplh_nframes; i += n)
+        {
+            for (n = 0; (n < burst) && (i + n < rplh_nframes); n++)
+                rplh_dma_rx(&rplh_frames[i + n]);
+
+            t0 = rplh_ns();
+            while (!low_level_rx_poll(ethernetif))
+                ;
+            ns += rplh_ns() - t0;
+        }
+    }
+    rplh_udp_release();
+
+    ethernetif_get_rx_stats(EMACINTF0, &stats);
+    printf("%u frames in bursts of %d, %u missed by the DMA\n",
+           (unsigned)(rplh_dma.frames + rplh_dma.missed), burst, (unsigned)rplh_dma.missed);
+    printf("rx path: %.0f frames/s, %.0f ns/frame, %.0f cycles/frame\n",
+           stats.frames * 1e9 / ns, (double)ns / stats.frames, (double)stats.rx_ticks / stats.frames);
+    printf("polls %u, most frames per poll %u, budget used up %u times\n",
+           (unsigned)stats.polls, (unsigned)stats.max_frames_per_poll, (unsigned)stats.budget_exhausted);
+    printf("UDP port %d got %u frames, holding %d; %u frames sent back\n",
+           RPLH_UDP_PORT, (unsigned)rplh_udp.frames, rplh_udp.depth, (unsigned)rplh_tx_frames);
+    printf("pool high-water marks (rx pbufs held by lwIP at most %u):\n", (unsigned)stats.rx_pbuf_max);
+    rplh_print_pool("RX_POOL", memp_RX_POOL.stats, EMAC_CNT * RECEIVE_DESC_SIZE);
+    rplh_print_pool("PBUF_POOL", lwip_stats.memp[MEMP_PBUF_POOL], PBUF_POOL_SIZE);
+    rplh_print_pool("PBUF", lwip_stats.memp[MEMP_PBUF], MEMP_NUM_PBUF);
+
+    /* Every buffer is back on the ring */
+    if ((EMACdev[EMACINTF0].BusyRxDesc != RECEIVE_DESC_SIZE) || (rplh_dma.frames != stats.frames))
+    {
+        printf("FAILED: %u rx descriptors armed, %u frames taken of %u\n",
+               (unsigned)EMACdev[EMACINTF0].BusyRxDesc, (unsigned)stats.frames, (unsigned)rplh_dma.frames);
+        return 1;
+    }
+    return 0;
+}
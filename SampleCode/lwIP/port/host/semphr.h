@@ -0,0 +1,11 @@
+/**************************************************************************//**
+ * @file     semphr.h
+ * @brief    Stand-in for the FreeRTOS semphr.h on a Linux host, see FreeRTOS.h.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "FreeRTOS.h"
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t xSemaphore, TickType_t xBlockTime);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t xSemaphore, BaseType_t *pxHigherPriorityTaskWoken);
@@ -0,0 +1,15 @@
+/**************************************************************************//**
+ * @file     sys.h
+ * @brief    Stand-in for the BSP sys.h on a Linux host. arch/cc.h includes
+ *           it, ma35d0_mac.c asks for the chip variant.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __SYS_H__
+#define __SYS_H__
+
+#include "NuMicro.h"
+
+int32_t Is_MA35D05K(void);
+
+#endif /* __SYS_H__ */
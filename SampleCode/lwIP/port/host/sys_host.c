@@ -0,0 +1,197 @@
+/**************************************************************************//**
+ * @file     sys_host.c
+ * @brief    lwIP system layer of the host checks, for a single thread
+ *
+ * Takes the place of sys_arch.c on a Linux host. Nothing can block: a
+ * semaphore or mailbox wait returns SYS_ARCH_TIMEOUT when it would, and no
+ * thread is started. Time is the host monotonic clock unless a check sets
+ * sys_host_time_ms to run its own.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include <stdlib.h>
+#include <time.h>
+
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+#include "lwip/stats.h"
+
+#include "sys_host.h"
+
+#define SYS_HOST_MBOX_SIZE  64
+
+struct sys_host_mbox
+{
+    void *msg[SYS_HOST_MBOX_SIZE];
+    int rd, wr;
+};
+
+u32_t *sys_host_time_ms;
+
+void
+sys_init(void)
+{
+}
+
+u32_t
+sys_now(void)
+{
+    struct timespec ts;
+
+    if (sys_host_time_ms != NULL)
+        return *sys_host_time_ms;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u32_t)(ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+sys_prot_t
+sys_arch_protect(void)
+{
+    return 1;
+}
+
+void
+sys_arch_unprotect(sys_prot_t pval)
+{
+    LWIP_UNUSED_ARG(pval);
+}
+
+err_t
+sys_mutex_new(sys_mutex_t *mutex)
+{
+    mutex->mut = mutex;
+    return ERR_OK;
+}
+
+void
+sys_mutex_lock(sys_mutex_t *mutex)
+{
+    LWIP_UNUSED_ARG(mutex);
+}
+
+void
+sys_mutex_unlock(sys_mutex_t *mutex)
+{
+    LWIP_UNUSED_ARG(mutex);
+}
+
+void
+sys_mutex_free(sys_mutex_t *mutex)
+{
+    mutex->mut = NULL;
+}
+
+err_t
+sys_sem_new(sys_sem_t *sem, u8_t initial_count)
+{
+    sem->sem = malloc(sizeof(u32_t));
+    if (sem->sem == NULL)
+        return ERR_MEM;
+    *(u32_t *)sem->sem = initial_count;
+    return ERR_OK;
+}
+
+void
+sys_sem_signal(sys_sem_t *sem)
+{
+    (*(u32_t *)sem->sem)++;
+}
+
+u32_t
+sys_arch_sem_wait(sys_sem_t *sem, u32_t timeout_ms)
+{
+    LWIP_UNUSED_ARG(timeout_ms);
+
+    if (*(u32_t *)sem->sem == 0)
+        return SYS_ARCH_TIMEOUT;
+    (*(u32_t *)sem->sem)--;
+    return 0;
+}
+
+void
+sys_sem_free(sys_sem_t *sem)
+{
+    free(sem->sem);
+    sem->sem = NULL;
+}
+
+err_t
+sys_mbox_new(sys_mbox_t *mbox, int size)
+{
+    LWIP_UNUSED_ARG(size);
+
+    mbox->mbx = calloc(1, sizeof(struct sys_host_mbox));
+    return (mbox->mbx != NULL) ? ERR_OK : ERR_MEM;
+}
+
+err_t
+sys_mbox_trypost(sys_mbox_t *mbox, void *msg)
+{
+    struct sys_host_mbox *mb = (struct sys_host_mbox *)mbox->mbx;
+
+    if ((mb->wr + 1) % SYS_HOST_MBOX_SIZE == mb->rd)
+        return ERR_MEM;
+    mb->msg[mb->wr] = msg;
+    mb->wr = (mb->wr + 1) % SYS_HOST_MBOX_SIZE;
+    return ERR_OK;
+}
+
+err_t
+sys_mbox_trypost_fromisr(sys_mbox_t *mbox, void *msg)
+{
+    return sys_mbox_trypost(mbox, msg);
+}
+
+void
+sys_mbox_post(sys_mbox_t *mbox, void *msg)
+{
+    err_t ret = sys_mbox_trypost(mbox, msg);
+
+    LWIP_ASSERT("mbox post failed", ret == ERR_OK);
+    LWIP_UNUSED_ARG(ret);
+}
+
+u32_t
+sys_arch_mbox_tryfetch(sys_mbox_t *mbox, void **msg)
+{
+    struct sys_host_mbox *mb = (struct sys_host_mbox *)mbox->mbx;
+
+    if (mb->rd == mb->wr)
+        return SYS_MBOX_EMPTY;
+    if (msg != NULL)
+        *msg = mb->msg[mb->rd];
+    mb->rd = (mb->rd + 1) % SYS_HOST_MBOX_SIZE;
+    return 0;
+}
+
+u32_t
+sys_arch_mbox_fetch(sys_mbox_t *mbox, void **msg, u32_t timeout_ms)
+{
+    LWIP_UNUSED_ARG(timeout_ms);
+
+    if (sys_arch_mbox_tryfetch(mbox, msg) == SYS_MBOX_EMPTY)
+        return SYS_ARCH_TIMEOUT;
+    return 1;
+}
+
+void
+sys_mbox_free(sys_mbox_t *mbox)
+{
+    free(mbox->mbx);
+    mbox->mbx = NULL;
+}
+
+sys_thread_t
+sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize, int prio)
+{
+    sys_thread_t ret = { NULL };
+
+    LWIP_UNUSED_ARG(name);
+    LWIP_UNUSED_ARG(thread);
+    LWIP_UNUSED_ARG(arg);
+    LWIP_UNUSED_ARG(stacksize);
+    LWIP_UNUSED_ARG(prio);
+    LWIP_ASSERT("no threads on the host", 0);
+    return ret;
+}
@@ -0,0 +1,15 @@
+/**************************************************************************//**
+ * @file     sys_host.h
+ * @brief    lwIP system layer of the host checks, for a single thread
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __SYS_HOST_H__
+#define __SYS_HOST_H__
+
+#include "lwip/arch.h"
+
+/* Set to the clock of a simulation to have sys_now() follow it */
+extern u32_t *sys_host_time_ms;
+
+#endif /* __SYS_HOST_H__ */
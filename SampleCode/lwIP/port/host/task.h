@@ -0,0 +1,19 @@
+/**************************************************************************//**
+ * @file     task.h
+ * @brief    Stand-in for the FreeRTOS task.h on a Linux host, see FreeRTOS.h.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "FreeRTOS.h"
+
+typedef void (*TaskFunction_t)(void *);
+
+#define taskSCHEDULER_RUNNING       ((BaseType_t)2)
+
+BaseType_t xTaskGetSchedulerState(void);
+BaseType_t xTaskCreate(TaskFunction_t pxTaskCode, const char *pcName, uint32_t usStackDepth,
+                       void *pvParameters, UBaseType_t uxPriority, TaskHandle_t *pxCreatedTask);
+void vTaskNotifyGiveFromISR(TaskHandle_t xTaskToNotify, BaseType_t *pxHigherPriorityTaskWoken);
+uint32_t ulTaskNotifyTake(BaseType_t xClearCountOnExit, TickType_t xTicksToWait);
+void vTaskYield(void);
+#define taskYIELD()                 vTaskYield()
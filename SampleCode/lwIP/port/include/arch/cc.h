@@ -91,6 +91,27 @@ typedef uint64_t   sys_prot_t;
 #define S32_F "8ld"
 #define X32_F "8lx"
 
+/*---------------memory-------------------------------------------------------*/
+
+/* Pools and heap start on a cache line (64 bytes on Cortex-A35) so they do
+   not share lines with other data */
+#define LWIP_DECLARE_MEMORY_ALIGNED(variable_name, size) \
+    u8_t variable_name[LWIP_MEM_ALIGN_BUFFER(size)] __attribute__((aligned(64)))
+
+/*---------------checksum-----------------------------------------------------*/
+
+/* Internet checksum routine, see chksum.c. Set LWIP_CHKSUM_NEON to 1 in
+   lwipopts.h for the Advanced SIMD version, the tasks running the stack then
+   need an FPU context (the port sets it up for the tasks it creates). */
+#ifndef LWIP_CHKSUM_NEON
+#define LWIP_CHKSUM_NEON    0
+#endif
+
+#ifndef LWIP_CHKSUM
+u16_t lwip_fast_chksum(const void *dataptr, int len);
+#define LWIP_CHKSUM         lwip_fast_chksum
+#endif
+
 /*--------------macros--------------------------------------------------------*/
 #ifndef LWIP_PLATFORM_ASSERT
 #define LWIP_PLATFORM_ASSERT(x) \
@@ -77,6 +77,28 @@ struct _sys_thread {
 };
 typedef struct _sys_thread sys_thread_t;
 
+/** Set this to 1 to enable core locking check functions in this port.
+ * For this to work, you'll have to define LWIP_ASSERT_CORE_LOCKED()
+ * and LWIP_MARK_TCPIP_THREAD() correctly in your lwipopts.h:
+ *   #define LWIP_ASSERT_CORE_LOCKED()  sys_check_core_locking()
+ *   #define LWIP_MARK_TCPIP_THREAD()   sys_mark_tcpip_thread()
+ */
+#ifndef LWIP_FREERTOS_CHECK_CORE_LOCKING
+#define LWIP_FREERTOS_CHECK_CORE_LOCKING              0
+#endif
+
+#if LWIP_FREERTOS_CHECK_CORE_LOCKING
+void sys_check_core_locking(void);
+void sys_mark_tcpip_thread(void);
+
+#if LWIP_TCPIP_CORE_LOCKING
+void sys_lock_tcpip_core(void);
+#define LOCK_TCPIP_CORE()               sys_lock_tcpip_core()
+void sys_unlock_tcpip_core(void);
+#define UNLOCK_TCPIP_CORE()             sys_unlock_tcpip_core()
+#endif /* LWIP_TCPIP_CORE_LOCKING */
+#endif /* LWIP_FREERTOS_CHECK_CORE_LOCKING */
+
 
 
 #endif /* __ARCH_SYS_ARCH_H__ */
@@ -0,0 +1,45 @@
+/**************************************************************************//**
+ * @file     lwippools.h
+ * @brief    lwIP heap size classes for MEM_USE_POOLS
+ *
+ * With MEM_USE_POOLS and MEMP_USE_CUSTOM_POOLS set in lwipopts.h, mem_malloc()
+ * takes the smallest free block of these classes instead of first-fit from
+ * the MEM_SIZE heap. Each class shows up as a "MALLOC_<size>" memp in the lwIP
+ * statistics. The number of blocks can be overridden in lwipopts.h.
+ *
+ * mem_malloc() puts a struct memp_malloc_helper, 4 bytes without MEM_STATS,
+ * in front of every block. The classes are 4 bytes short of a multiple of
+ * the 64-byte cache line, so that header and block take whole lines. With
+ * the pool memory aligned to a line (LWIP_DECLARE_MEMORY_ALIGNED in
+ * arch/cc.h) no two blocks share one. poolstats.c checks every class at
+ * build time.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+
+/* No include guard, memp_std.h includes this file once per pool table */
+
+#if MEM_USE_POOLS
+
+/* Small PBUF_RAM pbufs: TCP ACKs and control segments, ARP, ICMP, DHCP */
+#ifndef LWIP_MEM_POOL_124_NUM
+#define LWIP_MEM_POOL_124_NUM       16
+#endif
+
+/* Medium requests: DNS, partial TCP segments, application buffers */
+#ifndef LWIP_MEM_POOL_508_NUM
+#define LWIP_MEM_POOL_508_NUM       8
+#endif
+
+/* Full-sized PBUF_RAM frames: TCP_MSS segments with headers, UDP datagrams */
+#ifndef LWIP_MEM_POOL_1596_NUM
+#define LWIP_MEM_POOL_1596_NUM      12
+#endif
+
+LWIP_MALLOC_MEMPOOL_START
+LWIP_MALLOC_MEMPOOL(LWIP_MEM_POOL_124_NUM, 124)
+LWIP_MALLOC_MEMPOOL(LWIP_MEM_POOL_508_NUM, 508)
+LWIP_MALLOC_MEMPOOL(LWIP_MEM_POOL_1596_NUM, 1596)
+LWIP_MALLOC_MEMPOOL_END
+
+#endif /* MEM_USE_POOLS */
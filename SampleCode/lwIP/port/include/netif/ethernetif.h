@@ -9,10 +9,36 @@
 
 #include "lwip/netif.h"
 
+/* Rx polling counters of one EMAC interface, the cost counters are only
+   maintained when built with EMAC_PROFILE */
+struct ethernetif_rx_stats
+{
+    uint32_t irqs;                  /* rx task wake-ups requested by the ISR */
+    uint32_t polls;                 /* ring polls done by the rx task */
+    uint32_t frames;                /* frames taken from the ring */
+    uint32_t max_frames_per_poll;   /* largest batch seen in one poll */
+    uint32_t budget_exhausted;      /* polls that hit EMAC_RX_BUDGET */
+    uint64_t rx_ticks;              /* time spent in polls that got frames, ring walk and lwIP input */
+    uint64_t tx_ticks;              /* time spent in low_level_output */
+    uint32_t tx_frames;             /* frames handed to the tx ring */
+    uint32_t rx_pbuf_max;           /* most rx pbufs held by lwIP at once */
+};
+
+/* Hardware timestamp, EMAC system time */
+struct ethernetif_timestamp
+{
+    uint32_t sec;
+    uint32_t nsec;
+};
+
 err_t ethernetif_init0(struct netif *netif);
 err_t ethernetif_init1(struct netif *netif);
 void ethernetif_input0(uint32_t packetCnt);
 void ethernetif_input1(uint32_t packetCnt);
+void ethernetif_get_rx_stats(int intf, struct ethernetif_rx_stats *stats);
+int ethernetif_get_intf(struct netif *netif);
+int ethernetif_get_rx_timestamp(struct pbuf *p, struct ethernetif_timestamp *ts);
+int ethernetif_get_tx_timestamp(struct netif *netif, struct ethernetif_timestamp *ts);
 void EMAC0_IRQHandler(void);
 void EMAC1_IRQHandler(void);
 int32_t EMAC0_TransmitPkt(struct sk_buff *ptskb, uint8_t *pbuf, uint32_t len);
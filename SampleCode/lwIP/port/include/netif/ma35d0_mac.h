@@ -25,6 +25,27 @@
 #define DEFAULT_MAC0_ADDRESS {0x00, 0x11, 0x22, 0x33, 0x44, 0x55}
 #define DEFAULT_MAC1_ADDRESS {0x00, 0x11, 0x22, 0x33, 0x44, 0x66}
 
+/* Rx polling: the ISR masks the rx interrupt and the rx task drains the ring
+   EMAC_RX_BUDGET frames at a time, the interrupt is unmasked once the ring is empty */
+#define EMAC_RX_POLLING     1
+#define EMAC_RX_BUDGET      32
+/* Rx interrupt coalescing with the DMA RI watchdog, in units of 256 system clocks (1~255), 0 to disable */
+#define EMAC_RX_INT_WDT     0
+
+/* Core the rx task and the interrupt of each interface are bound to when built with
+   FreeRTOS-SMP core affinity, both must stay on the same core */
+#define EMAC0_CORE          0
+#define EMAC1_CORE          1
+
+/* Per-packet cost profiling: time spent in the rx/tx path (generic timer ticks,
+   CNTFRQ per second) and rx pbuf high-water marks are added to ethernetif_rx_stats */
+#ifndef EMAC_PROFILE
+#define EMAC_PROFILE        0
+#endif
+
+/* Reference clock of the IEEE 1588 system time counter (EPLL/8) */
+#define EMAC_PTP_REF_CLK    (CLK_GetPLLClockFreq(EPLL) / 8)
+
 /******************************************************************************
  * Functions
  ******************************************************************************/
@@ -37,13 +58,21 @@ void EMAC_giveup_rx_desc_queue(EMACdevice *emacdev, u32 desc_mode);
 void EMAC_giveup_tx_desc_queue(EMACdevice *emacdev, u32 desc_mode);
 s32 EMAC_close(int intf);
 s32 EMAC_xmit_frames(struct sk_buff *skb, int intf, u32 offload_needed, u32 ts);
-void EMAC_handle_transmit_over(int intf);
-uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb);
+s32 EMAC_xmit_frames_sg(int intf, u32 count, u32 *len, u32 *dma_addr, u32 offload_type, u32 ts);
+void EMAC_handle_transmit_over(int intf, void (*tx_done)(int intf, s32 desc_index));
+uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb, uint32_t budget);
+bool EMAC_rx_pending(int intf);
+void EMAC_rx_int_enable(int intf);
+s32 EMAC_recycle_rx_buf(int intf, void *pData);
+u32 EMAC_ptp_init(int intf);
+void EMAC_ptp_get_time(int intf, u32 *sec, u32 *nsec);
+s32 EMAC_ptp_step_time(int intf, s64 delta_ns);
 static void EMAC_powerup_mac(EMACdevice *emacdev);
 static void EMAC_powerdown_mac(EMACdevice *emacdev);
 uint32_t EMAC_int_handler0(struct sk_buff *prskb);
 uint32_t EMAC_int_handler1(struct sk_buff *prskb);
 extern void notify_rx_task(int intf);
+extern void notify_tx_reclaim(int intf);
 
 extern EMACdevice EMACdev[];
 extern u8 mac_addr0[];
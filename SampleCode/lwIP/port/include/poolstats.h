@@ -0,0 +1,29 @@
+/**************************************************************************//**
+ * @file     poolstats.h
+ * @brief    lwIP memory pool statistics
+ *
+ * Needs LWIP_STATS and MEMP_STATS. Every memp is reported, including the
+ * MEM_USE_POOLS size classes of lwippools.h (MALLOC_<size>).
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __POOLSTATS_H__
+#define __POOLSTATS_H__
+
+#include "lwip/opt.h"
+#include "lwip/stats.h"
+
+/* Usage of one memp */
+struct poolstats_entry
+{
+    const char *name;
+    uint32_t avail;     /* number of elements */
+    uint32_t used;      /* elements allocated now */
+    uint32_t max;       /* high-water mark of used */
+    uint32_t err;       /* failed allocations */
+};
+
+int poolstats_get(int idx, struct poolstats_entry *entry);
+void poolstats_display(void);
+
+#endif
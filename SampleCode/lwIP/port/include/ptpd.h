@@ -0,0 +1,97 @@
+/**************************************************************************//**
+ * @file     ptpd.h
+ * @brief    IEEE 1588 PTP ordinary clock on the EMAC timestamp unit
+ *
+ * The clock runs as a slave-only ordinary clock with the end-to-end delay
+ * mechanism over UDP/IPv4 (ports 319/320, 224.0.1.129). Sync/Delay_Req are
+ * timestamped by the EMAC and the EMAC system time is disciplined by a PI
+ * servo on the timestamp addend register.
+ *
+ * Usage: set LWIP_PTP and LWIP_IGMP to 1 in lwipopts.h, with the
+ * PTPD_NUM_TIMEOUTS timeouts of the clock on top of those of lwIP:
+ *   #define MEMP_NUM_SYS_TIMEOUT  (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 2)
+ * and call ptpd_init() once the netif has been added.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#ifndef __PTPD_H__
+#define __PTPD_H__
+
+#include "lwip/opt.h"
+#include "lwip/netif.h"
+
+#ifndef LWIP_PTP
+#define LWIP_PTP                0
+#endif
+
+/* lwIP timeouts in use: Delay_Req and Announce receipt */
+#define PTPD_NUM_TIMEOUTS       2
+
+#define PTP_EVENT_PORT          319
+#define PTP_GENERAL_PORT        320
+
+/* PTP domain the clock listens to */
+#ifndef PTPD_DOMAIN
+#define PTPD_DOMAIN             0
+#endif
+
+/* PI servo gains in 1/1000, for sync intervals up to 1s.
+   frequency correction [ppb] = KP * offset [ns] + KI * accumulated offset [ns] */
+#ifndef PTPD_SERVO_KP
+#define PTPD_SERVO_KP           700
+#endif
+#ifndef PTPD_SERVO_KI
+#define PTPD_SERVO_KI           300
+#endif
+
+/* Largest frequency correction written to the addend register [ppb] */
+#ifndef PTPD_SERVO_MAX_PPB
+#define PTPD_SERVO_MAX_PPB      500000
+#endif
+
+/* Offsets beyond this step the clock instead of slewing it [ns] */
+#ifndef PTPD_STEP_THRESHOLD_NS
+#define PTPD_STEP_THRESHOLD_NS  1000000
+#endif
+
+/* Offset under which the clock is reported as locked to the master [ns] */
+#ifndef PTPD_LOCK_THRESHOLD_NS
+#define PTPD_LOCK_THRESHOLD_NS  1000
+#endif
+
+/* Mean path delay is averaged over about this many Delay_Resp */
+#ifndef PTPD_DELAY_FILTER
+#define PTPD_DELAY_FILTER       8
+#endif
+
+enum ptpd_state
+{
+    PTPD_DISABLED,          /* ptpd_init() not called or failed */
+    PTPD_LISTENING,         /* waiting for an Announce */
+    PTPD_UNCALIBRATED,      /* following a master, offset not settled */
+    PTPD_SLAVE,             /* locked within PTPD_LOCK_THRESHOLD_NS */
+};
+
+/* PTP time, TAI if the master runs the PTP timescale */
+struct ptpd_time
+{
+    uint64_t sec;
+    uint32_t nsec;
+};
+
+struct ptpd_status
+{
+    enum ptpd_state state;
+    uint8_t master_id[8];           /* clock identity of the grandmaster */
+    int64_t offset_ns;              /* last offset from the master, positive if ahead */
+    int64_t mean_path_delay_ns;
+    int32_t freq_adj_ppb;           /* correction applied to the nominal rate */
+    uint32_t syncs;                 /* offsets fed to the servo */
+    uint32_t steps;                 /* times the clock was stepped */
+};
+
+err_t ptpd_init(struct netif *netif);
+void ptpd_get_time(struct ptpd_time *t);
+void ptpd_get_status(struct ptpd_status *status);
+
+#endif
@@ -49,138 +49,312 @@
 
 #include "lwip/def.h"
 #include "lwip/mem.h"
+#include "lwip/memp.h"
 #include "lwip/pbuf.h"
 #include "lwip/sys.h"
+#include "lwip/tcpip.h"
 #include <lwip/stats.h>
 #include <lwip/snmp.h>
+#include "lwip/prot/ip.h"
+#include "lwip/prot/ip4.h"
+#include "lwip/prot/udp.h"
 #include "netif/etharp.h"
 #include "netif/ethernetif.h"
+#include "ptpd.h"
 #include "string.h"
 #include "lwipopts.h"
 
 /* Define those to better describe your network interface. */
 #define IFNAME  'e'
-#define IFNAME0 '0'
-#define IFNAME1 '1'
 
-struct netif *_netif0;
-struct netif *_netif1;
-
-/* Fired by EMAC Rx interrupt. This is greedy so just keep medium priority */
+/* Fired by EMAC Rx interrupt. This is greedy so just keep medium priority.
+   With LWIP_TCPIP_CORE_LOCKING_INPUT the task runs the stack itself, so it
+   gets the priority of the tcpip thread */
+#if LWIP_TCPIP_CORE_LOCKING_INPUT
+#define EMAC_LWIP_RX_PRIORITY   TCPIP_THREAD_PRIO
+#else
 #define EMAC_LWIP_RX_PRIORITY   (tskIDLE_PRIORITY + 1)
+#endif
 #define EMAC_LWIP_RX_STACKSIZE  (1024)
 
-#define NUM_OF_RXSKB 32
-struct sk_buff rxskbuf[NUM_OF_RXSKB]; // application buffer queue
+#define NUM_OF_RXSKB EMAC_RX_BUDGET
+
+/* Pin the rx task and the EMAC interrupt of each interface to EMACx_CORE on FreeRTOS-SMP */
+#if defined(configNUMBER_OF_CORES) && (configNUMBER_OF_CORES > 1) && (configUSE_CORE_AFFINITY == 1)
+#define ETHERNETIF_CORE_AFFINITY    1
+#if (EMAC0_CORE >= configNUMBER_OF_CORES) || (EMAC1_CORE >= configNUMBER_OF_CORES)
+#error "EMAC0_CORE/EMAC1_CORE must be below configNUMBER_OF_CORES"
+#endif
+#else
+#define ETHERNETIF_CORE_AFFINITY    0
+#endif
 
 extern u8_t mac_addr0[6];
 extern u8_t mac_addr1[6];
 extern struct sk_buff txbuf[EMAC_CNT];
 extern struct sk_buff rxbuf[EMAC_CNT];
 
-static TaskHandle_t post_rx_task[EMAC_CNT] = {NULL, NULL};
+#if ETH_PAD_SIZE
+#error "Zero-copy receive hands the DMA buffer to lwIP as is, ETH_PAD_SIZE is not supported"
+#endif
+#if !LWIP_SUPPORT_CUSTOM_PBUF
+#error "Zero-copy receive requires LWIP_SUPPORT_CUSTOM_PBUF"
+#endif
+
+/**
+ * Zero-copy receive. Every rx DMA buffer is handed to lwIP as a custom pbuf
+ * and goes back to the rx descriptor ring only when the stack frees it.
+ */
+struct rx_pbuf
+{
+    struct pbuf_custom pc;
+    int intf;
+    void *buf;
+    u32 ts_sec;     // hardware rx timestamp
+    u32 ts_subsec;
+};
+
+LWIP_MEMPOOL_DECLARE(RX_POOL, EMAC_CNT * RECEIVE_DESC_SIZE, sizeof(struct rx_pbuf), "Zero-copy RX PBUF pool");
+
+/**
+ * Scatter-gather transmit. Every pbuf of a chain gets its own tx descriptor,
+ * the chain stays referenced until the descriptor of its last segment is
+ * reclaimed. Chains longer than EMAC_TX_MAX_SEGS are linearized first.
+ */
+#define EMAC_TX_MAX_SEGS        8
+#define EMAC_TX_WAIT_MS         100  /* how long the sender waits for a free descriptor */
 
 /**
  * Helper struct to hold private data used to operate your ethernet interface.
- * Keeping the ethernet address of the MAC in this struct is not necessary
- * as it is already kept in the struct netif.
- * But this is only an example, anyway...
+ * There is one instance per EMAC and nothing is shared between them, so both
+ * interfaces can be driven concurrently by their own rx task.
  */
 struct ethernetif
 {
     struct eth_addr *ethaddr;
     /* Add whatever per-interface state that is needed here. */
+    struct netif *netif;
+    int intf;
+    TaskHandle_t rx_task;
+    struct sk_buff rxskbuf[NUM_OF_RXSKB];   // application buffer queue
+    struct ethernetif_rx_stats rx_stats;
+    sys_mutex_t tx_lock;
+    SemaphoreHandle_t tx_done_sem;
+    struct pbuf *tx_pbuf[TRANSMIT_DESC_SIZE];
+    s32 tx_ts_desc;                             // descriptor of the PTP frame waiting for its timestamp, -1 if none
+    int tx_ts_valid;
+    struct ethernetif_timestamp tx_ts;          // tx timestamp of the last PTP event frame
+#if (EMAC_PROFILE == 1)
+    u32 rx_pbuf_held;                           // rx pbufs currently owned by lwIP
+#endif
+};
+
+/* Board specific settings of each interface */
+struct ethernetif_config
+{
+    u8_t *mac_addr;
+    IRQn_ID_t irqn;
+    IRQHandler_t irq_handler;
+    char name;
+    const char *rx_task_name;
+    UBaseType_t core;
 };
 
+static const struct ethernetif_config ethernetif_config[EMAC_CNT] =
+{
+    [EMACINTF0] = {mac_addr0, EMAC0_IRQn, EMAC0_IRQHandler, '0', "emac0-lwip-rx", EMAC0_CORE},
+    [EMACINTF1] = {mac_addr1, EMAC1_IRQn, EMAC1_IRQHandler, '1', "emac1-lwip-rx", EMAC1_CORE},
+};
+
+static struct ethernetif ethernetif_dev[EMAC_CNT];
+
+#if (EMAC_PROFILE == 1)
+#define PROFILE_TICKS()     EL0_GetCurrentPhysicalValue()
+#endif
+
+static void rx_buf_recycle(int intf, void *buf)
+{
+    SYS_ARCH_DECL_PROTECT(old_level);
+
+    /* pbufs may be freed from any task, serialize access to the rx ring */
+    SYS_ARCH_PROTECT(old_level);
+    EMAC_recycle_rx_buf(intf, buf);
+    SYS_ARCH_UNPROTECT(old_level);
+}
+
+static void rx_pbuf_free(struct pbuf *p)
+{
+    struct rx_pbuf *rp = (struct rx_pbuf *)p;
+#if (EMAC_PROFILE == 1)
+    SYS_ARCH_DECL_PROTECT(old_level);
+
+    SYS_ARCH_PROTECT(old_level);
+    ethernetif_dev[rp->intf].rx_pbuf_held--;
+    SYS_ARCH_UNPROTECT(old_level);
+#endif
+
+    rx_buf_recycle(rp->intf, rp->buf);
+    LWIP_MEMPOOL_FREE(RX_POOL, rp);
+}
+
+static void rx_pbuf_pool_init(void)
+{
+    static int init_done = 0;
+
+    if (!init_done)
+    {
+        LWIP_MEMPOOL_INIT(RX_POOL);
+        init_done = 1;
+    }
+}
+
 void notify_rx_task(int intf)
 {
+    struct ethernetif *ethernetif = &ethernetif_dev[intf];
     BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 
-    if(xTaskGetSchedulerState() != taskSCHEDULER_RUNNING)
+    if((xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) || (ethernetif->rx_task == NULL))
         return;
 
-    vTaskNotifyGiveFromISR(post_rx_task[intf], &xHigherPriorityTaskWoken);
+    ethernetif->rx_stats.irqs++;
+    vTaskNotifyGiveFromISR(ethernetif->rx_task, &xHigherPriorityTaskWoken);
     /* Force context switch immediately (risky for scheduler) */
     // portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
-void EMAC0_IRQHandler(void)
+void notify_tx_reclaim(int intf)
 {
-    struct sk_buff *rskb = &rxskbuf[0];
+    struct ethernetif *ethernetif = &ethernetif_dev[intf];
+    BaseType_t xHigherPriorityTaskWoken = pdFALSE;
+
+    if((xTaskGetSchedulerState() != taskSCHEDULER_RUNNING) || (ethernetif->rx_task == NULL))
+        return;
 
-    EMAC_int_handler0(rskb);
+    /* Wake up a sender waiting for descriptors, the rx task does the reclaim otherwise */
+    xSemaphoreGiveFromISR(ethernetif->tx_done_sem, &xHigherPriorityTaskWoken);
+    vTaskNotifyGiveFromISR(ethernetif->rx_task, &xHigherPriorityTaskWoken);
 }
 
-void emac0_lwip_rx(void *arg)
+static void tx_pbuf_release(int intf, s32 desc_index)
 {
-    struct sk_buff *rskb = &rxskbuf[0];
-    uint32_t packetCnt;
+    struct ethernetif *ethernetif = &ethernetif_dev[intf];
 
-    for (;;)
+    if (desc_index == ethernetif->tx_ts_desc)
     {
-        /* Block until IRQ notifies */
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
-
-        packetCnt = EMAC_handle_received_data(EMACINTF0, rskb);
+        /* EMAC_handle_transmit_over() has just latched the timestamp of this descriptor */
+        ethernetif->tx_ts.sec = EMACdev[intf].tx_sec;
+        ethernetif->tx_ts.nsec = EMACdev[intf].tx_subsec;
+        ethernetif->tx_ts_valid = (ethernetif->tx_ts.sec | ethernetif->tx_ts.nsec) != 0;
+        ethernetif->tx_ts_desc = -1;
+    }
 
-        ethernetif_input0(packetCnt);
+    if (ethernetif->tx_pbuf[desc_index] != NULL)
+    {
+        pbuf_free(ethernetif->tx_pbuf[desc_index]);
+        ethernetif->tx_pbuf[desc_index] = NULL;
     }
 }
 
-void EMAC1_IRQHandler(void)
+static void low_level_tx_reclaim(struct ethernetif *ethernetif)
 {
-    struct sk_buff *rskb = &rxskbuf[0];
-
-    EMAC_int_handler1(rskb);
+    sys_mutex_lock(&ethernetif->tx_lock);
+    EMAC_handle_transmit_over(ethernetif->intf, tx_pbuf_release);
+    sys_mutex_unlock(&ethernetif->tx_lock);
 }
 
-void emac1_lwip_rx(void *arg)
+static void ethernetif_input(struct ethernetif *ethernetif, uint32_t packetCnt);
+
+/**
+ * Processes one batch of at most EMAC_RX_BUDGET received frames.
+ *
+ * @param ethernetif the interface to poll
+ * @return 1 if the ring is drained and the rx interrupt has been unmasked,
+ *         0 if more frames are pending and the task should poll again
+ */
+static int low_level_rx_poll(struct ethernetif *ethernetif)
 {
-    struct sk_buff *rskb = &rxskbuf[0];
+    struct ethernetif_rx_stats *stats = &ethernetif->rx_stats;
     uint32_t packetCnt;
+#if (EMAC_PROFILE == 1)
+    u64 start;
+#endif
+    SYS_ARCH_DECL_PROTECT(old_level);
 
-    for (;;)
-    {
-        /* Block until IRQ notifies */
-        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    low_level_tx_reclaim(ethernetif);
 
-        packetCnt = EMAC_handle_received_data(EMACINTF1, rskb);
+#if (EMAC_PROFILE == 1)
+    start = PROFILE_TICKS();
+#endif
+    /* rx_buf_recycle() re-arms descriptors from any task under the same
+     * protection. It fills a descriptor before it hands it to the DMA, a
+     * detach running alongside on another core could take the half-filled
+     * descriptor for a received frame. */
+    SYS_ARCH_PROTECT(old_level);
+    packetCnt = EMAC_handle_received_data(ethernetif->intf, ethernetif->rxskbuf, EMAC_RX_BUDGET);
+    SYS_ARCH_UNPROTECT(old_level);
+
+    ethernetif_input(ethernetif, packetCnt);
+
+#if (EMAC_PROFILE == 1)
+    if (packetCnt)
+        stats->rx_ticks += PROFILE_TICKS() - start;
+#endif
+    stats->polls++;
+    stats->frames += packetCnt;
+    if (packetCnt > stats->max_frames_per_poll)
+        stats->max_frames_per_poll = packetCnt;
 
-        ethernetif_input1(packetCnt);
+#if (EMAC_RX_POLLING == 1)
+    if (packetCnt == EMAC_RX_BUDGET)
+    {
+        stats->budget_exhausted++;
+        return 0;
     }
+
+    /* Ring looks empty, hand it back to the interrupt. A frame landing
+     * in between would not raise RI again, so look once more. The ISR
+     * runs on this core, masking it locally keeps the two apart. */
+    SYS_ARCH_PROTECT(old_level);
+    EMAC_rx_int_enable(ethernetif->intf);
+    SYS_ARCH_UNPROTECT(old_level);
+
+    return !EMAC_rx_pending(ethernetif->intf);
+#else
+    return 1;
+#endif
 }
 
-/**
- * In this function, the hardware should be initialized.
- * Called from ethernetif_init().
- *
- * @param netif the already initialized lwip network interface structure
- *        for this ethernetif
- */
-static void
-low_level_init0(struct netif *netif)
+static void ethernetif_rx_task(void *arg)
 {
-    /* set MAC hardware address length */
-    netif->hwaddr_len = ETHARP_HWADDR_LEN;
+    struct ethernetif *ethernetif = (struct ethernetif *)arg;
 
-    /* set MAC hardware address */
-    memcpy(netif->hwaddr, mac_addr0, netif->hwaddr_len);
+#if LWIP_CHKSUM_NEON
+    portTASK_USES_FLOATING_POINT();
+#endif
 
-    /* maximum transfer unit */
-    netif->mtu = 1500;
+    for (;;)
+    {
+        if (low_level_rx_poll(ethernetif))
+        {
+            /* Block until IRQ notifies */
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        }
+        else
+        {
+            /* Budget used up, let other tasks run before polling again */
+            taskYIELD();
+        }
+    }
+}
 
-    /* device capabilities */
-    netif->flags = NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP | NETIF_FLAG_LINK_UP;
-#ifdef LWIP_IGMP
-    netif->flags |= NETIF_FLAG_IGMP;
-#endif
+void EMAC0_IRQHandler(void)
+{
+    EMAC_int_handler0(ethernetif_dev[EMACINTF0].rxskbuf);
+}
 
-    EMAC_open(EMACINTF0, EMAC_MODE);
-    /* we will call interrupt safe API, the priority must be at or below configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY */
-    IRQ_SetPriority((IRQn_ID_t)EMAC0_IRQn, (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1) << portPRIORITY_SHIFT);
-    IRQ_SetHandler(EMAC0_IRQn, EMAC0_IRQHandler);
-    IRQ_SetTarget(EMAC0_IRQn, 0x1 << cpuid());
-    IRQ_Enable(EMAC0_IRQn);
+void EMAC1_IRQHandler(void)
+{
+    EMAC_int_handler1(ethernetif_dev[EMACINTF1].rxskbuf);
 }
 
 /**
@@ -189,15 +363,18 @@ low_level_init0(struct netif *netif)
  *
  * @param netif the already initialized lwip network interface structure
  *        for this ethernetif
+ * @param ethernetif the interface to bring up
  */
 static void
-low_level_init1(struct netif *netif)
+low_level_init(struct netif *netif, struct ethernetif *ethernetif)
 {
+    const struct ethernetif_config *config = &ethernetif_config[ethernetif->intf];
+
     /* set MAC hardware address length */
     netif->hwaddr_len = ETHARP_HWADDR_LEN;
 
     /* set MAC hardware address */
-    memcpy(netif->hwaddr, mac_addr1, netif->hwaddr_len);
+    memcpy(netif->hwaddr, config->mac_addr, netif->hwaddr_len);
 
     /* maximum transfer unit */
     netif->mtu = 1500;
@@ -208,16 +385,28 @@ low_level_init1(struct netif *netif)
     netif->flags |= NETIF_FLAG_IGMP;
 #endif
 
-    EMAC_open(EMACINTF1, EMAC_MODE);
+#if (LWIP_USING_HW_CHECKSUM == 1)
+    /* checksums are generated and verified by the EMAC offload engine */
+    NETIF_SET_CHECKSUM_CTRL(netif, NETIF_CHECKSUM_DISABLE_ALL);
+#endif
+
+    EMAC_open(ethernetif->intf, EMAC_MODE);
     /* we will call interrupt safe API, the priority must be at or below configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY */
-    IRQ_SetPriority((IRQn_ID_t)EMAC1_IRQn, (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1) << portPRIORITY_SHIFT);
-    IRQ_SetHandler(EMAC1_IRQn, EMAC1_IRQHandler);
-    IRQ_SetTarget(EMAC1_IRQn, 0x1 << cpuid());
-    IRQ_Enable(EMAC1_IRQn);
+    IRQ_SetPriority(config->irqn, (configLIBRARY_MAX_SYSCALL_INTERRUPT_PRIORITY + 1) << portPRIORITY_SHIFT);
+    IRQ_SetHandler(config->irqn, config->irq_handler);
+#if (ETHERNETIF_CORE_AFFINITY == 1)
+    /* must be the core the rx task is bound to, see low_level_rx_poll() */
+    IRQ_SetTarget(config->irqn, 0x1 << config->core);
+#else
+    IRQ_SetTarget(config->irqn, 0x1 << cpuid());
+#endif
+    IRQ_Enable(config->irqn);
 }
 
-int32_t EMAC0_TransmitPkt(struct sk_buff *ptskb, uint8_t *pbuf, uint32_t len)
+static int32_t
+low_level_transmit_pkt(int intf, struct sk_buff *ptskb, uint8_t *pbuf, uint32_t len)
 {
+    struct ethernetif *ethernetif = &ethernetif_dev[intf];
     struct sk_buff *tskb;
 
 #if (LWIP_USING_HW_CHECKSUM == 1)
@@ -226,128 +415,223 @@ int32_t EMAC0_TransmitPkt(struct sk_buff *ptskb, uint8_t *pbuf, uint32_t len)
     u32 offload_needed = 0;
 #endif
 
+    int32_t ret;
+
     if(ptskb == NULL)
     {
-        tskb = (struct sk_buff *)((uint64_t)&txbuf[EMACINTF0] | NON_CACHE);
+        tskb = (struct sk_buff *)((uint64_t)&txbuf[intf] | NON_CACHE);
 
         tskb->len = len;
         memcpy((uint8_t *)((u64)(tskb->data)), pbuf, len);
-        return EMAC_xmit_frames(tskb, EMACINTF0, offload_needed, 0);
     }
     else
     {
-        ptskb->len = len;
-        return EMAC_xmit_frames(ptskb, EMACINTF0, offload_needed, 0);
+        tskb = ptskb;
+        tskb->len = len;
     }
+
+    sys_mutex_lock(&ethernetif->tx_lock);
+    ret = EMAC_xmit_frames(tskb, intf, offload_needed, 0);
+    sys_mutex_unlock(&ethernetif->tx_lock);
+
+    return ret;
+}
+
+int32_t EMAC0_TransmitPkt(struct sk_buff *ptskb, uint8_t *pbuf, uint32_t len)
+{
+    return low_level_transmit_pkt(EMACINTF0, ptskb, pbuf, len);
 }
 
 int32_t EMAC1_TransmitPkt(struct sk_buff *ptskb, uint8_t *pbuf, uint32_t len)
 {
-    struct sk_buff *tskb;
+    return low_level_transmit_pkt(EMACINTF1, ptskb, pbuf, len);
+}
 
+/**
+ * Picks the checksum insertion the EMAC offload engine should do for a frame.
+ * TCP/UDP/ICMP checksums are left zero by lwIP on this netif and are filled in
+ * completely by hardware. IPv4 fragments only get the header checksum, the
+ * engine cannot compute a payload checksum spread over several frames.
+ *
+ * @param p the MAC packet to send
+ * @return one of eDescTxCis*
+ */
+static u32
+low_level_tx_csum_type(struct pbuf *p)
+{
 #if (LWIP_USING_HW_CHECKSUM == 1)
-    u32 offload_needed = 1;
-#else
-    u32 offload_needed = 0;
-#endif
+    struct eth_hdr *ethhdr = (struct eth_hdr *)p->payload;
+    struct ip_hdr *iphdr;
+    u16_t type = ethhdr->type;
+    u16_t hlen = SIZEOF_ETH_HDR;
 
-    if(ptskb == NULL)
+    if ((type == PP_HTONS(ETHTYPE_VLAN)) && (p->len >= SIZEOF_ETH_HDR + SIZEOF_VLAN_HDR))
     {
-        tskb = (struct sk_buff *)((uint64_t)&txbuf[EMACINTF1] | NON_CACHE);
+        type = ((struct eth_vlan_hdr *)((u8_t *)p->payload + SIZEOF_ETH_HDR))->tpid;
+        hlen += SIZEOF_VLAN_HDR;
+    }
 
-        tskb->len = len;
-        memcpy((uint8_t *)((u64)(tskb->data)), pbuf, len);
-        return EMAC_xmit_frames(tskb, EMACINTF1, offload_needed, 0);
+    if (type == PP_HTONS(ETHTYPE_IP))
+    {
+        if (p->len < hlen + IP_HLEN)
+            return eDescTxCisIpv4HdrCs;
+
+        iphdr = (struct ip_hdr *)((u8_t *)p->payload + hlen);
+        if (IPH_OFFSET(iphdr) & PP_HTONS(IP_OFFMASK | IP_MF))
+            return eDescTxCisIpv4HdrCs;
+
+        switch (IPH_PROTO(iphdr))
+        {
+        case IP_PROTO_TCP:
+        case IP_PROTO_UDP:
+        case IP_PROTO_ICMP:
+            return eDescTxCisTcpPseudoCs;
+        default:
+            return eDescTxCisIpv4HdrCs;
+        }
     }
-    else
+    else if (type == PP_HTONS(ETHTYPE_IPV6))
     {
-        ptskb->len = len;
-        return EMAC_xmit_frames(ptskb, EMACINTF1, offload_needed, 0);
+        return eDescTxCisTcpPseudoCs;
     }
+#endif
+    return eDescTxCisBypass;
 }
 
+#if LWIP_PTP
 /**
- * This function should do the actual transmission of the packet. The packet is
- * contained in the pbuf that is passed to the function. This pbuf
- * might be chained.
- *
- * @param netif the lwip network interface structure for this ethernetif
- * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
- * @return ERR_OK if the packet could be sent
- *         an err_t value if the packet couldn't be sent
+ * Tells whether a frame is a PTP event message (UDP/IPv4 to port 319), the
+ * only frames the EMAC is asked to timestamp on transmit.
  *
- * @note Returning ERR_MEM here if a DMA queue of your MAC is full can lead to
- *       strange results. You might consider waiting for space in the DMA queue
- *       to become availale since the stack doesn't retry to send a packet
- *       dropped because of memory failure (except for the TCP timers).
+ * @param p the MAC packet to send
+ * @return 1 for a PTP event message, 0 otherwise
  */
-static err_t
-low_level_output0(struct netif *netif, struct pbuf *p)
+static u32
+low_level_tx_is_ptp_event(struct pbuf *p)
 {
-    struct pbuf *q;
-    u8_t *buf = NULL;
-    u16_t len = 0;
-    struct sk_buff *tskb = (struct sk_buff *)((uint64_t)&txbuf[EMACINTF0] | NON_CACHE);
+    struct eth_hdr *ethhdr = (struct eth_hdr *)p->payload;
+    struct ip_hdr *iphdr;
+    struct udp_hdr *udphdr;
+    u16_t type = ethhdr->type;
+    u16_t hlen = SIZEOF_ETH_HDR;
 
-#if ETH_PAD_SIZE
-    pbuf_header(p, -ETH_PAD_SIZE); /* drop the padding word */
-#endif
-
-    buf = (u8_t*)tskb->data;
-    for(q = p; q != NULL; q = q->next)
+    if ((type == PP_HTONS(ETHTYPE_VLAN)) && (p->len >= SIZEOF_ETH_HDR + SIZEOF_VLAN_HDR))
     {
-        memcpy((u8_t*)&buf[len], q->payload, q->len);
-        len = len + q->len;
+        type = ((struct eth_vlan_hdr *)((u8_t *)p->payload + SIZEOF_ETH_HDR))->tpid;
+        hlen += SIZEOF_VLAN_HDR;
     }
-    EMAC0_TransmitPkt(tskb, NULL, len);
 
-#if ETH_PAD_SIZE
-    pbuf_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
-#endif
+    if ((type != PP_HTONS(ETHTYPE_IP)) || (p->len < hlen + IP_HLEN))
+        return 0;
 
-    LINK_STATS_INC(link.xmit);
+    iphdr = (struct ip_hdr *)((u8_t *)p->payload + hlen);
+    if ((IPH_PROTO(iphdr) != IP_PROTO_UDP) || (IPH_OFFSET(iphdr) & PP_HTONS(IP_OFFMASK)))
+        return 0;
 
-    return ERR_OK;
+    hlen += IPH_HL_BYTES(iphdr);
+    if (p->len < hlen + UDP_HLEN)
+        return 0;
+
+    udphdr = (struct udp_hdr *)((u8_t *)p->payload + hlen);
+    return udphdr->dest == PP_HTONS(PTP_EVENT_PORT);
 }
+#endif
 
 /**
  * This function should do the actual transmission of the packet. The packet is
  * contained in the pbuf that is passed to the function. This pbuf
  * might be chained.
  *
+ * Each pbuf of the chain is mapped onto its own tx descriptor without copying,
+ * the chain is referenced until the DMA is done with it. If the descriptor ring
+ * is full, the caller is blocked until frames complete rather than dropping.
+ *
  * @param netif the lwip network interface structure for this ethernetif
  * @param p the MAC packet to send (e.g. IP packet including MAC addresses and type)
  * @return ERR_OK if the packet could be sent
  *         an err_t value if the packet couldn't be sent
- *
- * @note Returning ERR_MEM here if a DMA queue of your MAC is full can lead to
- *       strange results. You might consider waiting for space in the DMA queue
- *       to become availale since the stack doesn't retry to send a packet
- *       dropped because of memory failure (except for the TCP timers).
  */
 static err_t
-low_level_output1(struct netif *netif, struct pbuf *p)
+low_level_output(struct netif *netif, struct pbuf *p)
 {
+    struct ethernetif *ethernetif = netif->state;
     struct pbuf *q;
-    u8_t *buf = NULL;
-    u16_t len = 0;
-    struct sk_buff *tskb = (struct sk_buff *)((uint64_t)&txbuf[EMACINTF1] | NON_CACHE);
+    u32 seg_len[EMAC_TX_MAX_SEGS];
+    u32 seg_addr[EMAC_TX_MAX_SEGS];
+    u32 count = 0;
+    s32 desc_index;
+#if (EMAC_PROFILE == 1)
+    u64 start = PROFILE_TICKS();
+#endif
 
-#if ETH_PAD_SIZE
-    pbuf_header(p, -ETH_PAD_SIZE); /* drop the padding word */
+    u32 offload_type = low_level_tx_csum_type(p);
+#if LWIP_PTP
+    u32 ts = low_level_tx_is_ptp_event(p);
+#else
+    u32 ts = 0;
 #endif
 
-    buf = (u8_t*)tskb->data;
+    if (pbuf_clen(p) > EMAC_TX_MAX_SEGS)
+    {
+        /* Too many segments, send a linear copy instead */
+        p = pbuf_clone(PBUF_RAW, PBUF_RAM, p);
+        if (p == NULL)
+        {
+            LINK_STATS_INC(link.memerr);
+            LINK_STATS_INC(link.drop);
+            return ERR_MEM;
+        }
+    }
+    else
+    {
+        /* Keep the chain alive until the DMA has sent it */
+        pbuf_ref(p);
+    }
+
     for(q = p; q != NULL; q = q->next)
     {
-        memcpy((u8_t*)&buf[len], q->payload, q->len);
-        len = len + q->len;
+        if (q->len == 0)
+            continue;
+        dcache_clean_by_mva(q->payload, q->len);
+        seg_addr[count] = (u32)((u64)q->payload & 0xFFFFFFFF);
+        seg_len[count] = q->len;
+        count++;
     }
-    EMAC1_TransmitPkt(tskb, NULL, len);
 
-#if ETH_PAD_SIZE
-    pbuf_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
+    sys_mutex_lock(&ethernetif->tx_lock);
+    for (;;)
+    {
+        EMAC_handle_transmit_over(ethernetif->intf, tx_pbuf_release);
+
+        desc_index = EMAC_xmit_frames_sg(ethernetif->intf, count, seg_len, seg_addr, offload_type, ts);
+        if (desc_index >= 0)
+        {
+            ethernetif->tx_pbuf[desc_index] = p;
+            if (ts)
+            {
+                ethernetif->tx_ts_desc = desc_index;
+                ethernetif->tx_ts_valid = 0;
+            }
+#if (EMAC_PROFILE == 1)
+            ethernetif->rx_stats.tx_frames++;
+            ethernetif->rx_stats.tx_ticks += PROFILE_TICKS() - start;
 #endif
+            break;
+        }
+
+        /* Ring is full, wait for the DMA to complete some frames */
+        sys_mutex_unlock(&ethernetif->tx_lock);
+        if (xSemaphoreTake(ethernetif->tx_done_sem, pdMS_TO_TICKS(EMAC_TX_WAIT_MS)) != pdTRUE)
+        {
+            LWIP_DEBUGF(NETIF_DEBUG, ("low_level_output: tx ring stalled\n"));
+            pbuf_free(p);
+            LINK_STATS_INC(link.memerr);
+            LINK_STATS_INC(link.drop);
+            return ERR_MEM;
+        }
+        sys_mutex_lock(&ethernetif->tx_lock);
+    }
+    sys_mutex_unlock(&ethernetif->tx_lock);
 
     LINK_STATS_INC(link.xmit);
 
@@ -355,48 +639,54 @@ low_level_output1(struct netif *netif, struct pbuf *p)
 }
 
 /**
- * Should allocate a pbuf and transfer the bytes of the incoming
- * packet from the interface into the pbuf.
+ * Wraps the received DMA buffer into a custom pbuf without copying it.
+ * The buffer is given back to the rx descriptor ring when the pbuf is freed.
  *
  * @param netif the lwip network interface structure for this ethernetif
- * @return a pbuf filled with the received packet (including MAC header)
- *         NULL on memory error
+ * @param intf EMAC interface the buffer belongs to
+ * @param len length of the received frame
+ * @param rskb received frame as reported by EMAC_handle_received_data()
+ * @return a pbuf referencing the received packet (including MAC header)
+ *         NULL on memory error, the buffer is recycled in that case
  */
 static struct pbuf *
-low_level_input(struct netif *netif, u16_t len, u8_t *buf)
+low_level_input(struct netif *netif, int intf, u16_t len, struct sk_buff *rskb)
 {
-    struct pbuf *p, *q;
+    u8_t *buf = rskb->pData;
+    struct rx_pbuf *rp;
+    struct pbuf *p;
 
-#if ETH_PAD_SIZE
-    len += ETH_PAD_SIZE; /* allow room for Ethernet padding */
-#endif
+    rp = (struct rx_pbuf *)LWIP_MEMPOOL_ALLOC(RX_POOL);
+    if (rp == NULL)
+    {
+        // drop the packet and give the buffer back to DMA
+        rx_buf_recycle(intf, buf);
+        LINK_STATS_INC(link.memerr);
+        LINK_STATS_INC(link.drop);
+        return NULL;
+    }
 
-    /* We allocate a pbuf chain of pbufs from the pool. */
-    p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+    rp->pc.custom_free_function = rx_pbuf_free;
+    rp->intf = intf;
+    rp->buf = buf;
+    rp->ts_sec = rskb->ts_sec;
+    rp->ts_subsec = rskb->ts_subsec;
 
-    if (p != NULL)
+#if (EMAC_PROFILE == 1)
     {
-#if ETH_PAD_SIZE
-        pbuf_header(p, -ETH_PAD_SIZE); /* drop the padding word */
-#endif
+        struct ethernetif *ethernetif = netif->state;
+        SYS_ARCH_DECL_PROTECT(old_level);
 
-        len = 0;
-        /* We iterate over the pbuf chain until we have read the entire
-        * packet into the pbuf. */
-        p->payload = (u8_t*)buf;
-
-#if ETH_PAD_SIZE
-        pbuf_header(p, ETH_PAD_SIZE); /* reclaim the padding word */
+        SYS_ARCH_PROTECT(old_level);
+        if (++ethernetif->rx_pbuf_held > ethernetif->rx_stats.rx_pbuf_max)
+            ethernetif->rx_stats.rx_pbuf_max = ethernetif->rx_pbuf_held;
+        SYS_ARCH_UNPROTECT(old_level);
+    }
 #endif
 
-        LINK_STATS_INC(link.recv);
-    }
-    else
-    {
-        // do nothing. drop the packet
-        LINK_STATS_INC(link.memerr);
-        LINK_STATS_INC(link.drop);
-    }
+    p = pbuf_alloced_custom(PBUF_RAW, len, PBUF_REF, &rp->pc, buf, sizeof(((struct sk_buff *)0)->data));
+
+    LINK_STATS_INC(link.recv);
 
     return p;
 }
@@ -408,24 +698,46 @@ low_level_input(struct netif *netif, u16_t len, u8_t *buf)
  * interface. Then the type of the received packet is determined and
  * the appropriate input function is called.
  *
- * @param netif the lwip network interface structure for this ethernetif
+ * @param ethernetif the interface the frames were received on
+ * @param packetCnt number of frames reported in ethernetif->rxskbuf
  */
-void
-ethernetif_input0(uint32_t packetCnt)
+static void
+ethernetif_input(struct ethernetif *ethernetif, uint32_t packetCnt)
 {
+    struct netif *netif = ethernetif->netif;
+    struct sk_buff *rskb;
     struct eth_hdr *ethhdr;
     struct pbuf *p;
     u16_t i;
 
+    if (packetCnt == 0)
+        return;
+
+#if LWIP_TCPIP_CORE_LOCKING_INPUT
+    /* netif->input() runs the stack in this task, take the core lock once
+       for the whole batch rather than once per frame */
+    LOCK_TCPIP_CORE();
+#endif
     for(i = 0; i < packetCnt; i++) {
+        rskb = &ethernetif->rxskbuf[i];
+
+        /* hardware reported a bad frame or checksum, drop it */
+        if (!rskb->rdy)
+        {
+            rx_buf_recycle(ethernetif->intf, rskb->pData);
+            LINK_STATS_INC(link.chkerr);
+            LINK_STATS_INC(link.drop);
+            continue;
+        }
+
         /* move received packet into a new pbuf */
 #if (LWIP_USING_HW_CHECKSUM == 1)
-        p = low_level_input(_netif0, (&rxskbuf[i])->len, (&rxskbuf[i])->pData);
+        p = low_level_input(netif, ethernetif->intf, rskb->len, rskb);
 #else
-        p = low_level_input(_netif0, (&rxskbuf[i])->len + 4, (&rxskbuf[i])->pData);
+        p = low_level_input(netif, ethernetif->intf, rskb->len + 4, rskb);
 #endif
         /* no packet could be read, silently ignore this */
-        if (p == NULL) return;
+        if (p == NULL) continue;
 
         /* points to packet payload, which starts with an Ethernet header */
         ethhdr = p->payload;
@@ -440,8 +752,9 @@ ethernetif_input0(uint32_t packetCnt)
         case ETHTYPE_PPPOEDISC:
         case ETHTYPE_PPPOE:
     #endif /* PPPOE_SUPPORT */
-            /* full packet send to tcpip_thread to process */
-            if (_netif0->input(p, _netif0)!=ERR_OK)
+            /* full packet send to tcpip_thread to process, or processed
+               right here with LWIP_TCPIP_CORE_LOCKING_INPUT */
+            if (netif->input(p, netif)!=ERR_OK)
             {
                 LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
                 pbuf_free(p);
@@ -455,63 +768,104 @@ ethernetif_input0(uint32_t packetCnt)
             break;
         }
     }
+#if LWIP_TCPIP_CORE_LOCKING_INPUT
+    UNLOCK_TCPIP_CORE();
+#endif
 }
 
+void
+ethernetif_input0(uint32_t packetCnt)
+{
+    ethernetif_input(&ethernetif_dev[EMACINTF0], packetCnt);
+}
+
+void
+ethernetif_input1(uint32_t packetCnt)
+{
+    ethernetif_input(&ethernetif_dev[EMACINTF1], packetCnt);
+}
 
 /**
- * This function should be called when a packet is ready to be read
- * from the interface. It uses the function low_level_input() that
- * should handle the actual reception of bytes from the network
- * interface. Then the type of the received packet is determined and
- * the appropriate input function is called.
+ * Reads the rx polling counters of an interface, e.g. to tune EMAC_RX_BUDGET
+ * and EMAC_RX_INT_WDT. Average frames per poll is frames / polls.
+ * With EMAC_PROFILE, rx_ticks / frames and tx_ticks / tx_frames give the
+ * per-packet cost in generic timer ticks; multiply by the CPU clock and
+ * divide by CNTFRQ for cycles per frame.
  *
- * @param netif the lwip network interface structure for this ethernetif
+ * @param intf EMAC interface
+ * @param stats filled with a snapshot of the counters
  */
 void
-ethernetif_input1(uint32_t packetCnt)
+ethernetif_get_rx_stats(int intf, struct ethernetif_rx_stats *stats)
 {
-    struct eth_hdr *ethhdr;
-    struct pbuf *p;
-    u16_t i;
+    SYS_ARCH_DECL_PROTECT(old_level);
 
-    for(i = 0; i < packetCnt; i++) {
-        /* move received packet into a new pbuf */
-#if (LWIP_USING_HW_CHECKSUM == 1)
-        p = low_level_input(_netif1, (&rxskbuf[i])->len, (&rxskbuf[i])->pData);
-#else
-        p = low_level_input(_netif1, (&rxskbuf[i])->len + 4, (&rxskbuf[i])->pData);
-#endif
-        /* no packet could be read, silently ignore this */
-        if (p == NULL) return;
+    SYS_ARCH_PROTECT(old_level);
+    *stats = ethernetif_dev[intf].rx_stats;
+    SYS_ARCH_UNPROTECT(old_level);
+}
 
-        /* points to packet payload, which starts with an Ethernet header */
-        ethhdr = p->payload;
+/**
+ * Returns the EMAC interface behind a netif set up by ethernetif_init0/1().
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @return EMACINTF0 or EMACINTF1
+ */
+int
+ethernetif_get_intf(struct netif *netif)
+{
+    return ((struct ethernetif *)netif->state)->intf;
+}
 
-        switch (htons(ethhdr->type))
-        {
-        /* IP or ARP packet? */
-        case ETHTYPE_IP:
-        case ETHTYPE_ARP:
-    #if PPPOE_SUPPORT
-        /* PPPoE packet? */
-        case ETHTYPE_PPPOEDISC:
-        case ETHTYPE_PPPOE:
-    #endif /* PPPOE_SUPPORT */
-            /* full packet send to tcpip_thread to process */
-            if (_netif1->input(p, _netif1)!=ERR_OK)
-            {
-                LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_input: IP input error\n"));
-                pbuf_free(p);
-                p = NULL;
-            }
-            break;
+/**
+ * Reads the hardware timestamp taken when a frame was received.
+ * Works on the pbuf handed to the stack by this driver and on the same pbuf
+ * further up the stack, e.g. in a UDP receive callback.
+ *
+ * @param p received packet
+ * @param ts filled with the EMAC system time at the start of the frame
+ * @return 0 on success, -1 if the frame has no timestamp
+ */
+int
+ethernetif_get_rx_timestamp(struct pbuf *p, struct ethernetif_timestamp *ts)
+{
+    struct rx_pbuf *rp = (struct rx_pbuf *)p;
 
-        default:
-            pbuf_free(p);
-            p = NULL;
-            break;
-        }
+    if (!(p->flags & PBUF_FLAG_IS_CUSTOM) || (rp->pc.custom_free_function != rx_pbuf_free))
+        return -1;
+    if ((rp->ts_sec | rp->ts_subsec) == 0)
+        return -1;
+
+    ts->sec = rp->ts_sec;
+    ts->nsec = rp->ts_subsec;
+    return 0;
+}
+
+/**
+ * Reads the hardware timestamp of the last PTP event message sent on a netif.
+ * The timestamp becomes available once the EMAC reports the frame as sent.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @param ts filled with the EMAC system time the frame left the MAC
+ * @return 0 on success, -1 if the timestamp is not available (yet)
+ */
+int
+ethernetif_get_tx_timestamp(struct netif *netif, struct ethernetif_timestamp *ts)
+{
+    struct ethernetif *ethernetif = netif->state;
+    int ret = -1;
+
+    sys_mutex_lock(&ethernetif->tx_lock);
+    /* the tx interrupt may not have been handled yet */
+    EMAC_handle_transmit_over(ethernetif->intf, tx_pbuf_release);
+    if (ethernetif->tx_ts_valid)
+    {
+        *ts = ethernetif->tx_ts;
+        ret = 0;
     }
+    sys_mutex_unlock(&ethernetif->tx_lock);
+
+    return ret;
 }
 
 /**
@@ -519,28 +873,21 @@ ethernetif_input1(uint32_t packetCnt)
  * network interface. It calls the function low_level_init() to do the
  * actual setup of the hardware.
  *
- * This function should be passed as a parameter to netif_add().
- *
  * @param netif the lwip network interface structure for this ethernetif
+ * @param intf EMAC interface backing the netif
  * @return ERR_OK if the loopif is initialized
  *         ERR_MEM if private data couldn't be allocated
  *         any other err_t on error
  */
-err_t
-ethernetif_init0(struct netif *netif)
+static err_t
+ethernetif_init_intf(struct netif *netif, int intf)
 {
-    struct ethernetif *ethernetif;
+    const struct ethernetif_config *config = &ethernetif_config[intf];
+    struct ethernetif *ethernetif = &ethernetif_dev[intf];
+    BaseType_t ret;
 
     LWIP_ASSERT("netif != NULL", (netif != NULL));
 
-    _netif0 = netif;
-
-    ethernetif = mem_malloc(sizeof(struct ethernetif));
-    if (ethernetif == NULL) {
-        LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_init: out of memory\n"));
-        return ERR_MEM;
-    }
-
 #if LWIP_NETIF_HOSTNAME
     /* Initialize interface hostname */
     netif->hostname = "ma35d0";
@@ -553,89 +900,80 @@ ethernetif_init0(struct netif *netif)
      */
     netif->state = ethernetif;
     netif->name[0] = IFNAME;
-    netif->name[1] = IFNAME0;
+    netif->name[1] = config->name;
     /* We directly use etharp_output() here to save a function call.
      * You can instead declare your own function an call etharp_output()
      * from it if you have to do some checks before sending (e.g. if link
      * is available...) */
     netif->output = etharp_output;
-    netif->linkoutput = low_level_output0;
+    netif->linkoutput = low_level_output;
 
     ethernetif->ethaddr = (struct eth_addr *)&(netif->hwaddr[0]);
+    ethernetif->netif = netif;
+    ethernetif->intf = intf;
+    ethernetif->tx_ts_desc = -1;
+
+    rx_pbuf_pool_init();
+
+    if (sys_mutex_new(&ethernetif->tx_lock) != ERR_OK)
+        return ERR_MEM;
+    ethernetif->tx_done_sem = xSemaphoreCreateBinary();
+    if (ethernetif->tx_done_sem == NULL)
+        return ERR_MEM;
 
     /* initialize the hardware */
-    low_level_init0(netif);
+    low_level_init(netif, ethernetif);
 
-    xTaskCreate(emac0_lwip_rx,
-            "emac0-lwip-rx",
+#if (ETHERNETIF_CORE_AFFINITY == 1)
+    ret = xTaskCreateAffinitySet(ethernetif_rx_task,
+            config->rx_task_name,
             EMAC_LWIP_RX_STACKSIZE,
-            NULL,
+            ethernetif,
             EMAC_LWIP_RX_PRIORITY,
-            &post_rx_task[EMACINTF0]);
+            (UBaseType_t)(0x1 << config->core),
+            &ethernetif->rx_task);
+#else
+    ret = xTaskCreate(ethernetif_rx_task,
+            config->rx_task_name,
+            EMAC_LWIP_RX_STACKSIZE,
+            ethernetif,
+            EMAC_LWIP_RX_PRIORITY,
+            &ethernetif->rx_task);
+#endif
+    if (ret != pdPASS)
+        return ERR_MEM;
 
     return ERR_OK;
 }
 
+/**
+ * Should be called at the beginning of the program to set up the
+ * network interface of EMAC0.
+ *
+ * This function should be passed as a parameter to netif_add().
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @return ERR_OK if the loopif is initialized
+ *         any other err_t on error
+ */
+err_t
+ethernetif_init0(struct netif *netif)
+{
+    return ethernetif_init_intf(netif, EMACINTF0);
+}
 
 /**
  * Should be called at the beginning of the program to set up the
- * network interface. It calls the function low_level_init() to do the
- * actual setup of the hardware.
+ * network interface of EMAC1.
  *
  * This function should be passed as a parameter to netif_add().
  *
  * @param netif the lwip network interface structure for this ethernetif
  * @return ERR_OK if the loopif is initialized
- *         ERR_MEM if private data couldn't be allocated
  *         any other err_t on error
  */
 err_t
 ethernetif_init1(struct netif *netif)
 {
-    struct ethernetif *ethernetif;
-
-    LWIP_ASSERT("netif != NULL", (netif != NULL));
-
-    _netif1 = netif;
-
-    ethernetif = mem_malloc(sizeof(struct ethernetif));
-    if (ethernetif == NULL) {
-        LWIP_DEBUGF(NETIF_DEBUG, ("ethernetif_init: out of memory\n"));
-        return ERR_MEM;
-    }
-
-#if LWIP_NETIF_HOSTNAME
-    /* Initialize interface hostname */
-    netif->hostname = "ma35d0";
-#endif /* LWIP_NETIF_HOSTNAME */
-
-    /*
-     * Initialize the snmp variables and counters inside the struct netif.
-     * The last argument should be replaced with your link speed, in units
-     * of bits per second.
-     */
-    netif->state = ethernetif;
-    netif->name[0] = IFNAME;
-    netif->name[1] = IFNAME1;
-
-    /* We directly use etharp_output() here to save a function call.
-     * You can instead declare your own function an call etharp_output()
-     * from it if you have to do some checks before sending (e.g. if link
-     * is available...) */
-    netif->output = etharp_output;
-    netif->linkoutput = low_level_output1;
-
-    ethernetif->ethaddr = (struct eth_addr *)&(netif->hwaddr[0]);
-
-    /* initialize the hardware */
-    low_level_init1(netif);
-
-    xTaskCreate(emac1_lwip_rx,
-            "emac1-lwip-rx",
-            EMAC_LWIP_RX_STACKSIZE,
-            NULL,
-            EMAC_LWIP_RX_PRIORITY,
-            &post_rx_task[EMACINTF1]);
-
-    return ERR_OK;
+    return ethernetif_init_intf(netif, EMACINTF1);
 }
@@ -22,6 +22,8 @@ u8 mac_addr1[6] = DEFAULT_MAC1_ADDRESS;
 
 static u32 EMAC_Power_down; // This global variable is used to indicate the ISR whether the interrupts occured in the process of powering down the mac or not
 
+static u32 EMAC_int_enable[EMAC_CNT] = {DMA_INT_ENABLE, DMA_INT_ENABLE}; // DMA interrupts re-enabled on ISR exit, rx is left out while the rx task polls
+
 /**
  * @brief This sets up the transmit Descriptor queue in ring or chain mode.
  * This function is tightly coupled to the platform and operating system
@@ -237,6 +239,9 @@ s32 EMAC_open(int intf, int mode)
     EMAC_setup_rx_desc_queue(emacdev, RECEIVE_DESC_SIZE, RINGMODE);
     EMAC_init_rx_desc_base(emacdev);	//Program the transmit descriptor base address in to DmaTxBase addr
 
+    emacdev->RxIntWdt = EMAC_RX_INT_WDT;
+    EMAC_DMA_RX_INT_WDT(emacdev, EMAC_RX_INT_WDT);	//Coalesce rx interrupts if enabled
+
     EMAC_DMA_BUSMODE_INIT(emacdev, DmaBurstLength32 | DmaDescriptorSkip0 | EMAC_DmaBusMode_ATDS_Msk); //pbl32 incr with rxthreshold 128 and Desc is 8 Words
     EMAC_DMA_OPMODE_INIT(emacdev, EMAC_DmaOpMode_TSF_Msk | EMAC_DmaOpMode_OSF_Msk | DmaRxThreshCtrl128);
 
@@ -255,7 +260,8 @@ s32 EMAC_open(int intf, int mode)
     }
 
     EMAC_clear_interrupt(emacdev);
-    EMAC_enable_interrupt(emacdev, DMA_INT_ENABLE);
+    EMAC_int_enable[intf] = DMA_INT_ENABLE;
+    EMAC_enable_interrupt(emacdev, EMAC_int_enable[intf]);
 
     EMAC_DMA_RX_ENABLE(emacdev);
     EMAC_DMA_TX_ENABLE(emacdev);
@@ -393,18 +399,52 @@ s32 EMAC_xmit_frames(struct sk_buff *skb, int intf, u32 offload_needed, u32 ts)
     return 0;
 }
 
+/**
+ * @brief Function to transmit a frame scattered over several buffers.
+ * Each buffer is mapped onto its own tx descriptor, the buffers must stay untouched until
+ * EMAC_handle_transmit_over() reports the descriptor of the last segment as completed.
+ * @param[in] intf EMAC interface
+ *          - \ref EMACINTF0
+ *          - \ref EMACINTF1
+ * @param[in] count number of segments.
+ * @param[in] len array of segment lengths.
+ * @param[in] dma_addr array of Dma-able segment addresses.
+ * @param[in] offload_type checksum insertion type, one of eDescTxCis*
+ * @param[in] ts whether enable timestamp
+ * @return Returns tx descriptor index of the last segment on success and negative value if the ring is full.
+ */
+s32 EMAC_xmit_frames_sg(int intf, u32 count, u32 *len, u32 *dma_addr, u32 offload_type, u32 ts)
+{
+    s32 desc_index;
+    EMACdevice *emacdev = &EMACdev[intf];
+
+    desc_index = EMAC_set_tx_qptr_sg(emacdev, count, len, dma_addr, offload_type, ts);
+    if(desc_index < 0) {
+        TR("%s No More Free Tx Descriptors\n",__FUNCTION__);
+        return -1;
+    }
+
+    /*Now force the DMA to start transmission*/
+    EMAC_DMA_TX_PD_RESUME(emacdev);
+
+    return desc_index;
+}
+
 /**
  * @brief Function to handle housekeeping after a packet is transmitted over the wire.
  * After the transmission of a packet DMA generates corresponding interrupt
- * (if it is enabled). It takes care of returning the sk_buff to the linux
- * kernel, updating the networking statistics and tracking the descriptors.
+ * (if it is enabled) and the ISR calls notify_tx_reclaim(). This function then
+ * reclaims the completed descriptors, updates the networking statistics and
+ * reports every completed descriptor through tx_done so the caller can release
+ * the buffers attached to it.
  * @param[in] intf EMAC interface
  *          - \ref EMACINTF0
  *          - \ref EMACINTF1
+ * @param[in] tx_done callback invoked with each completed descriptor index, can be NULL.
  * @return None.
- * @note This function runs in interrupt context.
+ * @note This function runs in task context and must be serialized with the transmit path.
  */
-void EMAC_handle_transmit_over(int intf)
+void EMAC_handle_transmit_over(int intf, void (*tx_done)(int intf, s32 desc_index))
 {
     EMACdevice *emacdev;
     s32 desc_index;
@@ -419,7 +459,7 @@ void EMAC_handle_transmit_over(int intf)
 
     /*Handle the transmit Descriptors*/
     do {
-        desc_index = EMAC_get_tx_qptr(emacdev, &status, &length, &buffer1, &buffer2, &ext_status, &time_stamp_high, &time_stamp_low);
+        desc_index = EMAC_get_tx_qptr(emacdev, &status, &length, &buffer1, &buffer2, &ext_status, &time_stamp_low, &time_stamp_high);
         //EMAC_TS_read_timestamp_higher_val(emacdev, &time_stamp_higher);
 
         if(desc_index >= 0 /*&& data1 != 0*/) {
@@ -450,6 +490,9 @@ void EMAC_handle_transmit_over(int intf)
                 emacdev->NetStats.tx_aborted_errors += EMAC_is_tx_aborted(status);
                 emacdev->NetStats.tx_carrier_errors += EMAC_is_tx_carrier_error(status);
             }
+
+            if(tx_done)
+                tx_done(intf, desc_index);
         }
         emacdev->NetStats.collisions += EMAC_get_tx_collision_count(status);
     } while(desc_index >= 0);
@@ -466,10 +509,17 @@ void EMAC_handle_transmit_over(int intf)
  * @param[in] intf EMAC interface
  *          - \ref EMACINTF0
  *          - \ref EMACINTF1
- * @return None.
- * @note This function runs in interrupt context.
+ * @param[out] prskb array of sk_buff to hold the received frames.
+ * @param[in] budget maximum number of frames to take from the ring, size of prskb.
+ * @return Number of frames stored in prskb. Equal to budget if more frames may be pending.
+ * @note The descriptors are detached from the ring, each returned buffer must be given back
+ *       with EMAC_recycle_rx_buf() once the upper layer is done with it.
+ *       Frames the hardware flagged as bad (descriptor error or checksum offload error) are
+ *       returned with rdy cleared, they must not be passed up but their buffer still needs recycling.
+ *       The caller keeps this function and EMAC_recycle_rx_buf() of the same interface apart,
+ *       both work on the rx ring.
  */
-uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb)
+uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb, uint32_t budget)
 {
     EMACdevice *emacdev;
     s32 desc_index;
@@ -491,7 +541,10 @@ uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb)
 
     /*Handle the Receive Descriptors*/
     do {
-        desc_index = EMAC_get_rx_qptr(emacdev, &status, NULL, &dma_addr1, NULL, &ext_status, &time_stamp_high, &time_stamp_low);
+        if(ret >= budget)
+            break;
+
+        desc_index = EMAC_detach_rx_qptr(emacdev, &status, NULL, &dma_addr1, NULL, &ext_status, &time_stamp_high, &time_stamp_low);
         if(desc_index > 0) {
             TR("S:%08x ES:%08x DA1:%08x TSH:%08x TSL:%08x\n",status,ext_status,dma_addr1,time_stamp_high,time_stamp_low);
         }
@@ -562,14 +615,17 @@ uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb)
                     }
                 }
 
-                rb->rdy = 1;
-                rb->len = len;
-                rb->pData = (void *)((u64)dma_addr1 | NON_CACHE);
-                ret++;
-                rb = (struct sk_buff *)rb + 1;
-
-                emacdev->NetStats.rx_packets++;
-                emacdev->NetStats.rx_bytes += len;
+                /* Let the caller drop frames failing the MAC or checksum offload checks */
+                if(!EMAC_is_desc_valid(status) ||
+                   (EMAC_is_ext_status(emacdev, status) && (EMAC_ES_is_IP_header_error(ext_status) || EMAC_ES_is_IP_payload_error(ext_status)))) {
+                    emacdev->NetStats.rx_errors++;
+                    emacdev->NetStats.rx_dropped++;
+                    emacdev->NetStats.rx_crc_errors    += EMAC_is_rx_crc(status);
+                    emacdev->NetStats.rx_length_errors += EMAC_is_rx_frame_length_errors(status);
+                    rb->rdy = 0;
+                } else {
+                    rb->rdy = 1;
+                }
                 if(EMAC_is_timestamp_available(status)) {
                     emacdev->rx_sec = time_stamp_high;
                     emacdev->rx_subsec = time_stamp_low;
@@ -577,6 +633,15 @@ uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb)
                     emacdev->rx_sec = 0;
                     emacdev->rx_subsec = 0;
                 }
+                rb->len = len;
+                rb->pData = (void *)((u64)dma_addr1 | NON_CACHE);
+                rb->ts_sec = emacdev->rx_sec;
+                rb->ts_subsec = emacdev->rx_subsec;
+                ret++;
+                rb = (struct sk_buff *)rb + 1;
+
+                emacdev->NetStats.rx_packets++;
+                emacdev->NetStats.rx_bytes += len;
             } else {
                 /*Now the present skb should be set free*/
                 TR("s: %08x\n",status);
@@ -593,6 +658,154 @@ uint32_t EMAC_handle_received_data(int intf, struct sk_buff *prskb)
     return ret;
 }
 
+/**
+ * @brief Check whether a received frame is waiting in the rx descriptor ring.
+ * @param[in] intf EMAC interface
+ *          - \ref EMACINTF0
+ *          - \ref EMACINTF1
+ * @return true if EMAC_handle_received_data() would return at least one frame.
+ */
+bool EMAC_rx_pending(int intf)
+{
+    EMACdevice *emacdev = &EMACdev[intf];
+#ifdef CACHE_ON
+    DmaDesc *rxdesc = (DmaDesc *)((uint64_t)(emacdev->RxBusyDesc) | NON_CACHE);
+#else
+    DmaDesc *rxdesc = emacdev->RxBusyDesc;
+#endif
+
+    return !EMAC_is_desc_owned_by_dma(rxdesc) && !EMAC_is_desc_empty(emacdev, rxdesc);
+}
+
+/**
+ * @brief Unmask the rx interrupt masked by the ISR when it handed the ring to the rx task.
+ * @param[in] intf EMAC interface
+ *          - \ref EMACINTF0
+ *          - \ref EMACINTF1
+ * @return None.
+ * @note Caller must keep the EMAC interrupt from preempting this function, i.e. run on
+ *       the core the interrupt is routed to with interrupts masked.
+ */
+void EMAC_rx_int_enable(int intf)
+{
+    EMAC_int_enable[intf] |= EMAC_DmaInt_RIE_Msk;
+    EMAC_enable_interrupt(&EMACdev[intf], EMAC_int_enable[intf]);
+}
+
+/**
+ * @brief Give a receive buffer back to the rx descriptor ring.
+ * Counterpart of EMAC_handle_received_data(), the buffer is attached to the next empty
+ * descriptor and the DMA is kicked in case it was suspended for lack of descriptors.
+ * @param[in] intf EMAC interface
+ *          - \ref EMACINTF0
+ *          - \ref EMACINTF1
+ * @param[in] pData buffer returned in sk_buff pData by EMAC_handle_received_data().
+ * @return Returns rx descriptor index on success. Negative value if error.
+ */
+s32 EMAC_recycle_rx_buf(int intf, void *pData)
+{
+    EMACdevice *emacdev = &EMACdev[intf];
+    s32 desc_index;
+
+    desc_index = EMAC_set_rx_qptr(emacdev, (u32)((u64)pData & 0xFFFFFFFF), sizeof(((struct sk_buff *)0)->data));
+    if(desc_index >= 0)
+        EMAC_DMA_RX_PD_RESUME(emacdev);
+
+    return desc_index;
+}
+
+/**
+ * @brief Start the IEEE 1588 system time of an interface.
+ * The counter runs in fine update mode with digital rollover, i.e. the sub-second
+ * registers and descriptor timestamps are in nanoseconds. Only PTPv2 event messages
+ * over UDP/IPv4 addressed to a slave (Sync) are timestamped on receive, transmit
+ * timestamps are taken for the frames queued with ts set.
+ * @param[in] intf EMAC interface
+ *          - \ref EMACINTF0
+ *          - \ref EMACINTF1
+ * @return Nominal addend, the value that makes the system time run at the rate of EMAC_PTP_REF_CLK.
+ */
+u32 EMAC_ptp_init(int intf)
+{
+    EMACdevice *emacdev = &EMACdev[intf];
+    u32 ref_clk = EMAC_PTP_REF_CLK;
+    u32 ssinc, addend;
+
+    /* The accumulator can at most overflow every other reference clock, round the
+       increment up to whole nanoseconds and let the addend scale it back */
+    ssinc = (2000000000UL + ref_clk - 1) / ref_clk;
+    addend = (u32)((1000000000ULL << 32) / ((u64)ssinc * ref_clk));
+
+    EMAC_TS_DISABLE(emacdev);
+    EMAC_TS_INT_DISABLE(emacdev);
+    EMAC_TS_ENABLE(emacdev);
+
+    EMAC_TS_FINE_UPDATE(emacdev);
+    EMAC_TS_ROLLOVER_ENABLE(emacdev);
+    EMAC_TS_PTPV2(emacdev);
+    EMAC_TS_ALL_FRAME_DISABLE(emacdev);
+    EMAC_TS_ETHERNET_DISABLE(emacdev);
+    EMAC_TS_IPV6_DISABLE(emacdev);
+    EMAC_TS_IPV4_ENABLE(emacdev);
+    EMAC_TS_EVENT_ENABLE(emacdev);
+    EMAC_TS_PTP_FILTER_DISABLE(emacdev);
+    EMAC_TS_MASTER_DISABLE(emacdev);
+    EMAC_TS_set_clk_type(emacdev, EmacTSOrdClk);
+
+    EMAC_TS_subsecond_incr_init(emacdev, ssinc);
+    EMAC_TS_addend_update(emacdev, addend);
+    EMAC_TS_load_timestamp_higher_val(emacdev, 0);
+    EMAC_TS_timestamp_init(emacdev, 0, 0);
+
+    return addend;
+}
+
+/**
+ * @brief Read the IEEE 1588 system time of an interface.
+ * @param[in] intf EMAC interface
+ *          - \ref EMACINTF0
+ *          - \ref EMACINTF1
+ * @param[out] sec seconds
+ * @param[out] nsec nanoseconds
+ * @return None.
+ * @note The seconds are read again to catch a rollover between the two registers.
+ */
+void EMAC_ptp_get_time(int intf, u32 *sec, u32 *nsec)
+{
+    EMACdevice *emacdev = &EMACdev[intf];
+    u32 s;
+
+    do {
+        s = EMAC_READ((u64)&emacdev->MacBase->TSSec);
+        *nsec = EMAC_READ((u64)&emacdev->MacBase->TSNanosec);
+        *sec = EMAC_READ((u64)&emacdev->MacBase->TSSec);
+    } while(s != *sec);
+}
+
+/**
+ * @brief Step the IEEE 1588 system time of an interface.
+ * @param[in] intf EMAC interface
+ *          - \ref EMACINTF0
+ *          - \ref EMACINTF1
+ * @param[in] delta_ns nanoseconds to add, negative to move the time backwards
+ * @return Returns 0 on success, negative value if the update did not complete.
+ */
+s32 EMAC_ptp_step_time(int intf, s64 delta_ns)
+{
+    u64 mag = (delta_ns < 0) ? (u64)(-delta_ns) : (u64)delta_ns;
+    u32 nsec = (u32)(mag % 1000000000ULL);
+
+    if(delta_ns < 0) {
+        /* With the digital rollover of EMAC_ptp_init(), the nanoseconds to
+           subtract are written as 10^9 - nsec, the seconds as they are */
+        if(nsec != 0)
+            nsec = 1000000000U - nsec;
+        nsec |= EMAC_TSNanosecUpdate_ADDSUB_Msk;
+    }
+
+    return EMAC_TS_timestamp_update(&EMACdev[intf], (u32)(mag / 1000000000ULL), nsec);
+}
+
 /**
  * @brief Function to power up and resume EMAC IP if magic packet is determined.
  * @param[in] emacdev pointer to EMACdevice.
@@ -652,19 +865,19 @@ void EMAC_powerdown_mac(EMACdevice *emacdev)
 }
 
 /**
- * @brief Interrupt service routing for EMAC0.
- * This is the function registered as ISR for device interrupts.
- * @param[in] None
- * @return None
+ * @brief Interrupt service routing shared by EMAC0 and EMAC1.
+ * @param[in] intf EMAC interface which raised the interrupt
+ * @param[in] prskb Unused
+ * @return 0
  * @note This function runs in interrupt context
  */
-uint32_t EMAC_int_handler0(struct sk_buff *prskb)
+static uint32_t EMAC_int_handler(int intf, struct sk_buff *prskb)
 {
-    EMACdevice *emacdev = &EMACdev[EMACINTF0];
+    EMACdevice *emacdev = &EMACdev[intf];
     u32 interrupt, dma_status_reg, mac_status_reg;
     u32 dma_addr;
     u32 volatile reg;
-	uint32_t ret = 0;
+    uint32_t ret = 0;
 
     // Check EMAC interrupt
     mac_status_reg = EMAC_GET_INT_SUMMARY(emacdev);
@@ -739,7 +952,10 @@ uint32_t EMAC_int_handler0(struct sk_buff *prskb)
 
     if(interrupt & EMACDmaRxNormal) {
         TR("%s:: Rx Normal \n", __FUNCTION__);
-        notify_rx_task(EMACINTF0);
+#if (EMAC_RX_POLLING == 1)
+        EMAC_int_enable[intf] &= ~EMAC_DmaInt_RIE_Msk; // rx task polls the ring until it is empty
+#endif
+        notify_rx_task(intf);
     }
 
     if(interrupt & EMACDmaRxAbnormal) {
@@ -763,14 +979,14 @@ uint32_t EMAC_int_handler0(struct sk_buff *prskb)
     if(interrupt & EMACDmaTxNormal) {
         //xmit function has done its job
         TR("%s::Finished Normal Transmission \n",__FUNCTION__);
-        EMAC_handle_transmit_over(EMACINTF0);//Do whatever you want after the transmission is over
+        notify_tx_reclaim(intf);//Completed descriptors are reclaimed in task context
     }
 
     if(interrupt & EMACDmaTxAbnormal) {
         TR("%s::Abnormal Tx Interrupt Seen\n",__FUNCTION__);
 
         if(EMAC_Power_down == 0) {	// If Mac is not in powerdown
-            EMAC_handle_transmit_over(EMACINTF0);
+            notify_tx_reclaim(intf);
         }
     }
 
@@ -787,9 +1003,21 @@ uint32_t EMAC_int_handler0(struct sk_buff *prskb)
     }
 
     /* Enable the interrupt before returning from ISR*/
-    EMAC_enable_interrupt(emacdev, DMA_INT_ENABLE);
+    EMAC_enable_interrupt(emacdev, EMAC_int_enable[intf]);
 
-	return ret;
+    return ret;
+}
+
+/**
+ * @brief Interrupt service routing for EMAC0.
+ * This is the function registered as ISR for device interrupts.
+ * @param[in] None
+ * @return None
+ * @note This function runs in interrupt context
+ */
+uint32_t EMAC_int_handler0(struct sk_buff *prskb)
+{
+    return EMAC_int_handler(EMACINTF0, prskb);
 }
 
 /**
@@ -801,134 +1029,5 @@ uint32_t EMAC_int_handler0(struct sk_buff *prskb)
  */
 uint32_t EMAC_int_handler1(struct sk_buff *prskb)
 {
-    EMACdevice *emacdev = &EMACdev[EMACINTF1];
-    u32 interrupt, dma_status_reg, mac_status_reg;
-    u32 dma_addr;
-    u32 volatile reg;
-    uint32_t ret = 0;
-
-    // Check EMAC interrupt
-    mac_status_reg = EMAC_GET_INT_SUMMARY(emacdev);
-
-    /* handle ts status */
-    if(mac_status_reg & EMAC_IntStatus_TSIS_Msk) {
-        emacdev->NetStats.ts_int = 1;
-        reg = EMAC_GET_TS_STATUS(emacdev); // read to clear
-        if(!(reg & EMAC_TSStatus_TSTARGT_Msk))
-            TR("TS alarm flag not set??\n");
-        else
-            TR("TS alarm!!!!!!!!!!!!!!!!\n");
-    }
-
-    /* handle lpi status */
-    if(mac_status_reg & EMAC_IntStatus_LPIIS_Msk) {
-        reg = EMAC_GET_LPI_STATUS(emacdev); // read to clear
-    }
-
-    /* handle rgmii status */
-    if(mac_status_reg & EMAC_IntStatus_RGSMIIIS_Msk) {
-        reg = EMAC_GET_RGMII_STATUS(emacdev); // read to clear
-    }
-
-    EMAC_CLR_INT_SUMMARY(emacdev, mac_status_reg);
-
-    /*Read the Dma interrupt status to know whether the interrupt got generated by our device or not*/
-    dma_status_reg = EMAC_GET_DMA_STATUS(emacdev);
-
-    if(dma_status_reg == 0)
-        return ret;
-
-    EMAC_disable_interrupt_all(emacdev);
-
-    TR("%s:Dma Status Reg: 0x%08x\n",__FUNCTION__,dma_status_reg);
-
-    if(dma_status_reg & EMAC_DmaStatus_GPI_Msk) {
-        TR("%s:: Interrupt due to PMT module\n",__FUNCTION__);
-        EMAC_powerup_mac(emacdev);
-    }
-
-    if(dma_status_reg & EMAC_DmaStatus_GLI_Msk) {
-        TR("%s:: Interrupt due to EMAC LINE module\n",__FUNCTION__);
-    }
-
-    /*Now lets handle the DMA interrupts*/
-    interrupt = EMAC_get_interrupt_type(emacdev);
-    TR("%s:Interrupts to be handled: 0x%08x\n",__FUNCTION__,interrupt);
-
-    if(interrupt & EMACDmaError) {
-        TR("%s::Fatal Bus Error Inetrrupt Seen\n",__FUNCTION__);
-        EMAC_DMA_TX_DISABLE(emacdev);
-        EMAC_DMA_RX_DISABLE(emacdev);
-
-        EMAC_take_desc_ownership_tx(emacdev);
-        EMAC_take_desc_ownership_rx(emacdev);
-
-        EMAC_init_tx_rx_desc_queue(emacdev);
-
-        EMAC_reset(emacdev); //reset the DMA engine and the EMAC ip
-
-        EMAC_set_mac_addr(emacdev, 0, emacdev->Intf == 0 ? mac_addr0 : mac_addr1);
-        EMAC_DMA_BUSMODE_INIT(emacdev, EMAC_DmaBusMode_FB_Msk | DmaBurstLength8 | DmaDescriptorSkip0);
-        EMAC_DMA_OPMODE_INIT(emacdev, EMAC_DmaOpMode_TSF_Msk);
-
-        EMAC_init_rx_desc_base(emacdev);
-        EMAC_init_tx_desc_base(emacdev);
-        EMAC_init(emacdev);
-        EMAC_DMA_RX_ENABLE(emacdev);
-        EMAC_DMA_TX_ENABLE(emacdev);
-    }
-
-    if(interrupt & EMACDmaRxNormal) {
-        TR("%s:: Rx Normal \n", __FUNCTION__);
-        notify_rx_task(EMACINTF1);
-    }
-
-    if(interrupt & EMACDmaRxAbnormal) {
-        TR("%s::Abnormal Rx Interrupt Seen\n",__FUNCTION__);
-        emacdev->NetStats.rx_over_errors++;
-
-        if(EMAC_Power_down == 0) {	// If Mac is not in powerdown
-            EMAC_DMA_RX_PD_RESUME(emacdev);//To handle GBPS with 12 descriptors
-        }
-    }
-
-    if(interrupt & EMACDmaRxStopped) {
-        TR("%s::Receiver stopped seeing Rx interrupts\n",__FUNCTION__); //Receiver gone in to stopped state
-
-        if(EMAC_Power_down == 0) {	// If Mac is not in powerdown
-            emacdev->NetStats.rx_over_errors++;
-            EMAC_DMA_RX_ENABLE(emacdev);
-        }
-    }
-
-    if(interrupt & EMACDmaTxNormal) {
-        //xmit function has done its job
-        TR("%s::Finished Normal Transmission \n",__FUNCTION__);
-        EMAC_handle_transmit_over(EMACINTF1);//Do whatever you want after the transmission is over
-    }
-
-    if(interrupt & EMACDmaTxAbnormal) {
-        TR("%s::Abnormal Tx Interrupt Seen\n",__FUNCTION__);
-
-        if(EMAC_Power_down == 0) {	// If Mac is not in powerdown
-            EMAC_handle_transmit_over(EMACINTF1);
-        }
-    }
-
-    if(interrupt & EMACDmaTxStopped) {
-        TR("%s::Transmitter stopped sending the packets\n",__FUNCTION__);
-
-        if(EMAC_Power_down == 0) {	// If Mac is not in powerdown
-            EMAC_DMA_TX_DISABLE(emacdev);
-            EMAC_take_desc_ownership_tx(emacdev);
-
-            EMAC_DMA_TX_ENABLE(emacdev);
-            TR("%s::Transmission Resumed\n",__FUNCTION__);
-        }
-    }
-
-    /* Enable the interrupt before returning from ISR*/
-    EMAC_enable_interrupt(emacdev, DMA_INT_ENABLE);
-
-    return ret;
+    return EMAC_int_handler(EMACINTF1, prskb);
 }
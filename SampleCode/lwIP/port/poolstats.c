@@ -0,0 +1,83 @@
+/**************************************************************************//**
+ * @file     poolstats.c
+ * @brief    lwIP memory pool statistics
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+#include "lwip/priv/memp_priv.h"
+#include "poolstats.h"
+
+#if MEM_USE_POOLS && MEMP_USE_CUSTOM_POOLS && !MEMP_OVERFLOW_CHECK
+/* Each heap block of lwippools.h with its mem_malloc() header must take
+   whole 64-byte cache lines, as memp lays the blocks out */
+#define LWIP_MALLOC_MEMPOOL_START
+#define LWIP_MALLOC_MEMPOOL(num, size) \
+    typedef char poolstats_line_check_##size[((MEMP_SIZE + \
+        MEMP_ALIGN_SIZE(size + LWIP_MEM_ALIGN_SIZE(sizeof(struct memp_malloc_helper)))) % 64 == 0) ? 1 : -1];
+#define LWIP_MALLOC_MEMPOOL_END
+#include "lwippools.h"
+#undef LWIP_MALLOC_MEMPOOL_START
+#undef LWIP_MALLOC_MEMPOOL
+#undef LWIP_MALLOC_MEMPOOL_END
+#endif
+
+#if LWIP_STATS && MEMP_STATS
+
+/**
+ * Takes a consistent snapshot of the usage of one memp.
+ *
+ * @param idx memp index, 0 to MEMP_MAX - 1
+ * @param entry filled with the pool usage
+ * @return 0 on success, -1 if idx is out of range
+ */
+int poolstats_get(int idx, struct poolstats_entry *entry)
+{
+    struct stats_mem *mem;
+    SYS_ARCH_DECL_PROTECT(old_level);
+
+    if ((idx < 0) || (idx >= MEMP_MAX))
+        return -1;
+
+    mem = lwip_stats.memp[idx];
+
+    SYS_ARCH_PROTECT(old_level);
+#if defined(LWIP_DEBUG) || LWIP_STATS_DISPLAY
+    entry->name = mem->name;
+#else
+    entry->name = NULL;
+#endif
+    entry->avail = mem->avail;
+    entry->used = mem->used;
+    entry->max = mem->max;
+    entry->err = mem->err;
+    SYS_ARCH_UNPROTECT(old_level);
+
+    return 0;
+}
+
+/**
+ * Prints one line per memp on the console, pools that ever failed an
+ * allocation or ran full are marked.
+ */
+void poolstats_display(void)
+{
+    struct poolstats_entry entry;
+    int i;
+
+    LWIP_PLATFORM_DIAG(("\n%-16s %6s %6s %6s %6s\n", "pool", "avail", "used", "max", "err"));
+    for (i = 0; i < MEMP_MAX; i++)
+    {
+        poolstats_get(i, &entry);
+        LWIP_PLATFORM_DIAG(("%-16s %6u %6u %6u %6u%s\n",
+                            entry.name ? entry.name : "?",
+                            (unsigned)entry.avail, (unsigned)entry.used,
+                            (unsigned)entry.max, (unsigned)entry.err,
+                            (entry.err || (entry.max == entry.avail)) ? "  <--" : ""));
+    }
+}
+
+#endif /* LWIP_STATS && MEMP_STATS */
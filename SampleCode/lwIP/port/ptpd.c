@@ -0,0 +1,668 @@
+/**************************************************************************//**
+ * @file     ptpd.c
+ * @brief    IEEE 1588 PTP ordinary clock on the EMAC timestamp unit
+ *
+ * Slave-only ordinary clock, end-to-end delay mechanism, PTPv2 over UDP/IPv4.
+ * Everything runs in the lwIP core context (tcpip thread or core lock held):
+ * the UDP receive callbacks and the lwIP timeouts driving Delay_Req and the
+ * Announce receipt timeout.
+ *
+ *   t1  Sync origin time (from Follow_Up for two-step masters)
+ *   t2  Sync rx timestamp, taken by the EMAC
+ *   t3  Delay_Req tx timestamp, taken by the EMAC
+ *   t4  Delay_Req receive time, reported in Delay_Resp
+ *
+ *   mean path delay = ((t2 - t1) + (t4 - t3)) / 2
+ *   offset          = (t2 - t1) - mean path delay
+ *
+ * The best master clock algorithm is reduced to comparing the Announce data
+ * sets, foreign master qualification is not done.
+ *
+ * @copyright (C) 2023 Nuvoton Technology Corp. All rights reserved.
+ ******************************************************************************/
+
+#include "lwip/opt.h"
+
+#include "ptpd.h"
+
+#if LWIP_PTP /* don't build if not configured for use in lwipopts.h */
+
+#if !LWIP_UDP || !LWIP_IGMP
+#error "PTP needs LWIP_UDP and LWIP_IGMP"
+#endif
+
+#if MEMP_NUM_SYS_TIMEOUT < (LWIP_NUM_SYS_TIMEOUT_INTERNAL + PTPD_NUM_TIMEOUTS)
+#error "PTP needs PTPD_NUM_TIMEOUTS more in MEMP_NUM_SYS_TIMEOUT"
+#endif
+
+#include "lwip/def.h"
+#include "lwip/udp.h"
+#include "lwip/igmp.h"
+#include "lwip/tcpip.h"
+#include "lwip/timeouts.h"
+#include "netif/ethernetif.h"
+#include "string.h"
+
+#ifndef PTPD_DEBUG
+#define PTPD_DEBUG                  LWIP_DBG_OFF
+#endif
+
+#define PTP_VERSION                 2
+#define PTP_PORT_ID_LEN             10
+#define PTP_CLOCK_ID_LEN            8
+
+/* message lengths */
+#define PTP_HEADER_LEN              34
+#define PTP_SYNC_LEN                44
+#define PTP_DELAY_REQ_LEN           44
+#define PTP_FOLLOW_UP_LEN           44
+#define PTP_DELAY_RESP_LEN          54
+#define PTP_ANNOUNCE_LEN            64
+
+/* header field offsets */
+#define PTP_OFS_TYPE                0
+#define PTP_OFS_VERSION             1
+#define PTP_OFS_LENGTH              2
+#define PTP_OFS_DOMAIN              4
+#define PTP_OFS_FLAGS               6
+#define PTP_OFS_CORRECTION          8
+#define PTP_OFS_SOURCE_PORT         20
+#define PTP_OFS_SEQUENCE            30
+#define PTP_OFS_CONTROL             32
+#define PTP_OFS_LOG_INTERVAL        33
+#define PTP_OFS_TIMESTAMP           34
+
+/* Delay_Resp body */
+#define PTP_OFS_REQUESTING_PORT     44
+
+/* Announce body */
+#define PTP_OFS_GM_PRIORITY1        47
+#define PTP_OFS_GM_CLASS            48
+#define PTP_OFS_GM_ACCURACY         49
+#define PTP_OFS_GM_VARIANCE         50
+#define PTP_OFS_GM_PRIORITY2        52
+#define PTP_OFS_GM_IDENTITY         53
+#define PTP_OFS_STEPS_REMOVED       61
+
+#define PTP_FLAG_TWO_STEP           0x02    /* in the first flag octet */
+#define PTP_CONTROL_DELAY_REQ       1
+#define PTP_LOG_INTERVAL_NONE       0x7F
+
+#define PTP_ANNOUNCE_RECEIPT_TIMEOUT    3
+#define NS_PER_SEC                  1000000000LL
+
+/* Announce data set of the master followed */
+struct ptpd_master
+{
+    u8_t port_id[PTP_PORT_ID_LEN];
+    u8_t gm_priority1;
+    u8_t gm_class;
+    u8_t gm_accuracy;
+    u16_t gm_variance;
+    u8_t gm_priority2;
+    u8_t gm_id[PTP_CLOCK_ID_LEN];
+    u16_t steps_removed;
+    s8_t log_announce_interval;
+};
+
+struct ptpd_port
+{
+    struct netif *netif;
+    int intf;
+    struct udp_pcb *event_pcb;
+    struct udp_pcb *general_pcb;
+    u8_t port_id[PTP_PORT_ID_LEN];
+    enum ptpd_state state;
+    struct ptpd_master master;
+
+    /* two-step Sync waiting for its Follow_Up */
+    int sync_pending;
+    u16_t sync_seq;
+    s64 sync_t2;
+    s64 sync_correction;
+
+    /* t2 - t1 of the last Sync */
+    int ms_valid;
+    s64 ms_diff;
+
+    /* Delay_Req waiting for its Delay_Resp */
+    int delay_req_pending;
+    u16_t delay_req_seq;
+    s8_t log_delay_req_interval;
+
+    int mpd_valid;
+    s64 mean_path_delay;
+
+    /* servo */
+    u32_t nominal_addend;
+    s64 drift_ppb;
+    s32_t freq_adj_ppb;
+    s64 offset;
+
+    u32_t syncs;
+    u32_t steps;
+};
+
+static struct ptpd_port ptpd;
+static ip_addr_t ptp_mcast_addr;
+
+static void ptpd_delay_req_timer(void *arg);
+static void ptpd_announce_timeout(void *arg);
+
+static u16_t ptpd_get16(const u8_t *b)
+{
+    return (u16_t)((b[0] << 8) | b[1]);
+}
+
+static void ptpd_put16(u8_t *b, u16_t v)
+{
+    b[0] = (u8_t)(v >> 8);
+    b[1] = (u8_t)v;
+}
+
+/* correctionField is in nanoseconds scaled by 2^16 */
+static s64 ptpd_get_correction(const u8_t *msg)
+{
+    u64 v = 0;
+    int i;
+
+    for (i = 0; i < 8; i++)
+        v = (v << 8) | msg[PTP_OFS_CORRECTION + i];
+
+    return ((s64)v) >> 16;
+}
+
+/* 48 bit seconds and 32 bit nanoseconds */
+static s64 ptpd_get_timestamp(const u8_t *b)
+{
+    u64 sec = 0;
+    u32_t nsec = 0;
+    int i;
+
+    for (i = 0; i < 6; i++)
+        sec = (sec << 8) | b[i];
+    for (i = 6; i < 10; i++)
+        nsec = (nsec << 8) | b[i];
+
+    return (s64)sec * NS_PER_SEC + nsec;
+}
+
+static void ptpd_put_timestamp(u8_t *b, u64 sec, u32_t nsec)
+{
+    int i;
+
+    for (i = 5; i >= 0; i--, sec >>= 8)
+        b[i] = (u8_t)sec;
+    for (i = 9; i >= 6; i--, nsec >>= 8)
+        b[i] = (u8_t)nsec;
+}
+
+static s64 ptpd_hw_ns(const struct ethernetif_timestamp *ts)
+{
+    return (s64)ts->sec * NS_PER_SEC + ts->nsec;
+}
+
+/* log2 of a message interval in seconds to milliseconds */
+static u32_t ptpd_interval_ms(s8_t log_interval)
+{
+    if (log_interval < -7)
+        log_interval = -7;
+    if (log_interval > 6)
+        log_interval = 6;
+
+    return (log_interval < 0) ? (1000 >> -log_interval) : (1000 << log_interval);
+}
+
+static int ptpd_from_master(const u8_t *msg)
+{
+    return memcmp(&msg[PTP_OFS_SOURCE_PORT], ptpd.master.port_id, PTP_PORT_ID_LEN) == 0;
+}
+
+/**
+ * Compares two Announce data sets the way the data set comparison algorithm
+ * of IEEE 1588-2008 9.3.4 does, lower values are better at every step.
+ *
+ * @return 1 if a describes a better master than b
+ */
+static int ptpd_master_better(const struct ptpd_master *a, const struct ptpd_master *b)
+{
+    int cmp;
+
+    if (memcmp(a->gm_id, b->gm_id, PTP_CLOCK_ID_LEN) == 0)
+    {
+        /* same grandmaster seen through different paths */
+        if (a->steps_removed != b->steps_removed)
+            return a->steps_removed < b->steps_removed;
+        return memcmp(a->port_id, b->port_id, PTP_PORT_ID_LEN) < 0;
+    }
+
+    if (a->gm_priority1 != b->gm_priority1)
+        return a->gm_priority1 < b->gm_priority1;
+    if (a->gm_class != b->gm_class)
+        return a->gm_class < b->gm_class;
+    if (a->gm_accuracy != b->gm_accuracy)
+        return a->gm_accuracy < b->gm_accuracy;
+    if (a->gm_variance != b->gm_variance)
+        return a->gm_variance < b->gm_variance;
+    if (a->gm_priority2 != b->gm_priority2)
+        return a->gm_priority2 < b->gm_priority2;
+
+    cmp = memcmp(a->gm_id, b->gm_id, PTP_CLOCK_ID_LEN);
+    return cmp < 0;
+}
+
+/* Forget measurements taken against the old time base */
+static void ptpd_reset_measurements(void)
+{
+    ptpd.sync_pending = 0;
+    ptpd.ms_valid = 0;
+    ptpd.delay_req_pending = 0;
+}
+
+static void ptpd_step_clock(s64 delta_ns)
+{
+    LWIP_DEBUGF(PTPD_DEBUG, ("ptpd: step %lld ns\n", (long long)delta_ns));
+
+    EMAC_ptp_step_time(ptpd.intf, delta_ns);
+    ptpd.steps++;
+    ptpd_reset_measurements();
+}
+
+static void ptpd_set_freq(s32_t ppb)
+{
+    s64 addend = (s64)ptpd.nominal_addend + ((s64)ptpd.nominal_addend * ppb) / NS_PER_SEC;
+
+    ptpd.freq_adj_ppb = ppb;
+    EMAC_TS_addend_update(&EMACdev[ptpd.intf], (u32)addend);
+}
+
+static s64 ptpd_clamp(s64 v, s64 limit)
+{
+    if (v > limit)
+        return limit;
+    if (v < -limit)
+        return -limit;
+    return v;
+}
+
+/**
+ * PI servo. Offsets beyond PTPD_STEP_THRESHOLD_NS step the clock, otherwise
+ * the rate is trimmed through the addend register.
+ *
+ * @param offset slave time minus master time [ns]
+ */
+static void ptpd_servo(s64 offset)
+{
+    s64 ppb;
+
+    ptpd.offset = offset;
+    ptpd.syncs++;
+
+    if ((offset > PTPD_STEP_THRESHOLD_NS) || (offset < -PTPD_STEP_THRESHOLD_NS))
+    {
+        ptpd_step_clock(-offset);
+        ptpd.state = PTPD_UNCALIBRATED;
+        return;
+    }
+
+    ptpd.drift_ppb = ptpd_clamp(ptpd.drift_ppb + (PTPD_SERVO_KI * offset) / 1000, PTPD_SERVO_MAX_PPB);
+    ppb = ptpd_clamp((PTPD_SERVO_KP * offset) / 1000 + ptpd.drift_ppb, PTPD_SERVO_MAX_PPB);
+
+    /* running ahead means running fast, slow down */
+    ptpd_set_freq((s32_t)-ppb);
+
+    if ((offset < PTPD_LOCK_THRESHOLD_NS) && (offset > -PTPD_LOCK_THRESHOLD_NS))
+        ptpd.state = PTPD_SLAVE;
+    else
+        ptpd.state = PTPD_UNCALIBRATED;
+}
+
+static void ptpd_sync_sample(s64 t1, s64 t2)
+{
+    ptpd.ms_diff = t2 - t1;
+    ptpd.ms_valid = 1;
+
+    if (!ptpd.mpd_valid)
+    {
+        /* Bring the clock close to the master before the first delay measurement */
+        if ((ptpd.ms_diff > PTPD_STEP_THRESHOLD_NS) || (ptpd.ms_diff < -PTPD_STEP_THRESHOLD_NS))
+            ptpd_step_clock(-ptpd.ms_diff);
+        return;
+    }
+
+    ptpd_servo(ptpd.ms_diff - ptpd.mean_path_delay);
+}
+
+static void ptpd_select_master(const struct ptpd_master *m)
+{
+    LWIP_DEBUGF(PTPD_DEBUG, ("ptpd: new master %02x%02x%02x%02x%02x%02x%02x%02x\n",
+                             m->gm_id[0], m->gm_id[1], m->gm_id[2], m->gm_id[3],
+                             m->gm_id[4], m->gm_id[5], m->gm_id[6], m->gm_id[7]));
+
+    ptpd.master = *m;
+    ptpd.state = PTPD_UNCALIBRATED;
+    ptpd.mpd_valid = 0;
+    ptpd.log_delay_req_interval = 0;
+    ptpd_reset_measurements();
+
+    sys_untimeout(ptpd_delay_req_timer, NULL);
+    sys_timeout(ptpd_interval_ms(ptpd.log_delay_req_interval), ptpd_delay_req_timer, NULL);
+}
+
+static void ptpd_handle_announce(const u8_t *msg)
+{
+    struct ptpd_master m;
+
+    memcpy(m.port_id, &msg[PTP_OFS_SOURCE_PORT], PTP_PORT_ID_LEN);
+    m.gm_priority1 = msg[PTP_OFS_GM_PRIORITY1];
+    m.gm_class = msg[PTP_OFS_GM_CLASS];
+    m.gm_accuracy = msg[PTP_OFS_GM_ACCURACY];
+    m.gm_variance = ptpd_get16(&msg[PTP_OFS_GM_VARIANCE]);
+    m.gm_priority2 = msg[PTP_OFS_GM_PRIORITY2];
+    memcpy(m.gm_id, &msg[PTP_OFS_GM_IDENTITY], PTP_CLOCK_ID_LEN);
+    m.steps_removed = ptpd_get16(&msg[PTP_OFS_STEPS_REMOVED]);
+    m.log_announce_interval = (s8_t)msg[PTP_OFS_LOG_INTERVAL];
+
+    if (m.steps_removed >= 255)
+        return;
+
+    if ((ptpd.state != PTPD_LISTENING) && ptpd_from_master(msg))
+        ptpd.master = m;
+    else if ((ptpd.state == PTPD_LISTENING) || ptpd_master_better(&m, &ptpd.master))
+        ptpd_select_master(&m);
+    else
+        return;
+
+    /* Announce receipt timeout of the master followed */
+    sys_untimeout(ptpd_announce_timeout, NULL);
+    sys_timeout(PTP_ANNOUNCE_RECEIPT_TIMEOUT * ptpd_interval_ms(ptpd.master.log_announce_interval), ptpd_announce_timeout, NULL);
+}
+
+static void ptpd_handle_sync(const u8_t *msg, const struct ethernetif_timestamp *ts)
+{
+    s64 t2;
+
+    if ((ptpd.state == PTPD_LISTENING) || !ptpd_from_master(msg) || (ts == NULL))
+        return;
+
+    t2 = ptpd_hw_ns(ts);
+
+    if (msg[PTP_OFS_FLAGS] & PTP_FLAG_TWO_STEP)
+    {
+        ptpd.sync_pending = 1;
+        ptpd.sync_seq = ptpd_get16(&msg[PTP_OFS_SEQUENCE]);
+        ptpd.sync_t2 = t2;
+        ptpd.sync_correction = ptpd_get_correction(msg);
+    }
+    else
+    {
+        ptpd_sync_sample(ptpd_get_timestamp(&msg[PTP_OFS_TIMESTAMP]) + ptpd_get_correction(msg), t2);
+    }
+}
+
+static void ptpd_handle_follow_up(const u8_t *msg)
+{
+    s64 t1;
+
+    if ((ptpd.state == PTPD_LISTENING) || !ptpd_from_master(msg) || !ptpd.sync_pending ||
+        (ptpd_get16(&msg[PTP_OFS_SEQUENCE]) != ptpd.sync_seq))
+        return;
+
+    ptpd.sync_pending = 0;
+    t1 = ptpd_get_timestamp(&msg[PTP_OFS_TIMESTAMP]) + ptpd.sync_correction + ptpd_get_correction(msg);
+    ptpd_sync_sample(t1, ptpd.sync_t2);
+}
+
+static void ptpd_handle_delay_resp(const u8_t *msg)
+{
+    struct ethernetif_timestamp ts;
+    s64 t3, t4, delay;
+
+    if ((ptpd.state == PTPD_LISTENING) || !ptpd_from_master(msg) || !ptpd.delay_req_pending ||
+        (ptpd_get16(&msg[PTP_OFS_SEQUENCE]) != ptpd.delay_req_seq) ||
+        (memcmp(&msg[PTP_OFS_REQUESTING_PORT], ptpd.port_id, PTP_PORT_ID_LEN) != 0))
+        return;
+
+    ptpd.delay_req_pending = 0;
+    ptpd.log_delay_req_interval = (s8_t)msg[PTP_OFS_LOG_INTERVAL];
+
+    if (ethernetif_get_tx_timestamp(ptpd.netif, &ts) != 0)
+    {
+        LWIP_DEBUGF(PTPD_DEBUG, ("ptpd: no tx timestamp for Delay_Req %u\n", ptpd.delay_req_seq));
+        return;
+    }
+
+    if (!ptpd.ms_valid)
+        return;
+
+    t3 = ptpd_hw_ns(&ts);
+    t4 = ptpd_get_timestamp(&msg[PTP_OFS_TIMESTAMP]) - ptpd_get_correction(msg);
+    delay = (ptpd.ms_diff + (t4 - t3)) / 2;
+    if (delay < 0)
+        return;
+
+    if (!ptpd.mpd_valid)
+    {
+        ptpd.mean_path_delay = delay;
+        ptpd.mpd_valid = 1;
+    }
+    else
+    {
+        ptpd.mean_path_delay += (delay - ptpd.mean_path_delay) / PTPD_DELAY_FILTER;
+    }
+}
+
+static void ptpd_recv(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+    u8_t msg[PTP_ANNOUNCE_LEN];
+    struct ethernetif_timestamp ts;
+    int has_ts;
+    u16_t len;
+
+    LWIP_UNUSED_ARG(arg);
+    LWIP_UNUSED_ARG(pcb);
+    LWIP_UNUSED_ARG(addr);
+    LWIP_UNUSED_ARG(port);
+
+    has_ts = (ethernetif_get_rx_timestamp(p, &ts) == 0);
+    len = pbuf_copy_partial(p, msg, sizeof(msg), 0);
+    pbuf_free(p);
+
+    if ((len < PTP_HEADER_LEN) || ((msg[PTP_OFS_VERSION] & 0x0F) != PTP_VERSION) ||
+        (msg[PTP_OFS_DOMAIN] != PTPD_DOMAIN) || (ptpd.state == PTPD_DISABLED))
+        return;
+
+    /* our own multicast coming back */
+    if (memcmp(&msg[PTP_OFS_SOURCE_PORT], ptpd.port_id, PTP_CLOCK_ID_LEN) == 0)
+        return;
+
+    switch (msg[PTP_OFS_TYPE] & 0x0F)
+    {
+    case SYNC:
+        if (len >= PTP_SYNC_LEN)
+            ptpd_handle_sync(msg, has_ts ? &ts : NULL);
+        break;
+    case Follow_up:
+        if (len >= PTP_FOLLOW_UP_LEN)
+            ptpd_handle_follow_up(msg);
+        break;
+    case Delay_Resp:
+        if (len >= PTP_DELAY_RESP_LEN)
+            ptpd_handle_delay_resp(msg);
+        break;
+    case Announce:
+        if (len >= PTP_ANNOUNCE_LEN)
+            ptpd_handle_announce(msg);
+        break;
+    default:
+        break;
+    }
+}
+
+static void ptpd_send_delay_req(void)
+{
+    struct pbuf *p;
+    u8_t *msg;
+    u32 sec, nsec;
+
+    p = pbuf_alloc(PBUF_TRANSPORT, PTP_DELAY_REQ_LEN, PBUF_RAM);
+    if (p == NULL)
+        return;
+
+    msg = (u8_t *)p->payload;
+    memset(msg, 0, PTP_DELAY_REQ_LEN);
+    msg[PTP_OFS_TYPE] = Delay_Req;
+    msg[PTP_OFS_VERSION] = PTP_VERSION;
+    ptpd_put16(&msg[PTP_OFS_LENGTH], PTP_DELAY_REQ_LEN);
+    msg[PTP_OFS_DOMAIN] = PTPD_DOMAIN;
+    memcpy(&msg[PTP_OFS_SOURCE_PORT], ptpd.port_id, PTP_PORT_ID_LEN);
+    ptpd_put16(&msg[PTP_OFS_SEQUENCE], ++ptpd.delay_req_seq);
+    msg[PTP_OFS_CONTROL] = PTP_CONTROL_DELAY_REQ;
+    msg[PTP_OFS_LOG_INTERVAL] = PTP_LOG_INTERVAL_NONE;
+
+    /* only a rough origin time, t3 is the hardware timestamp */
+    EMAC_ptp_get_time(ptpd.intf, &sec, &nsec);
+    ptpd_put_timestamp(&msg[PTP_OFS_TIMESTAMP], sec, nsec);
+
+    if (udp_sendto_if(ptpd.event_pcb, p, &ptp_mcast_addr, PTP_EVENT_PORT, ptpd.netif) == ERR_OK)
+        ptpd.delay_req_pending = 1;
+
+    pbuf_free(p);
+}
+
+static void ptpd_delay_req_timer(void *arg)
+{
+    LWIP_UNUSED_ARG(arg);
+
+    if (ptpd.state == PTPD_LISTENING)
+        return;
+
+    ptpd_send_delay_req();
+    sys_timeout(ptpd_interval_ms(ptpd.log_delay_req_interval), ptpd_delay_req_timer, NULL);
+}
+
+static void ptpd_announce_timeout(void *arg)
+{
+    LWIP_UNUSED_ARG(arg);
+
+    LWIP_DEBUGF(PTPD_DEBUG, ("ptpd: master lost\n"));
+
+    sys_untimeout(ptpd_delay_req_timer, NULL);
+    memset(&ptpd.master, 0, sizeof(ptpd.master));
+    ptpd.state = PTPD_LISTENING;
+    ptpd_reset_measurements();
+}
+
+static struct udp_pcb *ptpd_new_pcb(u16_t port)
+{
+    struct udp_pcb *pcb;
+
+    pcb = udp_new_ip_type(IPADDR_TYPE_V4);
+    if (pcb == NULL)
+        return NULL;
+
+    if (udp_bind(pcb, IP4_ADDR_ANY, port) != ERR_OK)
+    {
+        udp_remove(pcb);
+        return NULL;
+    }
+
+    /* PTP messages are not meant to leave the subnet */
+    pcb->ttl = 1;
+#if LWIP_MULTICAST_TX_OPTIONS
+    udp_set_multicast_ttl(pcb, 1);
+#endif
+    udp_recv(pcb, ptpd_recv, NULL);
+
+    return pcb;
+}
+
+static void ptpd_start(void *arg)
+{
+    struct netif *netif = (struct netif *)arg;
+    const u8_t *mac = netif->hwaddr;
+
+    ptpd.netif = netif;
+    ptpd.intf = ethernetif_get_intf(netif);
+
+    /* EUI-64 clock identity from the MAC address, port number 1 */
+    ptpd.port_id[0] = mac[0];
+    ptpd.port_id[1] = mac[1];
+    ptpd.port_id[2] = mac[2];
+    ptpd.port_id[3] = 0xFF;
+    ptpd.port_id[4] = 0xFE;
+    ptpd.port_id[5] = mac[3];
+    ptpd.port_id[6] = mac[4];
+    ptpd.port_id[7] = mac[5];
+    ptpd_put16(&ptpd.port_id[8], 1);
+
+    ptpd.nominal_addend = EMAC_ptp_init(ptpd.intf);
+
+    IP_ADDR4(&ptp_mcast_addr, 224, 0, 1, 129);
+
+    ptpd.event_pcb = ptpd_new_pcb(PTP_EVENT_PORT);
+    ptpd.general_pcb = ptpd_new_pcb(PTP_GENERAL_PORT);
+    if ((ptpd.event_pcb == NULL) || (ptpd.general_pcb == NULL) ||
+        (igmp_joingroup_netif(netif, ip_2_ip4(&ptp_mcast_addr)) != ERR_OK))
+    {
+        LWIP_DEBUGF(PTPD_DEBUG, ("ptpd: cannot open PTP ports\n"));
+        return;
+    }
+
+    ptpd.state = PTPD_LISTENING;
+}
+
+/**
+ * Starts the PTP slave on a netif set up by ethernetif_init0/1(). The EMAC
+ * system time is restarted from zero and follows the best master heard.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @return ERR_OK if the service could be scheduled to start in the tcpip thread
+ */
+err_t ptpd_init(struct netif *netif)
+{
+    LWIP_ASSERT("netif != NULL", (netif != NULL));
+
+    return tcpip_callback(ptpd_start, netif);
+}
+
+/**
+ * Reads the current PTP time from the EMAC system time counter.
+ * The resolution is the sub-second increment of the counter, a few tens of ns.
+ *
+ * @param t filled with the current time, zero before ptpd_init()
+ */
+void ptpd_get_time(struct ptpd_time *t)
+{
+    u32 sec, nsec;
+
+    if (ptpd.netif == NULL)
+    {
+        t->sec = 0;
+        t->nsec = 0;
+        return;
+    }
+
+    EMAC_ptp_get_time(ptpd.intf, &sec, &nsec);
+    t->sec = sec;
+    t->nsec = nsec;
+}
+
+/**
+ * Reads the synchronization state, e.g. to wait for PTPD_SLAVE before
+ * relying on ptpd_get_time().
+ *
+ * @param status filled with a snapshot of the servo state
+ */
+void ptpd_get_status(struct ptpd_status *status)
+{
+    status->state = ptpd.state;
+    memcpy(status->master_id, ptpd.master.gm_id, PTP_CLOCK_ID_LEN);
+    status->offset_ns = ptpd.offset;
+    status->mean_path_delay_ns = ptpd.mean_path_delay;
+    status->freq_adj_ppb = ptpd.freq_adj_ppb;
+    status->syncs = ptpd.syncs;
+    status->steps = ptpd.steps;
+}
+
+#endif /* LWIP_PTP */
@@ -44,13 +44,6 @@
 #define LWIP_FREERTOS_CHECK_QUEUE_EMPTY_ON_FREE       0
 #endif
 
-/** Set this to 1 to enable core locking check functions in this port.
- * For this to work, you'll have to define LWIP_ASSERT_CORE_LOCKED()
- * and LWIP_MARK_TCPIP_THREAD() correctly in your lwipopts.h! */
-#ifndef LWIP_FREERTOS_CHECK_CORE_LOCKING
-#define LWIP_FREERTOS_CHECK_CORE_LOCKING              0
-#endif
-
 /** Set this to 0 to implement sys_now() yourself, e.g. using a hw timer.
  * Default is 1, where FreeRTOS ticks are used to calculate back to ms.
  */
@@ -350,6 +343,24 @@ sys_mbox_free(sys_mbox_t *mbox)
 }
 /*-----------------------------------------------------------*/
 
+#if LWIP_CHKSUM_NEON
+/* Threads running the stack use the SIMD checksum and need an FPU context */
+struct sys_thread_start {
+    lwip_thread_fn thread;
+    void *arg;
+};
+
+static void
+sys_thread_fpu_entry(void *arg)
+{
+    struct sys_thread_start start = *(struct sys_thread_start *)arg;
+
+    vPortFree(arg);
+    portTASK_USES_FLOATING_POINT();
+    start.thread(start.arg);
+}
+#endif /* LWIP_CHKSUM_NEON */
+
 sys_thread_t
 sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize, int prio)
 {
@@ -365,9 +376,23 @@ sys_thread_new(const char *name, lwip_thread_fn thread, void *arg, int stacksize
     rtos_stacksize = (size_t)stacksize / sizeof(StackType_t);
 #endif
 
+#if LWIP_CHKSUM_NEON
+    {
+        struct sys_thread_start *start = pvPortMalloc(sizeof(struct sys_thread_start));
+        LWIP_ASSERT("task creation failed", start != NULL);
+
+        start->thread = thread;
+        start->arg = arg;
+        ret = xTaskCreate(sys_thread_fpu_entry, name, (configSTACK_DEPTH_TYPE)rtos_stacksize, start, prio, &rtos_task);
+        if (ret != pdTRUE) {
+            vPortFree(start);
+        }
+    }
+#else
     /* lwIP's lwip_thread_fn matches FreeRTOS' TaskFunction_t, so we can pass the
         thread function without adaption here. */
     ret = xTaskCreate(thread, name, (configSTACK_DEPTH_TYPE)rtos_stacksize, arg, prio, &rtos_task);
+#endif
     LWIP_ASSERT("task creation failed", ret == pdTRUE);
 
     lwip_thread.thread_handle = rtos_task;
@@ -456,4 +481,60 @@ sys_arch_unprotect(sys_prot_t pval)
 
 #endif /* SYS_LIGHTWEIGHT_PROT */
 
+#if LWIP_FREERTOS_CHECK_CORE_LOCKING
+#if LWIP_TCPIP_CORE_LOCKING
+
+/** Flag the core lock held. The lock is recursive, so only the outermost
+ * lock/unlock pair of a task changes the holder. */
+static TaskHandle_t lwip_core_lock_holder_thread;
+static u32_t lwip_core_lock_count;
+
+void
+sys_lock_tcpip_core(void)
+{
+    sys_mutex_lock(&lock_tcpip_core);
+    if (lwip_core_lock_count == 0) {
+        lwip_core_lock_holder_thread = xTaskGetCurrentTaskHandle();
+    }
+    lwip_core_lock_count++;
+}
+
+void
+sys_unlock_tcpip_core(void)
+{
+    lwip_core_lock_count--;
+    if (lwip_core_lock_count == 0) {
+        lwip_core_lock_holder_thread = NULL;
+    }
+    sys_mutex_unlock(&lock_tcpip_core);
+}
+
+#endif /* LWIP_TCPIP_CORE_LOCKING */
+
+static TaskHandle_t lwip_tcpip_thread;
+
+void
+sys_mark_tcpip_thread(void)
+{
+    lwip_tcpip_thread = xTaskGetCurrentTaskHandle();
+}
+
+void
+sys_check_core_locking(void)
+{
+    if (lwip_tcpip_thread != NULL) {
+        TaskHandle_t current_thread = xTaskGetCurrentTaskHandle();
+
+#if LWIP_TCPIP_CORE_LOCKING
+        LWIP_ASSERT("Function called without core lock",
+                    current_thread == lwip_core_lock_holder_thread && lwip_core_lock_count > 0);
+#else /* LWIP_TCPIP_CORE_LOCKING */
+        LWIP_ASSERT("Function called from wrong thread", current_thread == lwip_tcpip_thread);
+#endif /* LWIP_TCPIP_CORE_LOCKING */
+        LWIP_UNUSED_ARG(current_thread);
+    }
+}
+
+#endif /* LWIP_FREERTOS_CHECK_CORE_LOCKING */
+
 
@@ -570,6 +570,38 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
                  const unsigned char *input,
                  unsigned char *output );
 
+#if defined(MBEDTLS_RSA_PUBLIC_ALT)
+/**
+ * \brief          Alternative implementation of mbedtls_rsa_public(),
+ *                 called once the context has been checked.
+ *
+ * \return         #MBEDTLS_ERR_PLATFORM_FEATURE_UNSUPPORTED to let
+ *                 mbedtls_rsa_public() do the operation in software.
+ * \return         Any other value is returned by mbedtls_rsa_public().
+ */
+int mbedtls_rsa_public_alt( mbedtls_rsa_context *ctx,
+                const unsigned char *input,
+                unsigned char *output );
+#endif
+
+#if defined(MBEDTLS_RSA_PRIVATE_ALT)
+/**
+ * \brief          Alternative implementation of mbedtls_rsa_private(),
+ *                 called once the context has been checked, with the
+ *                 context mutex held. It is responsible for the
+ *                 blinding countermeasures.
+ *
+ * \return         #MBEDTLS_ERR_PLATFORM_FEATURE_UNSUPPORTED to let
+ *                 mbedtls_rsa_private() do the operation in software.
+ * \return         Any other value is returned by mbedtls_rsa_private().
+ */
+int mbedtls_rsa_private_alt( mbedtls_rsa_context *ctx,
+                 int (*f_rng)(void *, unsigned char *, size_t),
+                 void *p_rng,
+                 const unsigned char *input,
+                 unsigned char *output );
+#endif
+
 /**
  * \brief          This function adds the message padding, then performs an RSA
  *                 operation.
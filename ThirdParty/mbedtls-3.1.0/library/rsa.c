@@ -748,6 +748,12 @@ int mbedtls_rsa_public( mbedtls_rsa_context *ctx,
     if( rsa_check_context( ctx, 0 /* public */, 0 /* no blinding */ ) )
         return( MBEDTLS_ERR_RSA_BAD_INPUT_DATA );
 
+#if defined(MBEDTLS_RSA_PUBLIC_ALT)
+    ret = mbedtls_rsa_public_alt( ctx, input, output );
+    if( ret != MBEDTLS_ERR_PLATFORM_FEATURE_UNSUPPORTED )
+        return( ret );
+#endif
+
     mbedtls_mpi_init( &T );
 
 #if defined(MBEDTLS_THREADING_C)
@@ -929,6 +935,19 @@ int mbedtls_rsa_private( mbedtls_rsa_context *ctx,
         return( ret );
 #endif
 
+#if defined(MBEDTLS_RSA_PRIVATE_ALT)
+    /* The hook updates the blinding values, hence under the mutex */
+    ret = mbedtls_rsa_private_alt( ctx, f_rng, p_rng, input, output );
+    if( ret != MBEDTLS_ERR_PLATFORM_FEATURE_UNSUPPORTED )
+    {
+#if defined(MBEDTLS_THREADING_C)
+        if( mbedtls_mutex_unlock( &ctx->mutex ) != 0 )
+            return( MBEDTLS_ERR_THREADING_MUTEX_ERROR );
+#endif
+        return( ret );
+    }
+#endif
+
     /* MPI Initialization */
     mbedtls_mpi_init( &T );
 